@@ -12,8 +12,11 @@
 #include "profile.h"
 #include "../color.h"
 
+#include <algorithm>
 #include <boost/range/adaptor/reversed.hpp>
 #include <cairo.h>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <iostream>
 
@@ -73,7 +76,124 @@ TransformCairo::TransformCairo(std::shared_ptr<Profile> const &from,
       , false)
     , _pixel_size_in((_channels_in + 1) * sizeof(float))
     , _pixel_size_out((_channels_out + 1) * sizeof(float))
-{}
+{
+    // Gamut checking marks out of gamut colors with an alarm color that can be changed later by
+    // set_gamut_warn(), and a sampled table would blend it into neighbouring in-gamut colors.
+    if (_channels_in == 3 && _channels_out == 3 && !(proof && with_gamut_warn)) {
+        build_lut();
+    }
+}
+
+/**
+ * Sample the transform on a regular grid, so 8 bit surfaces can be transformed by
+ * interpolating in the table instead of running every pixel through lcms.
+ */
+void TransformCairo::build_lut()
+{
+    constexpr int N = LUT_SIZE;
+    std::vector<float> input;
+    input.reserve(N * N * N * 4);
+    for (int r = 0; r < N; r++) {
+        for (int g = 0; g < N; g++) {
+            for (int b = 0; b < N; b++) {
+                input.insert(input.end(), {(float)r / (N - 1), (float)g / (N - 1), (float)b / (N - 1), 1.0f});
+            }
+        }
+    }
+
+    std::vector<float> output(N * N * N * 4);
+    cmsDoTransform(_handle, input.data(), output.data(), N * N * N);
+
+    _lut.resize(N * N * N * 3);
+    for (int i = 0; i < N * N * N; i++) {
+        for (int c = 0; c < 3; c++) {
+            _lut[i * 3 + c] = std::clamp(output[i * 4 + c], 0.0f, 1.0f) * 255.0f;
+        }
+    }
+}
+
+/**
+ * Transform a premultiplied ARGB32 surface using tetrahedral interpolation in the lookup table.
+ */
+void TransformCairo::do_transform_lut(cairo_surface_t *in, cairo_surface_t *out) const
+{
+    constexpr int N = LUT_SIZE;
+    constexpr int stride_r = N * N * 3;
+    constexpr int stride_g = N * 3;
+    constexpr int stride_b = 3;
+
+    int const width = cairo_image_surface_get_width(in);
+    int const height = cairo_image_surface_get_height(in);
+    int const stride_in = cairo_image_surface_get_stride(in);
+    int const stride_out = cairo_image_surface_get_stride(out);
+    auto const px_in = cairo_image_surface_get_data(in);
+    auto const px_out = cairo_image_surface_get_data(out);
+    auto const lut = _lut.data();
+
+    for (int y = 0; y < height; y++) {
+        auto row_in = reinterpret_cast<std::uint32_t const *>(px_in + y * stride_in);
+        auto row_out = reinterpret_cast<std::uint32_t *>(px_out + y * stride_out);
+        for (int x = 0; x < width; x++) {
+            std::uint32_t const px = row_in[x];
+            std::uint32_t const a = px >> 24;
+            if (a == 0) {
+                row_out[x] = 0;
+                continue;
+            }
+
+            // Position in the grid of the unpremultiplied color.
+            float const scale = (N - 1) / (float)a;
+            float const fr = std::min<std::uint32_t>((px >> 16) & 0xff, a) * scale;
+            float const fg = std::min<std::uint32_t>((px >> 8) & 0xff, a) * scale;
+            float const fb = std::min<std::uint32_t>(px & 0xff, a) * scale;
+            int const ir = std::min((int)fr, N - 2);
+            int const ig = std::min((int)fg, N - 2);
+            int const ib = std::min((int)fb, N - 2);
+            float const dr = fr - ir;
+            float const dg = fg - ig;
+            float const db = fb - ib;
+
+            // Pick the tetrahedron of the cube containing the point and walk its edges.
+            auto const c000 = lut + ir * stride_r + ig * stride_g + ib * stride_b;
+            auto const c111 = c000 + stride_r + stride_g + stride_b;
+            float const *c1, *c2;
+            float w0, w1, w2, w3;
+            if (dr >= dg) {
+                if (dg >= db) {
+                    c1 = c000 + stride_r; c2 = c1 + stride_g;
+                    w0 = 1 - dr; w1 = dr - dg; w2 = dg - db; w3 = db;
+                } else if (dr >= db) {
+                    c1 = c000 + stride_r; c2 = c1 + stride_b;
+                    w0 = 1 - dr; w1 = dr - db; w2 = db - dg; w3 = dg;
+                } else {
+                    c1 = c000 + stride_b; c2 = c1 + stride_r;
+                    w0 = 1 - db; w1 = db - dr; w2 = dr - dg; w3 = dg;
+                }
+            } else {
+                if (db >= dg) {
+                    c1 = c000 + stride_b; c2 = c1 + stride_g;
+                    w0 = 1 - db; w1 = db - dg; w2 = dg - dr; w3 = dr;
+                } else if (db >= dr) {
+                    c1 = c000 + stride_g; c2 = c1 + stride_b;
+                    w0 = 1 - dg; w1 = dg - db; w2 = db - dr; w3 = dr;
+                } else {
+                    c1 = c000 + stride_g; c2 = c1 + stride_r;
+                    w0 = 1 - dg; w1 = dg - dr; w2 = dr - db; w3 = db;
+                }
+            }
+
+            // Premultiply the result again.
+            float const alpha = a / 255.0f;
+            std::uint32_t result = a << 24;
+            for (int c = 0; c < 3; c++) {
+                float const v = w0 * c000[c] + w1 * c1[c] + w2 * c2[c] + w3 * c111[c];
+                auto const channel = std::min<std::uint32_t>(std::lround(v * alpha), a);
+                result |= channel << (16 - c * 8);
+            }
+            row_out[x] = result;
+        }
+    }
+}
 
 /**
  * Apply the CMS transform to the cairo surface and paint it into the output surface.
@@ -93,6 +213,14 @@ void TransformCairo::do_transform(cairo_surface_t *in, cairo_surface_t *out) con
         throw ColorError("Different image formats while applying CMS!");
     }
 
+    if (has_lut() &&
+        cairo_image_surface_get_format(in) == CAIRO_FORMAT_ARGB32 &&
+        cairo_image_surface_get_format(out) == CAIRO_FORMAT_ARGB32) {
+        do_transform_lut(in, out);
+        cairo_surface_mark_dirty(out);
+        return;
+    }
+
     auto px_in = cairo_image_surface_get_data(in);
     auto px_out = cairo_image_surface_get_data(out);
 
@@ -10,6 +10,7 @@
 
 #include <cairomm/surface.h>
 #include <memory>
+#include <vector>
 
 #include "transform.h"
 
@@ -35,9 +36,20 @@ public:
 
     static std::vector<float> splice(std::vector<float *> inputs, int width, int height, int channels);
     static void premultiply(float *input, int width, int height, int channels = 3);
+
+    /// Number of grid points per axis of the lookup table used for 8 bit surfaces.
+    static constexpr int LUT_SIZE = 33;
+    bool has_lut() const { return !_lut.empty(); }
+
 private:
+    void build_lut();
+    void do_transform_lut(cairo_surface_t *in, cairo_surface_t *out) const;
+
     int _pixel_size_in;
     int _pixel_size_out;
+
+    // RGB to RGB transforms sampled on a LUT_SIZE^3 grid, empty for other transforms.
+    std::vector<float> _lut;
 };
 
 } // namespace Inkscape::Colors::CMS
@@ -21,6 +21,7 @@
 #include <2geom/line.h>
 
 #include "conn-avoid-ref.h"
+#include "conn-background-router.h"
 #include "desktop.h"
 #include "document-undo.h"
 #include "document.h"
@@ -352,6 +353,9 @@ void avoid_item_move(Geom::Affine const */*mp*/, SPItem *moved_item)
     Avoid::Polygon poly = avoid_item_poly(moved_item);
     if (!poly.empty()) {
         router->moveShape(shapeRef, poly);
+        if (moved_item->document->isRoutingDeferred()) {
+            moved_item->document->getBackgroundRouter().shapeMoved(shapeRef->id(), poly);
+        }
     }
 }
 
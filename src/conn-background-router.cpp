@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Connector routing on a worker thread during interactive transforms.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "conn-background-router.h"
+
+#include <libavoid/connector.h>
+#include <libavoid/connend.h>
+#include <libavoid/router.h>
+#include <libavoid/shape.h>
+
+#include "async/async.h"
+#include "document.h"
+#include "object/sp-conn-end-pair.h"
+#include "object/sp-conn-end.h"
+#include "object/sp-path.h"
+#include "object/sp-root.h"
+
+namespace Inkscape {
+
+/// What the worker thread routes. The paths only identify the connectors and are not used there.
+struct ConnBackgroundRouter::Snapshot
+{
+    struct Connector
+    {
+        SPPath *path;
+        Avoid::Point src;
+        Avoid::Point dst;
+        Avoid::ConnType type;
+        double curvature;
+    };
+
+    std::vector<Avoid::Polygon> obstacles;
+    std::vector<Connector> connectors;
+};
+
+namespace {
+
+void collect_connectors(SPObject *object, std::vector<SPPath *> &paths)
+{
+    if (auto path = cast<SPPath>(object); path && path->connEndPair.isAutoRoutingConn()) {
+        paths.push_back(path);
+    }
+    for (auto &child : object->children) {
+        collect_connectors(&child, paths);
+    }
+}
+
+std::vector<SPPath *> get_connectors(SPDocument &document)
+{
+    std::vector<SPPath *> paths;
+    if (auto root = document.getRoot()) {
+        collect_connectors(root, paths);
+    }
+    return paths;
+}
+
+} // namespace
+
+ConnBackgroundRouter::ConnBackgroundRouter(SPDocument &document)
+    : _document(document)
+{}
+
+void ConnBackgroundRouter::begin()
+{
+    _ends.clear();
+    for (auto path : get_connectors(_document)) {
+        Geom::Point ends[2];
+        path->connEndPair.getEndpoints(ends);
+        _ends[path] = {ends[0], ends[1]};
+    }
+}
+
+void ConnBackgroundRouter::shapeMoved(unsigned id, Avoid::Polygon polygon)
+{
+    _moved_shapes[id] = std::move(polygon);
+}
+
+void ConnBackgroundRouter::reroute()
+{
+    if (_running) {
+        _again = true;
+        return;
+    }
+    _start();
+}
+
+void ConnBackgroundRouter::finish()
+{
+    _channel.close();
+    _running = _again = false;
+    _moved_shapes.clear();
+    _ends.clear();
+
+    // Let the document's router draw these again, so that they end up with their final route.
+    for (auto path : get_connectors(_document)) {
+        if (_drawn.count(path)) {
+            sp_conn_reroute_path(path);
+        }
+    }
+    _drawn.clear();
+}
+
+void ConnBackgroundRouter::_start()
+{
+    Snapshot snapshot;
+
+    for (auto obstacle : _document.getRouter()->m_obstacles) {
+        // Junctions only exist for connectors that Inkscape doesn't create.
+        if (!dynamic_cast<Avoid::ShapeRef *>(obstacle)) {
+            continue;
+        }
+        auto const moved = _moved_shapes.find(obstacle->id());
+        snapshot.obstacles.push_back(moved != _moved_shapes.end() ? moved->second : obstacle->polygon());
+    }
+
+    for (auto path : get_connectors(_document)) {
+        auto &conn = path->connEndPair;
+        Geom::Point ends[2];
+        conn.getEndpoints(ends);
+
+        // Show connectors that moved as straight lines until they are routed.
+        auto const current = std::make_pair(ends[0], ends[1]);
+        auto [last, inserted] = _ends.emplace(path, current);
+        if (!inserted && last->second != current) {
+            last->second = current;
+            Geom::Path line(ends[0]);
+            line.appendNew<Geom::LineSegment>(ends[1]);
+            sp_conn_redraw_path_interim(path, Geom::PathVector(line));
+            _drawn.insert(path);
+        }
+
+        snapshot.connectors.push_back({path, Avoid::Point(ends[0].x(), ends[0].y()),
+                                       Avoid::Point(ends[1].x(), ends[1].y()),
+                                       conn.isOrthogonal() ? Avoid::ConnType_Orthogonal : Avoid::ConnType_PolyLine,
+                                       conn.getCurvature()});
+    }
+
+    auto [src, dst] = Async::Channel::create();
+    _channel = std::move(dst);
+    _running = true;
+
+    Async::fire_and_forget([src = std::move(src), snapshot = std::move(snapshot), this] {
+        auto routes = _route(snapshot);
+        // Only runs while the channel is open, and so while this object exists.
+        src.run([this, routes = std::move(routes)]() mutable { _apply(std::move(routes)); });
+    });
+}
+
+ConnBackgroundRouter::Routes ConnBackgroundRouter::_route(Snapshot const &snapshot)
+{
+    // Set up like the document's router, see the SPDocument constructor.
+    Avoid::Router router(Avoid::PolyLineRouting | Avoid::OrthogonalRouting);
+    router.setRoutingPenalty(Avoid::segmentPenalty);
+
+    for (auto polygon : snapshot.obstacles) {
+        // Owned by the router.
+        new Avoid::ShapeRef(&router, polygon);
+    }
+
+    std::vector<Avoid::ConnRef *> conn_refs;
+    conn_refs.reserve(snapshot.connectors.size());
+    for (auto const &connector : snapshot.connectors) {
+        auto conn_ref = new Avoid::ConnRef(&router, Avoid::ConnEnd(connector.src), Avoid::ConnEnd(connector.dst));
+        conn_ref->setRoutingType(connector.type);
+        conn_refs.push_back(conn_ref);
+    }
+
+    router.processTransaction();
+
+    Routes routes;
+    routes.reserve(conn_refs.size());
+    for (std::size_t i = 0; i < conn_refs.size(); i++) {
+        auto const &connector = snapshot.connectors[i];
+        routes.emplace_back(connector.path, SPConnEndPair::createCurve(conn_refs[i], connector.curvature));
+    }
+    return routes;
+}
+
+void ConnBackgroundRouter::_apply(Routes routes)
+{
+    _running = false;
+
+    // Connectors deleted in the meantime are skipped.
+    std::map<SPPath *, Geom::PathVector> by_path(std::make_move_iterator(routes.begin()),
+                                                  std::make_move_iterator(routes.end()));
+    for (auto path : get_connectors(_document)) {
+        auto route = by_path.find(path);
+        if (route != by_path.end() && !route->second.empty()) {
+            sp_conn_redraw_path_interim(path, std::move(route->second));
+            _drawn.insert(path);
+        }
+    }
+
+    if (_again) {
+        _again = false;
+        _start();
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
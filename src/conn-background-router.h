@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Connector routing on a worker thread during interactive transforms.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_CONN_BACKGROUND_ROUTER_H
+#define SEEN_CONN_BACKGROUND_ROUTER_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include <2geom/pathvector.h>
+#include <2geom/point.h>
+#include <libavoid/geomtypes.h>
+
+#include "async/channel.h"
+
+class SPDocument;
+class SPPath;
+
+namespace Inkscape {
+
+/**
+ * Routes the connectors of a document while its own router is held back, see
+ * SPDocument::setRoutingDeferred().
+ *
+ * Each reroute copies the obstacles and connector ends into a separate router, which runs on a
+ * worker thread. Connectors whose ends moved are drawn as straight lines until their route
+ * arrives. Neither the document's router nor the XML is touched: the routes drawn here are
+ * only shown, and the document's router computes the final ones once deferral ends.
+ */
+class ConnBackgroundRouter
+{
+public:
+    explicit ConnBackgroundRouter(SPDocument &document);
+    ConnBackgroundRouter(ConnBackgroundRouter const &) = delete;
+    ConnBackgroundRouter &operator=(ConnBackgroundRouter const &) = delete;
+
+    /// Remember where the connectors end now, so that only those that move are straightened.
+    void begin();
+    /// Record the new shape of a moved obstacle, which the document's router has only queued.
+    void shapeMoved(unsigned id, Avoid::Polygon polygon);
+    /// Route the document as it is now, or as soon as the routing in progress is done.
+    void reroute();
+    /// Drop the routing in progress and hand the connectors drawn here back to the document's router.
+    void finish();
+
+private:
+    struct Snapshot;
+    using Routes = std::vector<std::pair<SPPath *, Geom::PathVector>>;
+
+    void _start();
+    void _apply(Routes routes);
+    static Routes _route(Snapshot const &snapshot);
+
+    SPDocument &_document;
+    std::map<unsigned, Avoid::Polygon> _moved_shapes;
+    std::map<SPPath *, std::pair<Geom::Point, Geom::Point>> _ends;
+    std::set<SPPath *> _drawn; ///< Connectors showing a route from here rather than their own
+    Async::Channel::Dest _channel;
+    bool _running = false;
+    bool _again = false;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_CONN_BACKGROUND_ROUTER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,495 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * A single canvas item drawing many control handles.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "canvas-item-ctrl-batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <cairomm/context.h>
+
+#include "ui/widget/canvas.h"
+#include "ui/widget/events/canvas-event.h"
+
+namespace Inkscape {
+
+// Size of the cells of the spatial hash, in canvas units; a few handles across.
+constexpr double CELL_SIZE = 32;
+
+static std::uint64_t cell_key(int x, int y)
+{
+    return (std::uint64_t{static_cast<std::uint32_t>(x)} << 32) | static_cast<std::uint32_t>(y);
+}
+
+static int cell_of(double coord)
+{
+    constexpr double limit = 1 << 30;
+    return static_cast<int>(std::clamp(std::floor(coord / CELL_SIZE), -limit, limit));
+}
+
+CanvasItemCtrlBatch::CanvasItemCtrlBatch(CanvasItemGroup *group)
+    : CanvasItem(group)
+{
+    _name = "CanvasItemCtrlBatch";
+    _pickable = true;
+}
+
+CanvasItemCtrlBatch::~CanvasItemCtrlBatch()
+{
+    for (auto entry : _dirty) {
+        if (entry->removed) {
+            delete entry;
+        }
+    }
+    _entries.clear_and_dispose([] (auto entry) { delete entry; });
+}
+
+/**
+ * Add a handle of the given type, initially visible at the origin.
+ */
+CanvasItemCtrlBatch::Entry *CanvasItemCtrlBatch::add(CanvasItemCtrlType type)
+{
+    auto entry = new Entry;
+    entry->handle.type = type;
+    entry->width = Handles::get_size(entry->rel_size, Handles::get_default_size_index());
+    defer([=, this] {
+        entry->z = ++_top;
+        _entries.push_back(*entry);
+        _changed(entry);
+    });
+    return entry;
+}
+
+/**
+ * Remove a handle and free it.
+ */
+void CanvasItemCtrlBatch::remove(Entry *entry)
+{
+    defer([=, this] {
+        if (entry->visible && entry->bounds) {
+            get_canvas()->redraw_area(*entry->bounds);
+        }
+        _unhash(*entry);
+        _entries.erase(_entries.iterator_to(*entry));
+        if (_hovered == entry) {
+            _hovered = nullptr;
+        }
+        if (_grabbed == entry) {
+            _grabbed = nullptr;
+            CanvasItem::ungrab();
+        }
+        if (entry->dirty) {
+            entry->removed = true; // Freed by the next update, which would otherwise refer to it.
+        } else {
+            delete entry;
+        }
+    });
+}
+
+void CanvasItemCtrlBatch::set_position(Entry *entry, Geom::Point const &position)
+{
+    defer([=, this] {
+        if (entry->position == position) return;
+        entry->position = position;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_anchor(Entry *entry, SPAnchorType anchor)
+{
+    defer([=, this] {
+        if (entry->anchor == anchor) return;
+        entry->anchor = anchor;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::lower_to_bottom(Entry *entry)
+{
+    defer([=, this] {
+        _entries.erase(_entries.iterator_to(*entry));
+        _entries.push_front(*entry);
+        entry->z = --_bottom;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_visible(Entry *entry, bool visible)
+{
+    defer([=, this] {
+        if (entry->visible == visible) return;
+        entry->visible = visible;
+        if (entry->bounds) {
+            get_canvas()->redraw_area(*entry->bounds);
+        }
+    });
+}
+
+void CanvasItemCtrlBatch::set_type(Entry *entry, CanvasItemCtrlType type)
+{
+    auto const size_index = Handles::get_default_size_index();
+    defer([=, this] {
+        if (entry->handle.type == type) return;
+        entry->handle.type = type;
+        entry->width = Handles::get_size(entry->rel_size, size_index);
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_size(Entry *entry, HandleSize rel_size)
+{
+    auto const size_index = Handles::get_default_size_index();
+    defer([=, this] {
+        entry->rel_size = rel_size;
+        _set_size(entry, Handles::get_size(rel_size, size_index));
+    });
+}
+
+void CanvasItemCtrlBatch::set_size_default(Entry *entry)
+{
+    auto const size_index = Handles::get_default_size_index();
+    defer([=, this] {
+        _set_size(entry, Handles::get_size(entry->rel_size, size_index));
+    });
+}
+
+void CanvasItemCtrlBatch::set_size_via_index(int size_index)
+{
+    defer([=, this] {
+        for (auto &entry : _entries) {
+            entry.width = Handles::get_size(entry.rel_size, size_index);
+        }
+        _all_dirty = true;
+        request_update();
+    });
+}
+
+void CanvasItemCtrlBatch::_set_size(Entry *entry, int size)
+{
+    defer([=, this] {
+        if (entry->width == size) return;
+        entry->width = size;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_selected(Entry *entry, bool selected)
+{
+    defer([=, this] {
+        entry->handle.selected = selected;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_click(Entry *entry, bool click)
+{
+    defer([=, this] {
+        entry->handle.click = click;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_hover(Entry *entry, bool hover)
+{
+    defer([=, this] {
+        entry->handle.hover = hover;
+        _changed(entry);
+    });
+}
+
+/**
+ * Reset the state to normal or normal selected
+ */
+void CanvasItemCtrlBatch::set_normal(Entry *entry, bool selected)
+{
+    defer([=, this] {
+        entry->handle.selected = selected;
+        entry->handle.hover = false;
+        entry->handle.click = false;
+        _changed(entry);
+    });
+}
+
+void CanvasItemCtrlBatch::set_handler(Entry *entry, std::function<bool(CanvasEvent const &)> handler)
+{
+    entry->handler = std::move(handler);
+}
+
+/**
+ * Queue an update of one handle, whose look or geometry changed.
+ */
+void CanvasItemCtrlBatch::_changed(Entry *entry)
+{
+    if (!entry->dirty) {
+        entry->dirty = true;
+        _dirty.push_back(entry);
+    }
+    request_update();
+}
+
+void CanvasItemCtrlBatch::_update(bool propagate)
+{
+    auto const redraw = [this] (Entry const &entry) {
+        if (entry.visible && entry.bounds) {
+            get_canvas()->redraw_area(*entry.bounds);
+        }
+    };
+
+    if (propagate || _all_dirty) {
+        request_redraw();
+        _cells.clear();
+        _bounds = {};
+        for (auto &entry : _entries) {
+            entry.cells = {};
+            _update_entry(entry);
+            _hash(entry);
+            _bounds |= entry.bounds;
+        }
+        request_redraw();
+    } else {
+        // The bounds only grow here, which is harmless; they are tight again after a full update.
+        for (auto entry : _dirty) {
+            if (entry->removed) continue;
+            redraw(*entry);
+            _unhash(*entry);
+            _update_entry(*entry);
+            _hash(*entry);
+            _bounds |= entry->bounds;
+            redraw(*entry);
+        }
+    }
+
+    for (auto entry : _dirty) {
+        if (entry->removed) {
+            delete entry;
+        } else {
+            entry->dirty = false;
+        }
+    }
+    _dirty.clear();
+    _all_dirty = false;
+}
+
+void CanvasItemCtrlBatch::_update_entry(Entry &entry)
+{
+    // Setting the position to (inf, inf) to hide it is a pervasive hack we need to support.
+    if (!entry.position.isFinite()) {
+        entry.bounds = {};
+        return;
+    }
+
+    auto const &style = _context->handlesCss()->style_map.at(entry.handle);
+    double const width = Handles::get_total_width(style, entry.width);
+    double const w_half = width / 2;
+    auto const offset =
+        Handles::get_anchor_offset(style.shape(), entry.anchor, width, affine(), _context->yaxisdown(), entry.angle);
+
+    entry.pos = Geom::Point(-w_half, -w_half) + offset + entry.position * affine();
+    entry.bounds = Geom::Rect::from_xywh(entry.pos, {width, width}).roundOutwards();
+}
+
+void CanvasItemCtrlBatch::_mark_net_invisible()
+{
+    // The handles may be out of date when the batch shows again.
+    _all_dirty = true;
+    CanvasItem::_mark_net_invisible();
+}
+
+void CanvasItemCtrlBatch::_invalidate_ctrl_handles()
+{
+    assert(!_context->snapshotted()); // precondition
+    _all_dirty = true;
+    request_update();
+}
+
+void CanvasItemCtrlBatch::_hash(Entry &entry)
+{
+    if (!entry.bounds) {
+        entry.cells = {};
+        return;
+    }
+    entry.cells = Geom::IntRect(cell_of(entry.bounds->left()), cell_of(entry.bounds->top()),
+                                cell_of(entry.bounds->right()), cell_of(entry.bounds->bottom()));
+    for (int y = entry.cells->top(); y <= entry.cells->bottom(); y++) {
+        for (int x = entry.cells->left(); x <= entry.cells->right(); x++) {
+            _cells[cell_key(x, y)].push_back(&entry);
+        }
+    }
+}
+
+void CanvasItemCtrlBatch::_unhash(Entry &entry)
+{
+    if (!entry.cells) {
+        return;
+    }
+    for (int y = entry.cells->top(); y <= entry.cells->bottom(); y++) {
+        for (int x = entry.cells->left(); x <= entry.cells->right(); x++) {
+            auto const it = _cells.find(cell_key(x, y));
+            if (it == _cells.end()) continue;
+            std::erase(it->second, &entry);
+            if (it->second.empty()) {
+                _cells.erase(it);
+            }
+        }
+    }
+    entry.cells = {};
+}
+
+/**
+ * The topmost visible handle at @a p (in canvas units), as CanvasItemCtrl::contains() tells.
+ */
+CanvasItemCtrlBatch::Entry *CanvasItemCtrlBatch::_entry_at(Geom::Point const &p, double tolerance) const
+{
+    Entry *found = nullptr;
+    for (int y = cell_of(p.y() - tolerance); y <= cell_of(p.y() + tolerance); y++) {
+        for (int x = cell_of(p.x() - tolerance); x <= cell_of(p.x() + tolerance); x++) {
+            auto const it = _cells.find(cell_key(x, y));
+            if (it == _cells.end()) continue;
+            for (auto entry : it->second) {
+                if (!entry->visible || (found && found->z > entry->z)) continue;
+                bool const hit = tolerance == 0 ? entry->bounds->interiorContains(p)
+                                                : Geom::distance(p, entry->position * affine()) <= tolerance;
+                if (hit) {
+                    found = entry;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool CanvasItemCtrlBatch::contains(Geom::Point const &p, double tolerance)
+{
+    return _entry_at(p, tolerance);
+}
+
+void CanvasItemCtrlBatch::grab(Entry *entry, EventMask event_mask)
+{
+    CanvasItem::grab(event_mask);
+    if (get_canvas()->get_grabbed_canvas_item() == this) {
+        _grabbed = entry;
+    }
+}
+
+void CanvasItemCtrlBatch::ungrab(Entry *entry)
+{
+    if (_grabbed != entry) {
+        return;
+    }
+    _grabbed = nullptr;
+    CanvasItem::ungrab();
+}
+
+bool CanvasItemCtrlBatch::_emit(Entry *entry, CanvasEvent const &event)
+{
+    // The handler may remove its handle.
+    auto const handler = entry->handler;
+    return handler && handler(event);
+}
+
+/**
+ * Pass events on to the handle under the pointer, or to the one that holds the grab. The canvas
+ * only sees the batch, so tell the handles when the pointer moves from one to another.
+ */
+bool CanvasItemCtrlBatch::handle_event(CanvasEvent const &event)
+{
+    if (_grabbed) {
+        return _emit(_grabbed, event);
+    }
+
+    bool ret = false;
+
+    auto const hover = [&] (Entry *entry, unsigned modifiers, Geom::Point const &pos) {
+        if (entry == _hovered) {
+            return;
+        }
+        if (auto const left = std::exchange(_hovered, nullptr)) {
+            auto leave = LeaveEvent();
+            leave.modifiers = modifiers;
+            _emit(left, leave);
+        }
+        _hovered = entry;
+        if (_hovered) {
+            auto enter = EnterEvent();
+            enter.modifiers = modifiers;
+            enter.pos = pos;
+            ret = _emit(_hovered, enter);
+        }
+    };
+
+    inspect_event(event,
+        [&] (EnterEvent const &event) {
+            hover(_entry_at(event.pos), event.modifiers, event.pos);
+        },
+        [&] (LeaveEvent const &event) {
+            if (auto const left = std::exchange(_hovered, nullptr)) {
+                ret = _emit(left, event);
+            }
+        },
+        [&] (MotionEvent const &event) {
+            hover(_entry_at(event.pos), event.modifiers, event.pos);
+            ret = _hovered && _emit(_hovered, event);
+        },
+        [&] (CanvasEvent const &event) {
+            ret = _hovered && _emit(_hovered, event);
+        }
+    );
+
+    return ret || CanvasItem::handle_event(event);
+}
+
+/**
+ * Render the visible handles in the area, from the bottom up.
+ */
+void CanvasItemCtrlBatch::_render(CanvasItemBuffer &buf) const
+{
+    // Handles share a few looks, so draw (or fetch) each of them once per render.
+    std::map<std::tuple<Handles::TypeState, int, double>, std::shared_ptr<Cairo::ImageSurface const>> glyphs;
+    auto const &css = *_context->handlesCss();
+
+    for (auto const &entry : _entries) {
+        if (!entry.visible || !entry.bounds || !entry.bounds->interiorIntersects(buf.rect)) {
+            continue;
+        }
+
+        auto &glyph = glyphs[{entry.handle, entry.width, entry.angle}];
+        if (!glyph) {
+            auto const &style = css.style_map.at(entry.handle);
+            if (Handles::get_width(style, entry.width) < 1) {
+                continue; // Nothing to render
+            }
+            glyph = Handles::draw(Handles::get_render_params(style, entry.width, style.shape(), style.getFill(),
+                                                             style.getStroke(), entry.angle, buf.device_scale));
+        }
+
+        // Round to the device pixel at the very last minute so we get less bluring
+        auto const [x, y] = Geom::Point{(entry.pos * buf.device_scale).round()} / buf.device_scale - buf.rect.min();
+        cairo_set_source_surface(buf.cr->cobj(), const_cast<cairo_surface_t *>(glyph->cobj()), x, y); // C API is const-incorrect.
+        buf.cr->paint();
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_CANVAS_ITEM_CTRL_BATCH_H
+#define SEEN_CANVAS_ITEM_CTRL_BATCH_H
+
+/**
+ * A single canvas item drawing many control handles.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <boost/intrusive/list.hpp>
+#include <2geom/int-rect.h>
+
+#include "canvas-item-ctrl.h"
+
+namespace Inkscape {
+
+/**
+ * Draws the handles added to it in one pass, and finds the one under the pointer through a
+ * spatial hash, so that it takes one canvas item rather than one per handle to show the nodes and
+ * handles of large paths.
+ *
+ * Handles look and size themselves as a CanvasItemCtrl of the same type would. Events go to the
+ * handler of the handle under the pointer, or of the one holding the grab, and the handles get
+ * enter and leave events of their own as the pointer moves from one to another.
+ */
+class CanvasItemCtrlBatch final : public CanvasItem
+{
+public:
+    CanvasItemCtrlBatch(CanvasItemGroup *group);
+
+    using CanvasItem::grab;
+    using CanvasItem::lower_to_bottom;
+    using CanvasItem::set_visible;
+    using CanvasItem::ungrab;
+
+    /// One handle. Only changed through the batch, which owns it once added.
+    struct Entry
+    {
+        Geom::Point position;
+        Handles::TypeState handle;
+        SPAnchorType anchor = SP_ANCHOR_CENTER;
+        HandleSize rel_size = HandleSize::NORMAL;
+        int width = 5;
+        bool visible = true;
+        std::function<bool(CanvasEvent const &)> handler;
+
+        // Set by the batch
+        long z = 0; ///< Stacking order, higher is on top.
+        double angle = 0;
+        Geom::Point pos; ///< Top left corner of the glyph in canvas units.
+        Geom::OptRect bounds;
+        Geom::OptIntRect cells; ///< The cells of the spatial hash the entry is in.
+        bool dirty = false;
+        bool removed = false;
+        boost::intrusive::list_member_hook<> member_hook;
+    };
+
+    // Structure
+    Entry *add(CanvasItemCtrlType type);
+    void remove(Entry *entry);
+
+    // Geometry
+    void set_position(Entry *entry, Geom::Point const &position);
+    void set_anchor(Entry *entry, SPAnchorType anchor);
+    void lower_to_bottom(Entry *entry);
+
+    // Selection
+    bool contains(Geom::Point const &p, double tolerance = 0) override;
+    void grab(Entry *entry, EventMask event_mask);
+    void ungrab(Entry *entry);
+
+    // Display
+    void set_visible(Entry *entry, bool visible);
+
+    // Properties
+    void set_type(Entry *entry, CanvasItemCtrlType type);
+    void set_size(Entry *entry, HandleSize rel_size);
+    void set_size_default(Entry *entry);
+    void set_size_via_index(int size_index); ///< For all handles.
+    void set_selected(Entry *entry, bool selected = true);
+    void set_click(Entry *entry, bool click = true);
+    void set_hover(Entry *entry, bool hover = true);
+    void set_normal(Entry *entry, bool selected = false);
+    void _set_size(Entry *entry, int size);
+
+    // Events
+    void set_handler(Entry *entry, std::function<bool(CanvasEvent const &)> handler);
+    bool handle_event(CanvasEvent const &event) override;
+
+protected:
+    ~CanvasItemCtrlBatch() override;
+
+    void _update(bool propagate) override;
+    void _mark_net_invisible() override;
+    void _render(CanvasItemBuffer &buf) const override;
+    void _invalidate_ctrl_handles() override;
+
+private:
+    using EntryList = boost::intrusive::list<
+        Entry, boost::intrusive::member_hook<Entry, boost::intrusive::list_member_hook<>, &Entry::member_hook>>;
+
+    void _changed(Entry *entry);
+    void _update_entry(Entry &entry);
+    void _hash(Entry &entry);
+    void _unhash(Entry &entry);
+    Entry *_entry_at(Geom::Point const &p, double tolerance = 0) const;
+    bool _emit(Entry *entry, CanvasEvent const &event);
+
+    EntryList _entries; // In stacking order.
+    long _top = 0;
+    long _bottom = 0;
+
+    // Geometry
+    std::vector<Entry *> _dirty;
+    bool _all_dirty = true;
+
+    // Spatial hash of the glyphs, in cells of CELL_SIZE canvas units.
+    std::unordered_map<std::uint64_t, std::vector<Entry *>> _cells;
+
+    // Events
+    Entry *_hovered = nullptr;
+    Entry *_grabbed = nullptr;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_CANVAS_ITEM_CTRL_BATCH_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4 :
@@ -225,16 +225,12 @@ void CanvasItemCtrl::_set_size(int size)
 constexpr int MIN_INDEX = 1;
 constexpr int MAX_INDEX = 15;
 
-static int get_size_default() {
+int Handles::get_default_size_index()
+{
     return Preferences::get()->getIntLimited("/options/grabsize/value", 3, MIN_INDEX, MAX_INDEX);
 }
 
-void CanvasItemCtrl::set_size(HandleSize rel_size) {
-    _rel_size = rel_size;
-    set_size_via_index(get_size_default());
-}
-
-void CanvasItemCtrl::set_size_via_index(int size_index)
+int Handles::get_size(HandleSize rel_size, int size_index)
 {
     // Size must always be an odd number to center on pixel.
     if (size_index < MIN_INDEX || size_index > MAX_INDEX) {
@@ -242,30 +238,30 @@ void CanvasItemCtrl::set_size_via_index(int size_index)
         size_index = 3;
     }
 
-    auto size = std::clamp(size_index + static_cast<int>(_rel_size), MIN_INDEX, MAX_INDEX);
-    _set_size(size);
+    return std::clamp(size_index + static_cast<int>(rel_size), MIN_INDEX, MAX_INDEX);
 }
 
-float CanvasItemCtrl::get_width() const {
-    auto const &style = _context->handlesCss()->style_map.at(_handle);
-    auto size = _width * style.scale() + style.size_extra();
-    return size;
+void CanvasItemCtrl::set_size(HandleSize rel_size) {
+    _rel_size = rel_size;
+    set_size_via_index(Handles::get_default_size_index());
 }
 
-float CanvasItemCtrl::get_total_width() const {
-    const auto& style = _context->handlesCss()->style_map.at(_handle);
-    auto width = get_width() + get_stroke_width() + 2 * style.outline_width();
-    return width;
+void CanvasItemCtrl::set_size_via_index(int size_index)
+{
+    _set_size(Handles::get_size(_rel_size, size_index));
 }
 
-int CanvasItemCtrl::get_pixmap_width(int device_scale) const {
-    return std::round(get_total_width() * device_scale);
+float CanvasItemCtrl::get_width() const {
+    return Handles::get_width(_context->handlesCss()->style_map.at(_handle), _width);
+}
+
+float CanvasItemCtrl::get_total_width() const {
+    return Handles::get_total_width(_context->handlesCss()->style_map.at(_handle), _width);
 }
 
 void CanvasItemCtrl::set_size_default()
 {
-    int size = get_size_default();
-    set_size_via_index(size);
+    set_size_via_index(Handles::get_default_size_index());
 }
 
 void CanvasItemCtrl::set_type(CanvasItemCtrlType type)
@@ -344,48 +340,44 @@ static double angle_of(Geom::Affine const &affine)
     return std::atan2(affine[1], affine[0]);
 }
 
-/**
- * Update and redraw control ctrl.
- */
-void CanvasItemCtrl::_update(bool)
+namespace Handles {
+
+float get_width(Style const &style, int size)
 {
-    // Queue redraw of old area (erase previous content).
-    request_redraw();
+    return size * style.scale() + style.size_extra();
+}
 
-    // Setting the position to (inf, inf) to hide it is a pervasive hack we need to support.
-    if (!_position.isFinite()) {
-        _bounds = {};
-        return;
-    }
+float get_stroke_width(Style const &style, int size)
+{
+    // growing stroke width with handle size, if style enables it
+    return style.stroke_width() * (1.0f + size * style.stroke_scale());
+}
 
-    const auto width = static_cast<double>(get_total_width());
+float get_total_width(Style const &style, int size)
+{
+    return get_width(style, size) + get_stroke_width(style, size) + 2 * style.outline_width();
+}
 
-    // Get half width, rounded down.
+Geom::Point get_anchor_offset(CanvasItemCtrlShape shape, SPAnchorType anchor, double width,
+                              Geom::Affine const &affine, bool yaxisdown, double &angle)
+{
     double const w_half = width / 2;
-
-    // Set _angle, and compute adjustment for anchor.
     double dx = 0;
     double dy = 0;
 
-    CanvasItemCtrlShape shape = _shape;
-    if (!_shape_set) {
-        auto const &style = _context->handlesCss()->style_map.at(_handle);
-        shape = style.shape();
-    }
-
     switch (shape) {
     case CANVAS_ITEM_CTRL_SHAPE_DARROW:
     case CANVAS_ITEM_CTRL_SHAPE_SARROW:
     case CANVAS_ITEM_CTRL_SHAPE_CARROW:
     case CANVAS_ITEM_CTRL_SHAPE_SALIGN:
     case CANVAS_ITEM_CTRL_SHAPE_CALIGN: {
-        double angle = int{_anchor} * M_PI_4;
+        angle = int{anchor} * M_PI_4;
         // Affine flips if view orientation has been altered (horizontal or vertical flip).
         // But it also flips when Y axis is pointing up. We need to take both into account.
-        if (affine().flips() == _context->yaxisdown()) {
+        if (affine.flips() == yaxisdown) {
             angle = -angle;
         }
-        angle += angle_of(affine());
+        angle += angle_of(affine);
         double const half = width / 2.0;
 
         dx = -(half + 2) * cos(angle); // Add a bit to prevent tip from overlapping due to rounding errors.
@@ -415,27 +407,16 @@ void CanvasItemCtrl::_update(bool)
         default:
             break;
         }
-
-        if (_angle != angle) {
-            _angle = angle;
-            _built.reset();
-        }
-
         break;
     }
 
     case CANVAS_ITEM_CTRL_SHAPE_PIVOT:
-    case CANVAS_ITEM_CTRL_SHAPE_MALIGN: {
-        double const angle = angle_of(affine());
-        if (_angle != angle) {
-            _angle = angle;
-            _built.reset();
-        }
+    case CANVAS_ITEM_CTRL_SHAPE_MALIGN:
+        angle = angle_of(affine);
         break;
-    }
 
     default:
-        switch (_anchor) {
+        switch (anchor) {
         case SP_ANCHOR_N:
         case SP_ANCHOR_CENTER:
         case SP_ANCHOR_S:
@@ -454,7 +435,7 @@ void CanvasItemCtrl::_update(bool)
             break;
         }
 
-        switch (_anchor) {
+        switch (anchor) {
         case SP_ANCHOR_W:
         case SP_ANCHOR_CENTER:
         case SP_ANCHOR_E:
@@ -475,8 +456,69 @@ void CanvasItemCtrl::_update(bool)
         break;
     }
 
+    return {dx, dy};
+}
+
+RenderParams get_render_params(Style const &style, int size, CanvasItemCtrlShape shape, uint32_t fill,
+                               uint32_t stroke, double angle, int device_scale)
+{
+    // take size in logical pixels and make it fit physical pixel grid
+    auto pixel_fit = [=](float v) { return std::round(v * device_scale) / device_scale; };
+
+    return {
+        .shape = shape,
+        .fill = fill,
+        .stroke = stroke,
+        .outline = style.getOutline(),
+        // effective stroke width
+        .stroke_width = pixel_fit(get_stroke_width(style, size)),
+        // fixed-size outline
+        .outline_width = pixel_fit(style.outline_width()),
+        .width = static_cast<int>(std::round(get_total_width(style, size) * device_scale)),
+        // handle size
+        .size = std::floor(get_width(style, size) * device_scale) / device_scale,
+        .angle = angle,
+        .device_scale = device_scale
+    };
+}
+
+} // namespace Handles
+
+/**
+ * Update and redraw control ctrl.
+ */
+void CanvasItemCtrl::_update(bool)
+{
+    // Queue redraw of old area (erase previous content).
+    request_redraw();
+
+    // Setting the position to (inf, inf) to hide it is a pervasive hack we need to support.
+    if (!_position.isFinite()) {
+        _bounds = {};
+        return;
+    }
+
+    const auto width = static_cast<double>(get_total_width());
+
+    // Get half width, rounded down.
+    double const w_half = width / 2;
+
+    CanvasItemCtrlShape shape = _shape;
+    if (!_shape_set) {
+        auto const &style = _context->handlesCss()->style_map.at(_handle);
+        shape = style.shape();
+    }
+
+    // Set _angle, and compute adjustment for anchor.
+    double angle = _angle;
+    auto const offset = Handles::get_anchor_offset(shape, _anchor, width, affine(), _context->yaxisdown(), angle);
+    if (_angle != angle) {
+        _angle = angle;
+        _built.reset();
+    }
+
     // The location we want to place our anchor/ctrl point
-    _pos = Geom::Point(-w_half, -w_half) + Geom::Point(dx, dy) + _position * affine();
+    _pos = Geom::Point(-w_half, -w_half) + offset + _position * affine();
 
     // The bounding box we want to invalidate in cairo, rounded out to catch any stray pixels
     _bounds = Geom::Rect::from_xywh(_pos, {width, width}).roundOutwards();
@@ -512,10 +554,7 @@ void CanvasItemCtrl::_invalidate_ctrl_handles()
 }
 
 float CanvasItemCtrl::get_stroke_width() const {
-    const auto& style = _context->handlesCss()->style_map.at(_handle);
-    // growing stroke width with handle size, if style enables it
-    auto stroke_width = style.stroke_width() * (1.0f + _width * style.stroke_scale());
-    return stroke_width;
+    return Handles::get_stroke_width(_context->handlesCss()->style_map.at(_handle), _width);
 }
 
 /**
@@ -528,29 +567,11 @@ void CanvasItemCtrl::build_cache(int device_scale) const
         return; // Nothing to render
     }
 
-    // take size in logical pixels and make it fit physical pixel grid
-    auto pixel_fit = [=](float v) { return std::round(v * device_scale) / device_scale; };
-
     auto const &style = _context->handlesCss()->style_map.at(_handle);
-    // effective stroke width
-    auto stroke_width = pixel_fit(get_stroke_width());
-    // fixed-size outline
-    auto outline_width = pixel_fit(style.outline_width());
-    // handle size
-    auto size = std::floor(width * device_scale) / device_scale;
-
-    _cache = Handles::draw({
-        .shape = _shape_set ? _shape : style.shape(),
-        .fill = _fill_set ? _fill : style.getFill(),
-        .stroke = _stroke_set ? _stroke : style.getStroke(),
-        .outline = style.getOutline(),
-        .stroke_width = stroke_width,
-        .outline_width = outline_width,
-        .width = get_pixmap_width(device_scale),
-        .size = size,
-        .angle = _angle,
-        .device_scale = device_scale
-    });
+    _cache = Handles::draw(Handles::get_render_params(style, _width, _shape_set ? _shape : style.shape(),
+                                                      _fill_set ? _fill : style.getFill(),
+                                                      _stroke_set ? _stroke : style.getStroke(), _angle,
+                                                      device_scale));
 }
 
 } // namespace Inkscape
@@ -19,10 +19,12 @@
  */
 
 #include <memory>
+#include <2geom/affine.h>
 #include <2geom/point.h>
 
 #include "canvas-item.h"
 #include "canvas-item-enums.h"
+#include "ctrl-handle-rendering.h"
 #include "ctrl-handle-styling.h"
 
 #include "enums.h" // SP_ANCHOR_X
@@ -99,12 +101,33 @@ private:
 
     // get effective stroke width
     float get_stroke_width() const;
-    // get size of the pixmap needed to render this control item
-    int get_pixmap_width(int device_scale) const;
     // for debugging only - save handles to "handle.png"
     void _dump();
 };
 
+namespace Handles {
+
+// The geometry of handles, shared by CanvasItemCtrl and CanvasItemCtrlBatch.
+
+/// The size index of handles set in the preferences.
+int get_default_size_index();
+/// The size of a handle of relative size @a rel_size, for size index @a size_index.
+int get_size(HandleSize rel_size, int size_index);
+/// Size of a handle of size index @a size, in logical pixels, without its stroke and outline.
+float get_width(Style const &style, int size);
+float get_stroke_width(Style const &style, int size);
+/// Size of a handle of size index @a size, in logical pixels, with its stroke and outline.
+float get_total_width(Style const &style, int size);
+/// Offset from the anchor point of a handle @a width wide to the centre of its glyph, in canvas
+/// units. Sets @a angle for the shapes that point somewhere.
+Geom::Point get_anchor_offset(CanvasItemCtrlShape shape, SPAnchorType anchor, double width,
+                              Geom::Affine const &affine, bool yaxisdown, double &angle);
+/// How to draw a handle of size index @a size; only worth it if get_width() is at least 1.
+RenderParams get_render_params(Style const &style, int size, CanvasItemCtrlShape shape, uint32_t fill,
+                               uint32_t stroke, double angle, int device_scale);
+
+} // namespace Handles
+
 } // namespace Inkscape
 
 #endif // SEEN_CANVAS_ITEM_CTRL_H
@@ -15,10 +15,17 @@
 
 #include "canvas-item-group.h"
 
+#include <algorithm>
+#include <cmath>
 #include <ranges>
 
 constexpr bool DEBUG_LOGGING = false;
 
+// Groups with fewer children are picked from by testing each one.
+constexpr std::size_t PICK_GRID_MIN_ITEMS = 64;
+// Items covering more cells than this are always tested.
+constexpr int PICK_GRID_MAX_CELLS_PER_ITEM = 16;
+
 namespace Inkscape {
 
 CanvasItemGroup::CanvasItemGroup(CanvasItemGroup *group)
@@ -46,9 +53,23 @@ void CanvasItemGroup::_update(bool propagate)
 
     // Update all children and calculate new bounds.
     for (auto &item : items) {
-        item.update(propagate);
+        if (_pick_grid) {
+            auto const old_bounds = item.get_bounds();
+            item.update(propagate);
+            // Items without bounds are left out while hidden, so also move those that show.
+            if (item.get_bounds() != old_bounds || (!old_bounds && _pick_grid->is_hidden(item) == item.is_visible())) {
+                _pick_grid->move(item);
+            }
+        } else {
+            item.update(propagate);
+        }
         _bounds |= item.get_bounds();
     }
+
+    // Children that moved out of the grid are tested on every pick; rebuild it once they are many.
+    if (_pick_grid && _pick_grid->large.size() > PICK_GRID_MIN_ITEMS + items.size() / 8) {
+        _invalidate_pick_grid();
+    }
 }
 
 void CanvasItemGroup::_mark_net_invisible()
@@ -62,6 +83,7 @@ void CanvasItemGroup::_mark_net_invisible()
         item._mark_net_invisible();
     }
     _bounds = {};
+    _invalidate_pick_grid();
 }
 
 void CanvasItemGroup::visit_page_rects(std::function<void(Geom::Rect const &)> const &f) const
@@ -86,6 +108,119 @@ void CanvasItemGroup::_invalidate_ctrl_handles()
     }
 }
 
+int CanvasItemGroup::PickGrid::cell(Geom::Point const &p, Geom::Dim2 d) const
+{
+    auto const i = static_cast<int>((p[d] - area[d].min()) / area[d].extent() * size);
+    return std::clamp(i, 0, size - 1);
+}
+
+void CanvasItemGroup::PickGrid::add(PickEntry const &entry, Geom::OptRect const &bounds)
+{
+    // Entries are kept in stacking order.
+    auto const insert = [&] (std::vector<PickEntry> &entries) {
+        auto const pos = std::upper_bound(entries.begin(), entries.end(), entry.order,
+                                          [] (int order, PickEntry const &e) { return order < e.order; });
+        entries.insert(pos, entry);
+    };
+
+    auto &slot = slots[entry.item];
+    slot = {entry.order};
+
+    // Hidden items can't be picked, and get bounds, so are moved, as they show again.
+    if (!bounds && !entry.item->is_visible()) {
+        slot.hidden = true;
+        return;
+    }
+
+    if (!cells.empty() && bounds && bounds->isFinite() && area.contains(*bounds)) {
+        slot.x0 = cell(bounds->min(), Geom::X);
+        slot.x1 = cell(bounds->max(), Geom::X);
+        slot.y0 = cell(bounds->min(), Geom::Y);
+        slot.y1 = cell(bounds->max(), Geom::Y);
+        slot.large = (slot.x1 - slot.x0 + 1) * (slot.y1 - slot.y0 + 1) > PICK_GRID_MAX_CELLS_PER_ITEM;
+    } else {
+        slot.large = true;
+    }
+
+    if (slot.large) {
+        insert(large);
+        return;
+    }
+    for (int y = slot.y0; y <= slot.y1; y++) {
+        for (int x = slot.x0; x <= slot.x1; x++) {
+            insert(cells[y * size + x]);
+        }
+    }
+}
+
+void CanvasItemGroup::PickGrid::remove(CanvasItem const *item)
+{
+    auto const it = slots.find(item);
+    if (it == slots.end()) {
+        return;
+    }
+    auto const &slot = it->second;
+    auto const erase = [&] (std::vector<PickEntry> &entries) {
+        auto const pos = std::lower_bound(entries.begin(), entries.end(), slot.order,
+                                          [] (PickEntry const &e, int order) { return e.order < order; });
+        if (pos != entries.end() && pos->item == item) {
+            entries.erase(pos);
+        }
+    };
+
+    if (slot.hidden) {
+        // Nowhere to remove it from.
+    } else if (slot.large) {
+        erase(large);
+    } else {
+        for (int y = slot.y0; y <= slot.y1; y++) {
+            for (int x = slot.x0; x <= slot.x1; x++) {
+                erase(cells[y * size + x]);
+            }
+        }
+    }
+    slots.erase(it);
+}
+
+bool CanvasItemGroup::PickGrid::is_hidden(CanvasItem const &item) const
+{
+    auto const it = slots.find(&item);
+    return it != slots.end() && it->second.hidden;
+}
+
+void CanvasItemGroup::PickGrid::move(CanvasItem &item)
+{
+    auto const it = slots.find(&item);
+    if (it == slots.end()) {
+        return;
+    }
+    auto const order = it->second.order;
+    remove(&item);
+    add({order, &item}, item.get_bounds());
+}
+
+void CanvasItemGroup::_build_pick_grid()
+{
+    auto &grid = _pick_grid.emplace();
+
+    Geom::OptRect area;
+    for (auto &item : items) {
+        if (auto const &bounds = item.get_bounds(); bounds && bounds->isFinite()) {
+            area |= *bounds;
+        }
+    }
+    if (area && !area->hasZeroArea()) {
+        grid.area = *area;
+        grid.size = std::clamp(static_cast<int>(std::ceil(std::sqrt(items.size()))), 1, 256);
+        grid.cells.resize(grid.size * grid.size);
+    }
+
+    int order = 0;
+    for (auto &item : items) {
+        grid.add({order++, &item}, item.get_bounds());
+    }
+}
+
 // Return last visible and pickable item that contains point.
 // SPCanvasGroup returned distance but it was not used.
 CanvasItem *CanvasItemGroup::pick_item(Geom::Point const &p)
@@ -95,18 +230,48 @@ CanvasItem *CanvasItemGroup::pick_item(Geom::Point const &p)
         std::cout << "  PICKING: In group: " << _name << "  bounds: " << _bounds << std::endl;
     }
 
-    for (auto &item : items | std::views::reverse) {
+    auto const pick = [&] (CanvasItem &item) -> CanvasItem * {
         if constexpr (DEBUG_LOGGING) std::cout << "    PICKING: Checking: " << item.get_name() << "  bounds: " << item.get_bounds() << std::endl;
 
         if (item.is_visible() && item.is_pickable() && item.contains(p)) {
             if (auto group = dynamic_cast<CanvasItemGroup*>(&item)) {
-                if (auto ret = group->pick_item(p)) {
-                    return ret;
-                }
-            } else {
-                return &item;
+                return group->pick_item(p);
+            }
+            return &item;
+        }
+        return nullptr;
+    };
+
+    if (items.size() < PICK_GRID_MIN_ITEMS) {
+        for (auto &item : items | std::views::reverse) {
+            if (auto ret = pick(item)) {
+                return ret;
             }
         }
+        return nullptr;
+    }
+
+    if (!_pick_grid) {
+        _build_pick_grid();
+    }
+    auto const &grid = *_pick_grid;
+
+    // Only items whose bounds contain the point can contain it, so those in the point's cell and
+    // the large ones. Test them from the top down, as above.
+    static std::vector<PickEntry> const no_entries;
+    auto const *cell = &no_entries;
+    if (!grid.cells.empty() && grid.area.contains(p)) {
+        cell = &grid.cells[grid.cell(p, Geom::Y) * grid.size + grid.cell(p, Geom::X)];
+    }
+
+    auto a = cell->rbegin();
+    auto b = grid.large.rbegin();
+    while (a != cell->rend() || b != grid.large.rend()) {
+        bool const take_a = b == grid.large.rend() || (a != cell->rend() && a->order > b->order);
+        auto &entry = take_a ? *a++ : *b++;
+        if (auto ret = pick(*entry.item)) {
+            return ret;
+        }
     }
 
     return nullptr;
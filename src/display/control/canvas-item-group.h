@@ -16,6 +16,10 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 #include "canvas-item.h"
 
 namespace Inkscape {
@@ -53,6 +57,44 @@ protected:
                                       &Inkscape::CanvasItem::member_hook>>;
 
     CanvasItemList items;
+
+    /**
+     * Uniform grid over the bounds of the children, so that picking among many items (such as the
+     * nodes of a large path) only tests those near the point. Built lazily; children that move
+     * are moved in it, and it is rebuilt when children are added, removed or restacked.
+     */
+    struct PickEntry
+    {
+        int order; // Position in items, for stacking order.
+        CanvasItem *item;
+    };
+    struct PickGrid
+    {
+        Geom::Rect area;
+        int size = 0; // Number of cells along each axis.
+        std::vector<std::vector<PickEntry>> cells;
+        std::vector<PickEntry> large; // Unbounded items, or ones covering too many cells.
+
+        // Where each item is, to move it.
+        struct Slot
+        {
+            int order;
+            bool hidden = false; // In neither the cells nor the large items.
+            bool large = false;
+            int x0 = 0, y0 = 0, x1 = -1, y1 = -1; // Range of cells.
+        };
+        std::unordered_map<CanvasItem const *, Slot> slots;
+
+        int cell(Geom::Point const &p, Geom::Dim2 d) const;
+        void add(PickEntry const &entry, Geom::OptRect const &bounds);
+        void remove(CanvasItem const *item);
+        void move(CanvasItem &item);
+        bool is_hidden(CanvasItem const &item) const;
+    };
+    std::optional<PickGrid> _pick_grid;
+
+    void _build_pick_grid();
+    void _invalidate_pick_grid() { _pick_grid.reset(); }
 };
 
 } // namespace Inkscape
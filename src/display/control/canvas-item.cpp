@@ -17,6 +17,7 @@
 #include "canvas-item.h"
 #include "canvas-item-group.h"
 #include "canvas-item-ctrl.h"
+#include "canvas-item-ctrl-batch.h"
 
 #include "ui/widget/canvas.h"
 
@@ -40,6 +41,7 @@ CanvasItem::CanvasItem(CanvasItemGroup *parent)
     if constexpr (DEBUG_LOGGING) std::cout << "CanvasItem: add " << get_name() << " to " << parent->get_name() << " " << parent->items.size() << std::endl;
     defer([=, this] {
         parent->items.push_back(*this);
+        parent->_invalidate_pick_grid();
         request_update();
     });
 }
@@ -56,6 +58,7 @@ void CanvasItem::unlink()
             auto it = _parent->items.iterator_to(*this);
             assert(it != _parent->items.end());
             _parent->items.erase(it);
+            _parent->_invalidate_pick_grid();
             _parent->request_update();
         } else {
             if constexpr (DEBUG_LOGGING) std::cout << "CanvasItem: destroy root " << get_name() << std::endl;
@@ -102,6 +105,7 @@ void CanvasItem::set_z_position(int zpos)
             std::advance(it, zpos);
             _parent->items.insert(it, *this);
         }
+        _parent->_invalidate_pick_grid();
     });
 }
 
@@ -115,6 +119,7 @@ void CanvasItem::raise_to_top()
     defer([=, this] {
         _parent->items.erase(_parent->items.iterator_to(*this));
         _parent->items.push_back(*this);
+        _parent->_invalidate_pick_grid();
     });
 }
 
@@ -128,6 +133,7 @@ void CanvasItem::lower_to_bottom()
     defer([=, this] {
         _parent->items.erase(_parent->items.iterator_to(*this));
         _parent->items.push_front(*this);
+        _parent->_invalidate_pick_grid();
     });
 }
 
@@ -341,6 +347,8 @@ void CanvasItem::update_canvas_item_ctrl_sizes(int size_index)
     if (auto ctrl = dynamic_cast<CanvasItemCtrl*>(this)) {
         // We can't use set_size_default as the preference file is updated ->after<- the signal is emitted!
         ctrl->set_size_via_index(size_index);
+    } else if (auto batch = dynamic_cast<CanvasItemCtrlBatch*>(this)) {
+        batch->set_size_via_index(size_index);
     } else if (auto group = dynamic_cast<CanvasItemGroup*>(this)) {
         for (auto &item : group->items) {
             item.update_canvas_item_ctrl_sizes(size_index);
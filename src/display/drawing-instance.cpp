@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Display content shared between the instances of a clone.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "drawing-instance.h"
+
+#include <cmath>
+
+#include "drawing-context.h"
+#include "drawing-surface.h"
+#include "drawing.h"
+
+namespace Inkscape {
+namespace {
+
+// Content larger than this on screen is rendered directly rather than kept as a raster.
+constexpr int RASTER_MAX_PIXELS = 512 * 512;
+// Bound on the rasters of one prototype, in bytes.
+constexpr std::size_t RASTER_BUDGET = 16 * 1024 * 1024;
+
+/// The settings of a drawing that the rendering of its items depends on.
+std::array<int, 5> drawing_settings(Drawing const &drawing)
+{
+    return {static_cast<int>(drawing.renderMode()), static_cast<int>(drawing.colorMode()),
+            drawing.outlineOverlay(), drawing.filterQuality(), drawing.blurQuality()};
+}
+
+Geom::OptIntRect shifted(Geom::OptIntRect const &rect, Geom::Point const &shift)
+{
+    if (!rect) {
+        return {};
+    }
+    return (Geom::Rect(*rect) * Geom::Translate(shift)).roundOutwards();
+}
+
+} // namespace
+
+DrawingPrototype::DrawingPrototype(Drawing &drawing, ShowFunc show, HideFunc hide)
+    : _drawing(drawing)
+    , _show(std::move(show))
+    , _hide(std::move(hide))
+{}
+
+void DrawingPrototype::contentChanged()
+{
+    // The content itself has already been changed through the object tree.
+    _drawing.defer([self = shared_from_this()] {
+        self->_rasters.clear();
+        self->_raster_bytes = 0;
+        for (auto instance : self->_instances) {
+            instance->_contentChanged();
+        }
+    });
+}
+
+void DrawingPrototype::hideContent()
+{
+    for (auto &tree : _trees) {
+        if (tree.root) {
+            _hide(tree.root);
+        }
+    }
+    _show = {};
+    _hide = {};
+
+    _drawing.defer([self = shared_from_this()] {
+        for (auto &tree : self->_trees) {
+            tree.root = nullptr;
+        }
+        self->_rasters.clear();
+        self->_raster_bytes = 0;
+    });
+}
+
+DrawingPrototype::Tree *DrawingPrototype::_acquireTree(Geom::Affine const &linear)
+{
+    for (auto &tree : _trees) {
+        if (Geom::are_near(tree.linear, linear)) {
+            tree.users++;
+            return &tree;
+        }
+    }
+
+    if (!_show) {
+        return nullptr;
+    }
+    auto const root = _show();
+    if (!root) {
+        return nullptr;
+    }
+    // Not part of the rendering tree, so that changes to it don't redraw the canvas.
+    root->_child_type = DrawingItem::ChildType::PROTOTYPE;
+
+    auto &tree = _trees.emplace_back();
+    tree.linear = linear;
+    tree.root = root;
+    tree.users = 1;
+    _updateTree(tree, linear, DrawingItem::STATE_ALL);
+    return &tree;
+}
+
+void DrawingPrototype::_releaseTree(Tree *tree)
+{
+    if (--tree->users > 0) {
+        return;
+    }
+    // Keep the last tree around, the instances are likely to come back to it.
+    if (tree->root && _trees.size() == 1) {
+        return;
+    }
+    if (tree->root && _hide) {
+        _hide(tree->root);
+    }
+    _rasters.remove_if([&, this] (Raster const &raster) {
+        if (!Geom::are_near(raster.linear, tree->linear)) {
+            return false;
+        }
+        _raster_bytes -= raster.bytes;
+        return true;
+    });
+    _trees.remove_if([=] (Tree const &t) { return &t == tree; });
+}
+
+void DrawingPrototype::_updateTree(Tree &tree, Geom::Affine const &ctm, unsigned flags)
+{
+    if (!tree.root) {
+        return;
+    }
+    // Only the content and the settings of the drawing change the tree at a given transform;
+    // what changes the instances doesn't.
+    unsigned reset = 0;
+    auto const settings = drawing_settings(_drawing);
+    if (!Geom::are_near(tree.ctm, ctm) || tree.settings != settings) {
+        reset = DrawingItem::STATE_ALL;
+    }
+    tree.ctm = ctm;
+    tree.settings = settings;
+    tree.root->update(Geom::IntRect::infinite(), {ctm}, flags, reset);
+}
+
+std::shared_ptr<DrawingSurface const> DrawingPrototype::_raster(Tree &tree, Geom::IntPoint const &phase)
+{
+    if (!tree.root) {
+        return {};
+    }
+
+    auto const device_scale = _device_scale.load(std::memory_order_relaxed);
+    auto const settings = drawing_settings(_drawing);
+    for (auto it = _rasters.begin(); it != _rasters.end(); ++it) {
+        if (it->phase == phase && it->device_scale == device_scale && it->settings == settings &&
+            Geom::are_near(it->linear, tree.linear))
+        {
+            _rasters.splice(_rasters.begin(), _rasters, it);
+            return it->surface;
+        }
+    }
+
+    // The size hardly depends on the position, so don't move the tree to find out.
+    auto const current = tree.root->drawbox();
+    if (!current || current->area() > RASTER_MAX_PIXELS) {
+        return {};
+    }
+
+    _updateTree(tree, tree.linear * Geom::Translate(Geom::Point(phase) / 4), DrawingItem::STATE_ALL);
+    auto const box = tree.root->drawbox();
+    if (!box) {
+        return {};
+    }
+
+    auto surface = std::make_shared<DrawingSurface>(*box, device_scale);
+    {
+        DrawingContext dc(*surface);
+        tree.root->render(dc, *box);
+    }
+
+    auto const bytes = std::size_t(box->area()) * 4 * device_scale * device_scale;
+    _rasters.push_front({tree.linear, phase, device_scale, settings, surface, bytes});
+    _raster_bytes += bytes;
+    // Those still in use by an instance stay alive until it moves on.
+    while (_raster_bytes > RASTER_BUDGET && _rasters.size() > 1) {
+        _raster_bytes -= _rasters.back().bytes;
+        _rasters.pop_back();
+    }
+    return surface;
+}
+
+DrawingInstance::DrawingInstance(Drawing &drawing, std::shared_ptr<DrawingPrototype> prototype)
+    : DrawingItem(drawing)
+    , _prototype(std::move(prototype))
+{
+    _prototype->_instances.insert(this);
+}
+
+DrawingInstance::~DrawingInstance()
+{
+    if (_tree) {
+        _prototype->_releaseTree(_tree);
+    }
+    _prototype->_instances.erase(this);
+}
+
+Geom::Point DrawingInstance::_shift() const
+{
+    return _translation - _tree->ctm.translation();
+}
+
+void DrawingInstance::_contentChanged()
+{
+    _markForRendering();
+    _markForUpdate(STATE_ALL, false);
+}
+
+unsigned DrawingInstance::_updateItem(Geom::IntRect const &/*area*/, UpdateContext const &ctx, unsigned flags, unsigned /*reset*/)
+{
+    auto &prototype = *_prototype;
+    auto const linear = ctx.ctm.withoutTranslation();
+    if (!_tree || !Geom::are_near(_tree->linear, linear)) {
+        auto const tree = prototype._acquireTree(linear);
+        if (_tree) {
+            prototype._releaseTree(_tree);
+        }
+        _tree = tree;
+    }
+
+    _bbox = {};
+    _raster.reset();
+    if (!_tree || !_tree->root) {
+        return STATE_ALL;
+    }
+
+    auto const translation = ctx.ctm.translation();
+    if (_drawing.renderMode() == RenderMode::NORMAL && !_drawing.outlineOverlay()) {
+        // Paint the raster of the nearest quarter-pixel position at a whole pixel offset.
+        auto whole = translation.floor();
+        auto phase = ((translation - Geom::Point(whole)) * 4).round();
+        for (auto d : {Geom::X, Geom::Y}) {
+            if (phase[d] == 4) {
+                phase[d] = 0;
+                whole[d] += 1;
+            }
+        }
+        _raster = prototype._raster(*_tree, phase);
+        _raster_shift = whole;
+    }
+
+    // No-op unless the content changed since another instance updated the tree.
+    prototype._updateTree(*_tree, _tree->ctm, flags);
+    _translation = translation;
+
+    bool const outline = _drawing.renderMode() == RenderMode::OUTLINE || _drawing.outlineOverlay();
+    auto const &root = *_tree->root;
+    _bbox = shifted(outline ? root.bbox() : root.drawbox(), _shift());
+    if (_bbox) {
+        // Later instances may still move the tree by a fraction of a pixel.
+        _bbox->expandBy(1);
+    }
+    _update_complexity += root.getUpdateComplexity();
+    _contains_unisolated_blend |= root.unisolatedBlend();
+
+    return STATE_ALL;
+}
+
+unsigned DrawingInstance::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const
+{
+    if (!_tree || !_tree->root) {
+        return RENDER_OK;
+    }
+
+    int const device_scale = dc.surface()->device_scale();
+    bool const plain = !(flags & (RENDER_OUTLINE | RENDER_NO_FILTERS | RENDER_VISIBLE_HAIRLINES));
+    if (_raster && plain && _raster->device_scale() == device_scale) {
+        Inkscape::DrawingContext::Save save(dc);
+        dc.translate(Geom::Point(_raster_shift));
+        // See DrawingImage::_renderItem() for why this is safe.
+        dc.setSource(const_cast<DrawingSurface *>(_raster.get()));
+        dc.paint();
+        return RENDER_OK;
+    }
+    if (plain) {
+        // Rasterize for this device scale from the next update on.
+        _prototype->_device_scale.store(device_scale, std::memory_order_relaxed);
+    }
+
+    auto const shift = _shift();
+    Inkscape::DrawingContext::Save save(dc);
+    dc.translate(shift);
+    auto const tree_area = (Geom::Rect(area) * Geom::Translate(-shift)).roundOutwards();
+    _tree->root->render(dc, rc, tree_area, flags, stop_at);
+    return RENDER_OK;
+}
+
+void DrawingInstance::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const
+{
+    if (!_tree || !_tree->root) {
+        return;
+    }
+
+    auto const shift = _shift();
+    Inkscape::DrawingContext::Save save(dc);
+    dc.translate(shift);
+    auto const tree_area = (Geom::Rect(area) * Geom::Translate(-shift)).roundOutwards();
+    _tree->root->clip(dc, rc, tree_area);
+}
+
+DrawingItem *DrawingInstance::_pickItem(Geom::Point const &p, double delta, unsigned flags)
+{
+    if (!_tree || !_tree->root) {
+        return nullptr;
+    }
+    // The items of the tree belong to the clone's content, so answer for them.
+    return _tree->root->pick(p - _shift(), delta, flags) ? this : nullptr;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
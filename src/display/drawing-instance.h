@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Display content shared between the instances of a clone.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_DRAWING_INSTANCE_H
+#define INKSCAPE_DISPLAY_DRAWING_INSTANCE_H
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_set>
+#include <2geom/affine.h>
+
+#include "display/drawing-item.h"
+
+namespace Inkscape {
+
+class DrawingInstance;
+class DrawingSurface;
+
+/**
+ * The content of a clone as shown by all of its instances in one Drawing.
+ *
+ * The content is shown once for each linear transform (zoom and rotation) that instances are
+ * drawn at, through the callbacks of the object tree. Those trees are not part of the rendering
+ * tree; the instances update them and render them shifted to their own position.
+ *
+ * Small content is also rasterized once for each linear transform and quarter-pixel position,
+ * and instances at that position paint the raster shifted by whole pixels. The rasters of one
+ * prototype are bounded in total size, the least recently used ones are dropped first.
+ */
+class DrawingPrototype : public std::enable_shared_from_this<DrawingPrototype>
+{
+public:
+    using ShowFunc = std::function<DrawingItem *()>;
+    using HideFunc = std::function<void (DrawingItem *)>;
+
+    DrawingPrototype(Drawing &drawing, ShowFunc show, HideFunc hide);
+    DrawingPrototype(DrawingPrototype const &) = delete;
+    DrawingPrototype &operator=(DrawingPrototype const &) = delete;
+
+    /// Drop the rasters and redraw the instances, after the shared content changed.
+    void contentChanged();
+    /// Hide the content for good, once the object tree no longer provides it.
+    void hideContent();
+
+    std::size_t rasterBytes() const { return _raster_bytes; }
+
+private:
+    struct Tree
+    {
+        Geom::Affine linear;
+        Geom::Affine ctm; ///< The linear transform plus the sub-pixel position it was updated at.
+        DrawingItem *root = nullptr;
+        int users = 0;
+        std::array<int, 5> settings{}; ///< The settings of the drawing it was updated with.
+    };
+
+    struct Raster
+    {
+        Geom::Affine linear;
+        Geom::IntPoint phase; ///< Sub-pixel position in quarter pixels.
+        int device_scale;
+        std::array<int, 5> settings;
+        std::shared_ptr<DrawingSurface const> surface;
+        std::size_t bytes;
+    };
+
+    Tree *_acquireTree(Geom::Affine const &linear);
+    void _releaseTree(Tree *tree);
+    void _updateTree(Tree &tree, Geom::Affine const &ctm, unsigned flags);
+    std::shared_ptr<DrawingSurface const> _raster(Tree &tree, Geom::IntPoint const &phase);
+
+    Drawing &_drawing;
+    ShowFunc _show;
+    HideFunc _hide;
+    std::list<Tree> _trees;
+    std::list<Raster> _rasters; ///< Most recently used first
+    std::size_t _raster_bytes = 0;
+    std::unordered_set<DrawingInstance *> _instances;
+    std::atomic<int> _device_scale = 1; ///< Device scale last rendered at, to rasterize for.
+
+    friend class DrawingInstance;
+};
+
+/**
+ * Shows the content of a DrawingPrototype at the transform of this item.
+ */
+class DrawingInstance
+    : public DrawingItem
+{
+public:
+    DrawingInstance(Drawing &drawing, std::shared_ptr<DrawingPrototype> prototype);
+    int tag() const override { return tag_of<decltype(*this)>; }
+
+protected:
+    ~DrawingInstance() override;
+
+    unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
+    unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
+    void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const override;
+    DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
+    bool _canClip() const override { return true; }
+
+private:
+    void _contentChanged();
+    /// From the coordinates of the tree, as it was last updated, to those of this item.
+    Geom::Point _shift() const;
+
+    std::shared_ptr<DrawingPrototype> _prototype;
+    DrawingPrototype::Tree *_tree = nullptr;
+    Geom::Point _translation;
+    std::shared_ptr<DrawingSurface const> _raster;
+    Geom::IntPoint _raster_shift;
+
+    friend class DrawingPrototype;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_DRAWING_INSTANCE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -1116,6 +1116,7 @@ void DrawingItem::_markForRendering()
 
     // dirty the caches of all parents
     DrawingItem *bkg_root = nullptr;
+    DrawingItem *top = this;
 
     for (auto i = this; i; i = i->_parent) {
         if (i != this && i->_filter) {
@@ -1128,12 +1129,18 @@ void DrawingItem::_markForRendering()
         if (i->_background_accumulate) {
             bkg_root = i;
         }
+        top = i;
     }
 
     if (bkg_root && bkg_root->_parent && bkg_root->_parent->_parent) {
         bkg_root->_invalidateFilterBackground(*dirty);
     }
 
+    // Prototypes are not on the canvas at these coordinates; their instances redraw themselves.
+    if (top->_child_type == ChildType::PROTOTYPE) {
+        return;
+    }
+
     if (auto canvasitem = drawing().getCanvasItemDrawing()) {
         canvasitem->get_canvas()->redraw_area(*dirty);
     }
@@ -175,7 +175,8 @@ protected:
         MASK   = 3, // Referenced by mask of parent.
         FILL   = 4, // Referenced by fill pattern of parent.
         STROKE = 5, // Referenced by stroke pattern of parent.
-        ROOT   = 6  // Referenced by root of drawing.
+        ROOT   = 6, // Referenced by root of drawing.
+        PROTOTYPE = 7 // No parent, shown through DrawingInstances.
     };
     enum RenderResult
     {
@@ -265,6 +266,7 @@ protected:
     }
 
     friend class Drawing;
+    friend class DrawingPrototype;
 };
 
 /// Apply antialias setting to Cairo.
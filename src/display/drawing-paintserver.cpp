@@ -1,10 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include "drawing-paintserver.h"
 
+#include <algorithm>
 #include <utility>
+#include <2geom/transforms.h>
 
 #include "cairo-utils.h"
 #include "colors/color.h"
+#include "dispatch-pool.h"
+#include "threading.h"
 
 namespace Inkscape {
 
@@ -120,12 +124,8 @@ cairo_pattern_t *DrawingRadialGradient::create_pattern(cairo_t *ct, Geom::OptRec
     return pat;
 }
 
-cairo_pattern_t *DrawingMeshGradient::create_pattern(cairo_t *, Geom::OptRect const &bbox, double opacity) const
+cairo_pattern_t *DrawingMeshGradient::create_mesh(double opacity) const
 {
-#ifdef MESH_DEBUG
-    std::cout << "sp_meshgradient_create_pattern: " << bbox << " " << opacity << std::endl;
-#endif
-
     auto pat = cairo_pattern_create_mesh();
 
     for (int i = 0; i < rows; i++) {
@@ -172,17 +172,149 @@ cairo_pattern_t *DrawingMeshGradient::create_pattern(cairo_t *, Geom::OptRect co
         }
     }
 
+    return pat;
+}
+
+/// Bounds of the mesh in gradient space, including all control points.
+Geom::OptRect DrawingMeshGradient::mesh_bounds() const
+{
+    Geom::OptRect bounds;
+    for (auto &row : patchdata) {
+        for (auto &data : row) {
+            for (int k = 0; k < 4; k++) {
+                for (auto &point : data.points[k]) {
+                    bounds.expandTo(point);
+                }
+                if (data.tensorIsSet[k]) {
+                    bounds.expandTo(data.tensorpoints[k]);
+                }
+            }
+        }
+    }
+    return bounds;
+}
+
+cairo_pattern_t *DrawingMeshGradient::create_pattern(cairo_t *ct, Geom::OptRect const &bbox, double opacity) const
+{
     // set pattern transform matrix
     Geom::Affine gs2user = transform;
     if (units == SP_GRADIENT_UNITS_OBJECTBOUNDINGBOX && bbox) {
         Geom::Affine bbox2user(bbox->width(), 0, 0, bbox->height(), bbox->left(), bbox->top());
         gs2user *= bbox2user;
     }
-    ink_cairo_pattern_set_matrix(pat, gs2user.inverse());
 
+    // Only rasterize when painting into an image; vector output keeps the real mesh.
+    auto const target = ct ? cairo_get_target(ct) : nullptr;
+    auto const bounds = mesh_bounds();
+    if (!target || cairo_surface_get_type(target) != CAIRO_SURFACE_TYPE_IMAGE || !bounds || gs2user.isSingular()) {
+        auto pat = create_mesh(opacity);
+        ink_cairo_pattern_set_matrix(pat, gs2user.inverse());
+        return pat;
+    }
+
+    // Resolution of the gradient space in device pixels.
+    cairo_matrix_t ctm;
+    cairo_get_matrix(ct, &ctm);
+    double device_scale_x, device_scale_y;
+    cairo_surface_get_device_scale(target, &device_scale_x, &device_scale_y);
+    auto const gs2device = gs2user * ink_matrix_to_2geom(ctm) * Geom::Scale(device_scale_x, device_scale_y);
+    auto const scale = Geom::Point(Geom::L2(Geom::Point(gs2device[0], gs2device[1])),
+                                   Geom::L2(Geom::Point(gs2device[2], gs2device[3])));
+    auto const user2raster = gs2user.inverse() * Geom::Scale(scale);
+
+    // The tiles of the raster under the area being painted, with a pixel to spare for filtering.
+    double x0, y0, x1, y1;
+    cairo_clip_extents(ct, &x0, &y0, &x1, &y1);
+    auto area = (Geom::Rect(x0, y0, x1, y1) * user2raster).roundOutwards();
+    area.expandBy(1);
+    auto const visible = area & (*bounds * Geom::Scale(scale)).roundOutwards();
+    if (!visible || visible->hasZeroArea()) {
+        return cairo_pattern_create_rgba(0, 0, 0, 0);
+    }
+    auto const tile_of = [] (int px) { return px >= 0 ? px / TILE_SIZE : -((TILE_SIZE - 1 - px) / TILE_SIZE); };
+    auto const first = Geom::IntPoint(tile_of(visible->left()), tile_of(visible->top()));
+    auto const count = Geom::IntPoint(tile_of(visible->right() - 1), tile_of(visible->bottom() - 1)) - first + Geom::IntPoint(1, 1);
+    if (static_cast<std::size_t>(count.x()) * count.y() > MAX_TILES) {
+        auto pat = create_mesh(opacity);
+        ink_cairo_pattern_set_matrix(pat, gs2user.inverse());
+        return pat;
+    }
+    int const num_tiles = count.x() * count.y();
+    auto const tile_pos = [&] (int i) { return first + Geom::IntPoint(i % count.x(), i / count.x()); };
+    auto const key = [&] (int i) {
+        auto const pos = tile_pos(i);
+        return TileKey{scale.x(), scale.y(), opacity, pos.x(), pos.y()};
+    };
+
+    std::vector<Cairo::RefPtr<Cairo::ImageSurface>> surfaces(num_tiles);
+    std::vector<int> missing;
+    {
+        auto lock = std::lock_guard(mutables);
+        for (int i = 0; i < num_tiles; i++) {
+            if (auto it = tiles.find(key(i)); it != tiles.end()) {
+                it->second.last_use = ++tile_clock;
+                surfaces[i] = it->second.surface;
+            } else {
+                missing.push_back(i);
+            }
+        }
+    }
+
+    // Rasterize the missing tiles in parallel, without holding up other renders of the mesh.
+    if (!missing.empty()) {
+        auto mesh = create_mesh(opacity);
+        auto const pool = get_global_dispatch_pool();
+        pool->dispatch_threshold(missing.size(), missing.size() > 1, [&] (int i, int) {
+            auto const pos = tile_pos(missing[i]);
+            auto surface = Cairo::ImageSurface::create(Cairo::ImageSurface::Format::ARGB32, TILE_SIZE, TILE_SIZE);
+            auto tile_ct = cairo_create(surface->cobj());
+            cairo_translate(tile_ct, -pos.x() * TILE_SIZE, -pos.y() * TILE_SIZE);
+            cairo_scale(tile_ct, scale.x(), scale.y());
+            cairo_set_source(tile_ct, mesh);
+            cairo_paint(tile_ct);
+            cairo_destroy(tile_ct);
+            surfaces[missing[i]] = std::move(surface);
+        });
+        cairo_pattern_destroy(mesh);
+
+        auto lock = std::lock_guard(mutables);
+        for (auto i : missing) {
+            // Another render may have rasterized the same tile meanwhile; either will do.
+            tiles.try_emplace(key(i), Tile{surfaces[i], ++tile_clock});
+        }
+        while (tiles.size() > MAX_TILES) {
+            tiles.erase(std::min_element(tiles.begin(), tiles.end(), [] (auto const &a, auto const &b) {
+                return a.second.last_use < b.second.last_use;
+            }));
+        }
+    }
+
+    // Sample from the tile, or from a copy of the tiles put side by side.
+    auto surface = surfaces.front();
+    if (num_tiles > 1) {
+        surface = Cairo::ImageSurface::create(Cairo::ImageSurface::Format::ARGB32, count.x() * TILE_SIZE, count.y() * TILE_SIZE);
+        auto joined_ct = cairo_create(surface->cobj());
+        cairo_set_operator(joined_ct, CAIRO_OPERATOR_SOURCE);
+        for (int i = 0; i < num_tiles; i++) {
+            int const x = i % count.x() * TILE_SIZE, y = i / count.x() * TILE_SIZE;
+            cairo_set_source_surface(joined_ct, surfaces[i]->cobj(), x, y);
+            cairo_rectangle(joined_ct, x, y, TILE_SIZE, TILE_SIZE);
+            cairo_fill(joined_ct);
+        }
+        cairo_destroy(joined_ct);
+    }
+
+    auto pat = cairo_pattern_create_for_surface(surface->cobj());
+    ink_cairo_pattern_set_matrix(pat, user2raster * Geom::Translate(-first.x() * TILE_SIZE, -first.y() * TILE_SIZE));
     return pat;
 }
 
+std::size_t DrawingMeshGradient::cached_tiles() const
+{
+    auto lock = std::lock_guard(mutables);
+    return tiles.size();
+}
+
 } // namespace Inkscape
 
 /*
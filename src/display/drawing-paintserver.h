@@ -12,8 +12,14 @@
  */
 
 #include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tuple>
 #include <vector>
 #include <cairo.h>
+#include <cairomm/surface.h>
 #include <2geom/rect.h>
 #include <2geom/affine.h>
 #include "object/sp-gradient-spread.h"
@@ -161,12 +167,43 @@ public:
         , cols(cols)
         , patchdata(std::move(patchdata)) {}
 
-    cairo_pattern_t *create_pattern(cairo_t*, Geom::OptRect const &bbox, double opacity) const override;
+    cairo_pattern_t *create_pattern(cairo_t *ct, Geom::OptRect const &bbox, double opacity) const override;
+
+    /// Rasterized tiles are only valid for the area and resolution they were painted at.
+    bool uses_cairo_ctx() const override { return true; }
+
+    /// Side of the square tiles the mesh is rasterized in, in device pixels.
+    static constexpr int TILE_SIZE = 256;
+    /// Most tiles kept per mesh, 32 MiB worth.
+    static constexpr std::size_t MAX_TILES = 128;
+
+    /// The number of tiles currently cached, for testing.
+    std::size_t cached_tiles() const;
 
 private:
+    cairo_pattern_t *create_mesh(double opacity) const;
+    Geom::OptRect mesh_bounds() const;
+
     int rows;
     int cols;
     std::vector<std::vector<PatchData>> patchdata;
+
+    /**
+     * Rasterization of the mesh in gradient space. Cairo rasterizes the Coons patches again for
+     * every area it is painted into, so the mesh is rasterized in fixed tiles at the resolution it
+     * is painted at, which later renders sample from. The least recently used tiles are dropped
+     * once they take more than a fixed amount of memory. Read/written on render.
+     */
+    using TileKey = std::tuple<double, double, double, int, int>; ///< Scale, opacity, position.
+    struct Tile
+    {
+        Cairo::RefPtr<Cairo::ImageSurface> surface;
+        std::uint64_t last_use;
+    };
+
+    mutable std::mutex mutables;
+    mutable std::map<TileKey, Tile> tiles;
+    mutable std::uint64_t tile_clock = 0;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Constant-time average colour lookups over a rendered area.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "drawing-sampler.h"
+
+#include <cairo.h>
+
+#include "cairo-utils.h"
+#include "drawing.h"
+#include "drawing-context.h"
+
+namespace Inkscape {
+
+/**
+ * Render @a area of @a drawing once and build the table from it.
+ */
+DrawingSampler::DrawingSampler(Drawing const &drawing, Geom::IntRect const &area)
+    : _area(area)
+{
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, area.width(), area.height());
+    {
+        auto dc = DrawingContext(surface, area.min());
+        drawing.render(dc, area);
+    }
+    _build(surface);
+    cairo_surface_destroy(surface);
+}
+
+/**
+ * Build the table from an ARGB32 image surface whose top left pixel is at @a origin.
+ */
+DrawingSampler::DrawingSampler(cairo_surface_t *surface, Geom::IntPoint const &origin)
+    : _area(Geom::IntRect::from_xywh(origin, {cairo_image_surface_get_width(surface),
+                                              cairo_image_surface_get_height(surface)}))
+{
+    _build(surface);
+}
+
+void DrawingSampler::_build(cairo_surface_t *surface)
+{
+    int const width = _area.width();
+    int const height = _area.height();
+    if (std::int64_t{width} * height > MAX_PIXELS) {
+        g_warning("DrawingSampler: area too large, sums would overflow.");
+        _area = Geom::IntRect::from_xywh(_area.min(), {0, 0});
+        return;
+    }
+
+    cairo_surface_flush(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+    int const stride = cairo_image_surface_get_stride(surface);
+
+    int const row = width + 1;
+    _sums.assign(std::size_t(row) * (height + 1), {0, 0, 0, 0});
+
+    for (int y = 0; y < height; ++y) {
+        auto const px = reinterpret_cast<guint32 const *>(data + y * stride);
+        std::array<std::uint32_t, 4> line{0, 0, 0, 0};
+        auto const above = &_sums[std::size_t(y) * row];
+        auto const here = &_sums[std::size_t(y + 1) * row];
+        for (int x = 0; x < width; ++x) {
+            EXTRACT_ARGB32(px[x], a, r, g, b)
+            line[0] += a;
+            line[1] += r;
+            line[2] += g;
+            line[3] += b;
+            for (int c = 0; c < 4; ++c) {
+                here[x + 1][c] = above[x + 1][c] + line[c];
+            }
+        }
+    }
+}
+
+Colors::Color DrawingSampler::averageColor(Geom::IntRect const &box) const
+{
+    auto const count = double(box.width()) * box.height();
+    auto const inside = box & _area;
+    if (count <= 0 || !inside || _sums.empty()) {
+        return Colors::Color(0x0);
+    }
+
+    std::size_t const row = _area.width() + 1;
+    auto const x0 = inside->left() - _area.left();
+    auto const x1 = inside->right() - _area.left();
+    auto const y0 = inside->top() - _area.top();
+    auto const y1 = inside->bottom() - _area.top();
+
+    // Unsigned wrap-around cancels out, the true sum always fits.
+    std::array<double, 4> sum;
+    for (int c = 0; c < 4; ++c) {
+        std::uint32_t const s = _sums[y1 * row + x1][c] - _sums[y0 * row + x1][c]
+                              - _sums[y1 * row + x0][c] + _sums[y0 * row + x0][c];
+        sum[c] = s / 255.0;
+    }
+
+    if (sum[0] <= 0) {
+        return Colors::Color(0x0);
+    }
+    auto color = Colors::Color(Colors::Space::Type::RGB, {sum[1] / sum[0], sum[2] / sum[0], sum[3] / sum[0],
+                                                          sum[0] / count});
+    color.normalize();
+    return color;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
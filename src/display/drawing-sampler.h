@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Constant-time average colour lookups over a rendered area.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_DRAWING_SAMPLER_H
+#define INKSCAPE_DISPLAY_DRAWING_SAMPLER_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <2geom/rect.h>
+
+#include "colors/color.h"
+
+extern "C" {
+typedef struct _cairo_surface cairo_surface_t;
+}
+
+namespace Inkscape {
+class Drawing;
+
+/**
+ * Summed-area table of the premultiplied channels of a rendered area. Once built, the average
+ * colour of any rectangle inside it costs four lookups, so picking many small boxes out of one
+ * large area (e.g. the Clone Tiler's trace mode) needs a single render instead of one per box.
+ */
+class DrawingSampler
+{
+public:
+    /// Largest area, in pixels, that a sampler will be built for; beyond it sums could overflow.
+    static constexpr std::int64_t MAX_PIXELS = 1 << 22;
+
+    DrawingSampler(Drawing const &drawing, Geom::IntRect const &area);
+    DrawingSampler(cairo_surface_t *surface, Geom::IntPoint const &origin);
+
+    Geom::IntRect const &area() const { return _area; }
+
+    /// Average colour over @a box, matching ink_cairo_surface_average_color() on a render of it.
+    /// Pixels of @a box outside area() count as transparent.
+    Colors::Color averageColor(Geom::IntRect const &box) const;
+
+private:
+    void _build(cairo_surface_t *surface);
+
+    Geom::IntRect _area;
+    /// (width + 1) x (height + 1) running sums of a, r, g, b with a zero first row and column.
+    std::vector<std::array<std::uint32_t, 4>> _sums;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_DRAWING_SAMPLER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -139,6 +139,7 @@ private:
     void defer(F &&f) { _snapshotted ? _funclog.emplace(std::forward<F>(f)) : f(); }
 
     friend class DrawingItem;
+    friend class DrawingPrototype;
 };
 
 } // namespace Inkscape
@@ -306,6 +306,13 @@ auto NRStyle::preparePaint(Inkscape::DrawingContext &dc, Inkscape::RenderContext
         return CairoPatternUniqPtr(pattern->renderPattern(rc, area, paint.opacity, dc.surface()->device_scale()));
     }
 
+    // Paint servers whose pattern depends on the cairo context can't be cached.
+    if (paint.type == NRStyleData::PaintType::SERVER && paint.server && paint.server->uses_cairo_ctx()) {
+        auto pat = CairoPatternUniqPtr(paint.server->create_pattern(dc.raw(), paintbox, paint.opacity));
+        ink_cairo_pattern_set_dither(pat.get(), rc.dithering && paint.server->ditherable());
+        return pat;
+    }
+
     // Otherwise, init or re-use cached pattern.
     cp.inited.init([&] {
         // Handle remaining non-DrawingPattern cases.
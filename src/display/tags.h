@@ -16,6 +16,7 @@
 X(DrawingItem,\
     X(DrawingShape)\
     X(DrawingImage)\
+    X(DrawingInstance)\
     X(DrawingGroup,\
         X(DrawingPattern)\
         X(DrawingText)\
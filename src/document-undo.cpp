@@ -48,6 +48,7 @@
 #include "document-undo.h"
 
 #include <glibmm/ustring.h>                 // for ustring, operator==
+#include <zlib.h>                           // for compress2, uncompress
 #include <vector>                           // for vector
 
 #include "document.h"                       // for SPDocument
@@ -167,6 +168,8 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc,
 
     bool limit_undo = Inkscape::Preferences::get()->getBool("/options/undo/limit");
     auto undo_size = Inkscape::Preferences::get()->getInt("/options/undo/size", 200);
+    // Memory budget of the undo history in MiB, zero means no budget.
+    auto undo_budget = Inkscape::Preferences::get()->getInt("/options/undo/budget", 0);
 
     // Undo size zero will cause crashes when changing the preference during an active document
     assert(undo_size > 0);
@@ -191,9 +194,15 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc,
     bool expired = doc->undo_timer && std::chrono::steady_clock::now() - *doc->undo_timer > std::chrono::duration<double>(doc->action_expires);
     if (key && !expired && !doc->actionkey.empty() && (doc->actionkey == key) && !doc->undo.empty()) {
         doc->undo.back()->event = sp_repr_coalesce_log(doc->undo.back()->event, log);
+        updateBytes(doc, doc->undo.back());
     } else {
         Inkscape::Event *event = new Inkscape::Event(log, event_description.c_str(), icon_name);
+        // The step below is final now, so its long values can be stored as deltas.
+        if (!doc->undo.empty()) {
+            compact(doc, doc->undo.back());
+        }
         doc->undo.push_back(event);
+        updateBytes(doc, event);
         doc->undoStackObservers.notifyUndoCommitEvent(event);
     }
 
@@ -221,11 +230,117 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc,
             Inkscape::Event *e = doc->undo.front();
             doc->undoStackObservers.notifyUndoExpired(e);
             doc->undo.pop_front();
+            doc->undo_bytes -= e->bytes;
             delete e;
         }
+        if (undo_budget > 0) {
+            enforceBudget(doc, static_cast<std::size_t>(undo_budget) * 1024 * 1024);
+        }
+    }
+}
+
+/**
+ * Measure the memory held by a step of the undo stack again and update the running total.
+ */
+void Inkscape::DocumentUndo::updateBytes(SPDocument *doc, Inkscape::Event *event)
+{
+    auto const bytes = sp_repr_log_memory_usage(event->event);
+    doc->undo_bytes = doc->undo_bytes - event->bytes + bytes;
+    event->bytes = bytes;
+}
+
+/**
+ * Store the long values changed by a step of the undo stack as deltas against their neighbours.
+ */
+void Inkscape::DocumentUndo::compact(SPDocument *doc, Inkscape::Event *event)
+{
+    if (!event->spilled) {
+        sp_repr_compact_log(event->event);
+        updateBytes(doc, event);
     }
 }
 
+/**
+ * Move the deltas of a step of the undo stack to the document's spill file.
+ * @return Whether anything was moved.
+ */
+bool Inkscape::DocumentUndo::spill(SPDocument *doc, Inkscape::Event *event)
+{
+    if (event->spilled) {
+        return false;
+    }
+    auto const data = sp_repr_spill_log(event->event);
+    if (data.empty()) {
+        return false;
+    }
+
+    if (!doc->undo_spill) {
+        doc->undo_spill = std::make_unique<UndoSpillFile>();
+    }
+    event->spilled = doc->undo_spill->write(data);
+    if (!event->spilled) {
+        // Keep the data in memory after all.
+        sp_repr_unspill_log(event->event, data);
+        return false;
+    }
+    updateBytes(doc, event);
+    return true;
+}
+
+/**
+ * Read back the spilled deltas of a step before it is undone or redone.
+ * @return False if they could not be read, in which case the step cannot be used.
+ */
+bool Inkscape::DocumentUndo::load(SPDocument *doc, Inkscape::Event *event)
+{
+    if (!event->spilled) {
+        return true;
+    }
+    auto const data = doc->undo_spill ? doc->undo_spill->read(*event->spilled) : std::nullopt;
+    if (!data || !sp_repr_unspill_log(event->event, *data)) {
+        g_warning("Cannot read undo data back from the temporary file.");
+        return false;
+    }
+    event->spilled.reset();
+    return true;
+}
+
+/**
+ * Bring the memory held by the undo stack under @a budget bytes. Long values are already stored
+ * as deltas; next, the oldest steps are spilled to a temporary file if the preferences allow it,
+ * and only if that is not enough are the oldest steps dropped. The most recent step is always
+ * kept, however large it is.
+ */
+void Inkscape::DocumentUndo::enforceBudget(SPDocument *doc, std::size_t budget)
+{
+    if (doc->undo_bytes <= budget) {
+        return;
+    }
+
+    if (Inkscape::Preferences::get()->getBool("/options/undo/spill", true)) {
+        for (auto it = doc->undo.begin(); it + 1 < doc->undo.end() && doc->undo_bytes > budget; ++it) {
+            spill(doc, *it);
+        }
+    }
+
+    while (doc->undo_bytes > budget && doc->undo.size() > 1) {
+        Inkscape::Event *e = doc->undo.front();
+        doc->undoStackObservers.notifyUndoExpired(e);
+        doc->undo.pop_front();
+        doc->undo_bytes -= e->bytes;
+        delete e;
+    }
+}
+
+std::size_t Inkscape::DocumentUndo::getUndoMemoryUsage(SPDocument const *doc)
+{
+    std::size_t total = doc->undo_bytes;
+    for (auto const e : doc->redo) {
+        total += e->bytes;
+    }
+    return total;
+}
+
 void Inkscape::DocumentUndo::cancel(SPDocument *doc)
 {
     g_assert (doc != nullptr);
@@ -247,6 +362,7 @@ void Inkscape::DocumentUndo::finish_incomplete_transaction(SPDocument &doc) {
         if (!doc.undo.empty()) {
             Inkscape::Event* undo_stack_top = doc.undo.back();
             undo_stack_top->event = sp_repr_coalesce_log(undo_stack_top->event, doc.partial);
+            updateBytes(&doc, undo_stack_top);
         } else {
             sp_repr_free_log(doc.partial);
         }
@@ -270,6 +386,7 @@ void Inkscape::DocumentUndo::perform_document_update(SPDocument &doc) {
         if (!doc.undo.empty()) {
             Inkscape::Event* undo_stack_top = doc.undo.back();
             undo_stack_top->event = sp_repr_coalesce_log(undo_stack_top->event, update_log);
+            updateBytes(&doc, undo_stack_top);
         } else {
             sp_repr_free_log(update_log);
         }
@@ -293,9 +410,15 @@ gboolean Inkscape::DocumentUndo::undo(SPDocument *doc)
     doc->actionkey.clear();
 
     finish_incomplete_transaction(*doc);
+    if (!doc->undo.empty() && !load(doc, doc->undo.back())) {
+        // Older steps build on this one, so none of them can be undone either.
+        clearUndo(doc);
+    }
     if (! doc->undo.empty()) {
         Inkscape::Event *log = doc->undo.back();
+        updateBytes(doc, log);
         doc->undo.pop_back();
+        doc->undo_bytes -= log->bytes;
         sp_repr_undo_log (log->event);
         perform_document_update(*doc);
         doc->redo.push_back(log);
@@ -329,11 +452,17 @@ gboolean Inkscape::DocumentUndo::redo(SPDocument *doc)
 	doc->actionkey.clear();
 
     finish_incomplete_transaction(*doc);
+    if (!doc->redo.empty() && !load(doc, doc->redo.back())) {
+        // Later steps build on this one, so none of them can be redone either.
+        clearRedo(doc);
+    }
     if (! doc->redo.empty()) {
         Inkscape::Event *log = doc->redo.back();
 		doc->redo.pop_back();
 		sp_repr_replay_log (log->event);
+        log->bytes = sp_repr_log_memory_usage(log->event);
         doc->undo.push_back(log);
+        doc->undo_bytes += log->bytes;
         perform_document_update(*doc);
 
         doc->setModifiedSinceSave();
@@ -362,6 +491,7 @@ void Inkscape::DocumentUndo::clearUndo(SPDocument *doc)
         doc->undo.pop_back();
         delete e;
     }
+    doc->undo_bytes = 0;
 }
 
 void Inkscape::DocumentUndo::clearRedo(SPDocument *doc)
@@ -376,6 +506,63 @@ void Inkscape::DocumentUndo::clearRedo(SPDocument *doc)
     }
 }
 
+Inkscape::UndoSpillFile::UndoSpillFile()
+    : _file(std::tmpfile())
+{
+    if (!_file) {
+        g_warning("Cannot create a temporary file for undo data.");
+    }
+}
+
+Inkscape::UndoSpillFile::~UndoSpillFile()
+{
+    if (_file) {
+        std::fclose(_file);
+    }
+}
+
+std::optional<Inkscape::Event::Spilled> Inkscape::UndoSpillFile::write(std::string const &data)
+{
+    if (!_file) {
+        return {};
+    }
+
+    auto compressed_size = compressBound(data.size());
+    std::vector<Bytef> compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, reinterpret_cast<Bytef const *>(data.data()), data.size(),
+                  Z_BEST_SPEED) != Z_OK) {
+        return {};
+    }
+
+    if (std::fseek(_file, 0, SEEK_END) != 0) {
+        return {};
+    }
+    auto const offset = std::ftell(_file);
+    if (offset < 0 || std::fwrite(compressed.data(), 1, compressed_size, _file) != compressed_size) {
+        return {};
+    }
+    return Event::Spilled{offset, compressed_size, data.size()};
+}
+
+std::optional<std::string> Inkscape::UndoSpillFile::read(Event::Spilled const &spilled)
+{
+    if (!_file || std::fseek(_file, spilled.offset, SEEK_SET) != 0) {
+        return {};
+    }
+    std::vector<Bytef> compressed(spilled.compressed_size);
+    if (std::fread(compressed.data(), 1, compressed.size(), _file) != compressed.size()) {
+        return {};
+    }
+
+    std::string data(spilled.size, '\0');
+    auto size = static_cast<uLongf>(data.size());
+    if (uncompress(reinterpret_cast<Bytef *>(data.data()), &size, compressed.data(), compressed.size()) != Z_OK ||
+        size != data.size()) {
+        return {};
+    }
+    return data;
+}
+
 /*
   Local Variables:
   mode:c++
@@ -10,6 +10,12 @@
 #ifndef SEEN_SP_DOCUMENT_UNDO_H
 #define SEEN_SP_DOCUMENT_UNDO_H
 
+#include <cstddef>
+#include <cstdio>
+#include <optional>
+#include <string>
+
+#include "event.h"
 #include "util-string/context-string.h" // ContextString
 #include <glib.h>   // gboolean, gchar
 
@@ -43,11 +49,22 @@ public:
 
     static void maybeDone(SPDocument *document, const gchar *keyconst, Util::Internal::ContextString event_description, Glib::ustring const &undo_icon, unsigned int object_modified_tag = 0);
 
+    /**
+     * Estimated memory held by the undo and redo history of the document, in bytes.
+     */
+    static std::size_t getUndoMemoryUsage(SPDocument const *document);
+
 private:
     static void finish_incomplete_transaction(SPDocument &document);
 
     static void perform_document_update(SPDocument &document);
 
+    static void updateBytes(SPDocument *document, Event *event);
+    static void compact(SPDocument *document, Event *event);
+    static bool spill(SPDocument *document, Event *event);
+    static bool load(SPDocument *document, Event *event);
+    static void enforceBudget(SPDocument *document, std::size_t budget);
+
 public:
     static void resetKey(SPDocument *document);
 
@@ -87,6 +104,26 @@ public:
     };
 };
 
+/**
+ * Temporary file holding compressed undo data moved out of memory. It is deleted when closed.
+ */
+class UndoSpillFile
+{
+public:
+    UndoSpillFile();
+    ~UndoSpillFile();
+    UndoSpillFile(UndoSpillFile const &) = delete;
+    UndoSpillFile &operator=(UndoSpillFile const &) = delete;
+
+    /// Compress and append the data, returning where it went, or nothing if it could not be written.
+    std::optional<Event::Spilled> write(std::string const &data);
+    /// Read back data written by write(), or nothing if it could not be read.
+    std::optional<std::string> read(Event::Spilled const &spilled);
+
+private:
+    std::FILE *_file;
+};
+
 } // namespace Inkscape
 
 #endif // SEEN_SP_DOCUMENT_UNDO_H
@@ -35,9 +35,14 @@
 
 #include "document.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
+#include <optional>
 #include <ranges>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <glibmm/main.h>
 #include <glibmm/miscutils.h>
@@ -51,11 +56,16 @@
 #include "actions/actions-pages.h"
 #include "actions/actions-svg-processing.h"
 #include "actions/actions-undo-document.h"
+#include "colors/color.h"
 #include "colors/document-cms.h"
+#include "colors/spaces/base.h"
+#include "conn-background-router.h"
 #include "debug/console-output-undo-observer.h"
 #include "desktop.h"
 #include "display/control/canvas-item-drawing.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing.h"
+#include "display/threading.h"
 #include "document-undo.h"
 #include "document-update.h"
 #include "event-log.h"
@@ -70,15 +80,20 @@
 #include "object/sp-defs.h"
 #include "object/sp-factory.h"
 #include "object/sp-item-group.h"
+#include "object/sp-linear-gradient.h"
 #include "object/sp-lpe-item.h"
+#include "object/sp-mesh-gradient.h"
 #include "object/sp-namedview.h"
 #include "object/sp-page.h"
+#include "object/sp-radial-gradient.h"
 #include "object/sp-root.h"
+#include "object/sp-stop.h"
 #include "object/sp-symbol.h"
 #include "page-manager.h"
 #include "rdf.h"
 #include "selection.h"
 #include "style.h"
+#include "svg/svg.h"
 #include "ui/widget/canvas.h"
 #include "ui/widget/desktop-widget.h"
 #include "util/units.h"
@@ -113,7 +128,6 @@ SPDocument::SPDocument()
     , document_base(nullptr)
     , document_name(nullptr)
     , console_output_undo_observer{create_console_output_observer()}
-    , object_id_counter(1)
     , _router(std::make_unique<Avoid::Router>(Avoid::PolyLineRouting | Avoid::OrthogonalRouting))
     , current_persp3d(nullptr)
     , current_persp3d_impl(nullptr)
@@ -385,7 +399,10 @@ std::unique_ptr<SPDocument> SPDocument::createDoc(
     }
 
     // Recursively build object tree
+    document->_preparseAttributes();
     document->root->invoke_build(document.get(), rroot, false);
+    document->_preparsed_paths.clear();
+    document->_preparsed_transforms.clear();
 
     /* Eliminate obsolete sodipodi:docbase, for privacy reasons */
     rroot->removeAttribute("sodipodi:docbase");
@@ -765,6 +782,138 @@ void SPDocument::rebase(bool keep_namedview)
     rebase(document_filename, keep_namedview);
 }
 
+/**
+ * Parse the "d" attribute of every <path> and the "transform" attribute of every element in the
+ * XML tree before the object tree is built.
+ *
+ * For path-heavy documents parsing these is the bulk of the build time, and it depends on nothing
+ * but the attribute strings, so it is spread over the dispatch pool. The object tree itself is
+ * still linked on the calling thread; SPPath and SPItem pick up the results through
+ * takePreparsedPath() and takePreparsedTransform().
+ *
+ * Styles are left to the build: their cascade depends on the parent's style and the stylesheets.
+ */
+void SPDocument::_preparseAttributes()
+{
+    // Below this many attributes the threading overhead outweighs the gain.
+    constexpr std::size_t PREPARSE_THRESHOLD = 64;
+
+    std::vector<std::pair<Inkscape::XML::Node const *, char const *>> paths;
+    std::vector<std::pair<Inkscape::XML::Node const *, char const *>> transforms;
+    std::vector<Inkscape::XML::Node const *> stack{rroot};
+    while (!stack.empty()) {
+        auto const node = stack.back();
+        stack.pop_back();
+        if (node->type() != Inkscape::XML::NodeType::ELEMENT_NODE) {
+            continue;
+        }
+        if (!std::strcmp(node->name(), "svg:path")) {
+            if (auto const d = node->attribute("d")) {
+                paths.emplace_back(node, d);
+            }
+        }
+        if (auto const transform = node->attribute("transform")) {
+            transforms.emplace_back(node, transform);
+        }
+        for (auto child = node->firstChild(); child; child = child->next()) {
+            stack.push_back(child);
+        }
+    }
+
+    if (paths.size() + transforms.size() < PREPARSE_THRESHOLD) {
+        return;
+    }
+
+    // Paths and transforms share one batch, the paths first as they take the longest.
+    std::vector<Geom::PathVector> pathvs(paths.size());
+    std::vector<Geom::Affine> affines(transforms.size());
+    auto const pool = Inkscape::get_global_dispatch_pool();
+    pool->dispatch(paths.size() + transforms.size(), [&](int job, int) {
+        if (std::size_t const i = job; i < paths.size()) {
+            pathvs[i] = sp_svg_read_pathv(paths[i].second);
+        } else {
+            auto const j = i - paths.size();
+            if (!sp_svg_transform_read(transforms[j].second, &affines[j])) {
+                affines[j] = Geom::identity();
+            }
+        }
+    });
+
+    _preparsed_paths.reserve(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        _preparsed_paths.emplace(paths[i].first, std::pair{paths[i].second, std::move(pathvs[i])});
+    }
+    _preparsed_transforms.reserve(transforms.size());
+    for (std::size_t i = 0; i < transforms.size(); ++i) {
+        _preparsed_transforms.emplace(transforms[i].first, std::pair{transforms[i].second, affines[i]});
+    }
+}
+
+/**
+ * Take the entry for @a repr out of @a map, and return its result if @a value is still the string
+ * it was parsed from. The attribute may have been rewritten since, e.g. by an LPE during build.
+ */
+template <typename Map>
+static auto take_preparsed(Map &map, Inkscape::XML::Node const *repr, char const *value)
+    -> std::optional<typename Map::mapped_type::second_type>
+{
+    auto const it = map.find(repr);
+    if (it == map.end()) {
+        return {};
+    }
+
+    std::optional<typename Map::mapped_type::second_type> result;
+    // The map keeps the parsed string alive, so no other value can be at the same address.
+    if (it->second.first == value || !std::strcmp(it->second.first, value)) {
+        result = std::move(it->second.second);
+    }
+    map.erase(it);
+    return result;
+}
+
+std::optional<Geom::PathVector> SPDocument::takePreparsedPath(Inkscape::XML::Node const *repr, char const *d)
+{
+    return take_preparsed(_preparsed_paths, repr, d);
+}
+
+std::optional<Geom::Affine> SPDocument::takePreparsedTransform(Inkscape::XML::Node const *repr, char const *value)
+{
+    return take_preparsed(_preparsed_transforms, repr, value);
+}
+
+Geom::PathVector SPDocument::getClonePath(Inkscape::XML::Node const *repr, char const *d)
+{
+    auto &entry = _clone_paths[repr];
+    // Each new value of the attribute is a new string, so the same pointer means the same data.
+    // The original drops the entry when it changes, but clones may be told before it is.
+    if (entry.d != d && (!entry.d || std::strcmp(entry.d, d) != 0)) {
+        entry.pathv = sp_svg_read_pathv(d);
+    }
+    entry.d = d;
+    // Geom::Path is copy-on-write, so this copy shares the parsed data.
+    return entry.pathv;
+}
+
+void SPDocument::forgetClonePath(Inkscape::XML::Node const *repr)
+{
+    _clone_paths.erase(repr);
+}
+
+SPUse *SPDocument::getCloneMaster(std::string const &key) const
+{
+    auto const it = _clone_masters.find(key);
+    return it != _clone_masters.end() ? it->second : nullptr;
+}
+
+void SPDocument::setCloneMaster(std::string const &key, SPUse *use)
+{
+    if (use) {
+        _clone_masters[key] = use;
+    } else {
+        _clone_masters.erase(key);
+    }
+}
+
 /**
  * Fetches a document and attaches it to the current document as a child href
  */
@@ -1288,14 +1437,18 @@ void SPDocument::bindObjectToId(char const *id, SPObject *object)
 
     if (object) {
         if(object->getId()) {
-            iddef.erase(object->getId());
+            if (iddef.erase(object->getId())) {
+                _trackIdSuffix(object->getId(), false);
+            }
         }
         auto ret = iddef.emplace(id, object);
         g_assert(ret.second);
+        _trackIdSuffix(id, true);
     } else {
         auto it = iddef.find(id);
         g_assert(it != iddef.end());
         iddef.erase(it);
+        _trackIdSuffix(id, false);
     }
 
     auto pos = id_changed_signals.find(idq);
@@ -1452,20 +1605,95 @@ std::vector<SPObject*> SPDocument::getObjectsBySelector(Glib::ustring const &sel
     return objects;
 }
 
-// Note: Despite appearances, this implementation is allocation-free thanks to SSO.
+/**
+ * Parse the canonical decimal number at the end of an id, i.e. "12" in "path12" but not in "path012".
+ * Returns the length of the prefix before it, or std::nullopt if there is none.
+ */
+static std::optional<std::size_t> parse_id_suffix(std::string_view id, unsigned long &number)
+{
+    auto const start = id.find_last_not_of("0123456789") + 1; // npos + 1 == 0
+    auto const digits = id.substr(start);
+    if (digits.empty() || digits.size() > 18 || digits[0] == '0') {
+        return {};
+    }
+    number = 0;
+    for (auto c : digits) {
+        number = number * 10 + (c - '0');
+    }
+    return start;
+}
+
+/**
+ * Keep the suffix pool of the id's prefix up to date when the id is bound or unbound.
+ * Pools only exist for prefixes generate_unique_id() has been asked for.
+ */
+void SPDocument::_trackIdSuffix(std::string_view id, bool bound)
+{
+    if (_id_suffixes.empty()) {
+        return;
+    }
+    unsigned long number;
+    auto const prefix_len = parse_id_suffix(id, number);
+    if (!prefix_len) {
+        return;
+    }
+    auto it = _id_suffixes.find(std::string(id.substr(0, *prefix_len)));
+    if (it == _id_suffixes.end()) {
+        return;
+    }
+
+    auto &suffixes = it->second;
+    if (bound) {
+        if (number > suffixes.highest) {
+            suffixes.highest = number;
+        } else {
+            suffixes.free.erase(number);
+        }
+    } else if (number <= suffixes.highest) {
+        suffixes.free.insert(number);
+    }
+}
+
+unsigned long SPDocument::highestIdSuffix(std::string const &prefix) const
+{
+    unsigned long highest = 0;
+    for (auto id = iddef.lower_bound(prefix); id != iddef.end() && id->first.starts_with(prefix); ++id) {
+        unsigned long number;
+        auto const tail = std::string_view(id->first).substr(prefix.size());
+        if (auto const len = parse_id_suffix(tail, number); len && *len == 0) {
+            highest = std::max(highest, number);
+        }
+    }
+    return highest;
+}
+
 std::string SPDocument::generate_unique_id(char const *prefix)
 {
     auto result = std::string(prefix);
     auto const prefix_len = result.size();
 
+    auto [it, inserted] = _id_suffixes.try_emplace(result);
+    auto &suffixes = it->second;
+    if (inserted) {
+        // First request for this prefix: pick up the suffixes already in use, once.
+        suffixes.highest = highestIdSuffix(result);
+    }
+
+    // The lookup only fails for ids the pool cannot see, e.g. "a12" for the prefix "a1" or ids in a parent document.
     while (true) {
-        result.replace(prefix_len, std::string::npos, std::to_string(object_id_counter));
+        unsigned long number;
+        if (!suffixes.free.empty()) {
+            number = *suffixes.free.begin();
+            suffixes.free.erase(suffixes.free.begin());
+        } else {
+            number = ++suffixes.highest;
+        }
+
+        result.replace(prefix_len, std::string::npos, std::to_string(number));
 
         if (!getObjectById(result)) {
             break;
         }
-
-        ++object_id_counter;
     }
 
     return result;
@@ -1669,6 +1897,11 @@ gint SPDocument::ensureUpToDate(unsigned int object_modified_tag)
         // changed objects and provide new routings.  This may cause some objects
             // to be modified, hence the second update pass.
         if (pass == 1) {
+            if (_routing_deferred) {
+                // Leave rerouting to rerouting_handler() and keep its pending connection.
+                modified_connection.disconnect();
+                return counter > 0;
+            }
             _router->processTransaction();
         }
     }
@@ -1700,6 +1933,12 @@ SPDocument::idle_handler()
 bool
 SPDocument::rerouting_handler()
 {
+    if (_routing_deferred) {
+        // Keep the queued actions for the final routing; show routes computed off this thread.
+        getBackgroundRouter().reroute();
+        return false;
+    }
+
     // Process any queued movement actions and determine new routings for
     // object-avoiding connectors.  Callbacks will be used to update and
     // redraw affected connectors.
@@ -1710,6 +1949,27 @@ SPDocument::rerouting_handler()
     return false;
 }
 
+void SPDocument::setRoutingDeferred(bool deferred)
+{
+    if (deferred == _routing_deferred) {
+        return;
+    }
+    _routing_deferred = deferred;
+    if (deferred) {
+        getBackgroundRouter().begin();
+    } else if (_background_router) {
+        _background_router->finish();
+    }
+}
+
+Inkscape::ConnBackgroundRouter &SPDocument::getBackgroundRouter()
+{
+    if (!_background_router) {
+        _background_router = std::make_unique<Inkscape::ConnBackgroundRouter>(*this);
+    }
+    return *_background_router;
+}
+
 static bool is_within(Geom::Rect const &area, Geom::Rect const &box)
 {
     return area.contains(box);
@@ -2191,6 +2451,92 @@ void SPDocument::importDefs(SPDocument *source)
     }
 }
 
+/// Append @a value to an import equivalence key, exactly; 0 and -0 compare equal, so they match.
+static void append_exact(std::string &key, double value)
+{
+    if (value == 0) {
+        value = 0;
+    }
+    key.append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+/**
+ * Defs can only be merged on import if their keys match: for gradients this covers everything
+ * SPGradient::isEquivalent() compares, path effects are only similar if they have the same id.
+ *
+ * Colors are compared with a tolerance, so they go in rounded to it; two colors within the
+ * tolerance of each other that round differently aren't merged, which only costs a duplicate.
+ */
+static std::optional<std::string> import_equivalence_key(SPObject *obj)
+{
+    if (auto lpeobj = cast<LivePathEffectObject>(obj)) {
+        if (!lpeobj->getId()) {
+            return {};
+        }
+        return std::string("l") + lpeobj->getId();
+    }
+
+    auto gr = cast<SPGradient>(obj);
+    if (!gr || !gr->getVector()) {
+        return {};
+    }
+
+    std::string key = "g";
+    if (gr->isSwatch()) {
+        key += 's';
+    } else if (is<SPLinearGradient>(gr)) {
+        key += 'l';
+    } else if (is<SPRadialGradient>(gr)) {
+        key += 'r';
+    } else if (is<SPMeshGradient>(gr)) {
+        key += 'm';
+    } else {
+        return {};
+    }
+    key += gr->hasStops() ? '+' : '-';
+    key += std::to_string(gr->getStopCount());
+
+    // The coordinates SPGradient::isAligned() compares; swatches aren't aligned.
+    if (!gr->isSwatch()) {
+        key += gr->gradientTransform_set ? 't' : '-';
+        if (gr->gradientTransform_set) {
+            for (int i = 0; i < 6; i++) {
+                append_exact(key, gr->gradientTransform[i]);
+            }
+        }
+        auto append_lengths = [&] (std::initializer_list<SVGLength const *> lengths) {
+            bool all_set = true;
+            for (auto length : lengths) {
+                key += length->_set ? '1' : '0';
+                all_set = all_set && length->_set;
+            }
+            if (all_set) {
+                for (auto length : lengths) {
+                    append_exact(key, length->computed);
+                }
+            }
+        };
+        if (auto lg = cast<SPLinearGradient>(gr)) {
+            append_lengths({&lg->x1, &lg->y1, &lg->x2, &lg->y2});
+        } else if (auto rg = cast<SPRadialGradient>(gr)) {
+            append_lengths({&rg->cx, &rg->cy, &rg->r, &rg->fx, &rg->fy});
+        }
+        // Meshes are aligned on their x and y having been set differently, so they can't go in.
+    }
+
+    for (auto stop = gr->getVector()->getFirstStop(); stop; stop = stop->getNextStop()) {
+        append_exact(key, stop->offset);
+        auto const color = stop->getColor();
+        key += color.getSpace() ? color.getSpace()->getName() : std::string();
+        for (auto value : color.getValues()) {
+            key += ',';
+            key += std::to_string(std::lround(value / 0.001));
+        }
+        key += ';';
+    }
+    return key;
+}
+
 void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs, Inkscape::XML::Node *target_defs)
 {
     int stagger=0;
@@ -2213,10 +2559,12 @@ void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs,
         in the current document.
 
         In the second find and mark definitions in the clipboard that are duplicates of earlier
-        definitions in the clipbard.  Unfortunately this is O(n^2) and could be very slow for a large
-        SVG with thousands of definitions.  As before, references are adjusted to reflect the name
+        definitions in the clipbard.  As before, references are adjusted to reflect the name
         going forward.
 
+        Both passes only compare definitions with the same import_equivalence_key(), so large
+        clipboards with thousands of definitions don't compare every pair.
+
         In the final cycle copy over those records not marked with that ID.
 
         If an SVG file uses the special ID it will cause problems!
@@ -2233,6 +2581,14 @@ void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs,
 
     std::string DuplicateDefString = "RESERVED_FOR_INKSCAPE_DUPLICATE_DEF";
 
+    // Candidates for merging in the document, in document order.
+    std::unordered_map<std::string, std::vector<SPObject *>> target_index;
+    for (auto &trg : getDefs()->children) {
+        if (auto key = import_equivalence_key(&trg)) {
+            target_index[*key].push_back(&trg);
+        }
+    }
+
     /* First pass: remove duplicates in clipboard of definitions in document */
     for (Inkscape::XML::Node *def = defs->firstChild() ; def ; def = def->next()) {
         if(def->type() != Inkscape::XML::NodeType::ELEMENT_NODE)continue;
@@ -2247,8 +2603,11 @@ void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs,
         // Prevent duplicates of solid swatches by checking if equivalent swatch already exists
         auto s_gr = cast<SPGradient>(src);
         auto s_lpeobj = cast<LivePathEffectObject>(src);
-        if (src && (s_gr || s_lpeobj)) {
-            for (auto& trg: getDefs()->children) {
+        auto key = import_equivalence_key(src);
+        auto candidates = key ? target_index.find(*key) : target_index.end();
+        if (src && (s_gr || s_lpeobj) && candidates != target_index.end()) {
+            for (auto trg_obj : candidates->second) {
+                auto &trg = *trg_obj;
                 auto t_gr = cast<SPGradient>(&trg);
                 if (src != &trg && s_gr && t_gr) {
                     if (s_gr->isEquivalent(t_gr)) {
@@ -2281,6 +2640,15 @@ void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs,
         }
     }
 
+    // Candidates for merging in the clipboard, in document order.
+    std::unordered_map<std::string, std::vector<Inkscape::XML::Node *>> source_index;
+    for (Inkscape::XML::Node *def = defs->firstChild() ; def ; def = def->next()) {
+        if (def->type() != Inkscape::XML::NodeType::ELEMENT_NODE) continue;
+        if (auto key = import_equivalence_key(source->getObjectByRepr(def))) {
+            source_index[*key].push_back(def);
+        }
+    }
+
     /* Second pass: remove duplicates in clipboard of earlier definitions in clipboard */
     for (Inkscape::XML::Node *def = defs->firstChild() ; def ; def = def->next()) {
         if(def->type() != Inkscape::XML::NodeType::ELEMENT_NODE)continue;
@@ -2289,8 +2657,16 @@ void SPDocument::_importDefsNode(SPDocument *source, Inkscape::XML::Node *defs,
         SPObject *src = source->getObjectByRepr(def);
         auto s_lpeobj = cast<LivePathEffectObject>(src);
         auto s_gr = cast<SPGradient>(src);
-        if (src && (s_gr || s_lpeobj)) {
-            for (Inkscape::XML::Node *laterDef = def->next() ; laterDef ; laterDef = laterDef->next()) {
+        auto key = import_equivalence_key(src);
+        auto candidates = key ? source_index.find(*key) : source_index.end();
+        if (src && (s_gr || s_lpeobj) && candidates != source_index.end()) {
+            // Only definitions after this one are compared.
+            auto later = std::find(candidates->second.begin(), candidates->second.end(), def);
+            if (later != candidates->second.end()) {
+                ++later;
+            }
+            for (; later != candidates->second.end(); ++later) {
+                Inkscape::XML::Node *laterDef = *later;
                 SPObject *trg = source->getObjectByRepr(laterDef);
                 auto t_gr = cast<SPGradient>(trg);
                 if (trg && (src != trg) && s_gr && t_gr) {
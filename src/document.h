@@ -23,9 +23,14 @@
 #include <deque>                               // for deque
 #include <map>                                 // for map
 #include <memory>                              // for unique_ptr, default_de...
+#include <optional>                            // for optional
 #include <queue>                               // for queue
+#include <set>                                 // for set
 #include <span>
 #include <string>                              // for string
+#include <string_view>                         // for string_view
+#include <unordered_map>                       // for unordered_map
+#include <utility>                             // for pair
 #include <vector>                              // for vector
 
 #include <boost/ptr_container/ptr_list.hpp>    // for ptr_list
@@ -38,10 +43,12 @@
 #include <sigc++/signal.h>                     // for signal
 
 #include <2geom/affine.h>                      // for Affine
+#include <2geom/pathvector.h>                  // for PathVector
 #include <2geom/rect.h>                        // for Rect, OptRect
 #include <2geom/transforms.h>                  // for Scale
 
 #include "3rdparty/libcroco/src/cr-cascade.h"  // for CRCascade
+#include "inkgc/gc-alloc.h"
 
 #include "composite-undo-stack-observer.h"
 
@@ -74,8 +81,10 @@ class SPItemCtx;
 class SPNamedView;
 class SPObject;
 class SPRoot;
+class SPUse;
 
 namespace Inkscape {
+    class ConnBackgroundRouter;
     class DocumentUndo;
     class Event;
     class EventLog;
@@ -84,6 +93,7 @@ namespace Inkscape {
         class DocumentCMS;
     }
     class Selection;
+    class UndoSpillFile;
     class UndoStackObserver;
     namespace XML {
         struct Document;
@@ -119,6 +129,32 @@ public:
             std::string const &filename = "");
     SPDocument *createChildDoc(std::string const &filename);
 
+    /**
+     * Return the path data parsed ahead of time for @a repr while the object tree is being built,
+     * provided @a d is still the string that was parsed. Each entry can only be taken once.
+     */
+    std::optional<Geom::PathVector> takePreparsedPath(Inkscape::XML::Node const *repr, char const *d);
+
+    /**
+     * Return the transform parsed ahead of time for @a repr while the object tree is being built,
+     * provided @a value is still the string that was parsed. Invalid transforms come back as the
+     * identity. Each entry can only be taken once.
+     */
+    std::optional<Geom::Affine> takePreparsedTransform(Inkscape::XML::Node const *repr, char const *value);
+
+    /**
+     * Return the path data @a d of @a repr for a cloned path. Every clone of the same repr gets
+     * a copy of one parsed path vector, so they share its storage instead of each holding their own.
+     */
+    Geom::PathVector getClonePath(Inkscape::XML::Node const *repr, char const *d);
+    /// Drop the shared path data of @a repr, when the original path changes or goes away.
+    void forgetClonePath(Inkscape::XML::Node const *repr);
+
+    /// In clone instancing mode, the use that builds the child shown by all uses with @a key.
+    SPUse *getCloneMaster(std::string const &key) const;
+    /// Register @a use as the master for @a key, or remove the master if it is nullptr.
+    void setCloneMaster(std::string const &key, SPUse *use);
+
     void setPages(bool enabled);
     void prunePages(const std::string &page_nums, bool invert = false);
 
@@ -160,6 +196,16 @@ public:
     bool idle_handler();
     bool rerouting_handler();
 
+    /**
+     * While routing is deferred, ensureUpToDate() leaves connector rerouting to the idle handler,
+     * which routes a copy of the diagram on a worker thread, see Inkscape::ConnBackgroundRouter,
+     * so that interactive transforms stay responsive. Connectors are routed synchronously again
+     * by the first update after deferral ends.
+     */
+    void setRoutingDeferred(bool deferred);
+    bool isRoutingDeferred() const { return _routing_deferred; }
+    Inkscape::ConnBackgroundRouter &getBackgroundRouter();
+
     void requestModified();
     bool _updateDocument(int flags, unsigned int object_modified_tag = 0); // Used by stand-alone sp_document_idle_handler
     int ensureUpToDate(unsigned int object_modified_tag = 0);
@@ -183,6 +229,7 @@ public:
     const Inkscape::Colors::DocumentCMS &getDocumentCMS() const { return *_cms_manager; }
 
 private:
+    void _preparseAttributes();
     void _importDefsNode(SPDocument *source, Inkscape::XML::Node *defs, Inkscape::XML::Node *target_defs);
     SPObject *_activexmltree;
 
@@ -316,9 +363,16 @@ public:
      *
      * Generates an id string not in use by any object in the document.
      * The generated string is based on the given prefix by appending a number.
+     * Suffixes are tracked per prefix, so this runs in amortised constant time.
      */
     std::string generate_unique_id(char const *prefix);
 
+    /**
+     * The largest number in the ids made of @a prefix followed by a number, or 0 if there is none.
+     * Only looks at the ids of this document, not those of the reference document.
+     */
+    unsigned long highestIdSuffix(std::string const &prefix) const;
+
     /**
      * @brief Set the reference document object.
      * Use this function to extend functionality of getObjectById() - it will search in reference document.
@@ -401,6 +455,8 @@ private:
     bool modified_since_autosave = false;
     sigc::connection modified_connection;
     sigc::connection rerouting_connection;
+    bool _routing_deferred = false;
+    std::unique_ptr<Inkscape::ConnBackgroundRouter> _background_router;
 
     // Document structure --------------------
     Inkscape::XML::Document *rdoc; ///< Our Inkscape::XML::Document
@@ -428,10 +484,48 @@ private:
     char *document_base;  ///< To be used for resolving relative hrefs.
     char *document_name;  ///< basename or other human-readable label for the document.
 
+    // Attributes parsed in parallel before building the object tree, keyed by repr ------
+    // The entries are scanned by the collector, so the strings they were parsed from can't be
+    // reused for another value while they wait to be taken.
+    template <typename T>
+    using PreparsedMap = std::unordered_map<Inkscape::XML::Node const *, std::pair<char const *, T>,
+                                            std::hash<Inkscape::XML::Node const *>,
+                                            std::equal_to<Inkscape::XML::Node const *>,
+                                            Inkscape::GC::Alloc<std::pair<Inkscape::XML::Node const *const,
+                                                                          std::pair<char const *, T>>,
+                                                                Inkscape::GC::SCANNED, Inkscape::GC::MANUAL>>;
+    PreparsedMap<Geom::PathVector> _preparsed_paths;
+    PreparsedMap<Geom::Affine> _preparsed_transforms;
+
+    // Path data shared between the clones of a path, keyed by the original repr ------
+    struct ClonePath
+    {
+        char const *d = nullptr; ///< The attribute value it was parsed from.
+        Geom::PathVector pathv;
+    };
+    // The entries are scanned by the collector, so the strings they point to can't be reused.
+    std::unordered_map<Inkscape::XML::Node const *, ClonePath, std::hash<Inkscape::XML::Node const *>,
+                       std::equal_to<Inkscape::XML::Node const *>,
+                       Inkscape::GC::Alloc<std::pair<Inkscape::XML::Node const *const, ClonePath>,
+                                           Inkscape::GC::SCANNED, Inkscape::GC::MANUAL>>
+        _clone_paths;
+
+    // Masters of the clones in clone instancing mode, see SPUse ------
+    std::unordered_map<std::string, SPUse *> _clone_masters;
+
     // Find items ----------------------------
     std::map<std::string, SPObject *> iddef;
     std::map<Inkscape::XML::Node *, SPObject *> reprdef;
 
+    // Unique id allocation, per prefix passed to generate_unique_id() --------------
+    struct IdSuffixes
+    {
+        unsigned long highest = 0;    ///< Largest numeric suffix bound or handed out so far.
+        std::set<unsigned long> free; ///< Suffixes below highest that were released again.
+    };
+    std::unordered_map<std::string, IdSuffixes> _id_suffixes;
+    void _trackIdSuffix(std::string_view id, bool bound);
+
     // Find items by geometry --------------------
     mutable std::map<unsigned long, std::deque<SPItem*>> _node_cache; // Used to speed up search.
 
@@ -448,6 +542,8 @@ private:
     Inkscape::XML::Event * partial; /* partial undo log when interrupted */
     std::deque<Inkscape::Event *> undo; /* Undo stack of reprs */
     std::deque<Inkscape::Event *> redo; /* Redo stack of reprs */
+    std::size_t undo_bytes = 0; /* Memory held by the undo stack, see Inkscape::Event::bytes */
+    std::unique_ptr<Inkscape::UndoSpillFile> undo_spill; /* Undo data moved out of memory */
     /* Undo listener */
     Inkscape::CompositeUndoStackObserver undoStackObservers;
 
@@ -459,7 +555,6 @@ private:
     Glib::ustring actionkey; // Last action key, used to combine actions in undo.
     double action_expires; // Expire time for last action key
     std::optional<std::chrono::steady_clock::time_point> undo_timer; // Timer for last action key
-    unsigned long object_id_counter; // Steadily-incrementing counter used to assign unique ids to objects.
 
     // Garbage collecting ----------------------
 
@@ -15,8 +15,10 @@
  */
 
 
+#include <cstddef>
 #include <glibmm/ustring.h>
 
+#include <optional>
 #include <utility>
 
 #include "xml/event-fns.h"
@@ -39,6 +41,17 @@ public:
     virtual ~Event() { sp_repr_free_log (event); }
 
     XML::Event *event;
+    std::size_t bytes = 0;     // Memory held by the event log, see sp_repr_log_memory_usage().
+
+    // Location of the log's deltas in the document's UndoSpillFile while they are spilled.
+    struct Spilled
+    {
+        long offset;
+        std::size_t compressed_size;
+        std::size_t size;
+    };
+    std::optional<Spilled> spilled;
+
     unsigned int type = 0;
     Glib::ustring description; // The description to use in the Undo dialog.
     Glib::ustring icon_name;   // The icon to use in the Undo dialog.
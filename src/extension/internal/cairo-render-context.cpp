@@ -159,6 +159,7 @@ CairoRenderContext &CairoRenderContext::operator=(CairoRenderContext &&other)
     _pdf_level = other._pdf_level;
     _ps_level = other._ps_level;
     _bitmapresolution = other._bitmapresolution;
+    _bitmap_budget = other._bitmap_budget;
     _is_valid = other._is_valid;
     _eps = other._eps;
     _is_texttopath = other._is_texttopath;
@@ -275,6 +276,34 @@ CairoRenderContext CairoRenderContext::createSimilar(double width, double height
     return new_context;
 }
 
+/**
+ * \brief Creates a new render context drawing into a recording surface, in the user space of this context
+ *
+ * The recording can be painted any number of times with paintRecording(); vector backends store
+ * its content only once (as a Form XObject in PDF).
+ *
+ * \param extents  area of the recording, in the current user space
+ */
+CairoRenderContext CairoRenderContext::createRecording(Geom::Rect const &extents) const
+{
+    g_assert(_is_valid);
+    cairo_rectangle_t const rect = {extents.left(), extents.top(), extents.width(), extents.height()};
+    CairoRenderContext new_context = _renderer->createContext();
+    new_context._surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &rect);
+    new_context._cr = cairo_create(new_context._surface);
+    new_context._width = _width;
+    new_context._height = _height;
+    new_context._dpi = _dpi;
+    new_context._bitmapresolution = _bitmapresolution;
+    new_context._bitmap_budget = _bitmap_budget;
+    new_context._is_texttopath = _is_texttopath;
+    new_context._is_filtertobitmap = _is_filtertobitmap;
+    new_context._vector_based_target = _vector_based_target;
+    new_context._is_valid = true;
+
+    return new_context;
+}
+
 bool CairoRenderContext::setImageTarget(cairo_format_t format)
 {
     // format cannot be set on an already initialized surface
@@ -872,6 +901,10 @@ bool CairoRenderContext::finishPage()
     if (!_is_show_page) {
         cairo_show_page(_cr);
         _is_show_page = true;
+        // Cairo has written out the page; don't keep it around in stdio buffers either.
+        if (_stream) {
+            fflush(_stream);
+        }
     }
 
     auto status = cairo_status(_cr);
@@ -1592,6 +1625,19 @@ bool CairoRenderContext::renderPathVector(Geom::PathVector const &pathv,
     return true;
 }
 
+/**
+ * Paint a surface made with createRecording() at the current transform.
+ */
+void CairoRenderContext::paintRecording(cairo_surface_t *recording)
+{
+    g_assert(_is_valid);
+
+    cairo_save(_cr);
+    cairo_set_source_surface(_cr, recording, 0, 0);
+    cairo_paint(_cr);
+    cairo_restore(_cr);
+}
+
 bool CairoRenderContext::renderImage(Inkscape::Pixbuf const *pb,
                                      Geom::Affine const &image_transform, SPStyle const *style)
 {
@@ -94,6 +94,7 @@ public:
     };
 
     CairoRenderContext createSimilar(double width, double height) const;
+    CairoRenderContext createRecording(Geom::Rect const &extents) const;
     bool finish(bool finish_surface = true);
     bool finishPage();
     bool nextPage(double width, double height, char const *label);
@@ -118,6 +119,10 @@ public:
     bool getFilterToBitmap() { return _is_filtertobitmap; }
     void setBitmapResolution(unsigned resolution) { _bitmapresolution = resolution; }
     unsigned getBitmapResolution() { return _bitmapresolution; }
+    /// Largest bitmap, in bytes, rendered at once for an item that falls back to a bitmap;
+    /// larger ones are rasterized in tiles.
+    void setBitmapBudget(std::size_t bytes) { _bitmap_budget = bytes; }
+    std::size_t getBitmapBudget() const { return _bitmap_budget; }
 
     /** Creates the cairo_surface_t for the context with the
     given width, height and with the currently set target
@@ -173,6 +178,7 @@ public:
     bool renderPathVector(Geom::PathVector const &pathv, SPStyle const *style, Geom::OptRect const &pbox, CairoPaintOrder order = STROKE_OVER_FILL);
     bool renderImage(Inkscape::Pixbuf const *pb,
                      Geom::Affine const &image_transform, SPStyle const *style);
+    void paintRecording(cairo_surface_t *recording);
     bool renderGlyphtext(PangoFont *font, Geom::Affine const &font_matrix,
                          std::vector<CairoGlyphInfo> const &glyphtext, SPStyle const *style,
                          bool second_pass = false);
@@ -193,6 +199,7 @@ private:
     unsigned int _pdf_level = 1;
     unsigned int _ps_level = 1;
     unsigned _bitmapresolution = 72;
+    std::size_t _bitmap_budget = 64 << 20;
 
     bool _is_valid          : 1 = false;
     bool _eps               : 1 = false;
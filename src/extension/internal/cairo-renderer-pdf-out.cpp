@@ -60,7 +60,8 @@ bool CairoRendererPdfOutput::check(Inkscape::Extension::Extension * /*module*/)
 // TODO: Make this function more generic so that it can do both PostScript and PDF; expose in the headers
 static bool
 pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int level, PDFOptions flags,
-                            int resolution)
+                            int resolution, std::vector<SPItem const *> const &items = {},
+                            SPPage const *page = nullptr, Geom::OptRect const &area = {})
 {
     if (flags.text_to_path) {
         assert(!flags.text_to_latex);
@@ -91,10 +92,23 @@ pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int
     ctx.setOmitText(flags.text_to_latex);
     ctx.setFilterToBitmap(flags.rasterize_filters);
     ctx.setBitmapResolution(resolution);
-
-    bool ret = ctx.setPdfTarget(filename)
-               && renderer.setupDocument(&ctx, doc, root)
-               && renderer.renderPages(&ctx, doc, flags.stretch_to_fit);
+    ctx.setBitmapBudget(std::size_t{flags.raster_budget} << 20);
+
+    renderer.setShowOnly(items);
+    // Text omitted for LaTeX is tracked per page, which a shared recording can't follow.
+    renderer.setReuseClones(flags.reuse_clones && !flags.text_to_latex);
+
+    bool ret = ctx.setPdfTarget(filename) && renderer.setupDocument(&ctx, doc, root);
+    if (ret && (page || area)) {
+        // A single page or area, written without touching the document.
+        ctx.pushState();
+        ret = (page ? renderer.renderPage(&ctx, doc, page, flags.stretch_to_fit)
+                    : renderer.renderArea(&ctx, doc, *area, flags.stretch_to_fit))
+              && ctx.finishPage();
+        ctx.popState();
+    } else if (ret) {
+        ret = renderer.renderPages(&ctx, doc, flags.stretch_to_fit);
+    }
     if (ret) {
         ctx.finish();
     }
@@ -104,26 +118,11 @@ pdf_render_document_to_file(SPDocument *doc, gchar const *filename, unsigned int
 }
 
 /**
-    \brief  This function calls the output module with the filename
-    \param  mod   unused
-    \param  doc   Document to be saved
-    \param  filename   Filename to save to (probably will end in .pdf)
-
-    The most interesting thing that this function does is just attach
-    an '>' on the front of the filename.  This is the syntax used to
-    tell the printing system to save to file.
-*/
-void
-CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc, gchar const *filename)
+ * Read the PDF version, bitmap resolution and rendering flags from the output parameters.
+ */
+static PDFOptions read_pdf_options(Inkscape::Extension::Output *mod, Inkscape::Extension::Extension *ext,
+                                   int &level, int &resolution)
 {
-    Inkscape::Extension::Extension * ext;
-    unsigned int ret;
-
-    ext = Inkscape::Extension::db.get("org.inkscape.output.pdf.cairorenderer");
-    if (ext == nullptr)
-        return;
-
-    int level = 0;
     try {
         const gchar *new_level = mod->get_param_optiongroup("PDFversion");
         if((new_level != nullptr) && (g_ascii_strcasecmp("PDF-1.5", new_level) == 0)) {
@@ -159,14 +158,28 @@ CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc,
         g_warning("Parameter <blurToBitmap> might not exist");
     }
 
-    int new_bitmapResolution  = 72;
     try {
-        new_bitmapResolution = mod->get_param_int("resolution");
+        resolution = mod->get_param_int("resolution");
     }
     catch(...) {
         g_warning("Parameter <resolution> might not exist");
     }
 
+    try {
+        flags.raster_budget = mod->get_param_int("rasterBudget");
+    }
+    catch(...) {
+        g_warning("Parameter <rasterBudget> might not exist");
+    }
+
+    flags.reuse_clones = false;
+    try {
+        flags.reuse_clones = mod->get_param_bool("reuseClones");
+    }
+    catch(...) {
+        g_warning("Parameter <reuseClones> might not exist");
+    }
+
     flags.stretch_to_fit = false;
     try {
         flags.stretch_to_fit = (strcmp(ext->get_param_optiongroup("stretch"), "relative") == 0);
@@ -174,6 +187,33 @@ CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc,
         g_warning("Parameter <stretch> might not exist");
     }
 
+    return flags;
+}
+
+/**
+    \brief  This function calls the output module with the filename
+    \param  mod   unused
+    \param  doc   Document to be saved
+    \param  filename   Filename to save to (probably will end in .pdf)
+
+    The most interesting thing that this function does is just attach
+    an '>' on the front of the filename.  This is the syntax used to
+    tell the printing system to save to file.
+*/
+void
+CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc, gchar const *filename)
+{
+    Inkscape::Extension::Extension * ext;
+    unsigned int ret;
+
+    ext = Inkscape::Extension::db.get("org.inkscape.output.pdf.cairorenderer");
+    if (ext == nullptr)
+        return;
+
+    int level = 0;
+    int new_bitmapResolution = 72;
+    PDFOptions flags = read_pdf_options(mod, ext, level, new_bitmapResolution);
+
     // Create PDF file
     {
         gchar * final_name;
@@ -194,6 +234,55 @@ CairoRendererPdfOutput::save(Inkscape::Extension::Output *mod, SPDocument *doc,
     }
 }
 
+/**
+ * Whether saveSubset() can write a file with the current output parameters. Converting text
+ * to paths or LaTeX has to modify the document, so those still need a full save on a copy.
+ */
+bool CairoRendererPdfOutput::canSaveSubset(Inkscape::Extension::Output *mod)
+{
+    auto ext = Inkscape::Extension::db.get("org.inkscape.output.pdf.cairorenderer");
+    if (!ext || !mod || mod->get_id() != std::string("org.inkscape.output.pdf.cairorenderer")) {
+        return false;
+    }
+    int level = 0;
+    int resolution = 72;
+    auto flags = read_pdf_options(mod, ext, level, resolution);
+    return !flags.text_to_path && !flags.text_to_latex;
+}
+
+/**
+ * Write a single page, or an area of the document, restricted to the given items, without
+ * modifying the document. This lets batch export avoid copying the whole document per file.
+ *
+ * \param items  Items to show; empty to show everything.
+ * \param page   Page to write, or null to write \a area instead.
+ * \param area   Area in document coordinates, used when \a page is null.
+ */
+void CairoRendererPdfOutput::saveSubset(Inkscape::Extension::Output *mod, SPDocument *doc, gchar const *filename,
+                                        std::vector<SPItem const *> const &items, SPPage const *page,
+                                        Geom::OptRect const &area)
+{
+    auto ext = Inkscape::Extension::db.get("org.inkscape.output.pdf.cairorenderer");
+    if (!ext || (!page && !area)) {
+        throw Inkscape::Extension::Output::save_failed();
+    }
+
+    int level = 0;
+    int new_bitmapResolution = 72;
+    PDFOptions flags = read_pdf_options(mod, ext, level, new_bitmapResolution);
+    if (flags.text_to_path || flags.text_to_latex) {
+        // These modes edit the document, which a subset must not do.
+        throw Inkscape::Extension::Output::save_failed();
+    }
+
+    gchar *final_name = g_strdup_printf("> %s", filename);
+    bool ret = pdf_render_document_to_file(doc, final_name, level, flags, new_bitmapResolution, items, page, area);
+    g_free(final_name);
+
+    if (!ret)
+        throw Inkscape::Extension::Output::save_failed();
+}
+
 #include "clear-n_.h"
 
 /**
@@ -222,6 +311,12 @@ CairoRendererPdfOutput::init ()
             "</param>\n"
             "<param name=\"blurToBitmap\" gui-text=\"" N_("Rasterize filter effects") "\" type=\"bool\">true</param>\n"
             "<param name=\"resolution\" gui-text=\"" N_("Resolution for rasterization (dpi):") "\" type=\"int\" min=\"1\" max=\"10000\">96</param>\n"
+            "<param name=\"rasterBudget\" gui-text=\"" N_("Memory per rasterization (MiB):") "\" gui-description=\""
+                N_("Objects whose bitmap would be larger than this are rasterized in several tiles, which keeps memory use bounded when exporting very large documents.")
+                "\" type=\"int\" min=\"1\" max=\"65536\">64</param>\n"
+            "<param name=\"reuseClones\" gui-text=\"" N_("Store clones only once") "\" gui-description=\""
+                N_("Write the content of each cloned object or symbol once and refer to it from every clone. This makes files with many clones much smaller.")
+                "\" type=\"bool\">false</param>\n"
             "<spacer size=\"10\" />"
             "<param name=\"stretch\" gui-text=\"" N_("Rounding compensation:") "\" gui-description=\""
                 N_("Exporting to PDF rounds the document size to the next whole number in pt units. Compensation may stretch the drawing slightly (up to 0.35mm for width and/or height). When not compensating, object sizes will be preserved strictly, but this can sometimes cause white gaps along the page margins.")
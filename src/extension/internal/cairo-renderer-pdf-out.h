@@ -15,8 +15,14 @@
 #ifndef EXTENSION_INTERNAL_CAIRO_RENDERER_PDF_OUT_H
 #define EXTENSION_INTERNAL_CAIRO_RENDERER_PDF_OUT_H
 
+#include <vector>
+#include <2geom/rect.h>
+
 #include "extension/implementation/implementation.h"
 
+class SPItem;
+class SPPage;
+
 namespace Inkscape {
 namespace Extension {
 namespace Internal {
@@ -29,6 +35,11 @@ public:
               SPDocument *doc,
               gchar const *filename) override;
     static void init();
+
+    static bool canSaveSubset(Inkscape::Extension::Output *mod);
+    static void saveSubset(Inkscape::Extension::Output *mod, SPDocument *doc, gchar const *filename,
+                           std::vector<SPItem const *> const &items, SPPage const *page,
+                           Geom::OptRect const &area);
 };
 
 struct PDFOptions {
@@ -37,6 +48,8 @@ struct PDFOptions {
     bool rasterize_filters : 1; ///< Rasterize filter effects?
     bool drawing_only      : 1; ///< Set page size to drawing + margin instead of document page.
     bool stretch_to_fit    : 1; ///< Compensate for Cairo's page size rounding to integers (in pt)?
+    bool reuse_clones      : 1; ///< Write the content of clones once and paint it by reference?
+    unsigned raster_budget = 64; ///< Largest bitmap rendered at once for rasterized items, in MiB.
 };
 
 } } }  /* namespace Inkscape, Extension, Internal */
@@ -28,8 +28,16 @@
 #endif
 
 
+#include <algorithm>
+#include <cmath>
 #include <csignal>
+#include <cstring>
 #include <cerrno>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string_view>
+#include <thread>
 
 #include <2geom/transforms.h>
 #include <2geom/pathvector.h>
@@ -37,6 +45,7 @@
 #include <2geom/rect.h>
 #include <cairo.h>
 #include <glib.h>
+#include <glibmm/checksum.h>
 #include <glibmm/i18n.h>
 
 // include support for only the compiled-in surface types
@@ -59,6 +68,7 @@
 
 #include "object/sp-anchor.h"
 #include "object/sp-clippath.h"
+#include "object/sp-filter.h"
 #include "object/sp-flowtext.h"
 #include "object/sp-hatch-path.h"
 #include "object/sp-image.h"
@@ -74,6 +84,7 @@
 #include "object/sp-symbol.h"
 #include "object/sp-text.h"
 #include "object/sp-use.h"
+#include "object/filters/image.h"
 
 #include "util/units.h"
 
@@ -88,7 +99,12 @@ namespace Internal {
 
 CairoRenderer::CairoRenderer() = default;
 
-CairoRenderer::~CairoRenderer() = default;
+CairoRenderer::~CairoRenderer()
+{
+    for (auto const &[key, recording] : _clone_recordings) {
+        cairo_surface_destroy(recording);
+    }
+}
 
 CairoRenderContext CairoRenderer::createContext()
 {
@@ -297,7 +313,7 @@ static void sp_group_render(SPGroup const *group, CairoRenderContext *ctx, SPIte
 {
     CairoRenderer *renderer = ctx->getRenderer();
     for (auto &obj : group->children) {
-        if (auto item = cast<SPItem>(&obj)) {
+        if (auto item = cast<SPItem>(&obj); item && renderer->isShown(item)) {
             renderer->renderItem(ctx, item, origin, page);
         }
     }
@@ -317,10 +333,11 @@ static void sp_use_render(SPUse const *use, CairoRenderContext *ctx, SPPage cons
         translated = true;
     }
 
-    if (use->child) {
+    auto const child = use->sharedChild();
+    if (child && !(renderer->getReuseClones() && renderer->renderSharedClone(ctx, use, page))) {
         // Padding in the use object as the origin here ensures markers
         // are rendered with their correct context-fill.
-        renderer->renderItem(ctx, use->child, use, page);
+        renderer->renderItem(ctx, child, use, page);
     }
 
     if (translated) {
@@ -394,7 +411,7 @@ static void sp_anchor_render(SPAnchor const *a, CairoRenderContext *ctx, SPItem
 
     CairoRenderer *renderer = ctx->getRenderer();
     for (auto const &object : a->children) {
-        if (auto item = cast<SPItem>(&object)) {
+        if (auto item = cast<SPItem>(&object); item && renderer->isShown(item)) {
             renderer->renderItem(ctx, item, origin, page);
         }
     }
@@ -456,14 +473,100 @@ static void sp_root_render(SPRoot const *root, CairoRenderContext *ctx)
 }
 
 /**
-    This function converts the item to a raster image and includes the image into the cairo renderer.
-    It is only used for filters and then only when rendering filters as bitmaps is requested.
-*/
-static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPage const *page)
+ * Add a fingerprint fragment to a running digest. Each fragment is prefixed with its length, so that
+ * different sequences of fragments never digest the same bytes.
+ */
+static void digest_fragment(Glib::Checksum &digest, std::string_view fragment)
 {
+    auto const length = std::to_string(fragment.size()) + ':';
+    digest.update(reinterpret_cast<guchar const *>(length.data()), length.size());
+    digest.update(reinterpret_cast<guchar const *>(fragment.data()), fragment.size());
+}
 
-    // The code was adapted from sp_selection_create_bitmap_copy in selection-chemistry.cpp
+/**
+ * Digest everything in the subtree of an object that affects how it renders, apart from the position
+ * of the rasterized item itself. Returns false if the result also depends on other parts of the document.
+ */
+static bool digest_raster_fingerprint(SPObject const *object, Glib::Checksum &digest, bool is_root)
+{
+    if (auto item = cast<SPItem>(object)) {
+        if (auto filter = item->style->getFilter()) {
+            for (auto &primitive : filter->children) {
+                // feImage may render other objects at their place in the document.
+                if (is<SPFeImage>(&primitive)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    digest_fragment(digest, "(");
+    if (auto repr = object->getRepr()) {
+        digest_fragment(digest, repr->name() ? repr->name() : "");
+        for (auto const &attr : repr->attributeList()) {
+            char const *key = g_quark_to_string(attr.key);
+            // The root's transform is covered by the caller; descendants' transforms change the picture.
+            if (std::strcmp(key, "id") == 0 || (is_root && std::strcmp(key, "transform") == 0)) {
+                continue;
+            }
+            digest_fragment(digest, key);
+            digest_fragment(digest, attr.value ? static_cast<char const *>(attr.value) : "");
+        }
+        if (auto content = repr->content()) {
+            digest_fragment(digest, content);
+        }
+    }
+    // Children include the content of clones.
+    for (auto &child : object->children) {
+        if (!digest_raster_fingerprint(&child, digest, false)) {
+            return false;
+        }
+    }
+    digest_fragment(digest, ")");
+    return true;
+}
 
+/**
+ * Key under which the bitmap of an item is shared. Items with equal keys rasterize to the same bitmap
+ * relative to their bounding box. Returns std::nullopt if the item can't be shared.
+ */
+static std::optional<CairoRenderer::BitmapKey> raster_cache_key(SPItem const *item, double res, unsigned width,
+                                                                unsigned height)
+{
+    CairoTagStringStream key;
+    key.precision(17);
+    key << item->i2doc_affine().withoutTranslation() << ';' << item->style->write(SP_STYLE_FLAG_ALWAYS);
+
+    Glib::Checksum digest(Glib::Checksum::Type::SHA256);
+    digest_fragment(digest, key.str());
+    if (!digest_raster_fingerprint(item, digest, true)) {
+        return {};
+    }
+    return CairoRenderer::BitmapKey{res, width, height, digest.get_string()};
+}
+
+/**
+ * Where and at what size an item is rasterized.
+ */
+struct RasterLayout
+{
+    double res;
+    Geom::Rect bbox; ///< Area of the document covered by the bitmap.
+    bool whole;      ///< Whether the bitmap shows all of the item.
+    unsigned width;
+    unsigned height;
+    unsigned tile_width;
+    unsigned tile_height;
+
+    bool isTiled() const { return tile_width != width || tile_height != height; }
+};
+
+/**
+ * Work out the bitmap an item is rasterized into on a page. Returns std::nullopt if there is nothing
+ * to rasterize.
+ */
+static std::optional<RasterLayout> raster_layout(SPItem const *item, CairoRenderContext *ctx, SPPage const *page)
+{
     // Calculate resolution
     /** @TODO reimplement the resolution stuff   (WHY?)
     */
@@ -475,49 +578,130 @@ static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPa
 
     // Get the bounding box of the selection in document coordinates.
     Geom::OptRect bbox = item->documentVisualBounds();
+    Geom::OptRect const item_bbox = bbox;
 
     bbox &= (page ? page->getDocumentRect() : item->document->preferredBounds());
 
     // no bbox, e.g. empty group or item not overlapping its page
     if (!bbox) {
-        return;
+        return {};
     }
 
     // The width and height of the bitmap in pixels
     unsigned width =  ceil(bbox->width() * Inkscape::Util::Quantity::convert(res, "px", "in"));
     unsigned height = ceil(bbox->height() * Inkscape::Util::Quantity::convert(res, "px", "in"));
 
-    if (width == 0 || height == 0) return;
+    if (width == 0 || height == 0) {
+        return {};
+    }
+
+    // Large items are rasterized in tiles, so that a single huge filtered object never needs more
+    // than the context's bitmap budget (times the filter's working copies) at a time.
+    std::size_t const max_pixels = std::max<std::size_t>(ctx->getBitmapBudget() / 4, 256 * 256);
+    unsigned tile_width = width;
+    unsigned tile_height = height;
+    if (std::size_t{width} * height > max_pixels) {
+        tile_width = std::min<unsigned>(width, std::sqrt(max_pixels));
+        tile_height = std::min<unsigned>(height, max_pixels / tile_width);
+    }
+
+    return RasterLayout{res, *bbox, bbox == item_bbox, width, height, tile_width, tile_height};
+}
+
+/**
+    This function converts the item to a raster image and includes the image into the cairo renderer.
+    It is only used for filters and then only when rendering filters as bitmaps is requested.
+*/
+static void sp_asbitmap_render(SPItem const *item, CairoRenderContext *ctx, SPPage const *page)
+{
+
+    // The code was adapted from sp_selection_create_bitmap_copy in selection-chemistry.cpp
+
+    auto const layout = raster_layout(item, ctx, page);
+    if (!layout) {
+        return;
+    }
+    auto const &bbox = layout->bbox;
+    unsigned const width = layout->width;
+    unsigned const height = layout->height;
 
     // Scale to exactly fit integer bitmap inside bounding box
-    double scale_x = bbox->width() / width;
-    double scale_y = bbox->height() / height;
+    double scale_x = bbox.width() / width;
+    double scale_y = bbox.height() / height;
 
     // Location of bounding box in document coordinates.
-    double shift_x = bbox->min()[Geom::X];
-    double shift_y = bbox->top();
+    double shift_x = bbox.min()[Geom::X];
+    double shift_y = bbox.top();
 
     // For default 96 dpi, snap bitmap to pixel grid
-    if (res == Inkscape::Util::Quantity::convert(1, "in", "px")) {
+    if (layout->res == Inkscape::Util::Quantity::convert(1, "in", "px")) {
         shift_x = round (shift_x);
         shift_y = round (shift_y);
     }
 
-    // Calculate the matrix that will be applied to the image so that it exactly overlaps the source objects
+    // ctx matrix already includes item transformation. We must substract.
+    Geom::Affine const t_item_inverse = item->i2doc_affine().inverse();
 
-    // Matrix to put bitmap in correct place on document
-    Geom::Affine t_on_document = Geom::Scale(scale_x, scale_y) * Geom::Translate(shift_x, shift_y);
+    auto renderer = ctx->getRenderer();
+    unsigned const tile_width = layout->tile_width;
+    unsigned const tile_height = layout->tile_height;
 
-    // ctx matrix already includes item transformation. We must substract.
-    Geom::Affine t_item =  item->i2doc_affine();
-    Geom::Affine t = t_on_document * t_item.inverse();
+    // A bitmap of the whole item may have been rasterized in the background already.
+    std::shared_ptr<Inkscape::Pixbuf const> prepared;
+    if (!layout->isTiled()) {
+        prepared = renderer->takePreparedBitmap(item, bbox);
+    }
+
+    // Identical items, such as clones of a filtered object, share the bitmap of a whole item
+    // for the rest of the export.
+    std::size_t const cache_limit = ctx->getBitmapBudget() * 4;
+    std::optional<CairoRenderer::BitmapKey> cache_key;
+    if (!layout->isTiled() && layout->whole &&
+        renderer->mayShareBitmap(std::size_t{width} * height * 4, cache_limit)) {
+        cache_key = raster_cache_key(item, layout->res, width, height);
+    }
+
+    // All tiles are rendered from one drawing, each into an exact pixel rectangle of the whole
+    // bitmap, so that they line up without seams. It is only set up when a bitmap must be drawn.
+    std::optional<InternalBitmapDrawing> drawing;
+
+    for (unsigned y = 0; y < height; y += tile_height) {
+        for (unsigned x = 0; x < width; x += tile_width) {
+            unsigned const w = std::min(tile_width, width - x);
+            unsigned const h = std::min(tile_height, height - y);
+            auto const pixels = Geom::IntRect::from_xywh(x, y, w, h);
+
+            // Calculate the matrix that will be applied to the image so that it exactly overlaps the source objects
 
-    // Do the export
-    std::unique_ptr<Inkscape::Pixbuf> pb(sp_generate_internal_bitmap(item->document, *bbox, res, {item}, true));
+            // Matrix to put bitmap in correct place on document
+            Geom::Affine t_on_document = Geom::Translate(x, y) * Geom::Scale(scale_x, scale_y) *
+                                         Geom::Translate(shift_x, shift_y);
+            Geom::Affine t = t_on_document * t_item_inverse;
+
+            // Do the export
+            std::shared_ptr<Inkscape::Pixbuf const> pb;
+            if (cache_key) {
+                pb = renderer->findBitmap(*cache_key);
+            }
+            if (!pb) {
+                if (prepared) {
+                    pb = std::move(prepared);
+                } else {
+                    if (!drawing) {
+                        drawing.emplace(item->document, bbox, layout->res, std::vector<SPItem const *>{item}, true);
+                    }
+                    pb.reset(drawing->render(pixels));
+                }
+                if (pb && cache_key) {
+                    renderer->storeBitmap(*cache_key, pb, cache_limit);
+                }
+            }
 
-    if (pb) {
-        //TEST(gdk_pixbuf_save( pb, "bitmap.png", "png", NULL, NULL ));
-        ctx->renderImage(pb.get(), t, item->style);
+            if (pb) {
+                //TEST(gdk_pixbuf_save( pb, "bitmap.png", "png", NULL, NULL ));
+                ctx->renderImage(pb.get(), t, item->style);
+            }
+        }
     }
 }
 
@@ -601,6 +785,249 @@ void CairoRenderer::_doRender(SPItem const *item, CairoRenderContext *ctx, SPIte
     }
 }
 
+/**
+ * Whether the content of a clone renders the same regardless of where it is painted, so that it can
+ * be recorded once. Clips and masks may be rasterized at page resolution, filters are rasterized,
+ * blending needs the real backdrop and links need their position on the page.
+ */
+static bool clone_content_is_shareable(SPItem const *item)
+{
+    if (item->getClipObject() || item->getMaskObject() || item->isFiltered() || is<SPAnchor>(item)) {
+        return false;
+    }
+    if (item->style->mix_blend_mode.set && item->style->mix_blend_mode.value != SP_CSS_BLEND_NORMAL) {
+        return false;
+    }
+    for (auto link : item->getLinked(SPObject::LinkedObjectNature::DEPENDENT)) {
+        if (is<SPAnchor>(link)) {
+            return false;
+        }
+    }
+
+    if (auto use = cast<SPUse>(item)) {
+        auto const child = use->sharedChild();
+        return !child || clone_content_is_shareable(child);
+    }
+    for (auto &child : item->children) {
+        if (auto child_item = cast<SPItem>(&child); child_item && !clone_content_is_shareable(child_item)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Find the style properties whose value the content of a clone takes from the clone: those that an
+ * item of the content inherits without any item above it within the content setting them.
+ *
+ * \param covered  Properties set within the content above \a object.
+ */
+static void collect_inherited_properties(SPObject const *object, std::vector<bool> &inherited,
+                                         std::vector<bool> covered)
+{
+    if (!object->style) {
+        return;
+    }
+    auto const &properties = object->style->properties();
+    for (std::size_t i = 0; i < properties.size(); i++) {
+        if (covered[i]) {
+            continue;
+        }
+        auto const property = properties[i];
+        if (property->inherit || (!property->set && property->inherits)) {
+            inherited[i] = true;
+        } else {
+            // Set here, or reset to the initial value, so nothing further down sees the clone's value.
+            covered[i] = true;
+        }
+    }
+    for (auto &child : object->children) {
+        collect_inherited_properties(&child, inherited, covered);
+    }
+}
+
+bool CairoRenderer::mayShareBitmap(std::size_t size, std::size_t limit) const
+{
+    return !_bitmaps.empty() || size <= limit;
+}
+
+std::shared_ptr<Inkscape::Pixbuf const> CairoRenderer::findBitmap(BitmapKey const &key) const
+{
+    auto it = _bitmaps.find(key);
+    return it != _bitmaps.end() ? it->second : nullptr;
+}
+
+void CairoRenderer::storeBitmap(BitmapKey const &key, std::shared_ptr<Inkscape::Pixbuf const> bitmap,
+                                std::size_t limit)
+{
+    std::size_t const size = std::size_t(bitmap->rowstride()) * bitmap->height();
+    if (_bitmaps_size + size > limit) {
+        return;
+    }
+    _bitmaps_size += size;
+    _bitmaps.emplace(key, std::move(bitmap));
+}
+
+/**
+ * A rasterization that runs on a worker thread while the output is written. The drawing is set up
+ * on the main thread when the rasterization starts, and torn down there once it is taken.
+ */
+struct CairoRenderer::PreparedBitmap
+{
+    SPItem const *item;
+    RasterLayout layout;
+    std::unique_ptr<InternalBitmapDrawing> drawing;
+    // Declared after the drawing, so that it waits for the rendering before the drawing goes away.
+    std::future<std::unique_ptr<Inkscape::Pixbuf>> bitmap;
+};
+
+void CairoRenderer::prepareBitmaps(CairoRenderContext *ctx, std::vector<SPItem const *> const &items,
+                                   SPPage const *page)
+{
+    _prepared_bitmaps.clear();
+    _prepared_taken = _prepared_started = 0;
+    for (auto item : items) {
+        _collectPreparedBitmaps(ctx, item, page);
+    }
+    _startPreparedBitmaps();
+}
+
+/**
+ * Find the items that are rasterized when an item is rendered, in the order _doRender() reaches them.
+ * Items rasterized in tiles are left to be rendered when they are reached, as are items within
+ * clones, markers, patterns, clips and masks.
+ */
+void CairoRenderer::_collectPreparedBitmaps(CairoRenderContext *ctx, SPItem const *item, SPPage const *page)
+{
+    if (item->isHidden() || has_hidder_filter(item)) {
+        return;
+    }
+    if (_shouldRasterize(ctx, item)) {
+        if (auto layout = raster_layout(item, ctx, page); layout && !layout->isTiled()) {
+            _prepared_bitmaps.push_back(std::make_unique<PreparedBitmap>(PreparedBitmap{item, *layout}));
+        }
+        return;
+    }
+    if (page && !page->itemOnPage(item, false, false)) {
+        return;
+    }
+    if (auto group = cast<SPGroup>(item); group && !is<SPMarker>(group)) {
+        for (auto &child : group->children) {
+            if (auto child_item = cast<SPItem>(&child); child_item && isShown(child_item)) {
+                _collectPreparedBitmaps(ctx, child_item, page);
+            }
+        }
+    }
+}
+
+/**
+ * Start as many of the expected rasterizations as there are worker threads for.
+ */
+void CairoRenderer::_startPreparedBitmaps()
+{
+    std::size_t const workers = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    _prepared_started = std::max(_prepared_started, _prepared_taken);
+    for (; _prepared_started < _prepared_bitmaps.size() && _prepared_started - _prepared_taken < workers;
+         _prepared_started++) {
+        auto &prepared = *_prepared_bitmaps[_prepared_started];
+        auto const &layout = prepared.layout;
+
+        // Clones of an item rasterized before are painted from the shared bitmap instead.
+        if (layout.whole) {
+            auto const key = raster_cache_key(prepared.item, layout.res, layout.width, layout.height);
+            if (key && findBitmap(*key)) {
+                continue;
+            }
+        }
+
+        // Showing the item builds the drawing from the object tree, which is only done here.
+        prepared.drawing = std::make_unique<InternalBitmapDrawing>(
+            prepared.item->document, layout.bbox, layout.res, std::vector<SPItem const *>{prepared.item}, true);
+        auto const pixels = Geom::IntRect::from_xywh(0, 0, layout.width, layout.height);
+        prepared.bitmap = std::async(std::launch::async, [drawing = prepared.drawing.get(), pixels] {
+            return std::unique_ptr<Inkscape::Pixbuf>(drawing->render(pixels));
+        });
+    }
+}
+
+std::shared_ptr<Inkscape::Pixbuf const> CairoRenderer::takePreparedBitmap(SPItem const *item,
+                                                                          Geom::Rect const &area)
+{
+    auto const first = _prepared_bitmaps.begin() + _prepared_taken;
+    auto const it = std::find_if(first, _prepared_bitmaps.end(),
+                                 [=](auto const &prepared) { return prepared->item == item; });
+    if (it == _prepared_bitmaps.end()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Inkscape::Pixbuf const> result;
+    auto &prepared = **it;
+    if (prepared.bitmap.valid() && prepared.layout.bbox == area) {
+        result = prepared.bitmap.get();
+    }
+
+    // Rasterizations expected before this one were not needed after all.
+    std::for_each(first, it + 1, [](auto &entry) { entry.reset(); });
+    _prepared_taken = it - _prepared_bitmaps.begin() + 1;
+    _startPreparedBitmaps();
+    return result;
+}
+
+bool CairoRenderer::renderSharedClone(CairoRenderContext *ctx, SPUse const *use, SPPage const *page)
+{
+    // Clip children only contribute their outline to the clip path; painting a recording would draw them.
+    if (ctx->getRenderMode() != CairoRenderContext::RENDER_MODE_NORMAL || use->isInClipPath()) {
+        return false;
+    }
+
+    auto const original = use->get_original();
+    auto const child = child;
+    if (!original || !clone_content_is_shareable(child)) {
+        return false;
+    }
+
+    // The content inherits part of the clone's style, and a cloned symbol is laid out in the clone's viewport.
+    auto it = _clone_inherited_properties.find(original);
+    if (it == _clone_inherited_properties.end()) {
+        auto const count = use->style->properties().size();
+        std::vector<bool> inherited(count);
+        collect_inherited_properties(child, inherited, std::vector<bool>(count));
+        std::vector<std::size_t> indices;
+        for (std::size_t i = 0; i < count; i++) {
+            if (inherited[i]) {
+                indices.push_back(i);
+            }
+        }
+        it = _clone_inherited_properties.emplace(original, std::move(indices)).first;
+    }
+
+    CairoTagStringStream key;
+    key.precision(17);
+    for (auto const i : it->second) {
+        auto const property = use->style->properties()[i];
+        key << property->name() << ':' << property->get_value() << ';';
+    }
+    key << child->transform;
+    if (auto symbol = cast<SPSymbol>(child)) {
+        key << ';' << symbol->c2p;
+    }
+
+    auto &recording = _clone_recordings[{original, key.str()}];
+    if (!recording) {
+        auto const bbox = child->visualBounds(child->transform);
+        if (!bbox) {
+            _clone_recordings.erase({original, key.str()});
+            return false;
+        }
+        auto rec_ctx = ctx->createRecording(*bbox);
+        renderItem(&rec_ctx, child, use, page);
+        recording = cairo_surface_reference(rec_ctx.getSurface());
+    }
+
+    ctx->paintRecording(recording);
+    return true;
+}
+
 void CairoRenderer::renderItem(CairoRenderContext *ctx, SPItem const *item, SPItem const *origin, SPPage const *page)
 {
     ctx->pushState();
@@ -684,7 +1111,9 @@ CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretc
     auto pages = doc->getPageManager().getPages();
     if (pages.size() == 0) {
         // Output the page bounding box as already set up in the initial setupDocument.
+        prepareBitmaps(ctx, {doc->getRoot()}, nullptr);
         renderItem(ctx, doc->getRoot());
+        prepareBitmaps(ctx, {}, nullptr);
         return true;
     }
 
@@ -708,12 +1137,76 @@ CairoRenderer::renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretc
 
 bool
 CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage const *page, bool stretch_to_fit)
+{
+    auto const rect = page->getBleed();
+    _beginPage(ctx, doc, rect, page->label(), stretch_to_fit);
+
+    SPRoot *root = doc->getRoot();
+    std::vector<SPItem *> items;
+    for (auto &child : page->getOverlappingItems(false, true, false)) {
+        if (_isShownOnPage(child)) {
+            items.push_back(child);
+        }
+    }
+    prepareBitmaps(ctx, {items.begin(), items.end()}, page);
+
+    for (auto child : items) {
+        ctx->pushState();
+
+        // This process does not return layers, so those affines are added manually.
+        for (auto anc : child->ancestorList(true)) {
+            if (auto layer = cast<SPItem>(anc)) {
+                if (layer != child && layer != root) {
+                    ctx->transform(layer->transform);
+                }
+            }
+        }
+
+        // Render the page into the context in the new location.
+        renderItem(ctx, child, nullptr, page);
+        ctx->popState();
+    }
+    prepareBitmaps(ctx, {}, page);
+    return true;
+}
+
+/**
+ * Render an arbitrary area of the document, given in document coordinates, as a single page.
+ * Only the items allowed by setShowOnly() are drawn.
+ */
+bool
+CairoRenderer::renderArea(CairoRenderContext *ctx, SPDocument *doc, Geom::Rect const &area, bool stretch_to_fit)
+{
+    _beginPage(ctx, doc, area * doc->getDocumentScale().inverse(), nullptr, stretch_to_fit);
+
+    // Like renderPage, the root's own viewBox transform has already been applied.
+    std::vector<SPItem const *> items;
+    for (auto &child : doc->getRoot()->children) {
+        if (auto item = cast<SPItem>(&child); item && isShown(item)) {
+            items.push_back(item);
+        }
+    }
+    prepareBitmaps(ctx, items, nullptr);
+
+    for (auto item : items) {
+        renderItem(ctx, item);
+    }
+    prepareBitmaps(ctx, {}, nullptr);
+    return true;
+}
+
+/**
+ * Start a new output page showing the given rectangle, in user units, and set up the
+ * transformation so that the rectangle's corner ends up at the page origin.
+ */
+void
+CairoRenderer::_beginPage(CairoRenderContext *ctx, SPDocument *doc, Geom::Rect const &rect, char const *label,
+                          bool stretch_to_fit)
 {
     // Calculate exact page rectangle in PostScript points:
     auto const scale = doc->getDocumentScale();
     auto const unit_conversion = Geom::Scale(Inkscape::Util::Quantity::convert(1, "px", "pt"));
 
-    auto const rect = page->getBleed();
     auto const exact_rect = rect * scale * unit_conversion;
     auto const [final_width, final_height] = compute_final_page_dimensions(exact_rect);
 
@@ -730,28 +1223,52 @@ CairoRenderer::renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage const
 
     SPRoot *root = doc->getRoot();
     ctx->transform(root->transform);
-    ctx->nextPage(final_width, final_height, page->label());
+    ctx->nextPage(final_width, final_height, label);
 
     // Set up page transformation which pushes objects back into the 0,0 location
     ctx->transform(Geom::Translate(rect.corner(0)).inverse());
+}
 
-    for (auto &child : page->getOverlappingItems(false, true, false)) {
-        ctx->pushState();
-
-        // This process does not return layers, so those affines are added manually.
-        for (auto anc : child->ancestorList(true)) {
-            if (auto layer = cast<SPItem>(anc)) {
-                if (layer != child && layer != root) {
-                    ctx->transform(layer->transform);
-                }
-            }
+void CairoRenderer::setShowOnly(std::vector<SPItem const *> const &items)
+{
+    _show_only.clear();
+    _show_only_ancestors.clear();
+    for (auto item : items) {
+        _show_only.insert(item);
+        for (auto parent = cast<SPItem>(item->parent); parent; parent = cast<SPItem>(parent->parent)) {
+            _show_only_ancestors.insert(parent);
         }
+    }
+}
 
-        // Render the page into the context in the new location.
-        renderItem(ctx, child, nullptr, page);
-        ctx->popState();
+/**
+ * Check a child met while traversing a group. Only the children of the ancestors of shown
+ * items are filtered; anything below a shown item, and the content of clips, masks, markers
+ * and patterns, is always drawn.
+ */
+bool CairoRenderer::isShown(SPItem const *item) const
+{
+    if (_show_only.empty() || !_show_only_ancestors.count(cast<SPItem>(item->parent))) {
+        return true;
     }
-    return true;
+    return _show_only.count(item) || _show_only_ancestors.count(item);
+}
+
+/**
+ * Like isShown() but for the items returned by SPPage::getOverlappingItems(), which can
+ * come from anywhere in the layer tree.
+ */
+bool CairoRenderer::_isShownOnPage(SPItem const *item) const
+{
+    if (_show_only.empty() || _show_only_ancestors.count(item)) {
+        return true;
+    }
+    for (auto obj = static_cast<SPObject const *>(item); obj; obj = obj->parent) {
+        if (_show_only.count(cast<SPItem>(obj))) {
+            return true;
+        }
+    }
+    return false;
 }
 
 // Apply an SVG clip path
@@ -16,8 +16,14 @@
  */
 
 #include "extension/extension.h"
+#include <compare>
+#include <cstddef>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
+#include <2geom/forward.h>
 
 //#include "libnrtype/font-instance.h"
 #include <cairo.h>
@@ -27,8 +33,11 @@ class SPClipPath;
 class SPMask;
 class SPHatchPath;
 class SPPage;
+class SPUse;
 
 namespace Inkscape {
+class Pixbuf;
+
 namespace Extension {
 namespace Internal {
 
@@ -56,8 +65,48 @@ public:
     void renderHatchPath(CairoRenderContext *ctx, SPHatchPath const &hatchPath, unsigned key);
     bool renderPages(CairoRenderContext *ctx, SPDocument *doc, bool stretch_to_fit);
     bool renderPage(CairoRenderContext *ctx, SPDocument *doc, SPPage const *page, bool stretch_to_fit);
+    bool renderArea(CairoRenderContext *ctx, SPDocument *doc, Geom::Rect const &area, bool stretch_to_fit);
+
+    /** Restrict rendering to the given items, their ancestors and their descendants, leaving
+    the document untouched. An empty list renders everything. */
+    void setShowOnly(std::vector<SPItem const *> const &items);
+    bool isShown(SPItem const *item) const;
+
+    /** Record the content of each distinct clone once and paint every instance from that
+    recording, so that vector output stores shared content only once. */
+    void setReuseClones(bool reuse) { _reuse_clones = reuse; }
+    bool getReuseClones() const { return _reuse_clones; }
+
+    /** Paint the content of a clone from its shared recording. Returns false if the clone
+    can't be shared and has to be rendered directly. */
+    bool renderSharedClone(CairoRenderContext *ctx, SPUse const *use, SPPage const *page);
+
+    /** Identifies a rasterization: its resolution and size, and a SHA-256 digest of everything
+    else that affects the bitmap. */
+    struct BitmapKey
+    {
+        double res;
+        unsigned width;
+        unsigned height;
+        std::string digest;
+        auto operator<=>(BitmapKey const &) const = default;
+    };
+
+    /** Bitmaps of rasterized items, shared between items that render identically for the
+    duration of an export. Storing stops once the cached bitmaps take up limit bytes. */
+    bool mayShareBitmap(std::size_t size, std::size_t limit) const;
+    std::shared_ptr<Inkscape::Pixbuf const> findBitmap(BitmapKey const &key) const;
+    void storeBitmap(BitmapKey const &key, std::shared_ptr<Inkscape::Pixbuf const> bitmap, std::size_t limit);
+
+    /** Start rasterizing, on worker threads, the items that rendering the given items in this order
+    turns into bitmaps, so that their bitmaps are ready by the time the output reaches them.
+    Bitmaps prepared earlier and not taken are dropped, so passing no items drops them all. */
+    void prepareBitmaps(CairoRenderContext *ctx, std::vector<SPItem const *> const &items, SPPage const *page);
+    /** The bitmap prepared for an item covering the given document area, or null if there is none. */
+    std::shared_ptr<Inkscape::Pixbuf const> takePreparedBitmap(SPItem const *item, Geom::Rect const &area);
 
 private:
+    struct PreparedBitmap;
     /** Decide whether the given item should be rendered as a bitmap. */
     static bool _shouldRasterize(CairoRenderContext *ctx, SPItem const *item);
 
@@ -65,6 +114,30 @@ private:
     static void _doRender(SPItem const *item, CairoRenderContext *ctx, SPItem const *origin = nullptr,
                           SPPage const *page = nullptr);
 
+    void _beginPage(CairoRenderContext *ctx, SPDocument *doc, Geom::Rect const &rect, char const *label,
+                    bool stretch_to_fit);
+    void _collectPreparedBitmaps(CairoRenderContext *ctx, SPItem const *item, SPPage const *page);
+    void _startPreparedBitmaps();
+    bool _isShownOnPage(SPItem const *item) const;
+
+    std::set<SPItem const *> _show_only;
+    std::set<SPItem const *> _show_only_ancestors;
+
+    bool _reuse_clones = false;
+    /// Recordings of clone content, keyed by the referenced item and everything the clone
+    /// changes about how it renders.
+    std::map<std::pair<SPItem const *, std::string>, cairo_surface_t *> _clone_recordings;
+    /// Per referenced item, the indices of the style properties its clones pass on to it.
+    std::map<SPItem const *, std::vector<std::size_t>> _clone_inherited_properties;
+
+    std::map<BitmapKey, std::shared_ptr<Inkscape::Pixbuf const>> _bitmaps;
+    std::size_t _bitmaps_size = 0;
+
+    /// Rasterizations expected in the order the output reaches them. Those before
+    /// _prepared_taken are done with, and those from _prepared_started on are not started yet.
+    std::vector<std::unique_ptr<PreparedBitmap>> _prepared_bitmaps;
+    std::size_t _prepared_taken = 0;
+    std::size_t _prepared_started = 0;
 };
 
 // FIXME: this should be a static method of CairoRenderer
@@ -218,7 +218,7 @@ void LaTeXTextRenderer::sp_use_render(SPUse *use)
         translated = true;
     }
 
-    auto childItem = use->child;
+    auto childItem = use->sharedChild();
     if (childItem) {
         renderItem(childItem);
     }
@@ -0,0 +1,609 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Parsing the pages of a PDF on worker threads.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "page-import.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "document.h"
+#include "rdf.h"
+#include "svg-builder.h"
+#include "object/sp-defs.h"
+#include "object/sp-item.h"
+#include "xml/document.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+using namespace std::literals;
+
+namespace Inkscape::Extension::Internal {
+
+namespace {
+
+constexpr auto placeholder_prefix = "pdf-import-"sv;
+
+/// The attributes that can refer to definitions by id.
+constexpr std::array<std::string_view, 8> reference_attributes = {
+    "style"sv, "clip-path"sv, "mask"sv, "fill"sv, "stroke"sv, "filter"sv, "xlink:href"sv, "href"sv,
+};
+
+bool is_reference_attribute(char const *name)
+{
+    return std::find(reference_attributes.begin(), reference_attributes.end(), name) != reference_attributes.end();
+}
+
+/// Call @a func with each placeholder id in @a value, along with its position.
+template <typename F>
+void for_each_placeholder(std::string_view value, F &&func)
+{
+    for (auto pos = value.find(placeholder_prefix); pos != value.npos;
+         pos = value.find(placeholder_prefix, pos + 1)) {
+        auto end = pos + placeholder_prefix.size();
+        while (end < value.size() && value[end] >= '0' && value[end] <= '9') {
+            end++;
+        }
+        if (end > pos + placeholder_prefix.size()) {
+            func(pos, value.substr(pos, end - pos));
+        }
+    }
+}
+
+bool is_placeholder(std::string_view value)
+{
+    bool found = false;
+    for_each_placeholder(value, [&](auto pos, auto id) { found = pos == 0 && id.size() == value.size(); });
+    return found;
+}
+
+} // namespace
+
+PageImportContext::PageImportContext(int workers)
+    : _workers(workers)
+{}
+
+PageImportContext::~PageImportContext() = default;
+
+void PageImportContext::runOnMainThread(std::function<void()> const &func)
+{
+    Call call{&func};
+    std::unique_lock lock(_mutex);
+    _calls.push_back(&call);
+    _cond.notify_all();
+    _cond.wait(lock, [&] { return call.done; });
+    if (call.error) {
+        std::rethrow_exception(call.error);
+    }
+}
+
+void PageImportContext::workerFinished()
+{
+    std::lock_guard lock(_mutex);
+    _workers--;
+    _cond.notify_all();
+}
+
+void PageImportContext::serve()
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _cond.wait(lock, [this] { return !_calls.empty() || _workers == 0; });
+        if (_calls.empty()) {
+            return;
+        }
+        auto call = _calls.front();
+        _calls.pop_front();
+
+        lock.unlock();
+        try {
+            (*call->func)();
+        } catch (...) {
+            call->error = std::current_exception();
+        }
+        lock.lock();
+
+        call->done = true;
+        _cond.notify_all();
+    }
+}
+
+std::shared_ptr<FontLookup const> PageImportContext::fontLookup(FontPtr const &font)
+{
+    auto const ref = font->getID();
+    auto const key = std::make_pair(ref->num, ref->gen);
+    {
+        std::lock_guard lock(_mutex);
+        if (auto it = _fonts.find(key); it != _fonts.end()) {
+            return it->second;
+        }
+    }
+
+    // The font factory can only be used on the main thread.
+    std::shared_ptr<FontLookup const> lookup;
+    runOnMainThread([&] { lookup = std::make_shared<FontLookup const>(font); });
+
+    std::lock_guard lock(_mutex);
+    return _fonts.emplace(key, std::move(lookup)).first->second;
+}
+
+Geom::OptRect PageImportContext::visualBounds(PageImport const &page, XML::Node const &node)
+{
+    Geom::OptRect bounds;
+    runOnMainThread([&] { bounds = _visualBounds(page, node); });
+    return bounds;
+}
+
+/**
+ * Measure a copy of the node in a document of its own, along with the definitions it refers to
+ * and the styles of its ancestors.
+ */
+Geom::OptRect PageImportContext::_visualBounds(PageImport const &page, XML::Node const &node)
+{
+    // Like an object that isn't part of the document, when parsing pages one after another.
+    std::vector<XML::Node const *> ancestors;
+    auto parent = node.parent();
+    for (; parent && parent != page.root(); parent = parent->parent()) {
+        ancestors.push_back(parent);
+    }
+    if (!parent) {
+        return {};
+    }
+
+    if (!_scratch) {
+        _scratch = SPDocument::createNewDocFromMem(
+            R"(<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink"/>)"sv);
+    }
+    auto xml_doc = _scratch->getReprDoc();
+    auto root = _scratch->getReprRoot();
+
+    std::vector<XML::Node *> added;
+    auto add = [&](XML::Node *to, XML::Node *child) {
+        to->appendChild(child);
+        Inkscape::GC::release(child);
+        if (to == root) {
+            added.push_back(child);
+        }
+    };
+
+    for (auto def : page.references(node)) {
+        add(root, def->duplicate(xml_doc));
+    }
+    XML::Node *container = root;
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+        auto shell = xml_doc->createElement((*it)->name());
+        for (auto const &attr : (*it)->attributeList()) {
+            auto name = g_quark_to_string(attr.key);
+            if (std::strcmp(name, "id") && std::strcmp(name, "clip-path") && std::strcmp(name, "mask")) {
+                shell->setAttribute(name, attr.value.pointer());
+            }
+        }
+        add(container, shell);
+        container = shell;
+    }
+    auto copy = node.duplicate(xml_doc);
+    add(container, copy);
+
+    _scratch->ensureUpToDate();
+    Geom::OptRect bounds;
+    if (auto item = cast<SPItem>(_scratch->getObjectByRepr(copy))) {
+        bounds = item->visualBounds();
+    }
+
+    for (auto child : added) {
+        root->removeChild(child);
+    }
+    return bounds;
+}
+
+PageImport::PageImport(PageImportContext &context)
+    : _context(context)
+    , _xml_doc(sp_repr_document_new("svg:svg"))
+    , _root(_xml_doc->root())
+{
+    _defs = _xml_doc->createElement("svg:defs");
+    _root->appendChild(_defs);
+    Inkscape::GC::release(_defs);
+
+    _root->addSubtreeObserver(*this);
+}
+
+PageImport::~PageImport()
+{
+    _root->removeSubtreeObserver(*this);
+    for (auto const &change : _changes) {
+        if (change.snapshot) {
+            Inkscape::GC::release(change.snapshot);
+        }
+    }
+    for (auto node : _kept) {
+        Inkscape::GC::release(node);
+    }
+    for (auto node : _detached) {
+        Inkscape::GC::release(node);
+    }
+    Inkscape::GC::release(_xml_doc);
+}
+
+/**
+ * The imported document gives the definition its id once it's replayed; until then the page
+ * refers to it by a placeholder.
+ */
+void PageImport::addDefinition(XML::Node *def, bool mask_id)
+{
+    auto id = std::string(placeholder_prefix) + std::to_string(++_next_id);
+    def->setAttribute("id", id);
+    if (mask_id) {
+        _mask_ids.insert(id);
+    }
+    _definitions[id] = def;
+    _defs->appendChild(def);
+}
+
+XML::Node *PageImport::getDefinition(std::string const &id) const
+{
+    auto it = _definitions.find(id);
+    if (it == _definitions.end()) {
+        return nullptr;
+    }
+    for (XML::Node const *node = it->second; node; node = node->parent()) {
+        if (node == _root) {
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<XML::Node const *> PageImport::references(XML::Node const &node) const
+{
+    std::vector<XML::Node const *> found;
+    std::vector<std::pair<XML::Node const *, bool>> todo{{&node, true}};
+    for (auto parent = node.parent(); parent && parent != _root; parent = parent->parent()) {
+        todo.emplace_back(parent, false);
+    }
+
+    while (!todo.empty()) {
+        auto [current, descend] = todo.back();
+        todo.pop_back();
+        for (auto const &attr : current->attributeList()) {
+            if (!attr.value || !is_reference_attribute(g_quark_to_string(attr.key))) {
+                continue;
+            }
+            for_each_placeholder(attr.value.pointer(), [&, this](auto, auto id) {
+                auto it = _definitions.find(std::string(id));
+                if (it != _definitions.end() && std::find(found.begin(), found.end(), it->second) == found.end()) {
+                    found.push_back(it->second);
+                    todo.emplace_back(it->second, true);
+                }
+            });
+        }
+        if (descend) {
+            for (auto child = current->firstChild(); child; child = child->next()) {
+                todo.emplace_back(child, true);
+            }
+        }
+    }
+    return found;
+}
+
+void PageImport::setMetadata(char const *name, std::string const &content)
+{
+    Change change{Change::METADATA};
+    change.key = name;
+    change.value = content;
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::notifyChildAdded(XML::Node &node, XML::Node &child, XML::Node *prev)
+{
+    Change change{Change::ADD};
+    change.node = &node;
+    change.child = &child;
+    change.prev = prev;
+    change.at_end = !child.next();
+    change.snapshot = child.duplicate(_xml_doc);
+
+    // Keep the nodes alive, so that they can't be mistaken for nodes created later.
+    std::vector<XML::Node *> todo{&child};
+    while (!todo.empty()) {
+        auto current = todo.back();
+        todo.pop_back();
+        change.subtree.push_back(current);
+        Inkscape::GC::anchor(current);
+        _kept.push_back(current);
+
+        std::vector<XML::Node *> children;
+        for (auto c = current->firstChild(); c; c = c->next()) {
+            children.push_back(c);
+        }
+        todo.insert(todo.end(), children.rbegin(), children.rend());
+    }
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::notifyChildRemoved(XML::Node &node, XML::Node &child, XML::Node * /*prev*/)
+{
+    Change change{Change::REMOVE};
+    change.node = &node;
+    change.child = &child;
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::notifyChildOrderChanged(XML::Node &node, XML::Node &child, XML::Node * /*old_prev*/,
+                                         XML::Node *new_prev)
+{
+    Change change{Change::ORDER};
+    change.node = &node;
+    change.child = &child;
+    change.prev = new_prev;
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::notifyContentChanged(XML::Node &node, Util::ptr_shared /*old_content*/,
+                                      Util::ptr_shared new_content)
+{
+    Change change{Change::CONTENT};
+    change.node = &node;
+    if (new_content) {
+        change.value = new_content.pointer();
+    }
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::notifyAttributeChanged(XML::Node &node, GQuark name, Util::ptr_shared /*old_value*/,
+                                        Util::ptr_shared new_value)
+{
+    Change change{Change::ATTRIBUTE};
+    change.node = &node;
+    change.name = name;
+    if (new_value) {
+        change.value = new_value.pointer();
+    }
+    _changes.push_back(std::move(change));
+}
+
+void PageImport::replay(SPDocument &document, ReplayState &state)
+{
+    auto &xml_doc = *document.getReprDoc();
+    _nodes[_root] = document.getReprRoot();
+    _nodes[_defs] = document.getDefs()->getRepr();
+
+    for (auto const &change : _changes) {
+        switch (change.type) {
+            case Change::ADD:
+                _replayAdd(change, xml_doc, state);
+                break;
+            case Change::REMOVE:
+                if (auto child = _real(change.child); child && child->parent()) {
+                    Inkscape::GC::anchor(child);
+                    _detached.insert(child);
+                    child->parent()->removeChild(child);
+                }
+                break;
+            case Change::ORDER:
+                if (auto node = _real(change.node)) {
+                    node->changeOrder(_real(change.child), _real(change.prev));
+                }
+                break;
+            case Change::ATTRIBUTE:
+                if (auto node = _real(change.node)) {
+                    _setAttribute(*node, g_quark_to_string(change.name), change.value ? change.value->c_str() : nullptr);
+                }
+                break;
+            case Change::CONTENT:
+                if (auto node = _real(change.node)) {
+                    node->setContent(change.value ? change.value->c_str() : nullptr);
+                }
+                break;
+            case Change::METADATA:
+                rdf_set_work_entity(&document, rdf_find_entity(change.key.c_str()), change.value->c_str());
+                break;
+        }
+    }
+
+    if (_last_clip) {
+        state.prev_clip = _real(_last_clip);
+    }
+}
+
+void PageImport::_replayAdd(Change const &change, XML::Document &xml_doc, ReplayState &state)
+{
+    auto parent = _real(change.node);
+    if (!parent) {
+        return;
+    }
+
+    // Without pages, the first clip would be the last one of the page before if they're the same.
+    if (change.child == _first_clip && state.prev_clip) {
+        auto prev_path = state.prev_clip->firstChild();
+        auto path = change.snapshot->firstChild();
+        auto even_odd = [](XML::Node const *p) {
+            auto rule = p->attribute("clip-rule");
+            return rule && std::string_view(rule) == "evenodd";
+        };
+        if (prev_path && path && prev_path->attribute("d") && path->attribute("d") &&
+            std::string_view(prev_path->attribute("d")) == path->attribute("d") &&
+            even_odd(prev_path) == even_odd(path)) {
+            _nodes[change.child] = state.prev_clip;
+            if (change.subtree.size() > 1) {
+                _nodes[change.subtree[1]] = prev_path;
+            }
+            if (auto id = change.snapshot->attribute("id"); id && state.prev_clip->attribute("id")) {
+                _ids[id] = state.prev_clip->attribute("id");
+            }
+            return;
+        }
+    }
+
+    std::vector<std::pair<std::string, XML::Node *>> ids;
+    auto local = change.subtree.cbegin();
+    auto real = _materialize(*change.snapshot, local, xml_doc, ids);
+    if (change.at_end) {
+        parent->appendChild(real);
+    } else {
+        parent->addChild(real, _real(change.prev));
+    }
+    Inkscape::GC::release(real);
+
+    // The document gave the definitions their ids as they were added.
+    for (auto const &[placeholder, node] : ids) {
+        if (auto id = node->attribute("id")) {
+            _ids[placeholder] = id;
+        }
+    }
+}
+
+/**
+ * Make the real node for the @a snapshot of the node at @a local, and for its children.
+ *
+ * A node that is added again after being removed is the same node, brought up to date, just
+ * as it would be when parsing into the imported document.
+ *
+ * @return the node, with a reference for the caller to release once it's added.
+ */
+XML::Node *PageImport::_materialize(XML::Node const &snapshot, std::vector<XML::Node *>::const_iterator &local,
+                                    XML::Document &xml_doc, std::vector<std::pair<std::string, XML::Node *>> &ids)
+{
+    auto const original = *local++;
+
+    XML::Node *real = nullptr;
+    bool const reused = _nodes.count(original);
+    if (reused) {
+        real = _nodes[original];
+        if (!_detached.erase(real)) {
+            Inkscape::GC::anchor(real);
+        }
+        if (auto parent = real->parent()) {
+            parent->removeChild(real);
+        }
+        for (auto child = real->firstChild(); child;) {
+            auto next = child->next();
+            Inkscape::GC::anchor(child);
+            if (!_detached.insert(child).second) {
+                Inkscape::GC::release(child);
+            }
+            real->removeChild(child);
+            child = next;
+        }
+    } else if (snapshot.type() == XML::NodeType::ELEMENT_NODE) {
+        real = xml_doc.createElement(snapshot.name());
+    } else {
+        real = snapshot.duplicate(&xml_doc);
+    }
+    _nodes[original] = real;
+
+    if (snapshot.type() != XML::NodeType::ELEMENT_NODE) {
+        if (reused && g_strcmp0(real->content(), snapshot.content())) {
+            real->setContent(snapshot.content());
+        }
+        return real;
+    }
+
+    if (reused) {
+        std::vector<std::string> stale;
+        for (auto const &attr : real->attributeList()) {
+            auto name = g_quark_to_string(attr.key);
+            if (std::strcmp(name, "id") && !snapshot.attribute(name)) {
+                stale.emplace_back(name);
+            }
+        }
+        for (auto const &name : stale) {
+            real->removeAttribute(name);
+        }
+    }
+
+    for (auto const &attr : snapshot.attributeList()) {
+        auto name = g_quark_to_string(attr.key);
+        auto value = attr.value.pointer();
+        if (std::strcmp(name, "id") == 0 && is_placeholder(value)) {
+            if (_mask_ids.count(value)) {
+                // Masks in patterns have ids of their own, given in the order they're made.
+                auto [it, inserted] = _ids.try_emplace(value);
+                if (inserted) {
+                    it->second = SvgBuilder::nextMaskId();
+                }
+                if (g_strcmp0(real->attribute("id"), it->second.c_str())) {
+                    real->setAttribute("id", it->second);
+                }
+            } else if (reused) {
+                if (auto id = real->attribute("id")) {
+                    _ids[value] = id;
+                }
+            } else {
+                ids.emplace_back(value, real);
+            }
+            continue;
+        }
+        _setAttribute(*real, name, value);
+    }
+
+    for (auto child = snapshot.firstChild(); child; child = child->next()) {
+        auto real_child = _materialize(*child, local, xml_doc, ids);
+        real->appendChild(real_child);
+        Inkscape::GC::release(real_child);
+    }
+    return real;
+}
+
+void PageImport::_setAttribute(XML::Node &real, char const *name, char const *value)
+{
+    if (!value) {
+        real.removeAttribute(name);
+        return;
+    }
+    auto resolved = _resolve(name, value);
+    if (g_strcmp0(real.attribute(name), resolved.c_str())) {
+        real.setAttribute(name, resolved);
+    }
+}
+
+XML::Node *PageImport::_real(XML::Node const *node) const
+{
+    if (!node) {
+        return nullptr;
+    }
+    auto it = _nodes.find(node);
+    return it != _nodes.end() ? it->second : nullptr;
+}
+
+/**
+ * The value of the attribute @a name with the placeholders replaced by the ids of the definitions.
+ */
+std::string PageImport::_resolve(char const *name, char const *value) const
+{
+    std::string resolved = value;
+    if (!is_reference_attribute(name)) {
+        return resolved;
+    }
+    // Back to front, so that the positions stay valid.
+    std::vector<std::pair<std::size_t, std::string>> found;
+    for_each_placeholder(resolved, [&](auto pos, auto id) { found.emplace_back(pos, id); });
+    for (auto it = found.rbegin(); it != found.rend(); ++it) {
+        if (auto id = _ids.find(it->second); id != _ids.end()) {
+            resolved.replace(it->first, it->second.size(), id->second);
+        }
+    }
+    return resolved;
+}
+
+} // namespace Inkscape::Extension::Internal
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
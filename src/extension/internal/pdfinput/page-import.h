@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Parsing the pages of a PDF on worker threads.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_EXTENSION_INTERNAL_PDFINPUT_PAGE_IMPORT_H
+#define SEEN_EXTENSION_INTERNAL_PDFINPUT_PAGE_IMPORT_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <2geom/rect.h>
+
+#include "poppler-utils.h"
+#include "xml/node-observer.h"
+
+class SPDocument;
+
+namespace Inkscape {
+namespace XML {
+struct Document;
+class Node;
+} // namespace XML
+
+namespace Extension::Internal {
+
+class PageImport;
+
+/**
+ * What the pages parsed on worker threads share, and the means for them to do what can only be
+ * done on the main thread.
+ */
+class PageImportContext
+{
+public:
+    explicit PageImportContext(int workers);
+    ~PageImportContext();
+
+    /// On a worker, run @a func on the main thread and return once it has run.
+    void runOnMainThread(std::function<void()> const &func);
+    /// On a worker, report that it won't make any more calls, whether it succeeded or not.
+    void workerFinished();
+    /// On the main thread, run the calls of the workers until they have all finished.
+    void serve();
+
+    /// The font data for text in @a font, looked up once per font of the PDF.
+    std::shared_ptr<FontLookup const> fontLookup(FontPtr const &font);
+    /// The visual bounds of @a node of @a page, as SPItem::visualBounds() gives them.
+    Geom::OptRect visualBounds(PageImport const &page, XML::Node const &node);
+
+private:
+    Geom::OptRect _visualBounds(PageImport const &page, XML::Node const &node);
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    struct Call
+    {
+        std::function<void()> const *func;
+        std::exception_ptr error;
+        bool done = false;
+    };
+    std::deque<Call *> _calls;
+    int _workers;
+
+    std::map<std::pair<int, int>, std::shared_ptr<FontLookup const>> _fonts;
+
+    // For measuring the items of pages, only used on the main thread.
+    std::unique_ptr<SPDocument> _scratch;
+};
+
+/**
+ * A page parsed on a worker thread, into an XML document of its own.
+ *
+ * What the SvgBuilder does to that document is recorded, and replayed onto the imported
+ * document on the main thread, in page order. The imported document gives ids to the elements
+ * as they are added, so replaying the changes in the same order gives the same SVG as parsing
+ * the pages one after another into that document. The builder refers to definitions by
+ * placeholder ids until then.
+ */
+class PageImport : public XML::NodeObserver
+{
+public:
+    /// State carried from one page to the next while replaying.
+    struct ReplayState
+    {
+        XML::Node *prev_clip = nullptr;
+    };
+
+    explicit PageImport(PageImportContext &context);
+    ~PageImport() override;
+    PageImport(PageImport const &) = delete;
+    PageImport &operator=(PageImport const &) = delete;
+
+    PageImportContext &context() { return _context; }
+    XML::Document *xmlDoc() const { return _xml_doc; }
+    XML::Node *root() const { return _root; }
+    XML::Node *defs() const { return _defs; }
+
+    /// Append @a def to the definitions, with a placeholder id; one of the "_mask" ids if @a mask_id.
+    void addDefinition(XML::Node *def, bool mask_id = false);
+    /// The definition with the placeholder @a id, if it's still part of the page.
+    XML::Node *getDefinition(std::string const &id) const;
+    /// The definitions that @a node, its ancestors and its descendants refer to, and so on.
+    std::vector<XML::Node const *> references(XML::Node const &node) const;
+    void setMetadata(char const *name, std::string const &content);
+
+    /// The first clip path of the page, which may be one of the previous page instead.
+    void setFirstClip(XML::Node *clip) { _first_clip = clip; }
+    /// The clip path that the next page compares its first one with.
+    void setLastClip(XML::Node *clip) { _last_clip = clip; }
+
+    /// Set if the page depends on the pages before it, so it can't be parsed on its own.
+    void setDependent() { _dependent = true; }
+    bool isDependent() const { return _dependent; }
+    /// Set if the page leaves state behind for the next page.
+    void setLeavesState() { _leaves_state = true; }
+    bool leavesState() const { return _leaves_state; }
+
+    /// Apply the recorded changes to @a document, on the main thread.
+    void replay(SPDocument &document, ReplayState &state);
+
+    // XML::NodeObserver
+    void notifyChildAdded(XML::Node &node, XML::Node &child, XML::Node *prev) override;
+    void notifyChildRemoved(XML::Node &node, XML::Node &child, XML::Node *prev) override;
+    void notifyChildOrderChanged(XML::Node &node, XML::Node &child, XML::Node *old_prev,
+                                 XML::Node *new_prev) override;
+    void notifyContentChanged(XML::Node &node, Util::ptr_shared old_content, Util::ptr_shared new_content) override;
+    void notifyAttributeChanged(XML::Node &node, GQuark name, Util::ptr_shared old_value,
+                                Util::ptr_shared new_value) override;
+
+private:
+    struct Change
+    {
+        enum Type { ADD, REMOVE, ORDER, ATTRIBUTE, CONTENT, METADATA } type;
+        XML::Node *node = nullptr; ///< The parent for ADD, REMOVE and ORDER.
+        XML::Node *child = nullptr;
+        XML::Node *prev = nullptr;
+        bool at_end = false;
+        XML::Node *snapshot = nullptr;    ///< ADD: a copy of the child as it was added.
+        std::vector<XML::Node *> subtree; ///< ADD: the nodes the snapshot copies, in document order.
+        GQuark name = 0;
+        std::string key;
+        std::optional<std::string> value;
+    };
+
+    void _replayAdd(Change const &change, XML::Document &xml_doc, ReplayState &state);
+    XML::Node *_materialize(XML::Node const &snapshot, std::vector<XML::Node *>::const_iterator &local,
+                            XML::Document &xml_doc, std::vector<std::pair<std::string, XML::Node *>> &ids);
+    void _setAttribute(XML::Node &real, char const *name, char const *value);
+    XML::Node *_real(XML::Node const *node) const;
+    std::string _resolve(char const *name, char const *value) const;
+
+    PageImportContext &_context;
+    XML::Document *_xml_doc;
+    XML::Node *_root;
+    XML::Node *_defs;
+    std::vector<Change> _changes;
+
+    int _next_id = 0;
+    std::unordered_map<std::string, XML::Node *> _definitions;
+    std::set<std::string> _mask_ids;
+    std::vector<XML::Node *> _kept; ///< Nodes the changes refer to, anchored until destruction.
+
+    XML::Node *_first_clip = nullptr;
+    XML::Node *_last_clip = nullptr;
+    bool _dependent = false;
+    bool _leaves_state = false;
+
+    // Filled in while replaying
+    std::unordered_map<XML::Node const *, XML::Node *> _nodes;
+    std::unordered_map<std::string, std::string> _ids;
+    std::set<XML::Node *> _detached; ///< Anchored real nodes that the page removed, and may add again.
+};
+
+} // namespace Extension::Internal
+} // namespace Inkscape
+
+#endif // SEEN_EXTENSION_INTERNAL_PDFINPUT_PAGE_IMPORT_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
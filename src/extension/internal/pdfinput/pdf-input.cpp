@@ -51,15 +51,21 @@
 #include <gtkmm/liststore.h>
 #include <gtkmm/notebook.h>
 #include <gtkmm/scale.h>
+#include <atomic>
+#include <future>
 #include <utility>
 
 #include "async/async.h"
 #include "document-undo.h"
+#include "display/dispatch-pool.h"
+#include "display/threading.h"
 #include "document.h"
 #include "extension/input.h"
 #include "extension/system.h"
+#include "inkgc/gc-core.h"
 #include "inkscape.h"
 #include "object/sp-root.h"
+#include "page-import.h"
 #include "pdf-parser.h"
 #include "preferences.h"
 #include "ui/builder-utils.h"
@@ -68,6 +74,7 @@
 #include "ui/pack.h"
 #include "util/gobjectptr.h"
 #include "util/parse-int-range.h"
+#include "util/scope_exit.h"
 #include "util/units.h"
 
 using namespace Inkscape::UI;
@@ -709,25 +716,40 @@ std::unique_ptr<SPDocument> PdfInput::open(Input *mod, char const *uri, bool)
         if (dot) {
             *dot = 0;
         }
-        SvgBuilder *builder = new SvgBuilder(doc.get(), docname, pdf_doc->getXRef());
-        builder->setFontStrategies(font_strats);
-        builder->setPageMode(import_pages);
-
-        // Get preferences
-        builder->setPageMode(mod->get_param_bool("importPages", true));
-        builder->setEmbedImages(mod->get_param_bool("embedImages", true));
-        builder->setConvertColors(dlg ? mod->get_param_bool("convertColors", true) : convert_colors);
-        builder->setGroupBy(dlg ? mod->get_param_optiongroup("groupBy") : group_by);
+        // Get preferences, once, as the builders of the pages may be set up on other threads.
+        bool const page_mode = mod->get_param_bool("importPages", true);
+        bool const embed_images = mod->get_param_bool("embedImages", true);
+        bool const builder_convert_colors = dlg ? mod->get_param_bool("convertColors", true) : convert_colors;
+        std::string const builder_group_by = dlg ? mod->get_param_optiongroup("groupBy") : group_by;
         std::string crop_to = mod->get_param_optiongroup("clipTo", "none");
         
         double color_delta = mod->get_param_float("approximationPrecision", 2.0);
 
-        for (auto p : pages) {
-            // And then add each of the pages
-            add_builder_page(pdf_doc, builder, doc.get(), p, crop_to, color_delta);
+        auto const setup = [&](SvgBuilder &builder) {
+            builder.setFontStrategies(font_strats);
+            builder.setPageMode(import_pages);
+            builder.setPageMode(page_mode);
+            builder.setEmbedImages(embed_images);
+            builder.setConvertColors(builder_convert_colors);
+            builder.setGroupBy(builder_group_by);
+        };
+
+        // Images written next to the document are numbered in the order they're made, and
+        // colors kept in their own color space are attached to the document as they're met.
+        bool const independent_pages = embed_images && builder_convert_colors;
+
+        if (!independent_pages ||
+            !add_builder_pages(pdf_doc, uri, doc.get(), docname, pages, setup, crop_to, color_delta)) {
+            SvgBuilder *builder = new SvgBuilder(doc.get(), docname, pdf_doc->getXRef());
+            setup(*builder);
+
+            for (auto p : pages) {
+                // And then add each of the pages
+                add_builder_page(pdf_doc, builder, doc.get(), p, crop_to, color_delta);
+            }
+
+            delete builder;
         }
-
-        delete builder;
         g_free(docname);
 #ifdef HAVE_POPPLER_CAIRO
     } else if (import_method == PdfImportType::PDF_IMPORT_CAIRO) {
@@ -858,6 +880,90 @@ PdfInput::add_builder_page(std::shared_ptr<PDFDoc>pdf_doc, SvgBuilder *builder,
             pdf_parser.build_annots(annots.arrayGet(i), page_num);
         }
     }
+
+    builder->flushImages();
+}
+
+/**
+ * Parse the pages on worker threads, each into a document of its own, and replay them into @a doc
+ * in page order, giving the same document as parsing them one after another.
+ *
+ * @return false, leaving @a doc as it was, when the pages can't be parsed on their own.
+ */
+bool PdfInput::add_builder_pages(std::shared_ptr<PDFDoc> pdf_doc, char const *uri, SPDocument *doc, gchar *docname,
+                                 std::set<unsigned> const &pages, std::function<void(SvgBuilder &)> const &setup,
+                                 std::string const &crop_to, double color_delta)
+{
+    int const threads = std::min<int>(get_global_dispatch_pool()->size(), pages.size());
+    if (threads < 2 || pdf_doc->getOptContentConfig()) {
+        // Layers are shared between the pages.
+        return false;
+    }
+
+    // Where each page goes, as the pages before it would leave the builder.
+    struct PageJob
+    {
+        int page_num;
+        int pages_before;
+        double left;
+        std::unique_ptr<PageImport> result;
+    };
+    std::vector<PageJob> jobs;
+    Catalog *catalog = pdf_doc->getCatalog();
+    int pages_before = 0;
+    double left = 0;
+    for (int page_num : pages) {
+        jobs.push_back({page_num, pages_before, left});
+        sanitize_page_number(page_num, catalog->getNumPages());
+        if (auto page = catalog->getPage(page_num)) {
+            if (auto width = PdfParser::getPageWidth(page)) {
+                int gap = 20;
+                left += width + gap;
+            }
+            pages_before++;
+        }
+    }
+
+    PageImportContext context(threads);
+    std::atomic<std::size_t> next_job = 0;
+    std::vector<std::future<void>> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::async(std::launch::async, [&] {
+            auto finished = scope_exit([&] { context.workerFinished(); });
+            Inkscape::GC::register_thread();
+
+            // Poppler documents can't be shared between threads.
+            auto worker_doc = _POPPLER_MAKE_SHARED_PDFDOC(uri);
+            for (auto index = next_job++; index < jobs.size(); index = next_job++) {
+                auto &job = jobs[index];
+                auto page = std::make_unique<PageImport>(context);
+                {
+                    SvgBuilder builder(*page, docname, worker_doc->getXRef());
+                    setup(builder);
+                    builder.setPagePosition(job.pages_before, job.left);
+                    add_builder_page(worker_doc, &builder, nullptr, job.page_num, crop_to, color_delta);
+                    builder.finishPage();
+                }
+                job.result = std::move(page);
+            }
+        }));
+    }
+    context.serve();
+    for (auto &worker : workers) {
+        worker.get();
+    }
+
+    for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->result->isDependent() || (it->result->leavesState() && std::next(it) != jobs.end())) {
+            return false;
+        }
+    }
+
+    PageImport::ReplayState state;
+    for (auto &job : jobs) {
+        job.result->replay(*doc, state);
+    }
+    return true;
 }
 
 #include "../clear-n_.h"
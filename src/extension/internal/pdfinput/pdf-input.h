@@ -17,6 +17,8 @@
 
 #include <glibmm/refptr.h>
 #include <gtkmm/dialog.h>
+#include <functional>
+#include <set>
 #include <unordered_map>
 
 #include "extension/implementation/implementation.h"
@@ -178,6 +180,9 @@ private:
         int page_num,
         std::string const &crop_to,
         double color_delta);
+    bool add_builder_pages(std::shared_ptr<PDFDoc> pdf_doc, char const *uri, SPDocument *doc, gchar *docname,
+                           std::set<unsigned> const &pages, std::function<void(SvgBuilder &)> const &setup,
+                           std::string const &crop_to, double color_delta);
 };
 
 } // namespace Inkscape::Extension::Internal
@@ -298,8 +298,7 @@ PdfParser::PdfParser(std::shared_ptr<PDFDoc> pdf_doc, Inkscape::Extension::Inter
 
     // Set margins, bleeds and page-cropping
     auto page_box = getRect(page->getCropBox());
-    auto scale = Geom::Scale(state->getPageWidth() / page_box.width(),
-                             state->getPageHeight() / page_box.height());
+    auto scale = pageScale(page, state);
     builder->setMargins(getRect(page->getTrimBox()) * scale,
                         getRect(page->getArtBox()) * scale,
                         getRect(page->getMediaBox()) * scale);
@@ -323,6 +322,22 @@ PdfParser::PdfParser(std::shared_ptr<PDFDoc> pdf_doc, Inkscape::Extension::Inter
     pushOperator("startPage");
 }
 
+/**
+ * The scale from PDF units to px, for the page in its initial state.
+ */
+Geom::Scale PdfParser::pageScale(Page *page, GfxState *state)
+{
+    auto page_box = getRect(page->getCropBox());
+    return Geom::Scale(state->getPageWidth() / page_box.width(), state->getPageHeight() / page_box.height());
+}
+
+double PdfParser::getPageWidth(Page *page)
+{
+    // The builder ends up with the size of the trim box, see setMargins().
+    GfxState state(96.0, 96.0, page->getCropBox(), page->getRotate(), true);
+    return (getRect(page->getTrimBox()) * pageScale(page, &state)).width();
+}
+
 PdfParser::PdfParser(XRef *xrefA, Inkscape::Extension::Internal::SvgBuilder *builderA, Dict *resDict,
                      _POPPLER_CONST PDFRectangle *box)
     : xref(xrefA)
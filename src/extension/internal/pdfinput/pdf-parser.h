@@ -25,6 +25,7 @@
 #endif
 
 #include <2geom/affine.h>
+#include <2geom/transforms.h>
 #include <glib/poppler-features.h>
 #include <map>
 #include <memory>
@@ -145,7 +146,12 @@ public:
     // Build all annotations provided in layer annotation - page_num
     void build_annots(const Object &annot, int page_num);
 
+    // The width in px that the page takes up in the document.
+    static double getPageWidth(Page *page);
+
 private:
+    static Geom::Scale pageScale(Page *page, GfxState *state);
+
     std::shared_ptr<PDFDoc> _pdf_doc;
     std::shared_ptr<CairoFontEngine> _font_engine;
 
@@ -227,6 +227,10 @@ double CairoFont::getSubstitutionCorrection(GfxFont *gfxFont)
 
 static cairo_user_data_key_t ft_cairo_key;
 
+// Serializes the use of the shared FT_Library and of the faces in fontFileCache, as pages may be
+// imported on several threads. Recursive, because faces can be released while loading a font.
+static std::recursive_mutex ft_mutex;
+
 // Font resources to be freed when cairo_font_face_t is destroyed
 struct FreeTypeFontResource
 {
@@ -239,6 +243,7 @@ static void _ft_done_face(void *closure)
 {
     FreeTypeFontResource *resource = (FreeTypeFontResource *)closure;
 
+    std::scoped_lock lock(ft_mutex);
     FT_Done_Face(resource->face);
     delete resource;
 }
@@ -772,6 +777,7 @@ std::shared_ptr<CairoFont> CairoFontEngine::getFont(GfxFont *gfxFont, PDFDoc *do
     if (fontType == fontType3) {
         font = std::shared_ptr<CairoFont>(CairoType3Font::create(gfxFont, doc, this, printing, xref));
     } else {
+        std::scoped_lock ft_lock(ft_mutex);
         font = std::shared_ptr<CairoFont>(CairoFreeTypeFont::create(gfxFont, xref, lib, this, useCIDs));
     }
 
@@ -486,6 +486,12 @@ std::string FontData::getSpecification() const
     }
 }
 
+FontLookup::FontLookup(FontPtr font)
+    : data(font)
+    , specification(data.getSpecification())
+    , substitute(data.getSubstitute())
+{}
+
 //------------------------------------------------------------------------
 // scanFonts from FontInfo.cc
 //------------------------------------------------------------------------
@@ -78,6 +78,18 @@ private:
     void _parseStyle();
 };
 
+/**
+ * The font data of a font, along with what is looked up from the installed fonts for it.
+ */
+struct FontLookup
+{
+    explicit FontLookup(FontPtr font);
+
+    FontData data;
+    std::string specification;
+    std::string substitute;
+};
+
 typedef std::shared_ptr<std::map<FontPtr, FontData>> FontList;
 
 FontList getPdfFonts(std::shared_ptr<PDFDoc> pdf_doc);
@@ -20,7 +20,10 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <vector>
 #include <locale>
 #include <codecvt>
 
@@ -37,6 +40,7 @@
 #endif
 
 #include "document.h"
+#include "page-import.h"
 #include "pdf-parser.h"
 #include "pdf-utils.h"
 #include <png.h>
@@ -48,7 +52,9 @@
 #include "colors/manager.h"
 #include "colors/spaces/cms.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/nr-filter-utils.h"
+#include "display/threading.h"
 #include "object/color-profile.h"
 #include "object/sp-defs.h"
 #include "object/sp-namedview.h"
@@ -104,21 +110,43 @@ SvgBuilder::SvgBuilder(SPDocument *document, gchar *docname, XRef *xref)
     _xref = xref;
     _xml_doc = _doc->getReprDoc();
     _container = _root = _doc->getReprRoot();
+    _pending_images = std::make_shared<PendingImages>();
+    _init();
+}
+
+/**
+ * Build a page into an XML document of its own, for parsing it on a worker thread.
+ */
+SvgBuilder::SvgBuilder(PageImport &page, gchar *docname, XRef *xref)
+{
+    _is_top_level = true;
+    _doc = nullptr;
+    _page_import = &page;
+    _docname = docname;
+    _xref = xref;
+    _xml_doc = page.xmlDoc();
+    _container = _root = page.root();
+    _pending_images = std::make_shared<PendingImages>();
     _init();
 }
 
 SvgBuilder::SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root) {
     _is_top_level = false;
     _doc = parent->_doc;
+    _page_import = parent->_page_import;
     _docname = parent->_docname;
     _xref = parent->_xref;
     _xml_doc = parent->_xml_doc;
     _container = this->_root = root;
+    _pending_images = parent->_pending_images;
     _init();
 }
 
 SvgBuilder::~SvgBuilder()
 {
+    if (_is_top_level) {
+        flushImages();
+    }
     if (_clip_history) {
         delete _clip_history;
         _clip_history = nullptr;
@@ -136,6 +164,70 @@ void SvgBuilder::_init() {
     _node_stack.push_back(_container);
 }
 
+void SvgBuilder::_addToDefs(Inkscape::XML::Node *node, bool mask_id)
+{
+    if (_page_import) {
+        _page_import->addDefinition(node, mask_id);
+    } else {
+        _doc->getDefs()->getRepr()->appendChild(node);
+    }
+}
+
+Inkscape::XML::Node *SvgBuilder::_getDefinition(std::string const &id)
+{
+    if (_page_import) {
+        return _page_import->getDefinition(id);
+    }
+    auto obj = _doc->getObjectById(id);
+    return obj ? obj->getRepr() : nullptr;
+}
+
+/**
+ * The visual bounds of the item for the node, if it's part of the document.
+ */
+Geom::OptRect SvgBuilder::_visualBounds(Inkscape::XML::Node const *node) const
+{
+    if (_page_import) {
+        return _page_import->context().visualBounds(*_page_import, *node);
+    }
+    _doc->ensureUpToDate();
+    auto item = cast<SPItem>(_doc->getObjectByRepr(const_cast<Inkscape::XML::Node *>(node)));
+    return item ? item->visualBounds() : Geom::OptRect();
+}
+
+/**
+ * The id for the next mask made by a builder that isn't the top-level one.
+ */
+std::string SvgBuilder::nextMaskId()
+{
+    static int mask_count = 0;
+    return "_mask" + std::to_string(mask_count++);
+}
+
+/**
+ * Start the page after the given number of pages, that take up the space left of it.
+ */
+void SvgBuilder::setPagePosition(int pages, double left)
+{
+    _page_num = pages;
+    _page_left = left;
+}
+
+/**
+ * Done with the page parsed on its own; note what the next page would have carried over.
+ */
+void SvgBuilder::finishPage()
+{
+    if (!_page_import) {
+        return;
+    }
+    _page_import->setLastClip(_prev_clip);
+    if (_clip_history->hasClipPath() || _clip_text || _clip_text_group || _clip_groups || !_mask_groups.empty() ||
+        !_alpha_objs.empty() || _group_alpha != 1.0 || _in_text_object || !_glyphs.empty() || !_aria_label.empty()) {
+        _page_import->setLeavesState();
+    }
+}
+
 /**
  * We're creating a multi-page document, push page number.
  */
@@ -150,6 +242,17 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
     _page_num += 1;
     _page_offset = true;
 
+    // Each page starts with the initial text state, as the text operators of its content expect.
+    if (_css_font) {
+        sp_repr_css_attr_unref(_css_font);
+        _css_font = nullptr;
+    }
+    _cairo_font = nullptr;
+    _font_specification.clear();
+    _css_font_size = 1.0;
+    _invalidated_style = true;
+    _invalidated_strategy = false;
+
     if (_page) {
         Inkscape::GC::release(_page);
     }
@@ -160,7 +263,7 @@ void SvgBuilder::pushPage(const std::string &label, GfxState *state)
         if (!label.empty()) {
             _page->setAttribute("inkscape:label", validateString(label));
         }
-        _doc->getDefs()->getRepr()->appendChild(_page);
+        _addToDefs(_page);
     }
 
     // Page translation is somehow lost in the way we're using poppler and the state management
@@ -269,7 +372,11 @@ void SvgBuilder::setMargins(const Geom::Rect &page, const Geom::Rect &margins, c
 void SvgBuilder::setMetadata(char const *name, const std::string &content)
 {
     if (name && !content.empty()) {
-        rdf_set_work_entity(_doc, rdf_find_entity(name), validateString(content).c_str());
+        if (_page_import) {
+            _page_import->setMetadata(name, validateString(content));
+        } else {
+            rdf_set_work_entity(_doc, rdf_find_entity(name), validateString(content).c_str());
+        }
     }
 }
 
@@ -920,11 +1027,8 @@ Geom::PathVector SvgBuilder::_checkClip(const Inkscape::XML::Node *node, const G
     if (node_vec.empty()) {
         // Non-path node (text, image, etc)
         // Create a PathVector of the bounding box instead
-        _doc->ensureUpToDate();
-        auto item = cast<SPItem>(_doc->getObjectByRepr(const_cast<Inkscape::XML::Node *>(node)));
         // transform will be applied later, so default identity is good
-        Geom::OptRect bounds;
-        bounds = item ? item->visualBounds() : bounds;
+        auto bounds = _visualBounds(node);
 
         if (!bounds.empty()) {
             node_vec.push_back(Geom::Path(*bounds));
@@ -974,9 +1078,13 @@ Inkscape::XML::Node *SvgBuilder::_createClip(const std::string &d, bool even_odd
     Inkscape::GC::release(path);
 
     // Append clipPath to defs and get id
-    _doc->getDefs()->getRepr()->appendChild(clip_path);
+    _addToDefs(clip_path);
     Inkscape::GC::release(clip_path);
 
+    if (_page_import && _is_top_level && !_prev_clip) {
+        _page_import->setFirstClip(clip_path);
+    }
+
     // update the previous clip path
     _prev_clip = clip_path;
 
@@ -987,7 +1095,11 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
 {
     if (name && group && std::string(name) == "OC") {
         auto layer_id = std::string("layer-") + sanitizeId(group);
-        if (auto existing = _doc->getObjectById(layer_id)) {
+        if (_page_import) {
+            // The layer may be one of another page.
+            _page_import->setDependent();
+        }
+        if (auto existing = _doc ? _doc->getObjectById(layer_id) : nullptr) {
             if (existing->getRepr()->parent() == _container) {
                 _container = existing->getRepr();
                 _node_stack.push_back(_container);
@@ -1017,6 +1129,10 @@ void SvgBuilder::beginMarkedContent(const char *name, const char *group)
 
 void SvgBuilder::addOptionalGroup(const std::string &oc, const std::string &label, bool visible)
 {
+    if (_page_import) {
+        // Layers are shared between the pages.
+        _page_import->setDependent();
+    }
     _ocgs[oc] = {label, visible};
 }
 
@@ -1173,7 +1289,7 @@ gchar *SvgBuilder::_createTilingPattern(GfxTilingPattern *tiling_pattern,
     delete pattern_builder;
 
     // Append the pattern to defs
-    _doc->getDefs()->getRepr()->appendChild(pattern_node);
+    _addToDefs(pattern_node);
     gchar *id = g_strdup(pattern_node->attribute("id"));
     Inkscape::GC::release(pattern_node);
 
@@ -1239,7 +1355,7 @@ gchar *SvgBuilder::_createGradient(GfxState *state, GfxShading *shading, const G
         return nullptr;
     }
 
-    _doc->getDefs()->getRepr()->appendChild(gradient);
+    _addToDefs(gradient);
     gchar *id = g_strdup(gradient->attribute("id"));
     Inkscape::GC::release(gradient);
 
@@ -1404,8 +1520,11 @@ void SvgBuilder::updateFont(GfxState *state, std::shared_ptr<CairoFont> cairo_fo
         return;
     }
 
-    auto font_data = FontData(font);
-    auto new_font_specification = font_data.getSpecification();
+    // Looked up once per font when parsing pages on their own, as that needs the main thread.
+    auto const lookup =
+        _page_import ? _page_import->context().fontLookup(font) : std::make_shared<FontLookup const>(font);
+    auto const &font_data = lookup->data;
+    auto const &new_font_specification = lookup->specification;
     TRACE(("FontSpecification: %s\n", new_font_specification.c_str()));
     if (_font_specification != new_font_specification) {
         // If any font property changes, we need a new <tspan> or <path>.
@@ -1421,7 +1540,7 @@ void SvgBuilder::updateFont(GfxState *state, std::shared_ptr<CairoFont> cairo_fo
     if (font_data.found) {
         sp_repr_css_set_property(_css_font, "font-family", font_data.family.c_str());
     } else if (font_strategy == FontFallback::AS_SUB) {
-        sp_repr_css_set_property(_css_font, "font-family", font_data.getSubstitute().c_str());
+        sp_repr_css_set_property(_css_font, "font-family", lookup->substitute.c_str());
     } else {
         auto keep_name = font_data.family.size() ? font_data.family : font_data.name;
         sp_repr_css_set_property(_css_font, "font-family", keep_name.c_str());
@@ -1765,10 +1884,9 @@ void SvgBuilder::_flushText(GfxState *state)
 
     // Set up a clipPath group (if required).
     if (state->getRender() & 4 && !_clip_text_group) {
-        auto defs = _doc->getDefs()->getRepr();
         _clip_text_group = _pushContainer("svg:clipPath");
         _clip_text_group->setAttribute("clipPathUnits", "userSpaceOnUse");
-        defs->appendChild(_clip_text_group);
+        _addToDefs(_clip_text_group);
         Inkscape::GC::release(_clip_text_group);
     }
 
@@ -1944,7 +2062,7 @@ void SvgBuilder::addChar(GfxState *state,
     _aria_space = false;
 
     std::string utf8_code;
-    static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
+    static thread_local std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv1;
     // Note std::wstring_convert and std::codecvt_utf are deprecated and will be removed in C++26.
     if (u) {
         // 'u' maybe null if there is not a "ToUnicode" table in the PDF!
@@ -2055,47 +2173,38 @@ void png_write_vector(png_structp png_ptr, png_bytep data, png_size_t length)
     }
 }
 
+// Decoded pixels of embedded images that may wait for encoding before flushImages() is forced
+static constexpr std::size_t MAX_PENDING_IMAGE_BYTES = std::size_t{64} << 20;
+
 /**
- * \brief Creates an <image> element containing the given ImageStream as a PNG
+ * \brief Writes pixels decoded by SvgBuilder::_createImage as PNG, either into a buffer or to a file
  *
+ * \param pixels  one byte of gray per pixel if alpha_only, otherwise one BGRA word per pixel
  */
-Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height,
-                                              GfxImageColorMap *color_map, bool interpolate,
-                                              int *mask_colors, bool alpha_only,
-                                              bool invert_alpha) {
-
+static bool write_png(std::vector<guchar> *buffer, FILE *fp, unsigned char const *pixels, int width, int height,
+                      bool alpha_only, bool invert_alpha)
+{
     // Create PNG write struct
     png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     if ( png_ptr == nullptr ) {
-        return nullptr;
+        return false;
     }
     // Create PNG info struct
     png_infop info_ptr = png_create_info_struct(png_ptr);
     if ( info_ptr == nullptr ) {
         png_destroy_write_struct(&png_ptr, nullptr);
-        return nullptr;
+        return false;
     }
     // Set error handler
     if (setjmp(png_jmpbuf(png_ptr))) {
         png_destroy_write_struct(&png_ptr, &info_ptr);
-        return nullptr;
+        return false;
     }
 
     // Set read/write functions
-    std::vector<guchar> png_buffer;
-    FILE *fp = nullptr;
-    gchar *file_name = nullptr;
-    if (_embed_images) {
-        png_set_write_fn(png_ptr, &png_buffer, png_write_vector, nullptr);
+    if (buffer) {
+        png_set_write_fn(png_ptr, buffer, png_write_vector, nullptr);
     } else {
-        static int counter = 0;
-        file_name = g_strdup_printf("%s_img%d.png", _docname, counter++);
-        fp = fopen(file_name, "wb");
-        if ( fp == nullptr ) {
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            g_free(file_name);
-            return nullptr;
-        }
         png_init_io(png_ptr, fp);
     }
 
@@ -2137,7 +2246,25 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     // Write the file header
     png_write_info(png_ptr, info_ptr);
 
-    // Convert pixels
+    std::size_t const stride = alpha_only ? width : std::size_t(width) * 4;
+    for ( int y = 0 ; y < height ; y++ ) {
+        png_write_row(png_ptr, const_cast<png_bytep>(pixels + y * stride));
+    }
+
+    // Close PNG
+    png_write_end(png_ptr, info_ptr);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    return true;
+}
+
+/**
+ * \brief Decodes an image stream into pixels as expected by write_png()
+ */
+static bool decode_image(Stream *str, int width, int height, GfxImageColorMap *color_map, int *mask_colors,
+                         bool alpha_only, bool invert_alpha, std::vector<unsigned char> &pixels)
+{
+    std::size_t const stride = alpha_only ? width : std::size_t(width) * 4;
+    pixels.resize(stride * height);
     ImageStream *image_stream;
     if (alpha_only) {
         if (color_map) {
@@ -2150,23 +2277,18 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
         if(!image_stream->rewind())
         {
             g_warning("ImageStream: Failed to rewind image stream");
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            if (!_embed_images) {
-                fclose(fp);
-                g_free(file_name);
-            }
             delete image_stream;
-            return nullptr;
+            return false;
         }
 #else
         image_stream->reset();
 #endif
 
         // Convert grayscale values
-        unsigned char *buffer = new unsigned char[width];
         int invert_bit = invert_alpha ? 1 : 0;
         for ( int y = 0 ; y < height ; y++ ) {
             unsigned char *row = image_stream->getLine();
+            unsigned char *buffer = pixels.data() + y * stride;
             if (color_map) {
                 color_map->getGrayLine(row, buffer, width);
             } else {
@@ -2179,10 +2301,8 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
                     }
                 }
             }
-            png_write_row(png_ptr, (png_bytep)buffer);
         }
-        delete [] buffer;
-    } else if (color_map) {
+    } else {
         image_stream = new ImageStream(str, width,
                                        color_map->getNumPixelComps(),
                                        color_map->getBits());
@@ -2190,23 +2310,18 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
         if(!image_stream->rewind())
         {
             g_warning("ImageStream: Failed to rewind image stream");
-            png_destroy_write_struct(&png_ptr, &info_ptr);
-            if (!_embed_images) {
-                fclose(fp);
-                g_free(file_name);
-            }
             delete image_stream;
-            return nullptr;
+            return false;
         }
 #else
         image_stream->reset();
 #endif
 
         // Convert RGB values
-        unsigned int *buffer = new unsigned int[width];
         if (mask_colors) {
             for ( int y = 0 ; y < height ; y++ ) {
                 unsigned char *row = image_stream->getLine();
+                auto buffer = reinterpret_cast<unsigned int *>(pixels.data() + y * stride);
                 color_map->getRGBLine(row, buffer, width);
 
                 unsigned int *dest = buffer;
@@ -2223,32 +2338,215 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
                     row += color_map->getNumPixelComps();
                     dest++;
                 }
-                // Write it to the PNG
-                png_write_row(png_ptr, (png_bytep)buffer);
             }
         } else {
             for ( int i = 0 ; i < height ; i++ ) {
                 unsigned char *row = image_stream->getLine();
+                auto buffer = reinterpret_cast<unsigned int *>(pixels.data() + i * stride);
                 memset((void*)buffer, 0xff, sizeof(int) * width);
                 color_map->getRGBLine(row, buffer, width);
-                png_write_row(png_ptr, (png_bytep)buffer);
             }
         }
-        delete [] buffer;
+    }
+    delete image_stream;
+    str->close();
+    return true;
+}
 
-    } else {    // A colormap must be provided, so quit
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        if (!_embed_images) {
-            fclose(fp);
-            g_free(file_name);
+/**
+ * The ColorTransform entry of the decode parameters of the DCT filter of @a str, if it has one.
+ */
+static std::optional<int> get_dct_color_transform(Stream *str)
+{
+    auto const dict = str->getDict();
+    if (!dict) {
+        return {};
+    }
+    // Inline images use abbreviated keys
+    auto lookup = [dict](char const *key, char const *abbreviation) {
+        auto obj = dict->lookup(key);
+        if (obj.isNull()) {
+            obj = dict->lookup(abbreviation);
+        }
+        return obj;
+    };
+    auto is_dct = [](Object const &filter) { return filter.isName("DCTDecode") || filter.isName("DCT"); };
+
+    Object filter = lookup("Filter", "F");
+    Object params = lookup("DecodeParms", "DP");
+    Object dct_params;
+    if (filter.isArray()) {
+        for (int i = 0; i < filter.arrayGetLength(); i++) {
+            if (is_dct(filter.arrayGet(i))) {
+                if (params.isArray() && i < params.arrayGetLength()) {
+                    dct_params = params.arrayGet(i);
+                }
+                break;
+            }
+        }
+    } else if (is_dct(filter)) {
+        dct_params = std::move(params);
+    }
+    if (!dct_params.isDict()) {
+        return {};
+    }
+    auto transform = dct_params.dictLookup("ColorTransform");
+    if (!transform.isInt()) {
+        return {};
+    }
+    return transform.getInt();
+}
+
+/**
+ * What the markers of a JPEG file before its image data say about its colours.
+ */
+struct JpegInfo
+{
+    int components = 0;
+    bool jfif = false;                  ///< Has a JFIF marker, so 3 components are YCbCr.
+    std::optional<int> adobe_transform; ///< The transform flag of an Adobe marker.
+    bool rgb_ids = false;               ///< The components are labelled 'R', 'G' and 'B'.
+};
+
+static std::optional<JpegInfo> read_jpeg_info(std::vector<unsigned char> const &data)
+{
+    JpegInfo info;
+    bool has_frame = false;
+    std::size_t pos = 2;
+    while (pos + 4 <= data.size()) {
+        if (data[pos] != 0xff) {
+            return {};
+        }
+        auto const marker = data[pos + 1];
+        if (marker == 0xff) { // fill byte
+            pos++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd8)) { // no segment
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xd9 || marker == 0xda) { // end of image, start of scan
+            break;
+        }
+        std::size_t const length = data[pos + 2] << 8 | data[pos + 3];
+        if (length < 2 || pos + 2 + length > data.size()) {
+            return {};
+        }
+        auto const segment = data.data() + pos + 4;
+        std::size_t const size = length - 2;
+        auto starts_with = [&](char const *tag, std::size_t tag_size) {
+            return size >= tag_size && std::equal(tag, tag + tag_size, segment);
+        };
+
+        if (marker == 0xe0 && starts_with("JFIF", 5)) {
+            info.jfif = true;
+        } else if (marker == 0xee && starts_with("Adobe", 5) && size >= 12) {
+            info.adobe_transform = segment[11];
+        } else if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+            // start of frame
+            if (size < 6) {
+                return {};
+            }
+            info.components = segment[5];
+            if (size < 6 + 3 * info.components) {
+                return {};
+            }
+            info.rgb_ids = info.components == 3 && segment[6] == 'R' && segment[9] == 'G' && segment[12] == 'B';
+            has_frame = true;
+        }
+        pos += 2 + length;
+    }
+    if (!has_frame) {
+        return {};
+    }
+    return info;
+}
+
+/**
+ * \brief Reads the JPEG data of a DCT encoded image, if it can be embedded as it is
+ *
+ * This is only the case for 8 bit gray or RGB images without a decode array, whose colours other
+ * readers of the file get the same as poppler does; anything else needs colour conversion. JPX is
+ * not passed through as few SVG renderers can read JPEG 2000.
+ */
+static bool read_jpeg_data(Stream *str, GfxImageColorMap *color_map, std::string &data)
+{
+    if (str->getKind() != strDCT || color_map->getBits() != 8) {
+        return false;
+    }
+    auto const mode = color_map->getColorSpace()->getMode();
+    if (mode != csDeviceGray && mode != csDeviceRGB) {
+        return false;
+    }
+    for (int i = 0; i < color_map->getNumPixelComps(); i++) {
+        if (color_map->getDecodeLow(i) != 0.0 || color_map->getDecodeHigh(i) != 1.0) {
+            return false;
+        }
+    }
+
+    // The stream the DCT filter reads from holds the JPEG file, with any other filters undone.
+    Stream *jpeg_stream = str->getNextStream();
+    if (!jpeg_stream) {
+        return false;
+    }
+#if POPPLER_CHECK_VERSION(22, 4, 0)
+    std::vector<unsigned char> jpeg = jpeg_stream->toUnsignedChars(65536, 65536);
+#else
+    int length = 0;
+    unsigned char *buffer = jpeg_stream->toUnsignedChars(&length, 65536, 65536);
+    std::vector<unsigned char> jpeg(buffer, buffer + length);
+    gfree(buffer);
+#endif
+    jpeg_stream->close();
+
+    // Check for the JPEG start of image marker
+    if (jpeg.size() <= 2 || jpeg[0] != 0xff || jpeg[1] != 0xd8) {
+        return false;
+    }
+    auto const info = read_jpeg_info(jpeg);
+    if (!info || info->components != color_map->getNumPixelComps()) {
+        return false;
+    }
+    if (info->components == 3) {
+        // Readers following libjpeg go by the Adobe marker, then the JFIF marker, then the
+        // component ids. Poppler also lets the Adobe marker win, but otherwise goes by the PDF.
+        bool const reader_ycc = info->adobe_transform ? *info->adobe_transform != 0 : info->jfif || !info->rgb_ids;
+        auto const color_transform = get_dct_color_transform(str);
+        bool const pdf_ycc = info->adobe_transform ? *info->adobe_transform != 0
+                           : color_transform       ? *color_transform != 0
+                                                   : reader_ycc;
+        if (reader_ycc != pdf_ycc) {
+            return false;
         }
+    }
+
+    data.assign(jpeg.begin(), jpeg.end());
+    return true;
+}
+
+/**
+ * \brief Creates an <image> element containing the given ImageStream
+ *
+ * Suitable JPEG images are embedded as they are, all others are converted to PNG. Embedded PNG
+ * images only get their data in flushImages(), so that they can be encoded in parallel.
+ */
+Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height,
+                                              GfxImageColorMap *color_map, bool interpolate,
+                                              int *mask_colors, bool alpha_only,
+                                              bool invert_alpha) {
+
+    if (!alpha_only && !color_map) {
+        // A colormap must be provided, so quit
+        return nullptr;
+    }
+
+    std::string jpeg_data;
+    bool const is_jpeg = _embed_images && !alpha_only && !mask_colors && read_jpeg_data(str, color_map, jpeg_data);
+    std::vector<unsigned char> pixels;
+    if (!is_jpeg && !decode_image(str, width, height, color_map, mask_colors, alpha_only, invert_alpha, pixels)) {
         return nullptr;
     }
-    delete image_stream;
-    str->close();
-    // Close PNG
-    png_write_end(png_ptr, info_ptr);
-    png_destroy_write_struct(&png_ptr, &info_ptr);
 
     // Create repr
     Inkscape::XML::Node *image_node = _xml_doc->createElement("svg:image");
@@ -2266,14 +2564,35 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     image_node->setAttribute("preserveAspectRatio", "none");
 
     // Create href
-    if (_embed_images) {
-        // Append format specification to the URI
-        auto *base64String = g_base64_encode(png_buffer.data(), png_buffer.size());
-        auto png_data = std::string("data:image/png;base64,") + base64String;
+    if (is_jpeg) {
+        auto *base64String = g_base64_encode(reinterpret_cast<guchar const *>(jpeg_data.data()), jpeg_data.size());
+        image_node->setAttribute("xlink:href", std::string("data:image/jpeg;base64,") + base64String);
         g_free(base64String);
-        image_node->setAttributeOrRemoveIfEmpty("xlink:href", png_data);
+    } else if (_embed_images) {
+        // Keep the node alive until its data has been filled in.
+        Inkscape::GC::anchor(image_node);
+        _pending_images->bytes += pixels.size();
+        _pending_images->images.push_back({image_node, std::move(pixels), width, height, alpha_only, invert_alpha});
+        // Don't let photo-heavy pages hold all their decoded pixels until the page ends.
+        if (_pending_images->bytes >= MAX_PENDING_IMAGE_BYTES) {
+            flushImages();
+        }
     } else {
+        static int counter = 0;
+        gchar *file_name = g_strdup_printf("%s_img%d.png", _docname, counter++);
+        FILE *fp = fopen(file_name, "wb");
+        if ( fp == nullptr ) {
+            Inkscape::GC::release(image_node);
+            g_free(file_name);
+            return nullptr;
+        }
+        bool const written = write_png(nullptr, fp, pixels.data(), width, height, alpha_only, invert_alpha);
         fclose(fp);
+        if (!written) {
+            Inkscape::GC::release(image_node);
+            g_free(file_name);
+            return nullptr;
+        }
         image_node->setAttribute("xlink:href", file_name);
         g_free(file_name);
     }
@@ -2281,6 +2600,41 @@ Inkscape::XML::Node *SvgBuilder::_createImage(Stream *str, int width, int height
     return image_node;
 }
 
+/**
+ * \brief Encodes the PNG data of the embedded images created so far and stores it in their nodes
+ *
+ * Images are encoded on the dispatch pool, which is where most of the time of importing
+ * image-heavy pages goes. This runs after each page, and earlier once the decoded pixels
+ * waiting to be encoded exceed MAX_PENDING_IMAGE_BYTES.
+ */
+void SvgBuilder::flushImages()
+{
+    auto &pending = _pending_images->images;
+    if (pending.empty()) {
+        return;
+    }
+
+    std::vector<std::string> hrefs(pending.size());
+    get_global_dispatch_pool()->dispatch_threshold(pending.size(), pending.size() > 1, [&](int i, int) {
+        auto const &image = pending[i];
+        std::vector<guchar> png_buffer;
+        if (write_png(&png_buffer, nullptr, image.pixels.data(), image.width, image.height, image.alpha_only,
+                      image.invert_alpha)) {
+            // Append format specification to the URI
+            auto *base64String = g_base64_encode(png_buffer.data(), png_buffer.size());
+            hrefs[i] = std::string("data:image/png;base64,") + base64String;
+            g_free(base64String);
+        }
+    });
+
+    for (std::size_t i = 0; i < pending.size(); i++) {
+        pending[i].node->setAttributeOrRemoveIfEmpty("xlink:href", hrefs[i]);
+        Inkscape::GC::release(pending[i].node);
+    }
+    pending.clear();
+    _pending_images->bytes = 0;
+}
+
 /**
  * \brief Creates a <mask> with the specified width and height and adds to <defs>
  *  If we're not the top-level SvgBuilder, creates a <defs> too and adds the mask to it.
@@ -2295,15 +2649,14 @@ Inkscape::XML::Node *SvgBuilder::_createMask(double width, double height) {
     mask_node->setAttributeSvgDouble("height", height);
     // Append mask to defs
     if (_is_top_level) {
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        _addToDefs(mask_node);
         Inkscape::GC::release(mask_node);
-        return _doc->getDefs()->getRepr()->lastChild();
+        return mask_node;
     } else {    // Work around for renderer bug when mask isn't defined in pattern
-        static int mask_count = 0;
-        gchar *mask_id = g_strdup_printf("_mask%d", mask_count++);
-        mask_node->setAttribute("id", mask_id);
-        g_free(mask_id);
-        _doc->getDefs()->getRepr()->appendChild(mask_node);
+        if (!_page_import) {
+            mask_node->setAttribute("id", nextMaskId());
+        }
+        _addToDefs(mask_node, true);
         Inkscape::GC::release(mask_node);
         return mask_node;
     }
@@ -2426,9 +2779,7 @@ Inkscape::XML::Node *SvgBuilder::_getGradientNode(Inkscape::XML::Node *node, boo
 {
     auto css = sp_repr_css_attr(node, "style");
     if (auto id = try_extract_uri_id(css->attribute(is_fill ? "fill" : "stroke"))) {
-        if (auto obj = _doc->getObjectById(*id)) {
-            return obj->getRepr();
-        }
+        return _getDefinition(*id);
     }
     return nullptr;
 }
@@ -2555,9 +2906,8 @@ void SvgBuilder::popGroup(GfxState *state)
 
             // if the parent has a mask, apply it to the child
             if (auto mask_id = try_extract_uri_id(parent->attribute("mask"))) {
-                if (auto obj = _doc->getObjectById(*mask_id)) {
-                    auto mask_node = obj->getRepr();
-                    applyOptionalMask(obj->getRepr(), child);
+                if (auto mask_node = _getDefinition(*mask_id)) {
+                    applyOptionalMask(mask_node, child);
                     // if the child has a transform, undo it on the mask children
                     if (child_tr != Geom::identity()) {
                         for (auto m_child = mask_node->firstChild(); m_child != nullptr; m_child = m_child->next()) {
@@ -42,6 +42,7 @@ class AnySpace;
 
 #include <2geom/affine.h>
 #include <2geom/point.h>
+#include <2geom/rect.h>
 #include <cairo-ft.h>
 #include <glibmm/ustring.h>
 #include <lcms2.h>
@@ -71,12 +72,15 @@ class ClipHistoryEntry;
 #include <glib.h>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Inkscape {
 namespace Extension {
 namespace Internal {
 
+class PageImport;
+
 /**
  * Holds information about glyphs added by PdfParser which haven't been added
  * to the document yet.
@@ -111,6 +115,7 @@ struct SvgGlyph {
 class SvgBuilder {
 public:
     SvgBuilder(SPDocument *document, gchar *docname, XRef *xref);
+    SvgBuilder(PageImport &page, gchar *docname, XRef *xref);
     SvgBuilder(SvgBuilder *parent, Inkscape::XML::Node *root);
     virtual ~SvgBuilder();
 
@@ -123,6 +128,8 @@ public:
     void setGroupOpacity(double opacity);
     void pushPage(const std::string &label, GfxState *state);
     void setPageMode(bool as_pages) { _as_pages = as_pages; }
+    void setPagePosition(int pages, double left);
+    void finishPage();
 
     // Path adding
     bool shouldMergePath(bool is_fill, const std::string &path);
@@ -144,6 +151,7 @@ public:
                             Stream *mask_str, int mask_width, int mask_height,
                             GfxImageColorMap *mask_color_map, bool mask_interpolate);
     void applyOptionalMask(Inkscape::XML::Node *mask, Inkscape::XML::Node *target);
+    void flushImages();
 
     // Groups, Transparency group and soft mask handling
     void startGroup(GfxState *state, double *bbox, GfxColorSpace *blending_color_space, bool isolated, bool knockout,
@@ -192,9 +200,16 @@ public:
 
     void setEmbedImages(bool embed_images) { _embed_images = embed_images; }
     void setConvertColors(bool convert_colors) { _convert_colors = convert_colors; }
+
+    static std::string nextMaskId();
 private:
     void _init();
 
+    // Definitions, in the document or in the page being parsed on its own
+    void _addToDefs(Inkscape::XML::Node *node, bool mask_id = false);
+    Inkscape::XML::Node *_getDefinition(std::string const &id);
+    Geom::OptRect _visualBounds(Inkscape::XML::Node const *node) const;
+
     // Pattern creation
     gchar *_createPattern(GfxPattern *pattern, GfxState *state, bool is_stroke=false);
     gchar *_createGradient(GfxState *state, GfxShading *shading, const Geom::Affine pat_matrix);
@@ -268,6 +283,24 @@ private:
     bool _embed_images = true;
     bool _convert_colors = true;
 
+    // Embedded images whose PNG data is encoded in parallel by flushImages()
+    struct PendingImage
+    {
+        Inkscape::XML::Node *node;
+        std::vector<unsigned char> pixels;
+        int width;
+        int height;
+        bool alpha_only;
+        bool invert_alpha;
+    };
+    struct PendingImages
+    {
+        std::vector<PendingImage> images;
+        std::size_t bytes = 0; // Decoded pixels held by images
+    };
+    // Shared with the builders of tiling patterns
+    std::shared_ptr<PendingImages> _pending_images;
+
     // The font when drawing the text into vector glyphs instead of text elements.
     std::shared_ptr<CairoFont> _cairo_font;
 
@@ -278,6 +311,7 @@ private:
 
     bool _is_top_level;  // Whether this SvgBuilder is the top-level one
     SPDocument *_doc;
+    PageImport *_page_import = nullptr; // The page, when parsing it on its own instead of into _doc
     gchar *_docname;    // Basename of the URI from which this document is created
     XRef *_xref;    // Cross-reference table from the PDF doc we're converting from
     Inkscape::XML::Document *_xml_doc;
@@ -21,80 +21,90 @@
 #include "display/drawing.h"
 #include "helper/pixbuf-ops.h"
 #include "object/sp-root.h"
-#include "util/scope_exit.h"
 #include "util/units.h"
 
 /**
-    Generates a bitmap from given items. The bitmap is stored in RAM and not written to file.
+    Shows the document in a new drawing for rendering the given area offscreen.
     @param document Inkscape document.
-    @param area     Export area in document units.
+    @param area     Area in document units; it must not be empty.
     @param dpi      Resolution.
-    @param items    Vector of pointers to SPItems to export. Export all items if empty.
+    @param items    Vector of pointers to SPItems to render. Render all items if empty.
     @param opaque   Set items opacity to 1 (used by Cairo renderer for filtered objects rendered as bitmaps).
-    @return The created GdkPixbuf structure or nullptr if rendering failed.
 */
-Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
-                                              Geom::Rect const &area,
-                                              double dpi,
-                                              std::vector<SPItem const *> items,
-                                              bool opaque,
-                                              uint32_t const *checkerboard_color,
-                                              double device_scale,
-                                              std::optional<Antialiasing> antialias)
+InternalBitmapDrawing::InternalBitmapDrawing(SPDocument *document,
+                                             Geom::Rect const &area,
+                                             double dpi,
+                                             std::vector<SPItem const *> items,
+                                             bool opaque,
+                                             std::optional<Antialiasing> antialias)
+    : _document(document)
+    , _drawing(std::make_unique<Inkscape::Drawing>()) // New drawing for offscreen rendering.
 {
     // Geometry
-    if (area.hasZeroArea()) {
-        return nullptr;
-    }
-
     Geom::Point origin = area.min();
     double scale_factor = Inkscape::Util::Quantity::convert(dpi, "px", "in");
     Geom::Affine affine = Geom::Translate(-origin) * Geom::Scale (scale_factor, scale_factor);
 
     int width  = std::ceil(scale_factor * area.width());
     int height = std::ceil(scale_factor * area.height());
+    _pixel_area = Geom::IntRect::from_xywh(0, 0, width, height);
 
     // Document
     document->ensureUpToDate();
-    unsigned dkey = SPItem::display_key_new(1);
+    _dkey = SPItem::display_key_new(1);
 
     // Drawing
-    Inkscape::Drawing drawing; // New drawing for offscreen rendering.
-    drawing.setRoot(document->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
-    auto invoke_hide_guard = scope_exit([&] { document->getRoot()->invoke_hide(dkey); });
-    drawing.root()->setTransform(affine);
-    drawing.setExact(); // Maximum quality for blurs.
-    drawing.setAntialiasingOverride(antialias);
+    _drawing->setRoot(document->getRoot()->invoke_show(*_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+    _drawing->root()->setTransform(affine);
+    _drawing->setExact(); // Maximum quality for blurs.
+    _drawing->setAntialiasingOverride(antialias);
 
     // Hide all items we don't want, instead of showing only requested items,
     // because that would not work if the shown item references something in defs.
     if (!items.empty()) {
-        document->getRoot()->invoke_hide_except(dkey, items);
+        document->getRoot()->invoke_hide_except(_dkey, items);
     }
 
-    auto final_area = Geom::IntRect::from_xywh(0, 0, width, height);
-    drawing.update(final_area);
+    _drawing->update(_pixel_area);
 
     if (opaque) {
         // Required by sp_asbitmap_render().
         for (auto item : items) {
-            if (item->get_arenaitem(dkey)) {
-                item->get_arenaitem(dkey)->setOpacity(1.0);
+            if (item->get_arenaitem(_dkey)) {
+                item->get_arenaitem(_dkey)->setOpacity(1.0);
             }
         }
     }
+}
+
+InternalBitmapDrawing::~InternalBitmapDrawing()
+{
+    _document->getRoot()->invoke_hide(_dkey);
+}
+
+/**
+    Renders part of the area. The bitmap is stored in RAM and not written to file.
+    @param pixels   Rectangle to render, in pixels of pixelArea().
+    @return The created Pixbuf or nullptr if rendering failed.
+*/
+Inkscape::Pixbuf *InternalBitmapDrawing::render(Geom::IntRect const &pixels,
+                                                uint32_t const *checkerboard_color,
+                                                double device_scale)
+{
+    int width  = pixels.width();
+    int height = pixels.height();
 
     // Rendering
     cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
 
     if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
         long long size = (long long)height * (long long)cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
-        g_warning("sp_generate_internal_bitmap: not enough memory to create pixel buffer. Need %lld.", size);
+        g_warning("InternalBitmapDrawing::render: not enough memory to create pixel buffer. Need %lld.", size);
         cairo_surface_destroy(surface);
         return nullptr;
     }
 
-    Inkscape::DrawingContext dc(surface, Geom::Point(0, 0));
+    Inkscape::DrawingContext dc(surface, Geom::Point(pixels.min()));
 
     if (checkerboard_color) {
         auto pattern = ink_cairo_pattern_create_checkerboard(*checkerboard_color);
@@ -107,7 +117,7 @@ Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
     }
 
     // render items
-    drawing.render(dc, final_area, Inkscape::DrawingItem::RENDER_BYPASS_CACHE);
+    _drawing->render(dc, pixels, Inkscape::DrawingItem::RENDER_BYPASS_CACHE);
 
     if (device_scale != 1.0) {
         cairo_surface_set_device_scale(surface, device_scale, device_scale);
@@ -116,6 +126,32 @@ Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
     return new Inkscape::Pixbuf(surface);
 }
 
+/**
+    Generates a bitmap from given items. The bitmap is stored in RAM and not written to file.
+    @param document Inkscape document.
+    @param area     Export area in document units.
+    @param dpi      Resolution.
+    @param items    Vector of pointers to SPItems to export. Export all items if empty.
+    @param opaque   Set items opacity to 1 (used by Cairo renderer for filtered objects rendered as bitmaps).
+    @return The created GdkPixbuf structure or nullptr if rendering failed.
+*/
+Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
+                                              Geom::Rect const &area,
+                                              double dpi,
+                                              std::vector<SPItem const *> items,
+                                              bool opaque,
+                                              uint32_t const *checkerboard_color,
+                                              double device_scale,
+                                              std::optional<Antialiasing> antialias)
+{
+    if (area.hasZeroArea()) {
+        return nullptr;
+    }
+
+    InternalBitmapDrawing drawing(document, area, dpi, std::move(items), opaque, antialias);
+    return drawing.render(drawing.pixelArea(), checkerboard_color, device_scale);
+}
+
 /*
   Local Variables:
   mode:c++
@@ -13,14 +13,54 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <memory>
+#include <optional>
 #include <vector>
 #include <cstdint>
 #include <2geom/forward.h>
+#include <2geom/int-rect.h>
 #include "display/drawing-item.h"
 
 class SPDocument;
 class SPItem;
-namespace Inkscape { class Pixbuf; }
+namespace Inkscape {
+class Drawing;
+class Pixbuf;
+} // namespace Inkscape
+
+/**
+ * Offscreen drawing of an area of the document at a fixed resolution.
+ *
+ * The document is shown once, after which any pixel rectangle of the area can be rendered;
+ * large areas can thus be rendered in tiles that line up exactly.
+ */
+class InternalBitmapDrawing
+{
+public:
+    InternalBitmapDrawing(SPDocument *document,
+                          Geom::Rect const &area,
+                          double dpi,
+                          std::vector<SPItem const *> items = {},
+                          bool set_opaque = false,
+                          std::optional<Antialiasing> antialias = {});
+    ~InternalBitmapDrawing();
+
+    InternalBitmapDrawing(InternalBitmapDrawing const &) = delete;
+    InternalBitmapDrawing &operator=(InternalBitmapDrawing const &) = delete;
+
+    /// The whole area in pixels, with its top left corner at (0, 0).
+    Geom::IntRect const &pixelArea() const { return _pixel_area; }
+
+    Inkscape::Pixbuf *render(Geom::IntRect const &pixels,
+                             uint32_t const *checkerboard_color = nullptr,
+                             double device_scale = 1.0);
+
+private:
+    SPDocument *_document;
+    unsigned _dkey;
+    std::unique_ptr<Inkscape::Drawing> _drawing;
+    Geom::IntRect _pixel_area;
+};
 
 Inkscape::Pixbuf *sp_generate_internal_bitmap(SPDocument *document,
                                               Geom::Rect const &area,
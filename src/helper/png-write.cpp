@@ -15,6 +15,8 @@
  */
 
 
+#include <algorithm>
+
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 
@@ -33,7 +35,9 @@
 
 #include "object/sp-defs.h"
 #include "object/sp-item.h"
+#include "object/sp-item-group.h"
 #include "object/sp-root.h"
+#include "object/sp-use.h"
 
 #include "ui/interface.h"
 #include <glibmm/convert.h>
@@ -389,6 +393,56 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                               width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing);
 }
 
+SPExportDrawing::SPExportDrawing(SPDocument *doc)
+    : _doc(doc)
+    , _dkey(SPItem::display_key_new(1))
+    , _drawing(std::make_unique<Inkscape::Drawing>())
+{
+    _doc->ensureUpToDate();
+    _drawing->setRoot(_doc->getRoot()->invoke_show(*_drawing, _dkey, SP_ITEM_SHOW_DISPLAY));
+    _drawing->setExact(); // export with maximum blur rendering quality
+}
+
+SPExportDrawing::~SPExportDrawing()
+{
+    // Hide items, this releases arenaitem
+    _doc->getRoot()->invoke_hide(_dkey);
+}
+
+void SPExportDrawing::showOnly(std::vector<SPItem const *> const &items)
+{
+    for (auto const &item : _hidden) {
+        if (item) {
+            item->setHiddenInView(_dkey, false);
+        }
+    }
+    _hidden.clear();
+
+    if (!items.empty()) {
+        _hideExcept(_doc->getRoot(), items);
+    }
+}
+
+// Mirrors SPItem::invoke_hide_except, but only hides the items in this display so it can be
+// undone, and so that updates of the items between exports don't show them again.
+void SPExportDrawing::_hideExcept(SPItem *item, std::vector<SPItem const *> const &items)
+{
+    if (std::find(items.begin(), items.end(), item) != items.end()) {
+        return;
+    }
+
+    if (!is<SPRoot>(item) && !is<SPGroup>(item) && !is<SPUse>(item) && item->get_arenaitem(_dkey)) {
+        item->setHiddenInView(_dkey, true);
+        _hidden.emplace_back(item);
+    }
+
+    for (auto &child : item->children) {
+        if (auto child_item = cast<SPItem>(&child)) {
+            _hideExcept(child_item, items);
+        }
+    }
+}
+
 /**
  * Export an area to a PNG file
  *
@@ -405,6 +459,32 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 {
     g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
+
+    if (!force_overwrite && !sp_ui_overwrite_file(Glib::filename_from_utf8(filename))) {
+        // aborted overwrite
+	return EXPORT_ABORTED;
+    }
+
+    SPExportDrawing drawing(doc);
+    return sp_export_png_file(drawing, filename, area, width, height, xdpi, ydpi, bgcolor, status, data, true,
+                              items_only, interlace, color_type, bit_depth, zlib, antialiasing);
+}
+
+/**
+ * Export an area of a shared display tree to a PNG file
+ *
+ * @param area Area in document coordinates
+ * @param filename Filename and path. Value is UTF8 encoded.
+ */
+ExportResult sp_export_png_file(SPExportDrawing &drawing, gchar const *filename,
+                                Geom::Rect const &area,
+                                unsigned long width, unsigned long height, double xdpi, double ydpi,
+                                Colors::Color const &bgcolor,
+                                unsigned (*status)(float, void *),
+                                void *data, bool force_overwrite,
+                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+{
+    g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(width >= 1, EXPORT_ERROR);
     g_return_val_if_fail(height >= 1, EXPORT_ERROR);
     g_return_val_if_fail(!area.hasZeroArea(), EXPORT_ERROR);
@@ -414,6 +494,7 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 	return EXPORT_ABORTED;
     }
 
+    SPDocument *doc = drawing.document();
     doc->ensureUpToDate();
 
     /* Calculate translation by transforming to document coordinates (flipping Y)*/
@@ -444,21 +525,14 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
     ebp.height = height;
     ebp.background = bgcolor;
 
-    /* Create new drawing */
-    Inkscape::Drawing drawing;
-    unsigned const dkey = SPItem::display_key_new(1);
-    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
-    drawing.root()->setTransform(affine);
-    drawing.setExact(); // export with maximum blur rendering quality
-    drawing.setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
+    drawing.drawing().root()->setTransform(affine);
+    drawing.drawing().setAntialiasingOverride(static_cast<Inkscape::Antialiasing>(antialiasing));
 
-    ebp.drawing = &drawing;
+    ebp.drawing = &drawing.drawing();
 
     // We show all and then hide all items we don't want, instead of showing only requested items,
     // because that would not work if the shown item references something in defs
-    if (!items_only.empty()) {
-        doc->getRoot()->invoke_hide_except(dkey, items_only);
-    }
+    drawing.showOnly(items_only);
 
     ebp.status = status;
     ebp.data   = data;
@@ -473,13 +547,9 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
         g_free(ebp.px);
     }
 
-    // Hide items, this releases arenaitem
-    doc->getRoot()->invoke_hide(dkey);
-
     return write_status ? EXPORT_OK : EXPORT_ERROR;
 }
 
-
 /*
   Local Variables:
   mode:c++
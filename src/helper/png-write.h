@@ -16,17 +16,59 @@
  */
 
 #include <glib.h> // Only for gchar.
+#include <memory>
 #include <vector>
 
 #include <2geom/forward.h>
 
+#include "object/weakptr.h"
+
 class SPDocument;
 class SPItem;
 
+namespace Inkscape {
+class Drawing;
+} // namespace Inkscape
+
 namespace Inkscape::Colors {
 class Color;
 }
 
+/**
+ * Display tree of a whole document that can be shared by several PNG exports.
+ *
+ * Batch export renders many areas of the same document; building the tree once and only
+ * switching item visibility and the root transform between exports avoids showing the whole
+ * document again for every exported item. Items removed from the document in between are
+ * simply skipped when visibility is restored.
+ */
+class SPExportDrawing
+{
+public:
+    explicit SPExportDrawing(SPDocument *doc);
+    ~SPExportDrawing();
+    SPExportDrawing(SPExportDrawing const &) = delete;
+    SPExportDrawing &operator=(SPExportDrawing const &) = delete;
+
+    SPDocument *document() const { return _doc; }
+    Inkscape::Drawing &drawing() { return *_drawing; }
+
+    /**
+     * Hide everything but the given items and their ancestors, or show everything again if the
+     * list is empty. Items stay shown, so anything they reference from defs still renders.
+     */
+    void showOnly(std::vector<SPItem const *> const &items);
+
+private:
+    void _hideExcept(SPItem *item, std::vector<SPItem const *> const &items);
+
+    SPDocument *_doc;
+    unsigned _dkey;
+    std::unique_ptr<Inkscape::Drawing> _drawing;
+    // Items are tracked rather than their drawing items, which go away if the item is deleted.
+    std::vector<Inkscape::SPWeakPtr<SPItem>> _hidden;
+};
+
 enum ExportResult {
     EXPORT_ERROR = 0,
     EXPORT_OK,
@@ -74,4 +116,28 @@ ExportResult sp_export_png_file(SPDocument *doc,
                                 int zlib = 6,
                                 int antialiasing = 2);
 
+/**
+ * Export an area of a shared display tree to a PNG file.
+ *
+ * Same as sp_export_png_file() above, but renders through @a drawing instead of showing the
+ * document in a new drawing.
+ */
+ExportResult sp_export_png_file(SPExportDrawing &drawing,
+                                gchar const *filename,
+                                Geom::Rect const &area,
+                                unsigned long int width,
+                                unsigned long int height,
+                                double xdpi,
+                                double ydpi,
+                                Inkscape::Colors::Color const &bgcolor,
+                                unsigned int (*status) (float, void *),
+                                void *data,
+                                bool force_overwrite = false,
+                                std::vector<SPItem const *> const &items_only = {},
+                                bool interlace = false,
+                                int color_type = 6,
+                                int bit_depth = 8,
+                                int zlib = 6,
+                                int antialiasing = 2);
+
 #endif // SEEN_SP_PNG_WRITE_H
@@ -17,8 +17,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <list>
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <glibmm/i18n.h>
 #include <glibmm/regex.h>
@@ -46,9 +46,10 @@ struct IdReference {
     const char *attr;  // property or href-like attribute
 };
 
-typedef std::map<Glib::ustring, std::list<IdReference> > refmap_type;
+// Keyed by std::string: ordering Glib::ustring keys collates, which dominates large pastes.
+typedef std::unordered_map<std::string, std::list<IdReference> > refmap_type;
 
-typedef std::pair<SPObject*, Glib::ustring> id_changeitem_type;
+typedef std::pair<SPObject*, std::string> id_changeitem_type;
 typedef std::list<id_changeitem_type> id_changelist_type;
 
 const char *href_like_attributes[] = {"inkscape:connection-end",
@@ -373,36 +374,65 @@ static void find_references(SPObject *elem, refmap_type &refmap, bool from_clipb
     }
 }
 
+/**
+ * Hands out replacement IDs of the form "<old id>-<n>". The counter of each old ID starts
+ * past the "<old id>-<n>" IDs the documents already have and only grows, so every clash is
+ * resolved with a lookup in the documents' ID index instead of a retry loop, even when the
+ * same document is imported many times.
+ */
+class IdAllocator
+{
+public:
+    IdAllocator(SPDocument const *doc, SPDocument const *other = nullptr)
+        : _doc(doc)
+        , _other(other)
+    {}
+
+    std::string allocate(std::string const &old_id)
+    {
+        auto [it, inserted] = _counters.try_emplace(old_id);
+        auto &counter = it->second;
+        if (inserted) {
+            auto const prefix = old_id + '-';
+            counter = _doc->highestIdSuffix(prefix);
+            if (_other) {
+                counter = std::max(counter, _other->highestIdSuffix(prefix));
+            }
+        }
+        std::string new_id;
+        do {
+            new_id = old_id + '-' + std::to_string(++counter);
+        } while (_doc->getObjectById(new_id) || (_other && _other->getObjectById(new_id)));
+        return new_id;
+    }
+
+private:
+    SPDocument const *_doc;
+    SPDocument const *_other;
+    std::unordered_map<std::string, unsigned long> _counters;
+};
+
 /**
  *  Change any IDs that clash with IDs in the current document, and make
  *  a list of those changes that will require fixing up references.
  */
-static void change_clashing_ids(SPDocument *imported_doc, SPDocument *current_doc, SPObject *elem,
+static void change_clashing_ids(SPDocument *current_doc, IdAllocator &allocator, SPObject *elem,
                                 refmap_type const &refmap, id_changelist_type *id_changes, bool from_clipboard)
 {
     const gchar *id = elem->getId();
-    bool fix_clashing_ids = true;
+    SPObject *cd_obj = id ? current_doc->getObjectById(id) : nullptr;
 
-    if (id && current_doc->getObjectById(id)) {
-        // Choose a new ID.
-        // To try to preserve any meaningfulness that the original ID
-        // may have had, the new ID is the old ID followed by a hyphen
-        // and one or more digits.
-
-        if (is<SPGradient>(elem)) {
-            SPObject *cd_obj =  current_doc->getObjectById(id);
+    if (cd_obj) {
+        bool fix_clashing_ids = true;
 
-            if (cd_obj && is<SPGradient>(cd_obj)) {
-                auto cd_gr = cast<SPGradient>(cd_obj);
-                if ( cd_gr->isEquivalent(cast<SPGradient>(elem))) {
-                    fix_clashing_ids = false;
-                 }
-             }
+        if (auto gr = cast<SPGradient>(elem)) {
+            auto cd_gr = cast<SPGradient>(cd_obj);
+            if (cd_gr && cd_gr->isEquivalent(gr)) {
+                fix_clashing_ids = false;
+            }
         }
 
-        auto lpeobj = cast<LivePathEffectObject>(elem);
-        if (lpeobj) {
-            SPObject *cd_obj = current_doc->getObjectById(id);
+        if (auto lpeobj = cast<LivePathEffectObject>(elem)) {
             auto cd_lpeobj = cast<LivePathEffectObject>(cd_obj);
             if (cd_lpeobj && lpeobj->is_similar(cd_lpeobj)) {
                 fix_clashing_ids = from_clipboard;
@@ -410,17 +440,12 @@ static void change_clashing_ids(SPDocument *imported_doc, SPDocument *current_do
         }
 
         if (fix_clashing_ids) {
+            // Choose a new ID.
+            // To try to preserve any meaningfulness that the original ID
+            // may have had, the new ID is the old ID followed by a hyphen
+            // and a number.
             std::string old_id(id);
-            std::string new_id(old_id + '-');
-            for (;;) {
-                new_id += "0123456789"[std::rand() % 10];
-                const char *str = new_id.c_str();
-                if (current_doc->getObjectById(str) == nullptr &&
-                    imported_doc->getObjectById(str) == nullptr) break;
-            }
-            // Change to the new ID
-
-            elem->setAttribute("id", new_id);
+            elem->setAttribute("id", allocator.allocate(old_id));
             // Make a note of this change, if we need to fix up refs to it
             if (refmap.find(old_id) != refmap.end()) {
                 id_changes->emplace_back(elem, old_id);
@@ -428,11 +453,10 @@ static void change_clashing_ids(SPDocument *imported_doc, SPDocument *current_do
         }
     }
 
-
     // recurse
     for (auto& child: elem->children)
     {
-        change_clashing_ids(imported_doc, current_doc, &child, refmap, id_changes, from_clipboard);
+        change_clashing_ids(current_doc, allocator, &child, refmap, id_changes, from_clipboard);
     }
 }
 
@@ -468,7 +492,8 @@ void prevent_id_clashes(SPDocument *imported_doc, SPDocument *current_doc, bool
     SPObject *imported_root = imported_doc->getRoot();
 
     find_references(imported_root, refmap, from_clipboard);
-    change_clashing_ids(imported_doc, current_doc, imported_root, refmap, &id_changes, from_clipboard);
+    IdAllocator allocator(current_doc, imported_doc);
+    change_clashing_ids(current_doc, allocator, imported_root, refmap, &id_changes, from_clipboard);
     fix_up_refs(refmap, id_changes);
 }
 
@@ -613,13 +638,8 @@ void rename_id(SPObject *elem, Glib::ustring const &new_name)
         // Choose a new ID.
         // To try to preserve any meaningfulness that the original ID
         // may have had, the new ID is the old ID followed by a hyphen
-        // and one or more digits.
-        new_name2 += '-';
-        for (;;) {
-            new_name2 += "0123456789"[std::rand() % 10];
-            if (current_doc->getObjectById(new_name2) == nullptr)
-                break;
-        }
+        // and a number.
+        new_name2 = IdAllocator(current_doc).allocate(new_name2);
     }
     g_free (id);
     // Change to the new ID
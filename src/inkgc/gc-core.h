@@ -57,6 +57,8 @@ struct Ops {
     void (*enable)();
     void (*disable)();
     void (*free)(void *ptr);
+    bool (*register_thread)();
+    void (*unregister_thread)();
 };
 
 struct Core {
@@ -112,6 +114,12 @@ public:
     static inline void free(void *ptr) {
         return _ops.free(ptr);
     }
+    static inline bool register_thread() {
+        return _ops.register_thread();
+    }
+    static inline void unregister_thread() {
+        _ops.unregister_thread();
+    }
 private:
     static Ops _ops;
 };
@@ -122,6 +130,12 @@ inline void init() {
 
 void request_early_collection();
 
+/**
+ * Lets the calling thread allocate and hold collected memory, until it exits.
+ * Threads other than the main one must call this first.
+ */
+void register_thread();
+
 }
 }
 
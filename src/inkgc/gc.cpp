@@ -10,6 +10,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+// Before gc.h, for the thread registration functions.
+#define GC_THREADS
 #include "inkgc/gc-core.h"
 #include <stdexcept>
 #include <cstring>
@@ -40,10 +42,23 @@ void do_init() {
     GC_set_finalize_on_demand(0);
 
     GC_INIT();
+    GC_allow_register_threads();
 
     GC_set_warn_proc(&display_warning);
 }
 
+bool do_register_thread() {
+    GC_stack_base stack_base;
+    if (GC_get_stack_base(&stack_base) != GC_SUCCESS) {
+        g_error("Unable to find the stack of a thread to register with the collector");
+    }
+    return GC_register_my_thread(&stack_base) == GC_SUCCESS;
+}
+
+void do_unregister_thread() {
+    GC_unregister_my_thread();
+}
+
 void *debug_malloc(std::size_t size) {
     return GC_debug_malloc(size, GC_EXTRAS);
 }
@@ -115,6 +130,10 @@ void dummy_enable() {}
 
 void dummy_disable() {}
 
+bool dummy_register_thread() { return false; }
+
+void dummy_unregister_thread() {}
+
 Ops enabled_ops = {
     &do_init,
     &GC_malloc,
@@ -134,7 +153,9 @@ Ops enabled_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_free
+    &GC_free,
+    &do_register_thread,
+    &do_unregister_thread
 };
 
 Ops debug_ops = {
@@ -152,7 +173,9 @@ Ops debug_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_debug_free
+    &GC_debug_free,
+    &do_register_thread,
+    &do_unregister_thread
 };
 
 Ops disabled_ops = {
@@ -170,7 +193,9 @@ Ops disabled_ops = {
     &dummy_gcollect,
     &dummy_enable,
     &dummy_disable,
-    &std::free
+    &std::free,
+    &dummy_register_thread,
+    &dummy_unregister_thread
 };
 
 class InvalidGCModeError : public std::runtime_error {
@@ -253,6 +278,15 @@ void stub_free(void *) {
     die_because_not_initialized();
 }
 
+bool stub_register_thread() {
+    die_because_not_initialized();
+    return false;
+}
+
+void stub_unregister_thread() {
+    die_because_not_initialized();
+}
+
 }
 
 Ops Core::_ops = {
@@ -270,7 +304,9 @@ Ops Core::_ops = {
     &stub_gcollect,
     &stub_enable,
     &stub_disable,
-    &stub_free
+    &stub_free,
+    &stub_register_thread,
+    &stub_unregister_thread
 };
 
 void Core::init() {
@@ -304,6 +340,27 @@ void request_early_collection() {
     }
 }
 
+namespace {
+
+/// Unregisters its thread on exit, unless the thread was registered already.
+struct ThreadRegistration {
+    bool registered = false;
+    ~ThreadRegistration() {
+        if (registered) {
+            Core::unregister_thread();
+        }
+    }
+};
+
+}
+
+void register_thread() {
+    thread_local ThreadRegistration registration;
+    if (!registration.registered) {
+        registration.registered = Core::register_thread();
+    }
+}
+
 }
 }
 
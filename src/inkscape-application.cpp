@@ -41,7 +41,10 @@
 #include <fstream>
 #include <iomanip>
 #include <cerrno>  // History file
+#include <algorithm>
 #include <regex>
+#include <stdexcept>
+#include <sstream>
 #include <numeric>
 #include <unistd.h>
 #include <chrono>
@@ -721,6 +724,7 @@ InkscapeApplication::InkscapeApplication()
     _start_main_option_section();
     gapp->add_main_option_entry(T::OptionType::BOOL,     "shell",                 '\0', N_("Start Inkscape in interactive shell mode"),                                 "");
     gapp->add_main_option_entry(T::OptionType::BOOL,     "active-window",          'q', N_("Use active window from commandline"),                                       "");
+    gapp->add_main_option_entry(T::OptionType::BOOL,     "daemon",                '\0', N_("Keep running headless and process document jobs read from standard input"), "");
     // clang-format on
 
     gapp->signal_handle_local_options().connect(sigc::mem_fun(*this, &InkscapeApplication::on_handle_local_options), true);
@@ -992,6 +996,11 @@ void InkscapeApplication::on_activate()
     // Create new document, either from pipe or from template.
     SPDocument *document = nullptr;
 
+    if (_use_daemon) {
+        daemon();
+        return;
+    }
+
     if (_use_pipe) {
         // Create document from pipe in.
         std::istreambuf_iterator<char> begin(std::cin), end;
@@ -1070,6 +1079,18 @@ void InkscapeApplication::on_open(Gio::Application::type_vec_files const &files,
 
     _closeStartScreen();
 
+    if (_use_daemon) {
+        // Files given on the command line are available to jobs under their base name.
+        std::map<std::string, SPDocument *> documents;
+        for (auto const &file : files) {
+            if (auto document = document_open(file).first) {
+                documents[file->get_basename()] = document;
+            }
+        }
+        daemon(std::move(documents));
+        return;
+    }
+
     bool first = true; // for opening all files in one new window
     for (auto file : files) {
         // Open file
@@ -1092,8 +1113,9 @@ void InkscapeApplication::on_open(Gio::Application::type_vec_files const &files,
     }
 }
 
-void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vector_t &action_vector)
+bool InkscapeApplication::parse_actions(Glib::ustring const &input, action_vector_t &action_vector)
 {
+    bool valid = true;
     auto const re_colon = Glib::Regex::create("\\s*:\\s*");
 
     // Split action list
@@ -1128,6 +1150,7 @@ void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vecto
                         b = false;
                     } else {
                         std::cerr << "InkscapeApplication::parse_actions: Invalid boolean value: " << action << ":" << value << std::endl;
+                        valid = false;
                     }
                     action_vector.emplace_back(action, Glib::Variant<bool>::create(b));
                 } else if (type.get_string() == "i") {
@@ -1140,6 +1163,7 @@ void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vecto
                     std::vector<Glib::ustring> tokens3 = Glib::Regex::split_simple(",", value.c_str());
                     if (tokens3.size() != 2) {
                         std::cerr << "InkscapeApplication::parse_actions: " << action << " requires two comma separated numbers" << std::endl;
+                        valid = false;
                         continue;
                     }
 
@@ -1150,6 +1174,7 @@ void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vecto
                         d1 = std::stod(tokens3[1]);
                     } catch (...) {
                         std::cerr << "InkscapeApplication::parse_actions: " << action << " requires two comma separated numbers" << std::endl;
+                        valid = false;
                         continue;
                     }
 
@@ -1157,6 +1182,7 @@ void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vecto
                } else {
                     std::cerr << "InkscapeApplication::parse_actions: unhandled action value: "
                               << action << ": " << type.get_string() << std::endl;
+                    valid = false;
                 }
             } else {
                 // Stateless (i.e. no value).
@@ -1164,8 +1190,10 @@ void InkscapeApplication::parse_actions(Glib::ustring const &input, action_vecto
             }
         } else {
             std::cerr << "InkscapeApplication::parse_actions: could not find action for: " << action << std::endl;
+            valid = false;
         }
     }
+    return valid;
 }
 
 #ifdef WITH_GNU_READLINE
@@ -1315,6 +1343,114 @@ void InkscapeApplication::shell(bool active_window)
     }
 }
 
+/**
+ * Headless job loop for export farms: documents stay open between jobs and the process keeps its
+ * fonts, extensions and preferences loaded. Jobs are read from stdin, one per line:
+ *
+ *   open NAME FILENAME   Open a document and make it available as NAME.
+ *   run NAME ACTIONS     Run "action1:arg1; action2:arg2; ..." with NAME as the active document.
+ *   close NAME           Close the document.
+ *   list                 Print the names of the open documents.
+ *   quit                 Close all documents and leave the loop.
+ *
+ * Output of the actions is written to stdout as usual. Each job is then terminated by a line
+ * "@ok SECONDS" giving its wall time, or "@error MESSAGE". A run with an unknown action or an
+ * invalid argument is not started. Documents opened by the actions of a run are closed after it.
+ */
+void InkscapeApplication::daemon(std::map<std::string, SPDocument *> documents)
+{
+    // Every job starts from the export settings given on the command line.
+    auto const export_defaults = _file_export;
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        auto const start = std::chrono::steady_clock::now();
+
+        std::istringstream job(line);
+        std::string command, name, args;
+        job >> command >> name;
+        std::getline(job >> std::ws, args);
+
+        if (command.empty()) {
+            continue;
+        } else if (command == "quit" || command == "q") {
+            break;
+        }
+
+        std::string error;
+        auto const it = documents.find(name);
+        if (command == "list") {
+            for (auto const &entry : documents) {
+                std::cout << entry.first << std::endl;
+            }
+        } else if (name.empty()) {
+            error = "missing document name";
+        } else if (command == "open") {
+            if (it != documents.end()) {
+                error = "document '" + name + "' is already open";
+            } else if (auto document = document_open(Gio::File::create_for_commandline_arg(args)).first) {
+                documents.emplace(name, document);
+            } else {
+                error = "failed to open '" + args + "'";
+            }
+        } else if (it == documents.end()) {
+            error = "no document named '" + name + "'";
+        } else if (command == "close") {
+            document_close(it->second);
+            documents.erase(it);
+        } else if (command == "run") {
+            action_vector_t action_vector;
+            bool parsed = false;
+            try {
+                parsed = parse_actions(args, action_vector);
+            } catch (std::logic_error const &) {
+                // std::stoi() and std::stod() on malformed numbers.
+            }
+            if (!parsed) {
+                error = "invalid actions '" + args + "'";
+            } else {
+                auto const open_before = get_documents();
+
+                _file_export = export_defaults;
+                _active_document = it->second;
+                _active_selection = it->second->getSelection();
+                _active_desktop = nullptr;
+                _active_window = nullptr;
+                _active_document->ensureUpToDate();
+
+                activate_any_actions(action_vector, _gio_application, nullptr, _active_document);
+
+                _active_document = nullptr;
+                _active_selection = nullptr;
+
+                // Actions may close documents (file-close), which then can't be addressed any more...
+                std::erase_if(documents, [this] (auto const &entry) {
+                    return _documents.find(entry.second) == _documents.end();
+                });
+                // ...or open ones of their own (file-open), which no later job can reach.
+                for (auto document : get_documents()) {
+                    if (std::find(open_before.begin(), open_before.end(), document) == open_before.end()) {
+                        document_close(document);
+                    }
+                }
+            }
+        } else {
+            error = "unknown command '" + command + "'";
+        }
+
+        if (error.empty()) {
+            std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "@ok " << elapsed.count() << std::endl;
+        } else {
+            std::cout << "@error " << error << std::endl;
+        }
+    }
+
+    for (auto const &[name, document] : documents) {
+        document_close(document);
+    }
+}
+
 // Todo: Code can be improved by using proper IPC rather than temporary file polling.
 void InkscapeApplication::redirect_output()
 {
@@ -1493,7 +1629,8 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
         options->contains("action-list")           ||
         options->contains("actions")               ||
         options->contains("actions-file")          ||
-        options->contains("shell")
+        options->contains("shell")                 ||
+        options->contains("daemon")
         ) {
         _with_gui = false;
     }
@@ -1509,6 +1646,7 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
     if (options->contains("batch-process"))  _batch_process = true;
     if (options->contains("shell"))          _use_shell = true;
     if (options->contains("pipe"))           _use_pipe  = true;
+    if (options->contains("daemon"))         _use_daemon = true;
 
     // Enable auto-export
     if (options->contains("export-filename")  ||
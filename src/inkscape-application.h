@@ -137,6 +137,7 @@ protected:
     bool _batch_process = false; // Temp
     bool _use_shell   = false;
     bool _use_pipe    = false;
+    bool _use_daemon  = false;
     bool _auto_export = false;
     int _pdf_poppler  = false;
     FontStrategy _pdf_font_strategy = FontStrategy::RENDER_MISSING;
@@ -179,10 +180,12 @@ protected:
     void on_activate();
     void on_open(const Gio::Application::type_vec_files &files, const Glib::ustring &hint);
     void process_document(SPDocument* document, std::string output_path, bool new_window = false);
-    void parse_actions(const Glib::ustring& input, action_vector_t& action_vector);
+    /// Returns false if any of the actions is unknown or has an invalid argument.
+    bool parse_actions(const Glib::ustring& input, action_vector_t& action_vector);
 
     void redirect_output();
     void shell(bool active_window = false);
+    void daemon(std::map<std::string, SPDocument *> documents = {});
 
     void _start_main_option_section(const Glib::ustring& section_name = "");
     
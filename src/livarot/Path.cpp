@@ -66,7 +66,7 @@ void Path::Copy(Path * who)
         
     for (auto i : who->descr_cmd)
     {
-        descr_cmd.push_back(i->clone());
+        descr_cmd.push_back(i->clone(&descr_storage));
     }
 
     forced_subdivisions = who->forced_subdivisions;
@@ -87,7 +87,7 @@ int Path::ForcePoint()
         return -1;
     }
 
-    descr_cmd.push_back(new PathDescrForced);
+    descr_cmd.push_back(new (descr_storage) PathDescrForced);
     return descr_cmd.size() - 1;
 }
 
@@ -103,7 +103,7 @@ void Path::InsertForcePoint(int at)
 	return;
     }
     
-    descr_cmd.insert(descr_cmd.begin() + at, new PathDescrForced);
+    descr_cmd.insert(descr_cmd.begin() + at, new (descr_storage) PathDescrForced);
 }
 
 int Path::Close()
@@ -115,7 +115,7 @@ int Path::Close()
         return -1;
     }
 
-    descr_cmd.push_back(new PathDescrClose);
+    descr_cmd.push_back(new (descr_storage) PathDescrClose);
     
     descr_flags &= ~(descr_doing_subpath);
     
@@ -128,7 +128,7 @@ int Path::MoveTo(Geom::Point const &iPt)
 	CloseSubpath();
     }
     
-    descr_cmd.push_back(new PathDescrMoveTo(iPt));
+    descr_cmd.push_back(new (descr_storage) PathDescrMoveTo(iPt));
 
     descr_flags |= descr_doing_subpath;
     return descr_cmd.size() - 1;
@@ -145,7 +145,7 @@ void Path::InsertMoveTo(Geom::Point const &iPt, int at)
         return;
     }
 
-  descr_cmd.insert(descr_cmd.begin() + at, new PathDescrMoveTo(iPt));
+  descr_cmd.insert(descr_cmd.begin() + at, new (descr_storage) PathDescrMoveTo(iPt));
 }
 
 int Path::LineTo(Geom::Point const &iPt)
@@ -154,7 +154,7 @@ int Path::LineTo(Geom::Point const &iPt)
 	return MoveTo (iPt);
     }
     
-    descr_cmd.push_back(new PathDescrLineTo(iPt));
+    descr_cmd.push_back(new (descr_storage) PathDescrLineTo(iPt));
     return descr_cmd.size() - 1;
 }
 
@@ -169,7 +169,7 @@ void Path::InsertLineTo(Geom::Point const &iPt, int at)
         return;
     }
     
-    descr_cmd.insert(descr_cmd.begin() + at, new PathDescrLineTo(iPt));
+    descr_cmd.insert(descr_cmd.begin() + at, new (descr_storage) PathDescrLineTo(iPt));
 }
 
 int Path::CubicTo(Geom::Point const &iPt, Geom::Point const &iStD, Geom::Point const &iEnD)
@@ -178,7 +178,7 @@ int Path::CubicTo(Geom::Point const &iPt, Geom::Point const &iStD, Geom::Point c
 	return MoveTo (iPt);
     }
 
-    descr_cmd.push_back(new PathDescrCubicTo(iPt, iStD, iEnD));
+    descr_cmd.push_back(new (descr_storage) PathDescrCubicTo(iPt, iStD, iEnD));
     return descr_cmd.size() - 1;
 }
 
@@ -194,7 +194,7 @@ void Path::InsertCubicTo(Geom::Point const &iPt, Geom::Point const &iStD, Geom::
 	return;
     }
   
-    descr_cmd.insert(descr_cmd.begin() + at, new PathDescrCubicTo(iPt, iStD, iEnD));
+    descr_cmd.insert(descr_cmd.begin() + at, new (descr_storage) PathDescrCubicTo(iPt, iStD, iEnD));
 }
 
 int Path::ArcTo(Geom::Point const &iPt, double iRx, double iRy, double angle,
@@ -204,7 +204,7 @@ int Path::ArcTo(Geom::Point const &iPt, double iRx, double iRy, double angle,
 	return MoveTo(iPt);
     }
 
-    descr_cmd.push_back(new PathDescrArcTo(iPt, iRx, iRy, angle, iLargeArc, iClockwise));
+    descr_cmd.push_back(new (descr_storage) PathDescrArcTo(iPt, iRx, iRy, angle, iLargeArc, iClockwise));
     return descr_cmd.size() - 1;
 }
 
@@ -221,7 +221,7 @@ void Path::InsertArcTo(Geom::Point const &iPt, double iRx, double iRy, double an
 	return;
     }
   
-    descr_cmd.insert(descr_cmd.begin() + at, new PathDescrArcTo(iPt, iRx, iRy,
+    descr_cmd.insert(descr_cmd.begin() + at, new (descr_storage) PathDescrArcTo(iPt, iRx, iRy,
                                                                 angle, iLargeArc, iClockwise));
 }
 
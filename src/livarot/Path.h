@@ -21,6 +21,7 @@
 #include <span>
 #include <vector>
 #include "LivarotDefs.h"
+#include "path-description.h"
 #include <2geom/point.h>
 
 struct PathDescr;
@@ -105,6 +106,7 @@ class Path
   int         descr_flags = descr_ready;
 
 public:
+  PathDescrStorage descr_storage; /*!< Where the commands of this path are placed. */
   std::vector<PathDescr*> descr_cmd; /*!< A vector of owned pointers to path commands. */
 
   /**
@@ -384,6 +384,8 @@ void Path::LoadPathVector(Geom::PathVector const &pv, std::vector<Geom::PathVect
     Reset();
 
     forced_subdivisions.reserve(cuts.size());
+    // One command per curve, plus a moveto and a close per subpath.
+    descr_cmd.reserve(pv.curveCount() + 2 * pv.size());
     auto it = cuts.begin();
 
     for (int i = 0, maxi = pv.size(); i < maxi; i++) {
@@ -729,7 +731,7 @@ void Path::ConvertForcedToMoveTo()
             if ( i < int(descr_cmd.size()) - 1 && hasMoved ) { // sinon il termine le chemin
 
                 delete descr_cmd[i];
-                descr_cmd[i] = new PathDescrMoveTo(lastSeen);
+                descr_cmd[i] = new (descr_storage) PathDescrMoveTo(lastSeen);
                 lastMove = lastSeen;
                 hasMoved = true;
             }
@@ -974,7 +976,7 @@ void Path::ConvertPositionsToForced(int nbPos, cut_position *poss)
             case descr_close:
             {
                 delete descr_cmd[i];
-                descr_cmd[i] = new PathDescrLineTo(Geom::Point(0, 0));
+                descr_cmd[i] = new (descr_storage) PathDescrLineTo(Geom::Point(0, 0));
 
                 int fp = i - 1;
                 while ( fp >= 0 && (descr_cmd[fp]->getType()) != descr_moveto ) {
@@ -10,8 +10,10 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <utility>
 #include <glib.h>
 #include "Shape.h"
 #include "livarot/sweep-event-queue.h"
@@ -50,6 +52,11 @@ Shape::~Shape ()
 {
   maxPt = 0;
   maxAr = 0;
+
+  // Only set here if a sweep bailed out early; hand them back for reuse.
+  SweepTreeList::release(sTree);
+  SweepEventQueue::release(sEvts);
+  clearIncidenceData();
 }
 
 void Shape::Affiche()
@@ -206,9 +213,9 @@ Shape::Copy (Shape * who)
   MakeRasterData (false);
   MakeBackData (false);
 
-  delete sTree;
+  SweepTreeList::release(sTree);
   sTree = nullptr;
-  delete sEvts;
+  SweepEventQueue::release(sEvts);
   sEvts = nullptr;
 
   Reset (who->numberOfPoints(), who->numberOfEdges());
@@ -2097,13 +2104,47 @@ void Shape::initialiseEdgeData()
 }
 
 
+namespace {
+/// Incidence buffer kept between sweeps on the same thread.
+struct SpareIncidenceData
+{
+    Shape::incidenceData *data = nullptr;
+    int size = 0;
+    ~SpareIncidenceData() { g_free(data); }
+};
+thread_local SpareIncidenceData spare_incidence_data;
+
+/// Buffers larger than this are freed rather than kept for the next sweep.
+constexpr std::size_t MAX_SPARE_INCIDENCE_BYTES = 4 * 1024 * 1024;
+} // namespace
+
 void Shape::clearIncidenceData()
 {
+    // Keep the larger of the two buffers for the next sweep, unless it is far larger than this
+    // sweep needed or too large to keep around at all.
+    auto &spare = spare_incidence_data;
+    if (maxInc > spare.size && maxInc <= 4 * std::max(nbInc, 64) &&
+        maxInc * sizeof(incidenceData) <= MAX_SPARE_INCIDENCE_BYTES) {
+        std::swap(iData, spare.data);
+        std::swap(maxInc, spare.size);
+    }
     g_free(iData);
     iData = nullptr;
     nbInc = maxInc = 0;
 }
 
+void Shape::growIncidenceData()
+{
+    auto &spare = spare_incidence_data;
+    if (!iData && spare.size > nbInc) {
+        std::swap(iData, spare.data);
+        std::swap(maxInc, spare.size);
+        return;
+    }
+    maxInc = 2 * nbInc + 1;
+    iData = (incidenceData *) g_realloc(iData, maxInc * sizeof (incidenceData));
+}
+
 
 
 /**
@@ -633,6 +633,7 @@ private:
     void initialisePointData();
     void initialiseEdgeData();
     void clearIncidenceData();
+    void growIncidenceData();
 
     void _countUpDown(int P, int *numberUp, int *numberDown, int *upEdge, int *downEdge) const;
     void _countUpDownTotalDegree2(int P, int *numberUp, int *numberDown, int *upEdge, int *downEdge) const;
@@ -40,10 +40,10 @@ void Shape::BeginRaster(float &pos, int &curPt)
     MakeEdgeData(true);
 
     if (sTree == nullptr) {
-        sTree = new SweepTreeList(numberOfEdges());
+        sTree = SweepTreeList::acquire(numberOfEdges());
     }
     if (sEvts == nullptr) {
-        sEvts = new SweepEventQueue(numberOfEdges());
+        sEvts = SweepEventQueue::acquire(numberOfEdges());
     }
 
     SortPoints();
@@ -67,9 +67,9 @@ void Shape::BeginRaster(float &pos, int &curPt)
 
 void Shape::EndRaster()
 {
-    delete sTree;
+    SweepTreeList::release(sTree);
     sTree = nullptr;
-    delete sEvts;
+    SweepEventQueue::release(sEvts);
     sEvts = nullptr;
     
     MakePointData(false);
@@ -190,10 +190,10 @@ Shape::ConvertToShape (Shape * a, FillRule directed, bool invert)
 
   // allocating the sweepline data structures
   if (sTree == nullptr) {
-    sTree = new SweepTreeList(a->numberOfEdges());
+    sTree = SweepTreeList::acquire(a->numberOfEdges());
   }
   if (sEvts == nullptr) {
-    sEvts = new SweepEventQueue(a->numberOfEdges());
+    sEvts = SweepEventQueue::acquire(a->numberOfEdges());
   }
 
   // make room for stuff and set flags
@@ -905,9 +905,9 @@ Shape::ConvertToShape (Shape * a, FillRule directed, bool invert)
 
   //      Plot(200.0,200.0,2.0,400.0,400.0,true,true,true,true);
 
-  delete sTree;
+  SweepTreeList::release(sTree);
   sTree = nullptr;
-  delete sEvts;
+  SweepEventQueue::release(sEvts);
   sEvts = nullptr;
 
   MakePointData (false);
@@ -945,10 +945,10 @@ Shape::Booleen (Shape * a, Shape * b, BooleanOp mod,int cutPathID)
   b->ResetSweep ();
 
   if (sTree == nullptr) {
-      sTree = new SweepTreeList(a->numberOfEdges() + b->numberOfEdges());
+      sTree = SweepTreeList::acquire(a->numberOfEdges() + b->numberOfEdges());
   }
   if (sEvts == nullptr) {
-      sEvts = new SweepEventQueue(a->numberOfEdges() + b->numberOfEdges());
+      sEvts = SweepEventQueue::acquire(a->numberOfEdges() + b->numberOfEdges());
   }
   
   MakePointData (true);
@@ -1708,9 +1708,9 @@ Shape::Booleen (Shape * a, Shape * b, BooleanOp mod,int cutPathID)
     }
   }
   
-  delete sTree;
+  SweepTreeList::release(sTree);
   sTree = nullptr;
-  delete sEvts;
+  SweepEventQueue::release(sEvts);
   sEvts = nullptr;
   
   if ( mod == bool_op_cut ) {
@@ -2128,11 +2128,7 @@ Shape::PushIncidence (Shape * a, int cb, int pt, double theta)
     return -1;
 
   if (nbInc >= maxInc)
-    {
-      maxInc = 2 * nbInc + 1;
-      iData =
-	(incidenceData *) g_realloc(iData, maxInc * sizeof (incidenceData));
-    }
+    growIncidenceData();
   int n = nbInc++;
   iData[n].nextInc = a->swsData[cb].firstLinkedPoint;
   iData[n].pt = pt;
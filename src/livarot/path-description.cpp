@@ -8,11 +8,109 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 #include "livarot/path-description.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
 #include <2geom/affine.h>
 
-PathDescr *PathDescrMoveTo::clone() const
+namespace {
+
+constexpr std::size_t DESCR_SLOT_SIZE = std::max({sizeof(PathDescrMoveTo), sizeof(PathDescrLineTo),
+                                                  sizeof(PathDescrCubicTo), sizeof(PathDescrArcTo),
+                                                  sizeof(PathDescrForced), sizeof(PathDescrClose)});
+// Chunks double in size from the first to the last size, and stay at that.
+constexpr std::size_t DESCR_FIRST_CHUNK_SLOTS = 16;
+constexpr std::size_t DESCR_MAX_CHUNK_SLOTS = 1024;
+
+} // namespace
+
+struct PathDescrSlot
+{
+    PathDescrStorage *storage; ///< Null for commands from the general-purpose allocator.
+    union
+    {
+        PathDescrSlot *next;
+        alignas(std::max_align_t) std::byte bytes[DESCR_SLOT_SIZE];
+    } u;
+};
+
+PathDescrStorage::~PathDescrStorage()
+{
+    for (auto chunk : _chunks) {
+        delete[] chunk;
+    }
+}
+
+void *PathDescrStorage::allocate()
+{
+    PathDescrSlot *slot;
+    if (_free) {
+        slot = _free;
+        _free = slot->u.next;
+    } else {
+        if (!_left) {
+            _chunk_slots = _chunk_slots ? std::min(2 * _chunk_slots, DESCR_MAX_CHUNK_SLOTS) : DESCR_FIRST_CHUNK_SLOTS;
+            _next = new PathDescrSlot[_chunk_slots];
+            _left = _chunk_slots;
+            _chunks.push_back(_next);
+        }
+        slot = _next++;
+        _left--;
+    }
+    slot->storage = this;
+    return slot->u.bytes;
+}
+
+void PathDescrStorage::deallocate(PathDescrSlot *slot)
+{
+    slot->u.next = _free;
+    _free = slot;
+}
+
+static PathDescrSlot *slot_of(void *ptr)
+{
+    return reinterpret_cast<PathDescrSlot *>(static_cast<std::byte *>(ptr) - offsetof(PathDescrSlot, u));
+}
+
+void *PathDescr::operator new(std::size_t size)
+{
+    // Same layout as a slot, so that delete can tell both kinds apart.
+    auto const slot = static_cast<PathDescrSlot *>(::operator new(offsetof(PathDescrSlot, u) + size));
+    slot->storage = nullptr;
+    return slot->u.bytes;
+}
+
+void *PathDescr::operator new(std::size_t size, PathDescrStorage &storage)
+{
+    if (size > DESCR_SLOT_SIZE) {
+        return operator new(size);
+    }
+    return storage.allocate();
+}
+
+void PathDescr::operator delete(void *ptr, std::size_t /*size*/)
+{
+    if (!ptr) {
+        return;
+    }
+    auto const slot = slot_of(ptr);
+    if (slot->storage) {
+        slot->storage->deallocate(slot);
+    } else {
+        ::operator delete(slot);
+    }
+}
+
+void PathDescr::operator delete(void *ptr, PathDescrStorage &/*storage*/)
+{
+    // Only called if a constructor throws.
+    operator delete(ptr, 0);
+}
+
+PathDescr *PathDescrMoveTo::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrMoveTo(*this);
+    return storage ? new (*storage) PathDescrMoveTo(*this) : new PathDescrMoveTo(*this);
 }
 
 void PathDescrMoveTo::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const &/*last*/) const
@@ -31,9 +129,9 @@ void PathDescrLineTo::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const &
     s << "L " << p[Geom::X] << " " << p[Geom::Y] << " ";
 }
 
-PathDescr *PathDescrLineTo::clone() const
+PathDescr *PathDescrLineTo::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrLineTo(*this);
+    return storage ? new (*storage) PathDescrLineTo(*this) : new PathDescrLineTo(*this);
 }
 
 void PathDescrLineTo::dump(std::ostream &s) const
@@ -54,9 +152,9 @@ void PathDescrCubicTo::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const
       << p[Geom::Y] << " ";
 }
 
-PathDescr *PathDescrCubicTo::clone() const
+PathDescr *PathDescrCubicTo::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrCubicTo(*this);
+    return storage ? new (*storage) PathDescrCubicTo(*this) : new PathDescrCubicTo(*this);
 }
 
 void PathDescrCubicTo::dump(std::ostream &s) const
@@ -80,9 +178,9 @@ void PathDescrArcTo::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const &/
       << p[Geom::Y] << " ";
 }
 
-PathDescr *PathDescrArcTo::clone() const
+PathDescr *PathDescrArcTo::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrArcTo(*this);
+    return storage ? new (*storage) PathDescrArcTo(*this) : new PathDescrArcTo(*this);
 }
 
 void PathDescrArcTo::dump(std::ostream &s) const
@@ -96,9 +194,9 @@ void PathDescrArcTo::dump(std::ostream &s) const
       << (large ? 1 : 0);
 }
 
-PathDescr *PathDescrForced::clone() const
+PathDescr *PathDescrForced::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrForced(*this);
+    return storage ? new (*storage) PathDescrForced(*this) : new PathDescrForced(*this);
 }
 
 void PathDescrClose::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const &/*last*/) const
@@ -106,9 +204,9 @@ void PathDescrClose::dumpSVG(Inkscape::SVGOStringStream& s, Geom::Point const &/
     s << "z ";
 }
 
-PathDescr *PathDescrClose::clone() const
+PathDescr *PathDescrClose::clone(PathDescrStorage *storage) const
 {
-    return new PathDescrClose(*this);
+    return storage ? new (*storage) PathDescrClose(*this) : new PathDescrClose(*this);
 }
 
 
@@ -10,6 +10,8 @@
 #ifndef SEEN_INKSCAPE_LIVAROT_PATH_DESCRIPTION_H
 #define SEEN_INKSCAPE_LIVAROT_PATH_DESCRIPTION_H
 
+#include <cstddef>
+#include <vector>
 #include <2geom/point.h>
 #include "svg/stringstream.h"
 
@@ -39,6 +41,34 @@ enum
                               with the type. */
 };
 
+struct PathDescrSlot;
+
+/**
+ * Fixed-size slots for the path commands of one Path. Slots are taken from chunks that grow with
+ * the path, and slots of deleted commands are reused by the same path. Chunks are only released
+ * with the storage. Like the path owning it, storage is used by one thread at a time, so it
+ * needs no lock.
+ */
+class PathDescrStorage
+{
+public:
+    PathDescrStorage() = default;
+    // Commands are never shared between paths, so a copy starts out empty.
+    PathDescrStorage(PathDescrStorage const &) {}
+    PathDescrStorage &operator=(PathDescrStorage const &) { return *this; }
+    ~PathDescrStorage();
+
+    void *allocate();
+    void deallocate(PathDescrSlot *slot);
+
+private:
+    std::vector<PathDescrSlot *> _chunks;
+    PathDescrSlot *_free = nullptr;
+    PathDescrSlot *_next = nullptr;
+    std::size_t _left = 0;
+    std::size_t _chunk_slots = 0;
+};
+
 /**
  * A base class for Livarot's path commands. Each curve type such as Line, CubicBezier
  * derives from this base class.
@@ -49,6 +79,18 @@ struct PathDescr
   PathDescr(int f) : flags(f), associated(-1), tSt(0), tEn(1) {}
   virtual ~PathDescr() = default;
 
+  /**
+   * The commands of a Path are placed in its own storage with `new (path->descr_storage)`.
+   * Long paths create and destroy commands by the hundred thousand; the storage recycles their
+   * slots instead of going through the general-purpose allocator for each one, and keeps the
+   * commands of a path next to each other in memory. Other commands come from the
+   * general-purpose allocator. Either kind is destroyed with delete.
+   */
+  static void *operator new(std::size_t size);
+  static void *operator new(std::size_t size, PathDescrStorage &storage);
+  static void operator delete(void *ptr, std::size_t size);
+  static void operator delete(void *ptr, PathDescrStorage &storage);
+
   int getType() const { return flags & descr_type_mask; }
   void setType(int t) {
     flags &= ~descr_type_mask;
@@ -67,9 +109,9 @@ struct PathDescr
 
     /**
      * A virtual function that derived classes will implement. Returns a newly allocated copy
-     * of the path description.
+     * of the path description, placed in @a storage if given.
      */
-    virtual PathDescr *clone() const = 0;
+    virtual PathDescr *clone(PathDescrStorage *storage = nullptr) const = 0;
 
     /**
      * A virtual function that derived classes will implement. Similar to dumpSVG however this
@@ -96,7 +138,7 @@ struct PathDescrMoveTo : public PathDescr
       : PathDescr(descr_moveto), p(pp) {}
 
   void dumpSVG(Inkscape::SVGOStringStream &s, Geom::Point const &last) const override;
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
   void dump(std::ostream &s) const override;
 
   Geom::Point p; /*!< The point to move to. */
@@ -111,7 +153,7 @@ struct PathDescrLineTo : public PathDescr
     : PathDescr(descr_lineto), p(pp) {}
 
   void dumpSVG(Inkscape::SVGOStringStream &s, Geom::Point const &last) const override;
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
   void dump(std::ostream &s) const override;
 
   Geom::Point p; /*!< The point to draw a line to. */
@@ -133,7 +175,7 @@ struct PathDescrCubicTo : public PathDescr
     : PathDescr(descr_cubicto), p(pp), start(s), end(e) {}
 
   void dumpSVG(Inkscape::SVGOStringStream &s, Geom::Point const &last) const override;
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
   void dump(std::ostream &s) const override;
 
   Geom::Point p;     /*!< The final point of the bezier curve. */
@@ -154,7 +196,7 @@ struct PathDescrArcTo : public PathDescr
     : PathDescr(descr_arcto), p(pp), rx(x), ry(y), angle(a), large(l), clockwise(c) {}
 
   void dumpSVG(Inkscape::SVGOStringStream &s, Geom::Point const &last) const override;
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
   void dump(std::ostream &s) const override;
 
   Geom::Point p;   /*!< The final point of the arc. */
@@ -174,7 +216,7 @@ struct PathDescrForced : public PathDescr
 {
   PathDescrForced() : PathDescr(descr_forced), p(0, 0) {}
 
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
 
   /* FIXME: not sure whether _forced should have a point associated with it;
   ** Path::ConvertForcedToMoveTo suggests that maybe it should.
@@ -191,7 +233,7 @@ struct PathDescrClose : public PathDescr
   PathDescrClose() : PathDescr(descr_close) {}
 
   void dumpSVG(Inkscape::SVGOStringStream &s, Geom::Point const &last) const override;
-  PathDescr *clone() const override;
+  PathDescr *clone(PathDescrStorage *storage = nullptr) const override;
 
   /* FIXME: not sure whether _forced should have a point associated with it;
   ** Path::ConvertForcedToMoveTo suggests that maybe it should.
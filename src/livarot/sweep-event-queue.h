@@ -87,6 +87,19 @@ public:
      */
     void relocate(SweepEvent *e, int to);
 
+    /**
+     * Get an empty queue able to hold `s` events, reusing the storage of the last queue handed
+     * back through release() on this thread when it is large enough.
+     *
+     * @param s The number of events it should be able to hold.
+     */
+    static SweepEventQueue *acquire(int s);
+
+    /**
+     * Give back a queue obtained from acquire(). Null is allowed.
+     */
+    static void release(SweepEventQueue *queue);
+
 private:
     int nbEvt;           /*!< Number of events currently in the heap. */
     int maxEvt;          /*!< Allocated size of the heap. */
@@ -7,7 +7,9 @@
  * Copyright (C) 2018 Authors
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
+#include <cstddef>
 #include <glib.h>
+#include <memory>
 #include "livarot/sweep-event-queue.h"
 #include "livarot/sweep-tree.h"
 #include "livarot/sweep-event.h"
@@ -28,6 +30,45 @@ SweepEventQueue::~SweepEventQueue()
     delete []inds;
 }
 
+namespace {
+thread_local std::unique_ptr<SweepEventQueue> spare_event_queue;
+
+// Storage larger than this is not kept between sweeps, so that one huge path operation does not
+// pin its memory for the lifetime of the thread.
+constexpr std::size_t MAX_SPARE_BYTES = 4 * 1024 * 1024;
+// Spare storage this many times larger than a sweep needs is shrunk to the need.
+constexpr int MAX_SPARE_FACTOR = 4;
+} // namespace
+
+SweepEventQueue *SweepEventQueue::acquire(int s)
+{
+    auto queue = spare_event_queue.release();
+    if (!queue) {
+        return new SweepEventQueue(s);
+    }
+
+    if (queue->maxEvt < s || queue->maxEvt > MAX_SPARE_FACTOR * s) {
+        g_free(queue->events);
+        delete []queue->inds;
+        queue->maxEvt = s;
+        queue->events = (SweepEvent *) g_malloc(s * sizeof(SweepEvent));
+        queue->inds = new int[s];
+    }
+    queue->nbEvt = 0;
+    return queue;
+}
+
+void SweepEventQueue::release(SweepEventQueue *queue)
+{
+    // Keep whichever of the two queues has the larger storage, within bounds.
+    if (queue && queue->maxEvt * (sizeof(SweepEvent) + sizeof(int)) <= MAX_SPARE_BYTES &&
+        (!spare_event_queue || spare_event_queue->maxEvt < queue->maxEvt)) {
+        spare_event_queue.reset(queue);
+    } else {
+        delete queue;
+    }
+}
+
 SweepEvent *SweepEventQueue::add(SweepTree *iLeft, SweepTree *iRight, Geom::Point &px, double itl, double itr)
 {
     if (nbEvt > maxEvt) {
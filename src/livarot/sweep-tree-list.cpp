@@ -8,9 +8,21 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 #include <glib.h>
+#include <cstddef>
+#include <memory>
 #include "livarot/sweep-tree.h"
 #include "livarot/sweep-tree-list.h"
 
+namespace {
+thread_local std::unique_ptr<SweepTreeList> spare_tree_list;
+
+// Storage larger than this is not kept between sweeps, so that one huge path operation does not
+// pin its memory for the lifetime of the thread.
+constexpr std::size_t MAX_SPARE_BYTES = 4 * 1024 * 1024;
+// Spare storage this many times larger than a sweep needs is shrunk to the need.
+constexpr int MAX_SPARE_FACTOR = 4;
+} // namespace
+
 
 SweepTreeList::SweepTreeList(int s) :
     nbTree(0),
@@ -31,6 +43,36 @@ SweepTreeList::~SweepTreeList()
 }
 
 
+SweepTreeList *SweepTreeList::acquire(int s)
+{
+    auto list = spare_tree_list.release();
+    if (!list) {
+        return new SweepTreeList(s);
+    }
+
+    if (list->maxTree < s || list->maxTree > MAX_SPARE_FACTOR * s) {
+        g_free(list->trees);
+        list->trees = (SweepTree *) g_malloc(s * sizeof(SweepTree));
+        list->maxTree = s;
+    }
+    list->nbTree = 0;
+    list->racine = nullptr;
+    return list;
+}
+
+
+void SweepTreeList::release(SweepTreeList *list)
+{
+    // Keep whichever of the two lists has the larger storage, within bounds.
+    if (list && list->maxTree * sizeof(SweepTree) <= MAX_SPARE_BYTES &&
+        (!spare_tree_list || spare_tree_list->maxTree < list->maxTree)) {
+        spare_tree_list.reset(list);
+    } else {
+        delete list;
+    }
+}
+
+
 SweepTree *SweepTreeList::add(Shape *iSrc, int iBord, int iWeight, int iStartPoint, Shape */*iDst*/)
 {
     if (nbTree >= maxTree) {
@@ -33,7 +33,7 @@ class SweepTree;
 class SweepTreeList {
 public:
     int nbTree;          /*!< Number of nodes in the tree. */
-    int const maxTree;   /*!< Max number of nodes in the tree. */
+    int maxTree;         /*!< Max number of nodes in the tree. */
     SweepTree *trees;    /*!< The array of nodes. */
     SweepTree *racine;   /*!< Root of the tree. */
 
@@ -67,6 +67,20 @@ public:
      * else.
      */
     SweepTree *add(Shape *iSrc, int iBord, int iWeight, int iStartPoint, Shape *iDst);
+
+    /**
+     * Get an empty list able to hold `s` nodes. The storage of the last list handed back
+     * through release() on this thread is reused when it is large enough, so repeated sweeps
+     * (e.g. the tweak tool on every motion event) don't allocate.
+     *
+     * @param s The number of maximum nodes it should be able to hold.
+     */
+    static SweepTreeList *acquire(int s);
+
+    /**
+     * Give back a list obtained from acquire(). Null is allowed.
+     */
+    static void release(SweepTreeList *list);
 };
 
 
@@ -277,7 +277,7 @@ void ColorsExtractor::extractObjectColors(SPObject *object, ObjectStyleType type
             extractObjectColors(&child, type);
         }
     } else if (auto use = cast<SPUse>(object)) {
-        extractObjectStyle(use->child, type, use);
+        extractObjectStyle(use->sharedChild(), type, use);
     } else if (object) {
         extractObjectStyle(object, type);
     }
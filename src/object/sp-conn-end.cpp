@@ -122,14 +122,9 @@ static bool try_get_intersect_point_with_item(SPPath* conn, SPItem* item,
 }
 
 
-static void sp_conn_get_route_and_redraw(SPPath *const path, const bool updatePathRepr = true)
+// Cut the path's curve where it enters the items it is attached to.
+static void sp_conn_trim_to_attached_items(SPPath *const path)
 {
-    // Get the new route around obstacles.
-    bool rerouted = path->connEndPair.reroutePathFromLibavoid();
-    if (!rerouted) {
-        return;
-    }
-
     SPItem *h2attItem[2] = {nullptr};
     path->connEndPair.getAttachedItems(h2attItem);
 
@@ -150,6 +145,17 @@ static void sp_conn_get_route_and_redraw(SPPath *const path, const bool updatePa
         }
     }
     change_endpts(path, endPos);
+}
+
+static void sp_conn_get_route_and_redraw(SPPath *const path, const bool updatePathRepr = true)
+{
+    // Get the new route around obstacles.
+    bool rerouted = path->connEndPair.reroutePathFromLibavoid();
+    if (!rerouted) {
+        return;
+    }
+
+    sp_conn_trim_to_attached_items(path);
     if (updatePathRepr) {
         path->updateRepr();
         path->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
@@ -187,6 +193,17 @@ void sp_conn_redraw_path(SPPath *const path)
     sp_conn_get_route_and_redraw(path);
 }
 
+/**
+ * Show a route that was not computed by the document's router, given in document coordinates.
+ * Like dragging, this leaves the repr alone.
+ */
+void sp_conn_redraw_path_interim(SPPath *const path, Geom::PathVector route)
+{
+    route *= path->i2doc_affine().inverse();
+    path->setCurve(std::move(route));
+    sp_conn_trim_to_attached_items(path);
+}
+
 
 static void change_endpts(SPPath *path, double endPos[2])
 {
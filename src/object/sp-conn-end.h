@@ -12,6 +12,7 @@
 
 #include <cstddef>
 #include <sigc++/connection.h>
+#include <2geom/pathvector.h>
 
 #include "sp-use-reference.h"
 #include "conn-avoid-ref.h"
@@ -55,6 +56,7 @@ void sp_conn_end_href_changed(SPObject *old_ref, SPObject *ref,
 void sp_conn_reroute_path(SPPath *const path);
 void sp_conn_reroute_path_immediate(SPPath *const path);
 void sp_conn_redraw_path(SPPath *const path);
+void sp_conn_redraw_path_interim(SPPath *const path, Geom::PathVector route);
 void sp_conn_end_detach(SPObject *const owner, unsigned const handle_ix);
 
 #endif /* !SEEN_SP_CONN_END */
@@ -322,7 +322,7 @@ static std::unique_ptr<Shape> extract_shape(SPItem *item)
     Geom::Affine tr_mat;
     auto *shape_source = item;
     if (auto use = cast<SPUse>(item)) {
-        shape_source = use->child;
+        shape_source = use->sharedChild();
         tr_mat = use->getRelativeTransform(item->parent);
     } else {
         tr_mat = item->transform;
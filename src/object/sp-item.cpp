@@ -272,6 +272,20 @@ bool SPItem::isHidden(unsigned display_key) const
     return true;
 }
 
+void SPItem::setHiddenInView(unsigned display_key, bool hidden)
+{
+    for (auto &v : views) {
+        if (v.key == display_key) {
+            if (hidden) {
+                v.flags |= SP_ITEM_VIEW_HIDDEN;
+            } else {
+                v.flags &= ~SP_ITEM_VIEW_HIDDEN;
+            }
+            v.drawingitem->setVisible(!hidden && !isHidden());
+        }
+    }
+}
+
 void SPItem::setHighlight(Inkscape::Colors::Color color) {
     _highlightColor = std::move(color);
     updateRepr();
@@ -567,7 +581,9 @@ void SPItem::set(SPAttr key, gchar const* value) {
     switch (key) {
         case SPAttr::TRANSFORM: {
             Geom::Affine t;
-            if (value && sp_svg_transform_read(value, &t)) {
+            if (auto preparsed = value ? document->takePreparsedTransform(getRepr(), value) : std::nullopt) {
+                item->set_item_transform(*preparsed);
+            } else if (value && sp_svg_transform_read(value, &t)) {
                 item->set_item_transform(t);
             } else {
                 item->set_item_transform(Geom::identity());
@@ -819,7 +835,7 @@ void SPItem::update(SPCtx *ctx, unsigned flags)
                 v.drawingitem->setAntialiasing(style->shape_rendering.computed == SP_CSS_SHAPE_RENDERING_CRISPEDGES ? Inkscape::Antialiasing::None : Inkscape::Antialiasing::Good);
                 v.drawingitem->setIsolation(style->isolation.value);
                 v.drawingitem->setBlendMode(style->mix_blend_mode.value);
-                v.drawingitem->setVisible(!isHidden());
+                v.drawingitem->setVisible(!isHidden() && !(v.flags & SP_ITEM_VIEW_HIDDEN));
             }
         }
     }
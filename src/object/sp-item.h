@@ -85,6 +85,11 @@ enum SPItemKey
  */
 #define SP_ITEM_REFERENCE_FLAGS (1 << 1)
 
+/**
+ * Set on a view that is hidden in its display only, see SPItem::setHiddenInView().
+ */
+#define SP_ITEM_VIEW_HIDDEN (1 << 2)
+
 /**
  * Contains transformations to document/viewport and the viewport size.
  */
@@ -187,6 +192,12 @@ public:
     bool unoptimized();
     bool isHidden(unsigned display_key) const;
 
+    /**
+     * Hide or show the item in the display with the given key only, e.g. to leave it out of an
+     * export. Unlike toggling the drawing item, this survives updates of the item.
+     */
+    void setHiddenInView(unsigned display_key, bool hidden);
+
     /**
      * Returns something suitable for the `Hide' checkbox in the Object Properties dialog box.
      *  Corresponds to setExplicitlyHidden.
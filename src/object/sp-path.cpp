@@ -24,6 +24,7 @@
 #include <2geom/curves.h>
 
 #include "attributes.h"
+#include "document.h"
 #include "sp-guide.h"
 #include "sp-lpe-item.h"
 #include "style.h"
@@ -184,6 +185,9 @@ void SPPath::build(SPDocument *document, Inkscape::XML::Node *repr) {
 
 void SPPath::release() {
     this->connEndPair.release();
+    if (!cloned) {
+        document->forgetClonePath(getRepr());
+    }
 
     SPShape::release();
 }
@@ -199,8 +203,17 @@ void SPPath::set(SPAttr key, const gchar* value) {
             break;
 
        case SPAttr::D:
+            if (!cloned) {
+                document->forgetClonePath(getRepr());
+            }
             if (value) {
-                setCurve(sp_svg_read_pathv(value));
+                if (auto pathv = document->takePreparsedPath(getRepr(), value)) {
+                    setCurve(std::move(*pathv));
+                } else if (cloned) {
+                    setCurve(document->getClonePath(getRepr(), value));
+                } else {
+                    setCurve(sp_svg_read_pathv(value));
+                }
             } else {
                 setCurve(nullptr);
             }
@@ -14,7 +14,9 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <sstream>
 
 #include <2geom/transforms.h>
 #include <glibmm/i18n.h>
@@ -42,6 +44,7 @@
 #include "uri.h"
 
 #include "display/drawing-group.h"
+#include "display/drawing-instance.h"
 #include "xml/document.h"                            // for Document
 #include "xml/href-attribute-helper.h"               // for getHrefAttribute
 
@@ -97,6 +100,8 @@ void SPUse::build(SPDocument *document, Inkscape::XML::Node *repr) {
 }
 
 void SPUse::release() {
+    leave_instancing();
+
     if (this->child) {
         this->detach(this->child);
         this->child = nullptr;
@@ -182,6 +187,7 @@ Inkscape::XML::Node* SPUse::write(Inkscape::XML::Document *xml_doc, Inkscape::XM
         repr->setAttributeOrRemoveIfEmpty(href_key, uri_string);
     }
 
+    auto const child = sharedChild();
     if (auto shape = cast<SPShape>(child)) {
         shape->set_shape(); // evaluate curve of child
     } else if (auto text = cast<SPText>(child)) {
@@ -199,7 +205,7 @@ Inkscape::XML::Node* SPUse::write(Inkscape::XML::Document *xml_doc, Inkscape::XM
 Geom::OptRect SPUse::bbox(Geom::Affine const &transform, SPItem::BBoxType bboxtype) const {
     Geom::OptRect bbox;
 
-    if (this->child) {
+    if (auto const child = sharedChild()) {
         Geom::Affine const ct(child->transform * Geom::Translate(this->x.computed, this->y.computed) * transform );
 
         bbox = child->bounds(bboxtype, ct);
@@ -235,8 +241,8 @@ void SPUse::print(SPPrintContext* ctx) {
         ctx->bind(Geom::Translate(this->x.computed, this->y.computed), 1.0);
     }
 
-    if (this->child) {
-        this->child->invoke_print(ctx);
+    if (auto const child = sharedChild()) {
+        child->invoke_print(ctx);
     }
 
     if (has_xy_offset()) {
@@ -245,7 +251,7 @@ void SPUse::print(SPPrintContext* ctx) {
 }
 
 const char* SPUse::typeName() const {
-    if (is<SPSymbol>(child)) {
+    if (is<SPSymbol>(sharedChild())) {
         return "symbol";
     } else {
         return "clone";
@@ -253,7 +259,7 @@ const char* SPUse::typeName() const {
 }
 
 const char* SPUse::displayName() const {
-    if (is<SPSymbol>(child)) {
+    if (is<SPSymbol>(sharedChild())) {
         return _("Symbol");
     } else {
         return _("Clone");
@@ -261,7 +267,7 @@ const char* SPUse::displayName() const {
 }
 
 gchar* SPUse::description() const {
-    if (child) {
+    if (auto const child = sharedChild()) {
         if (is<SPSymbol>(child)) {
             if (child->title()) {
                 return g_strdup_printf(_("called %s"), Glib::Markup::escape_text(Glib::ustring( g_dpgettext2(nullptr, "Symbol", child->title()))).c_str());
@@ -283,7 +289,7 @@ gchar* SPUse::description() const {
         }
 
         ++recursion_depth;
-        char *child_desc = this->child->detailedDescription();
+        char *child_desc = child->detailedDescription();
         --recursion_depth;
 
         char *ret = g_strdup_printf(_("of: %s"), child_desc);
@@ -312,6 +318,9 @@ Inkscape::DrawingItem* SPUse::show(Inkscape::Drawing &drawing, unsigned int key,
 
         Geom::Translate t(this->x.computed, this->y.computed);
         ai->setChildTransform(t);
+    } else if (_master) {
+        ai->prependChild(new Inkscape::DrawingInstance(drawing, _master->acquire_prototype(drawing, flags)));
+        ai->setChildTransform(Geom::Translate(x.computed, y.computed));
     }
 
     return ai;
@@ -320,6 +329,13 @@ Inkscape::DrawingItem* SPUse::show(Inkscape::Drawing &drawing, unsigned int key,
 void SPUse::hide(unsigned int key) {
     if (this->child) {
         this->child->invoke_hide(key);
+    } else if (_master) {
+        // The view is still there, its DrawingInstance is deleted with it.
+        for (auto &v : views) {
+            if (v.key == key) {
+                _master->release_prototype(v.drawingitem->drawing());
+            }
+        }
     }
 
 //  SPItem::onHide(key);
@@ -335,11 +351,11 @@ void SPUse::hide(unsigned int key) {
  * the trivial case) and not the "true original". If you want the true original, use trueOriginal().
  */
 SPItem *SPUse::root() {
-    SPItem *orig = this->child;
+    SPItem *orig = sharedChild();
 
     auto use = cast<SPUse>(orig);
     while (orig && use) {
-        orig = use->child;
+        orig = use->sharedChild();
         use = cast<SPUse>(orig);
     }
 
@@ -412,11 +428,11 @@ bool SPUse::anyInChain(bool (*predicate)(SPItem const *)) const
  */
 int SPUse::cloneDepth() const {
     unsigned depth = 1;
-    SPItem *orig = this->child;
+    SPItem *orig = sharedChild();
 
     while (orig && cast<SPUse>(orig)) {
         ++depth;
-        orig = cast<SPUse>(orig)->child;
+        orig = cast<SPUse>(orig)->sharedChild();
     }
 
     if (!orig) {
@@ -433,14 +449,14 @@ int SPUse::cloneDepth() const {
 Geom::Affine SPUse::get_root_transform() const
 {
     //track the ultimate source of a chain of uses
-    SPObject *orig = this->child;
+    SPObject *orig = sharedChild();
 
     std::vector<SPItem const *> chain;
     chain.push_back(this);
 
     while (cast<SPUse>(orig)) {
         chain.push_back(cast<SPItem>(orig));
-        orig = cast<SPUse>(orig)->child;
+        orig = cast<SPUse>(orig)->sharedChild();
     }
 
     chain.push_back(cast<SPItem>(orig));
@@ -591,6 +607,8 @@ void SPUse::href_changed() {
     this->_delete_connection.disconnect();
     this->_transformed_connection.disconnect();
 
+    leave_instancing();
+
     if (this->child) {
         this->detach(this->child);
         this->child = nullptr;
@@ -600,26 +618,42 @@ void SPUse::href_changed() {
         SPItem *refobj = this->ref->getObject();
 
         if (refobj) {
-            Inkscape::XML::Node *childrepr = refobj->getRepr();
+            auto key = instance_key(refobj);
+            auto const master = key.empty() ? nullptr : document->getCloneMaster(key);
 
-            SPObject* obj = SPFactory::createObject(NodeTraits::get_type_string(*childrepr));
+            if (master) {
+                attach_to_master(master, std::move(key));
+            } else {
+                Inkscape::XML::Node *childrepr = refobj->getRepr();
 
-            auto item = cast<SPItem>(obj);
-            if (item) {
-                child = item;
+                SPObject* obj = SPFactory::createObject(NodeTraits::get_type_string(*childrepr));
 
-                this->attach(this->child, this->lastChild());
-                sp_object_unref(this->child, this);
+                auto item = cast<SPItem>(obj);
+                if (item) {
+                    child = item;
 
-                this->child->invoke_build(refobj->document, childrepr, TRUE);
+                    this->attach(this->child, this->lastChild());
+                    sp_object_unref(this->child, this);
 
-                for (auto &v : views) {
-                    auto ai = this->child->invoke_show(v.drawingitem->drawing(), v.key, v.flags);
-                    if (ai) {
-                        v.drawingitem->prependChild(ai);
+                    this->child->invoke_build(refobj->document, childrepr, TRUE);
+
+                    for (auto &v : views) {
+                        auto ai = this->child->invoke_show(v.drawingitem->drawing(), v.key, v.flags);
+                        if (ai) {
+                            v.drawingitem->prependChild(ai);
+                        }
+                    }
+
+                    if (!key.empty()) {
+                        _instance_key = std::move(key);
+                        document->setCloneMaster(_instance_key, this);
                     }
+                } else {
+                    delete obj;
                 }
+            }
 
+            if (child || _master) {
                 this->_delete_connection = refobj->connectDelete(
                     sigc::hide(sigc::mem_fun(*this, &SPUse::delete_self))
                 );
@@ -627,13 +661,142 @@ void SPUse::href_changed() {
                 this->_transformed_connection = refobj->connectTransformed(
                     sigc::hide(sigc::mem_fun(*this, &SPUse::move_compensate))
                 );
-            } else {
-                delete obj;
             }
         }
     }
 }
 
+/**
+ * The key under which uses of @a original share their child in clone instancing mode, or an
+ * empty string if this use builds its own.
+ *
+ * The content inherits its style from the use, and a symbol is laid out in the viewport of the
+ * use. So the key holds the size of the use, all the style properties set on it, and the
+ * inheritable ones set on its ancestors. Their computed values are not known before the first
+ * update, but the same specified values lead to the same computed ones.
+ */
+std::string SPUse::instance_key(SPItem const *original) const
+{
+    if (cloned || !original || !Inkscape::Preferences::get()->getBool("/options/cloneinstancing/value", false)) {
+        return {};
+    }
+
+    auto const attribute = [this] (char const *name) {
+        auto const value = getAttribute(name);
+        return value ? value : "";
+    };
+
+    std::ostringstream key;
+    key << original << '|' << attribute("width") << '|' << attribute("height");
+    bool own = true;
+    for (auto object = static_cast<SPObject const *>(this); object; object = object->parent) {
+        key << '|';
+        if (!object->style) {
+            continue;
+        }
+        for (auto property : object->style->properties()) {
+            if (property->set && (own || property->inherits)) {
+                key << property->name() << ':' << property->get_value() << ';';
+            }
+        }
+        own = false;
+    }
+    return key.str();
+}
+
+void SPUse::attach_to_master(SPUse *master, std::string key)
+{
+    _master = master;
+    _instance_key = std::move(key);
+    _master->_instances.push_back(this);
+
+    for (auto &v : views) {
+        show_instance(v);
+    }
+}
+
+void SPUse::show_instance(SPItemView &view)
+{
+    auto &drawing = view.drawingitem->drawing();
+    view.drawingitem->prependChild(new Inkscape::DrawingInstance(drawing, _master->acquire_prototype(drawing, view.flags)));
+    cast<Inkscape::DrawingGroup>(view.drawingitem.get())->setChildTransform(Geom::Translate(x.computed, y.computed));
+}
+
+void SPUse::detach_from_master()
+{
+    for (auto &v : views) {
+        _master->release_prototype(v.drawingitem->drawing());
+        v.drawingitem->clearChildren();
+    }
+
+    auto &instances = _master->_instances;
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+    _master = nullptr;
+    _instance_key.clear();
+}
+
+/**
+ * Stop sharing the child of a master, or as a master, let the instances find another one. They
+ * do so once they are modified next, rather than while this use is being changed or released.
+ */
+void SPUse::leave_instancing()
+{
+    _instance_orphaned = false;
+
+    if (_master) {
+        detach_from_master();
+    } else if (!_instance_key.empty()) {
+        if (document->getCloneMaster(_instance_key) == this) {
+            document->setCloneMaster(_instance_key, nullptr);
+        }
+        for (auto instance : std::vector(_instances)) {
+            instance->detach_from_master();
+            instance->_instance_orphaned = true;
+            instance->requestModified(SP_OBJECT_MODIFIED_FLAG);
+        }
+        _instance_key.clear();
+    }
+}
+
+std::shared_ptr<Inkscape::DrawingPrototype> SPUse::acquire_prototype(Inkscape::Drawing &drawing, unsigned flags)
+{
+    auto &entry = _instance_prototypes[&drawing];
+    if (!entry.prototype) {
+        // The trees are shown with keys of their own, so that they are independent of any view.
+        auto show = [this, &drawing, &entry, flags] () -> Inkscape::DrawingItem * {
+            if (!child) {
+                return nullptr;
+            }
+            auto const key = SPItem::display_key_new(1);
+            auto const item = child->invoke_show(drawing, key, flags);
+            if (item) {
+                entry.keys.emplace(item, key);
+            }
+            return item;
+        };
+        auto hide = [this, &entry] (Inkscape::DrawingItem *item) {
+            auto const it = entry.keys.find(item);
+            if (it != entry.keys.end() && child) {
+                child->invoke_hide(it->second);
+                entry.keys.erase(it);
+            }
+        };
+        entry.prototype = std::make_shared<Inkscape::DrawingPrototype>(drawing, std::move(show), std::move(hide));
+    }
+    entry.users++;
+    return entry.prototype;
+}
+
+void SPUse::release_prototype(Inkscape::Drawing &drawing)
+{
+    auto const it = _instance_prototypes.find(&drawing);
+    if (it == _instance_prototypes.end() || --it->second.users > 0) {
+        return;
+    }
+    it->second.prototype->hideContent();
+    _instance_prototypes.erase(it);
+}
+
 void SPUse::delete_self() {
     // always delete uses which are used in flowtext
     if (parent && cast<SPFlowregion>(parent)) {
@@ -705,6 +868,15 @@ void SPUse::modified(unsigned flags)
     // std::cout << "SPUse::modified: " << (getId()?getId():"null") << std::endl;
     flags = cascade_flags(flags);
 
+    // Find another master, or leave this one when no longer looking the same.
+    if (_instance_orphaned ||
+        ((flags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG)) && (_master || !_instance_key.empty()) &&
+         instance_key(ref->getObject()) != _instance_key))
+    {
+        href_changed();
+        requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
+    }
+
     if (flags & SP_OBJECT_STYLE_MODIFIED_FLAG) {
         for (auto &v : views) {
             auto g = cast<Inkscape::DrawingGroup>(v.drawingitem.get());
@@ -716,10 +888,18 @@ void SPUse::modified(unsigned flags)
     if (child) {
         sp_object_ref(child);
 
-        if (flags || (child->mflags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_CHILD_MODIFIED_FLAG))) {
+        bool const changed = child->mflags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_CHILD_MODIFIED_FLAG);
+        if (flags || changed) {
             child->emitModified(flags);
         }
 
+        // The instances show the child through their own drawing items.
+        if (changed || (flags & SP_OBJECT_STYLE_MODIFIED_FLAG)) {
+            for (auto &[drawing, entry] : _instance_prototypes) {
+                entry.prototype->contentChanged();
+            }
+        }
+
         sp_object_unref(child);
     }
 }
@@ -835,7 +1015,7 @@ SPItem *SPUse::get_original() const
 }
 
 void SPUse::snappoints(std::vector<Inkscape::SnapCandidatePoint> &p, Inkscape::SnapPreferences const *snapprefs) const {
-    SPItem const *child = this->child;
+    SPItem const *child = sharedChild();
 
     if (!child) {
         return;
@@ -845,6 +1025,14 @@ void SPUse::snappoints(std::vector<Inkscape::SnapCandidatePoint> &p, Inkscape::S
     std::vector<Inkscape::SnapCandidatePoint> vec_pts;
     child->snappoints(vec_pts, snapprefs);
 
+    // The child of a master is where the master is, move its points over here.
+    if (_master) {
+        auto const master_to_this = _master->i2dt_affine().inverse() * i2dt_affine();
+        for (auto &it : vec_pts) {
+            it.setPoint(it.getPoint() * master_to_this);
+        }
+    }
+
     // Offset these snap candidate points if the X/Y attributes have been set for this item
     // (see https://gitlab.com/inkscape/inkscape/-/issues/2765)
     if (has_xy_offset()) {
@@ -17,11 +17,20 @@
  */
 
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "sp-dimensions.h"
 #include "sp-item.h"
 
 class SPUseReference;
 
+namespace Inkscape {
+class DrawingPrototype;
+} // namespace Inkscape
+
 class SPUse final : public SPItem, public SPDimensions {
 public:
 	SPUse();
@@ -30,6 +39,7 @@ public:
 
     // item built from the original's repr (the visible clone)
     // relative to the SPUse itself, it is treated as a child, similar to a grouped item relative to its group
+    // In clone instancing mode, only the first of the uses that look the same builds it, see master().
     SPItem *child;
 
     // SVG attrs
@@ -76,10 +86,39 @@ public:
     bool anyInChain(bool (*predicate)(SPItem const *)) const;
 
     void getLinked(std::vector<SPObject *> &objects, LinkedObjectNature direction = LinkedObjectNature::ANY) const override;
+
+    /// In clone instancing mode, the use whose child this one shows, or nullptr if it has its own.
+    SPUse *master() const { return _master; }
+    /// The item this use shows: its own child, or the child of its master. Must not be changed.
+    SPItem *sharedChild() const { return child ? child : _master ? _master->child : nullptr; }
+
 private:
     void href_changed();
     void move_compensate(Geom::Affine const *mp);
     void delete_self();
+
+    std::string instance_key(SPItem const *original) const;
+    void attach_to_master(SPUse *master, std::string key);
+    void detach_from_master();
+    void leave_instancing();
+    void show_instance(SPItemView &view);
+    std::shared_ptr<Inkscape::DrawingPrototype> acquire_prototype(Inkscape::Drawing &drawing, unsigned flags);
+    void release_prototype(Inkscape::Drawing &drawing);
+
+    // Clone instancing: uses that reference the same original with the same inherited style show
+    // the child of one of them, the master, instead of building their own.
+    std::string _instance_key; ///< Set while this is a master or an instance.
+    SPUse *_master = nullptr;
+    std::vector<SPUse *> _instances; ///< Of a master.
+    bool _instance_orphaned = false; ///< Lost its master and has to find another.
+
+    struct InstancePrototype
+    {
+        std::shared_ptr<Inkscape::DrawingPrototype> prototype;
+        unsigned users = 0;
+        std::map<Inkscape::DrawingItem const *, unsigned> keys; ///< Display keys of the shown trees.
+    };
+    std::map<Inkscape::Drawing const *, InstancePrototype> _instance_prototypes; ///< Of a master.
 };
 
 #endif
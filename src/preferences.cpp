@@ -357,6 +357,8 @@ Preferences::Entry const Preferences::getEntry(Glib::ustring const &pref_path)
     // Negative caching is done "implicitly" here by storing std::nullopt in the cache
     // and passing it to Entry().
 
+    // Importers read preferences from worker threads too.
+    std::lock_guard lock(_cache_mutex);
     if (_initialized) {
         // get cached value, if it exists
         auto it = cachedEntry.find(pref_path.raw());
@@ -492,7 +494,10 @@ void Preferences::mergeStyle(Glib::ustring const &pref_path, SPCSSAttr *style)
  */
 void Preferences::remove(Glib::ustring const &pref_path)
 {
-    cachedEntry.erase(pref_path);
+    {
+        std::lock_guard lock(_cache_mutex);
+        cachedEntry.erase(pref_path);
+    }
 
     Inkscape::XML::Node *node = _getNode(pref_path, false);
     if (node && node->parent()) {
@@ -763,6 +768,7 @@ void Preferences::_setRawValue(Glib::ustring const &path, Glib::ustring const &v
     // update cache first, so by the time notification change fires and observers are called,
     // they have access to current settings even if they watch a group
     if (_initialized) {
+        std::lock_guard lock(_cache_mutex);
         cachedEntry[path.raw()] = Entry(path, value);
     }
 
@@ -20,6 +20,7 @@
 #include <glibmm/ustring.h>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -707,6 +708,7 @@ public:
             _prefs_doc->beginTransaction();
         return scope_exit([this,new_transaction] {
             if (new_transaction) {
+                std::lock_guard lock(_cache_mutex);
                 cachedEntry.clear();
                 _prefs_doc->rollback();
             }
@@ -749,6 +751,8 @@ private:
     /// Cache for getEntry()
     // cache key has type std::string because Glib::ustring is slower for equality checks
     std::unordered_map<std::string, Entry> cachedEntry;
+    /// Guards cachedEntry, which getEntry() fills from any thread.
+    std::mutex _cache_mutex;
 
     /// Wrapper class for XML node observers
     class PrefNodeObserver;
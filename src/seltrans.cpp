@@ -157,6 +157,9 @@ Inkscape::SelTrans::~SelTrans()
     _sel_changed_connection.disconnect();
     _sel_modified_connection.disconnect();
 
+    // Destroyed mid-drag (tool switch, desktop closing): don't leave connector routing deferred.
+    _endDeferredRouting();
+
     for (auto &knot : knots) {
         SPKnot::unref(knot);
         knot = nullptr;
@@ -232,6 +235,32 @@ void Inkscape::SelTrans::setCenter(Geom::Point const &p)
     _updateHandles();
 }
 
+/**
+ * Defer connector routing in the document being transformed. The desktop may switch documents
+ * before the grab ends, so the document is remembered until then.
+ */
+void Inkscape::SelTrans::_beginDeferredRouting()
+{
+    _endDeferredRouting();
+    _routing_document = _desktop->getDocument();
+    if (_routing_document) {
+        _routing_document->setRoutingDeferred(true);
+        _routing_document_destroyed = _routing_document->connectDestroy([this] {
+            _routing_document = nullptr;
+            _routing_document_destroyed.disconnect();
+        });
+    }
+}
+
+void Inkscape::SelTrans::_endDeferredRouting()
+{
+    _routing_document_destroyed.disconnect();
+    if (_routing_document) {
+        _routing_document->setRoutingDeferred(false);
+        _routing_document = nullptr;
+    }
+}
+
 void Inkscape::SelTrans::grab(Geom::Point const &p, gdouble x, gdouble y, bool show_handles, bool translating)
 {
     // While dragging a handle, we will either scale, skew, or rotate and the "translating" parameter will be false
@@ -243,6 +272,7 @@ void Inkscape::SelTrans::grab(Geom::Point const &p, gdouble x, gdouble y, bool s
 
     _grabbed = true;
     _show_handles = show_handles;
+    _beginDeferredRouting();
     _updateVolatileState();
     _current_relative_affine.setIdentity();
 
@@ -422,6 +452,7 @@ void Inkscape::SelTrans::ungrab()
     g_return_if_fail(_grabbed);
     _grabbed = false;
     _show_handles = true;
+    _endDeferredRouting();
 
     _desktop->getSnapIndicator()->remove_snapsource();
 
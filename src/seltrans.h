@@ -32,6 +32,7 @@
 #include "ui/knot/knot.h"
 
 class  SPDesktop;
+class SPDocument;
 struct SPCanvasItem;
 struct SPSelTransHandle;
 
@@ -115,6 +116,8 @@ private:
     void _clear_stamp();
     void _updateHandles();
     void _updateVolatileState();
+    void _beginDeferredRouting();
+    void _endDeferredRouting();
     void _selChanged(Inkscape::Selection *selection);
     void _selModified(Inkscape::Selection *selection, unsigned int flags);
     void _boundingBoxPrefsChanged(int prefs_bbox);
@@ -150,6 +153,8 @@ private:
 
     bool _grabbed = false;
     bool _show_handles = true;
+    SPDocument *_routing_document = nullptr; ///< Document whose connector routing the grab defers
+    sigc::connection _routing_document_destroyed;
     bool _empty;
     bool _changed;
 
@@ -32,6 +32,7 @@
 #include "display/cairo-utils.h"
 #include "display/drawing-context.h"
 #include "display/drawing.h"
+#include "display/drawing-sampler.h"
 #include "object/algorithms/unclump.h"
 #include "object/sp-namedview.h"
 #include "object/sp-root.h"
@@ -77,6 +78,7 @@ static constexpr int VB_MARGIN = 4;
 static Glib::ustring const prefs_path = "/dialogs/clonetiler/";
 
 static std::unique_ptr<Inkscape::Drawing> trace_drawing;
+static std::optional<Inkscape::DrawingSampler> trace_sampler;
 static unsigned trace_visionkey;
 static gdouble trace_zoom;
 static SPDocument *trace_doc = nullptr;
@@ -1907,6 +1909,15 @@ void CloneTiler::trace_setup(SPDocument *doc, gdouble zoom, SPItem *original)
     trace_doc->ensureUpToDate();
 
     trace_zoom = zoom;
+
+    // Render the background once; every tile then reads its average colour from the table.
+    trace_drawing->root()->setTransform(Geom::Scale(trace_zoom));
+    trace_drawing->update();
+    if (auto const area = trace_drawing->root()->drawbox()) {
+        if (std::int64_t{area->width()} * area->height() <= Inkscape::DrawingSampler::MAX_PIXELS) {
+            trace_sampler.emplace(*trace_drawing, *area);
+        }
+    }
 }
 
 guint32 CloneTiler::trace_pick(Geom::Rect box)
@@ -1915,6 +1926,11 @@ guint32 CloneTiler::trace_pick(Geom::Rect box)
         return 0;
     }
 
+    if (trace_sampler) {
+        // Nothing is drawn outside the sampled area, so this is exact for any box.
+        return trace_sampler->averageColor((box * Geom::Scale(trace_zoom)).roundOutwards()).toRGBA();
+    }
+
     trace_drawing->root()->setTransform(Geom::Scale(trace_zoom));
     trace_drawing->update();
 
@@ -1936,6 +1952,7 @@ void CloneTiler::trace_finish()
     if (trace_doc) {
         trace_doc->getRoot()->invoke_hide(trace_visionkey);
         trace_doc = nullptr;
+        trace_sampler.reset();
         trace_drawing.reset();
     }
 }
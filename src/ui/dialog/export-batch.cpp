@@ -13,6 +13,7 @@
 
 #include "ui/dialog/export-batch.h"
 
+#include <optional>
 #include <regex>
 #include <glibmm/convert.h>
 #include <glibmm/i18n.h>
@@ -27,6 +28,7 @@
 #include "desktop.h"
 #include "document-undo.h"
 #include "extension/output.h"
+#include "helper/png-write.h"
 #include "inkscape-window.h"
 #include "io/fix-broken-links.h"
 #include "io/sandbox.h"
@@ -750,6 +752,9 @@ void BatchExport::onExport()
     auto sels = _desktop->getSelection()->items();
     std::vector<SPItem const *> selected_items(sels.begin(), sels.end());
 
+    // One display tree serves all raster exports, only visibility and transform change per item.
+    std::optional<SPExportDrawing> drawing;
+
     // Start Exporting Each Item
     for (int j = 0; j < num_rows && !interrupted; j++) {
 
@@ -859,8 +864,15 @@ void BatchExport::onExport()
                 unsigned long int width = (int)(area.width() * dpi / DPI_BASE + 0.5);
                 unsigned long int height = (int)(area.height() * dpi / DPI_BASE + 0.5);
 
+                if (!drawing) {
+                    drawing.emplace(_document);
+                }
                 Export::exportRaster(area, width, height, dpi, _background_color.get_current_color(),
-                                     item_filename_utf8, true, onProgressCallback, this, ext, &show_only);
+                                     item_filename_utf8, true, onProgressCallback, this, ext, &show_only,
+                                     &*drawing);
+            } else if (Export::canExportVectorSubset(ext)) {
+                // Rendered straight from the document, no copy needed.
+                Export::exportVectorSubset(ext, _document, item_filename_utf8, true, show_only, page, area);
             } else if (page || !show_only.empty()) {
                 auto copy_doc = _document->copy();
                 Export::exportVector(ext, copy_doc.get(), item_filename_utf8, true, show_only, page);
@@ -870,6 +882,8 @@ void BatchExport::onExport()
             }
         }
     }
+    drawing.reset();
+
     // Save the export batch path only on successful export
     _document->getRoot()->setAttribute("inkscape:export-batch-path", path.value()->get_parse_name());
     DocumentUndo::done(_document, RC_("Undo", "Set Batch Export Options"), INKSCAPE_ICON("export"));
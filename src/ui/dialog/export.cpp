@@ -17,6 +17,7 @@
 
 #include "export.h"
 
+#include <cairo.h>
 #include <glibmm/convert.h>
 #include <glibmm/fileutils.h>
 #include <glibmm/i18n.h>
@@ -25,6 +26,7 @@
 
 #include "desktop.h"
 #include "extension/output.h"
+#include "extension/internal/cairo-renderer-pdf-out.h"
 #include "helper/png-write.h"
 #include "inkscape.h"
 #include "io/resource.h"
@@ -207,7 +209,8 @@ bool Export::exportRaster(
         Geom::Rect const &area, unsigned long int const &width, unsigned long int const &height,
         float const &dpi, Inkscape::Colors::Color const &bgcolor, Glib::ustring const &filename, bool overwrite,
         unsigned (*callback)(float, void *), void *data,
-        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items)
+        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items,
+        SPExportDrawing *drawing)
 {
     SPDesktop *desktop = SP_ACTIVE_DESKTOP;
     if (!desktop)
@@ -265,10 +268,17 @@ bool Export::exportRaster(
         selected = *items;
     }
 
-    ExportResult result = sp_export_png_file(
-        desktop->getDocument(), Glib::filename_to_utf8(png_filename).c_str(), area, width, height, pHYs,
-        pHYs, // previously xdpi, ydpi.
-        bgcolor, callback, data, true, selected, use_interlacing, color_type, bit_depth, zlib, antialiasing);
+    ExportResult result;
+    if (drawing) {
+        result = sp_export_png_file(
+            *drawing, Glib::filename_to_utf8(png_filename).c_str(), area, width, height, pHYs, pHYs, bgcolor,
+            callback, data, true, selected, use_interlacing, color_type, bit_depth, zlib, antialiasing);
+    } else {
+        result = sp_export_png_file(
+            desktop->getDocument(), Glib::filename_to_utf8(png_filename).c_str(), area, width, height, pHYs,
+            pHYs, // previously xdpi, ydpi.
+            bgcolor, callback, data, true, selected, use_interlacing, color_type, bit_depth, zlib, antialiasing);
+    }
 
     bool failed = result == EXPORT_ERROR; // || prog_dialog->get_stopped();
 
@@ -453,6 +463,69 @@ bool Export::exportVector(
     return true;
 }
 
+/**
+ * Whether exportVectorSubset() can be used with this output extension and its current settings.
+ */
+bool Export::canExportVectorSubset(Inkscape::Extension::Output *extension)
+{
+#ifdef CAIRO_HAS_PDF_SURFACE
+    return extension && Inkscape::Extension::Internal::CairoRendererPdfOutput::canSaveSubset(extension);
+#else
+    return false;
+#endif
+}
+
+/**
+ * Export a page, or an area when there is no page, showing only the given items, straight
+ * from the document. Unlike exportVector() this needs no copy of the document, which makes
+ * batch exports of many items much cheaper.
+ *
+ * @arg filename Filename. Path is absolute or relative to the current document.
+ * Value is in UTF8 encoding.
+ */
+bool Export::exportVectorSubset(
+        Inkscape::Extension::Output *extension, SPDocument *doc,
+        Glib::ustring const &filename,
+        bool overwrite, const std::vector<SPItem const *> &items, SPPage const *page, Geom::Rect const &area)
+{
+    SPDesktop *desktop = SP_ACTIVE_DESKTOP;
+    if (!desktop)
+        return false;
+
+    if (filename.empty()) {
+        desktop->messageStack()->flash(Inkscape::ERROR_MESSAGE, _("You have to enter a filename."));
+        sp_ui_error_dialog(_("You have to enter a filename"));
+        return false;
+    }
+
+    std::string path = absolutizePath(doc, Glib::filename_from_utf8(filename));
+    Glib::ustring safeFile = Inkscape::IO::sanitizeString(path.c_str());
+
+    if (!overwrite && !sp_ui_overwrite_file(path)) {
+        return false;
+    }
+
+    try {
+#ifdef CAIRO_HAS_PDF_SURFACE
+        Inkscape::Extension::Internal::CairoRendererPdfOutput::saveSubset(extension, doc, path.c_str(), items,
+                                                                         page, area);
+#else
+        throw Inkscape::Extension::Output::save_failed();
+#endif
+    } catch (Inkscape::Extension::Output::save_failed &e) {
+        Glib::ustring error = g_strdup_printf(_("Could not export to filename <b>%s</b>.\n"), safeFile.c_str());
+
+        desktop->messageStack()->flash(Inkscape::ERROR_MESSAGE, error.c_str());
+        sp_ui_error_dialog(error.c_str());
+
+        return false;
+    }
+
+    desktop->messageStack()->flashF(Inkscape::INFORMATION_MESSAGE, _("Drawing exported to <b>%s</b>."),
+                                    safeFile.c_str());
+    return true;
+}
+
 std::string Export::filePathFromObject(SPDocument *doc, SPObject *obj, const std::string &file_entry_text)
 {
     Glib::ustring id = _("bitmap");
@@ -22,6 +22,7 @@ class Builder;
 class Notebook;
 } // namespace Gtk
 
+class SPExportDrawing;
 class SPObject;
 class SPPage;
 
@@ -91,7 +92,8 @@ public:
         Geom::Rect const &area, unsigned long int const &width, unsigned long int const &height,
         float const &dpi, Inkscape::Colors::Color const &bgcolor, Glib::ustring const &filename, bool overwrite,
         unsigned (*callback)(float, void *), void *data,
-        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items = nullptr);
+        Inkscape::Extension::Output *extension, std::vector<SPItem const *> *items = nullptr,
+        SPExportDrawing *drawing = nullptr);
   
     static bool exportVector(
         Inkscape::Extension::Output *extension, SPDocument *doc, Glib::ustring const &filename,
@@ -102,6 +104,11 @@ public:
     static bool exportVector(
         Inkscape::Extension::Output *extension, SPDocument *doc, Glib::ustring const &filename,
         bool overwrite, const std::vector<SPItem const *> &items, const std::vector<SPPage const *> &pages);
+
+    static bool canExportVectorSubset(Inkscape::Extension::Output *extension);
+    static bool exportVectorSubset(
+        Inkscape::Extension::Output *extension, SPDocument *doc, Glib::ustring const &filename,
+        bool overwrite, const std::vector<SPItem const *> &items, SPPage const *page, Geom::Rect const &area);
 };
 
 } // namespace UI::Dialog
@@ -2606,6 +2606,12 @@ void InkscapePreferences::initPageBehavior()
     _undo_size.init("/options/undo/size", 1.0, 32000.0, 1.0, 1.0, 200.0, true, false);
     _page_behavior.add_line(false, _("Maximum _Undo Size:"), _undo_size, "",
                          _("How large the undo log will be allowed to get before being trimmed to free memory."), false );
+    _undo_budget.init("/options/undo/budget", 0.0, 65536.0, 16.0, 128.0, 0.0, true, false);
+    _page_behavior.add_line(false, _("Undo _memory budget:"), _undo_budget, _("MiB"),
+                         _("Remove the oldest changes when the undo log holds more memory than this. 0 means no memory budget."), false);
+    _undo_spill.init(_("Move old changes to a temporary file first"), "/options/undo/spill", true);
+    _page_behavior.add_line(false, "", _undo_spill, "",
+                         _("When over the undo memory budget, compress the oldest changes into a temporary file, and only remove changes if that is not enough."));
     _undo_limit.changed_signal.connect(sigc::mem_fun(_undo_size, &Gtk::Widget::set_sensitive));
     _undo_size.set_sensitive(_undo_limit.get_active());
 
@@ -430,7 +430,9 @@ protected:
     // System page
     UI::Widget::PrefSpinButton  _misc_simpl;
     UI::Widget::PrefSpinButton  _undo_size;
+    UI::Widget::PrefSpinButton  _undo_budget;
     UI::Widget::PrefCheckButton _undo_limit;
+    UI::Widget::PrefCheckButton _undo_spill;
     Gtk::Entry                  _sys_user_prefs;
     Gtk::Entry                  _sys_tmp_files;
     Gtk::Entry                  _sys_extension_dir;
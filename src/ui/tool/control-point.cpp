@@ -44,11 +44,23 @@ ControlPoint::ControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAncho
                            Inkscape::CanvasItemCtrlType type,
                            Inkscape::CanvasItemGroup *group)
     : _desktop(d)
+    , _canvas_item_ctrl(group ? group : d->getCanvasControls(), type)
     , _position(initial_pos)
 {
-    _canvas_item_ctrl = make_canvasitem<Inkscape::CanvasItemCtrl>(group ? group : _desktop->getCanvasControls(), type);
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:ControlPoint");
-    _canvas_item_ctrl->set_anchor(anchor);
+    _canvas_item_ctrl.set_name("CanvasItemCtrl:ControlPoint");
+    _canvas_item_ctrl.set_anchor(anchor);
+
+    _commonInit();
+}
+
+ControlPoint::ControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
+                           Inkscape::CanvasItemCtrlType type,
+                           Inkscape::CanvasItemCtrlBatch *batch)
+    : _desktop(d)
+    , _canvas_item_ctrl(batch, type)
+    , _position(initial_pos)
+{
+    _canvas_item_ctrl.set_anchor(anchor);
 
     _commonInit();
 }
@@ -60,7 +72,7 @@ ControlPoint::~ControlPoint()
     // while it holds the mouse grab,
     // Otherwise, Inkscape thinks we are still dragging.
     if (_event_grab) {
-        _canvas_item_ctrl->ungrab();
+        _canvas_item_ctrl.ungrab();
         
         _event_grab = false;
         _drag_initiated = false;
@@ -71,13 +83,13 @@ ControlPoint::~ControlPoint()
         _clearMouseover();
     }
 
-    _canvas_item_ctrl->set_visible(false);
+    _canvas_item_ctrl.set_visible(false);
 }
 
 void ControlPoint::_commonInit()
 {
-    _canvas_item_ctrl->set_position(_position);
-    _event_handler_connection = _canvas_item_ctrl->connect_event([this] (CanvasEvent const &event) {
+    _canvas_item_ctrl.set_position(_position);
+    _canvas_item_ctrl.set_handler([this] (CanvasEvent const &event) {
         // re-routes events into the virtual function   TODO: Refactor this nonsense.
         if (!_desktop) {
             return false;
@@ -89,7 +101,7 @@ void ControlPoint::_commonInit()
 void ControlPoint::setPosition(Geom::Point const &pos)
 {
     _position = pos;
-    _canvas_item_ctrl->set_position(_position);
+    _canvas_item_ctrl.set_position(_position);
 }
 
 void ControlPoint::move(Geom::Point const &pos)
@@ -103,16 +115,12 @@ void ControlPoint::transform(Geom::Affine const &m) {
 
 bool ControlPoint::visible() const
 {
-    return _canvas_item_ctrl->is_visible();
+    return _canvas_item_ctrl.is_visible();
 }
 
 void ControlPoint::setVisible(bool v)
 {
-    if (v) {
-        _canvas_item_ctrl->set_visible(true);
-    } else {
-        _canvas_item_ctrl->set_visible(false);
-    }
+    _canvas_item_ctrl.set_visible(v);
 }
 
 Glib::ustring ControlPoint::format_tip(char const *format, ...)
@@ -131,12 +139,12 @@ Glib::ustring ControlPoint::format_tip(char const *format, ...)
 
 void ControlPoint::_setSize(unsigned int size)
 {
-    _canvas_item_ctrl->_set_size(size);
+    _canvas_item_ctrl._set_size(size);
 }
 
 void ControlPoint::_setControlType(Inkscape::CanvasItemCtrlType type)
 {
-    _canvas_item_ctrl->set_type(type);
+    _canvas_item_ctrl.set_type(type);
 }
 
 // main event callback, which emits all other callbacks.
@@ -189,7 +197,7 @@ bool ControlPoint::_eventHandler(Tools::ToolBase *tool, CanvasEvent const &event
                 pointer_offset = _position - _desktop->w2d(_drag_event_origin);
                 _drag_initiated = false;
                 // route all events to this handler
-                _canvas_item_ctrl->grab(grab_event_mask); // cursor is null
+                _canvas_item_ctrl.grab(grab_event_mask); // cursor is null
                 _event_grab = true;
                 _setState(STATE_CLICKED);
                 ret = true;
@@ -246,7 +254,7 @@ bool ControlPoint::_eventHandler(Tools::ToolBase *tool, CanvasEvent const &event
             // if (_desktop && _desktop->getTool() && _desktop->getTool()->_delayed_snap_event) {
             tool->process_delayed_snap_event();
 
-            _canvas_item_ctrl->ungrab();
+            _canvas_item_ctrl.ungrab();
             _setMouseover(this, event.modifiers);
             _event_grab = false;
 
@@ -303,7 +311,7 @@ bool ControlPoint::_eventHandler(Tools::ToolBase *tool, CanvasEvent const &event
             fake.control_point_synthesized = true;
             dragged(new_pos, fake);
 
-            _canvas_item_ctrl->ungrab();
+            _canvas_item_ctrl.ungrab();
             _clearMouseover(); // this will also reset state to normal
             _event_grab = false;
             _drag_initiated = false;
@@ -409,8 +417,8 @@ void ControlPoint::transferGrab(ControlPoint *prev_point, MotionEvent const &eve
     if (!_event_grab) return;
 
     grabbed(event);
-    prev_point->_canvas_item_ctrl->ungrab();
-    _canvas_item_ctrl->grab(grab_event_mask); // cursor is null
+    prev_point->_canvas_item_ctrl.ungrab();
+    _canvas_item_ctrl.grab(grab_event_mask); // cursor is null
 
     _drag_initiated = true;
 
@@ -420,16 +428,16 @@ void ControlPoint::transferGrab(ControlPoint *prev_point, MotionEvent const &eve
 
 void ControlPoint::_setState(State state)
 {
-    _canvas_item_ctrl->set_normal(_selected_appearance);
+    _canvas_item_ctrl.set_normal(_selected_appearance);
 
     switch(state) {
         case STATE_NORMAL:
             break;
         case STATE_MOUSEOVER:
-            _canvas_item_ctrl->set_hover();
+            _canvas_item_ctrl.set_hover();
             break;
         case STATE_CLICKED:
-            _canvas_item_ctrl->set_click();
+            _canvas_item_ctrl.set_click();
             break;
     };
     _state = state;
@@ -439,13 +447,13 @@ void ControlPoint::set_selected_appearance(bool selected) {
     if (_selected_appearance == selected) return;
 
     _selected_appearance = selected;
-    _canvas_item_ctrl->set_selected(selected);
+    _canvas_item_ctrl.set_selected(selected);
 }
 
 // TODO: RENAME
 void ControlPoint::_handleControlStyling()
 {
-    _canvas_item_ctrl->set_size_default();
+    _canvas_item_ctrl.set_size_default();
 }
 
 bool ControlPoint::_is_drag_cancelled(MotionEvent const &event)
@@ -478,6 +486,115 @@ bool ControlPoint::doubleclicked(ButtonReleaseEvent const &/*event*/)
     return false;
 }
 
+// ===== Visual representation =====
+
+ControlPoint::Ctrl::Ctrl(Inkscape::CanvasItemGroup *group, Inkscape::CanvasItemCtrlType type)
+    : _item(make_canvasitem<Inkscape::CanvasItemCtrl>(group, type))
+{}
+
+ControlPoint::Ctrl::Ctrl(Inkscape::CanvasItemCtrlBatch *batch, Inkscape::CanvasItemCtrlType type)
+    : _batch(batch)
+    , _entry(batch->add(type))
+{}
+
+ControlPoint::Ctrl::~Ctrl()
+{
+    if (_batch) {
+        _batch->remove(_entry);
+    }
+}
+
+void ControlPoint::Ctrl::set_name(std::string &&name)
+{
+    if (_item) {
+        _item->set_name(std::move(name));
+    }
+}
+
+void ControlPoint::Ctrl::set_position(Geom::Point const &position)
+{
+    _batch ? _batch->set_position(_entry, position) : _item->set_position(position);
+}
+
+void ControlPoint::Ctrl::set_anchor(SPAnchorType anchor)
+{
+    _batch ? _batch->set_anchor(_entry, anchor) : _item->set_anchor(anchor);
+}
+
+void ControlPoint::Ctrl::lower_to_bottom()
+{
+    _batch ? _batch->lower_to_bottom(_entry) : _item->lower_to_bottom();
+}
+
+bool ControlPoint::Ctrl::is_visible() const
+{
+    return _batch ? _entry->visible : _item->is_visible();
+}
+
+void ControlPoint::Ctrl::set_visible(bool visible)
+{
+    _batch ? _batch->set_visible(_entry, visible) : _item->set_visible(visible);
+}
+
+void ControlPoint::Ctrl::set_type(Inkscape::CanvasItemCtrlType type)
+{
+    _batch ? _batch->set_type(_entry, type) : _item->set_type(type);
+}
+
+void ControlPoint::Ctrl::set_size(Inkscape::HandleSize rel_size)
+{
+    _batch ? _batch->set_size(_entry, rel_size) : _item->set_size(rel_size);
+}
+
+void ControlPoint::Ctrl::set_size_default()
+{
+    _batch ? _batch->set_size_default(_entry) : _item->set_size_default();
+}
+
+void ControlPoint::Ctrl::_set_size(int size)
+{
+    _batch ? _batch->_set_size(_entry, size) : _item->_set_size(size);
+}
+
+void ControlPoint::Ctrl::set_selected(bool selected)
+{
+    _batch ? _batch->set_selected(_entry, selected) : _item->set_selected(selected);
+}
+
+void ControlPoint::Ctrl::set_click(bool click)
+{
+    _batch ? _batch->set_click(_entry, click) : _item->set_click(click);
+}
+
+void ControlPoint::Ctrl::set_hover(bool hover)
+{
+    _batch ? _batch->set_hover(_entry, hover) : _item->set_hover(hover);
+}
+
+void ControlPoint::Ctrl::set_normal(bool selected)
+{
+    _batch ? _batch->set_normal(_entry, selected) : _item->set_normal(selected);
+}
+
+void ControlPoint::Ctrl::grab(Inkscape::EventMask event_mask)
+{
+    _batch ? _batch->grab(_entry, event_mask) : _item->grab(event_mask);
+}
+
+void ControlPoint::Ctrl::ungrab()
+{
+    _batch ? _batch->ungrab(_entry) : _item->ungrab();
+}
+
+void ControlPoint::Ctrl::set_handler(std::function<bool(CanvasEvent const &)> handler)
+{
+    if (_batch) {
+        _batch->set_handler(_entry, std::move(handler));
+    } else {
+        _connection = _item->connect_event(std::move(handler));
+    }
+}
+
 } // namespace Inkscape::UI
 
 /*
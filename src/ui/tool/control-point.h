@@ -14,6 +14,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "display/control/canvas-item-ctrl.h"
+#include "display/control/canvas-item-ctrl-batch.h"
 #include "display/control/canvas-item-ptr.h"
 
 class SPDesktop;
@@ -196,6 +197,14 @@ protected:
                  Inkscape::CanvasItemCtrlType type,
                  Inkscape::CanvasItemGroup *group = nullptr);
 
+    /**
+     * Create a control point drawn by @a batch, along with the other points of the batch, rather
+     * than by a canvas item of its own. For points that come in large numbers, like nodes.
+     */
+    ControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
+                 Inkscape::CanvasItemCtrlType type,
+                 Inkscape::CanvasItemCtrlBatch *batch);
+
     /// @name Handle control point events in subclasses
     /// @{
     /**
@@ -262,7 +271,45 @@ protected:
     virtual Glib::ustring _getDragTip(MotionEvent const &event) const { return ""; }
     virtual bool _hasDragTips() const { return false; }
 
-    CanvasItemPtr<Inkscape::CanvasItemCtrl> _canvas_item_ctrl; ///< Visual representation of the control point.
+    /**
+     * The visual representation of a control point: a CanvasItemCtrl of its own, or a handle of a
+     * CanvasItemCtrlBatch. Offers the part of the CanvasItemCtrl interface the points use.
+     */
+    class Ctrl
+    {
+    public:
+        Ctrl(Inkscape::CanvasItemGroup *group, Inkscape::CanvasItemCtrlType type);
+        Ctrl(Inkscape::CanvasItemCtrlBatch *batch, Inkscape::CanvasItemCtrlType type);
+        ~Ctrl();
+        Ctrl(Ctrl const &) = delete;
+        Ctrl &operator=(Ctrl const &) = delete;
+
+        void set_name(std::string &&name);
+        void set_position(Geom::Point const &position);
+        void set_anchor(SPAnchorType anchor);
+        void lower_to_bottom();
+        bool is_visible() const;
+        void set_visible(bool visible);
+        void set_type(Inkscape::CanvasItemCtrlType type);
+        void set_size(Inkscape::HandleSize rel_size);
+        void set_size_default();
+        void _set_size(int size);
+        void set_selected(bool selected = true);
+        void set_click(bool click = true);
+        void set_hover(bool hover = true);
+        void set_normal(bool selected = false);
+        void grab(Inkscape::EventMask event_mask);
+        void ungrab();
+        void set_handler(std::function<bool(CanvasEvent const &)> handler);
+
+    private:
+        CanvasItemPtr<Inkscape::CanvasItemCtrl> _item;
+        Inkscape::CanvasItemCtrlBatch *_batch = nullptr;
+        Inkscape::CanvasItemCtrlBatch::Entry *_entry = nullptr;
+        sigc::scoped_connection _connection;
+    };
+
+    Ctrl _canvas_item_ctrl; ///< Visual representation of the control point.
 
     State _state = STATE_NORMAL;
 
@@ -286,8 +333,6 @@ private:
 
     Geom::Point _position; ///< Current position in desktop coordinates
 
-    sigc::scoped_connection _event_handler_connection;
-
     /** Stores the window point over which the cursor was during the last mouse button press. */
     static Geom::Point _drag_event_origin;
     /** Stores the desktop point from which the last drag was initiated. */
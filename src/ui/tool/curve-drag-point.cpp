@@ -31,7 +31,7 @@ CurveDragPoint::CurveDragPoint(PathManipulator &pm) :
                  pm._multi_path_manipulator._path_data.dragpoint_group),
       _pm(pm)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:CurveDragPoint");
+    _canvas_item_ctrl.set_name("CanvasItemCtrl:CurveDragPoint");
     setVisible(false);
 }
 
@@ -170,7 +170,7 @@ bool Handle::_drag_out = false;
 
 Handle::Handle(NodeSharedData const &data, Geom::Point const &initial_pos, Node *parent)
     : ControlPoint(data.desktop, initial_pos, SP_ANCHOR_CENTER, Inkscape::CANVAS_ITEM_CTRL_TYPE_ROTATE,
-                   data.handle_group)
+                   data.handle_batch)
     , _handle_line(make_canvasitem<CanvasItemCurve>(data.handle_line_group))
     , _parent(parent)
     , _degenerate(true)
@@ -286,6 +286,9 @@ void Handle::move(Geom::Point const &new_pos)
 
 void Handle::setPosition(Geom::Point const &p)
 {
+    if (_parent->ln_list) {
+        _parent->ln_list->nodeMoved(_parent);
+    }
     ControlPoint::setPosition(p);
     _handle_line->set_coords(_parent->position(), position());
 
@@ -745,13 +748,12 @@ Glib::ustring Handle::_getDragTip(MotionEvent const & /*event*/) const
 
 Node::Node(NodeSharedData const &data, Geom::Point const &initial_pos)
     : SelectableControlPoint(data.desktop, initial_pos, SP_ANCHOR_CENTER, Inkscape::CANVAS_ITEM_CTRL_TYPE_NODE_CUSP,
-                             *data.selection, data.node_group)
+                             *data.selection, data.node_batch)
     , _front(data, initial_pos, this)
     , _back(data, initial_pos, this)
     , _type(NODE_CUSP)
     , _handles_shown(false)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:Node");
     // NOTE we do not set type here, because the handles are still degenerate
 }
 
@@ -786,6 +788,14 @@ Node *Node::_prev()
     }
 }
 
+void Node::setPosition(Geom::Point const &p)
+{
+    if (ln_list) {
+        ln_list->nodeMoved(this);
+    }
+    ControlPoint::setPosition(p);
+}
+
 void Node::move(Geom::Point const &new_pos)
 {
     // move handles when the node moves.
@@ -1144,7 +1154,7 @@ bool Node::isEndNode() const
 
 void Node::sink()
 {
-    _canvas_item_ctrl->lower_to_bottom();
+    _canvas_item_ctrl.lower_to_bottom();
 }
 
 NodeType Node::parse_nodetype(char x)
@@ -1336,7 +1346,7 @@ void Node::_linearGrow(int dir)
 void Node::_setState(State state)
 {
     // change node size to match type and selection state
-    _canvas_item_ctrl->set_size(selected() ? HandleSize::LARGE : HandleSize::NORMAL);
+    _canvas_item_ctrl.set_size(selected() ? HandleSize::LARGE : HandleSize::NORMAL);
     switch (state) {
         // These were used to set "active" and "prelight" flags but the flags weren't being used.
         case STATE_NORMAL:
@@ -1746,6 +1756,32 @@ bool NodeList::empty() const
     return ln_next == this;
 }
 
+void NodeList::nodeMoved(Node *node)
+{
+    // a dirty subpath is rebuilt whole anyway
+    if (!_dirty) {
+        _moved.push_back(node);
+    }
+}
+
+void NodeList::markClean()
+{
+    if (_dirty) {
+        std::size_t index = 0;
+        for (auto &node : *this) {
+            node._index = index++;
+        }
+    }
+    _dirty = false;
+    _moved.clear();
+}
+
+void NodeList::_invalidate()
+{
+    _dirty = true;
+    _moved.clear();
+}
+
 NodeList::size_type NodeList::size() const
 {
     size_type sz = 0;
@@ -1785,6 +1821,7 @@ NodeList::iterator NodeList::insert(iterator pos, Node *x)
     ins->ln_prev->ln_next = x;
     ins->ln_prev = x;
     x->ln_list = this;
+    _invalidate();
     return iterator(x);
 }
 
@@ -1800,9 +1837,11 @@ void NodeList::splice(iterator pos, NodeList &list, iterator i)
     splice(pos, list, i, j);
 }
 
-void NodeList::splice(iterator pos, NodeList & /*list*/, iterator first, iterator last)
+void NodeList::splice(iterator pos, NodeList &list, iterator first, iterator last)
 {
     ListNode *ins_beg = first._node, *ins_end = last._node, *at = pos._node;
+    list._invalidate();
+    _invalidate();
     for (ListNode *ln = ins_beg; ln != ins_end; ln = ln->ln_next) {
         ln->ln_list = this;
     }
@@ -1818,6 +1857,7 @@ void NodeList::splice(iterator pos, NodeList & /*list*/, iterator first, iterato
 
 void NodeList::shift(int n)
 {
+    _invalidate();
     // 1. make the list perfectly cyclic
     ln_next->ln_prev = ln_prev;
     ln_prev->ln_next = ln_next;
@@ -1847,6 +1887,7 @@ void NodeList::reverse()
         node->back()->setPosition(save_pos);
     }
     std::swap(ln_next, ln_prev);
+    _invalidate();
 }
 
 void NodeList::clear()
@@ -1894,6 +1935,7 @@ NodeList::iterator NodeList::erase(iterator i)
     delete rm;
     rmprev->ln_next = rmnext;
     rmnext->ln_prev = rmprev;
+    _invalidate();
     return i;
 }
 
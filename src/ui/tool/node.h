@@ -13,6 +13,8 @@
 #ifndef INKSCAPE_UI_TOOL_NODE_H
 #define INKSCAPE_UI_TOOL_NODE_H
 
+#include <vector>
+
 #include "selectable-control-point.h"
 #include "snap-candidate.h"
 #include "ui/tool/node-types.h"
@@ -38,9 +40,9 @@ std::ostream &operator<<(std::ostream &, NodeType);
 
 struct ListNode
 {
-    ListNode *ln_next;
-    ListNode *ln_prev;
-    NodeList *ln_list;
+    ListNode *ln_next = nullptr;
+    ListNode *ln_prev = nullptr;
+    NodeList *ln_list = nullptr;
 };
 
 struct NodeSharedData
@@ -50,6 +52,8 @@ struct NodeSharedData
     Inkscape::CanvasItemGroup *node_group;
     Inkscape::CanvasItemGroup *handle_group;
     Inkscape::CanvasItemGroup *handle_line_group;
+    Inkscape::CanvasItemCtrlBatch *node_batch;   ///< Draws the nodes, in node_group.
+    Inkscape::CanvasItemCtrlBatch *handle_batch; ///< Draws the handles, in handle_group.
 };
 
 class Handle : public ControlPoint
@@ -127,6 +131,7 @@ public:
     Node(Node const &) = delete;
 
     void move(Geom::Point const &p) override;
+    void setPosition(Geom::Point const &p) override;
     void transform(Geom::Affine const &m) override;
     void fixNeighbors() override;
     Geom::Rect bounds() const override;
@@ -184,6 +189,8 @@ public:
 
     NodeList &nodeList() { return *(static_cast<ListNode*>(this)->ln_list); }
     NodeList &nodeList() const { return *(static_cast<ListNode const*>(this)->ln_list); }
+    /// Position of the node in its subpath, valid while the subpath isn't dirty.
+    std::size_t index() const { return _index; }
 
     /**
      * Move the node to the bottom of its canvas group.
@@ -238,6 +245,7 @@ private:
     Handle _back; ///< Node handle in the forward direction of the path
     NodeType _type; ///< Type of node - cusp, smooth...
     bool _handles_shown;
+    std::size_t _index = 0;
 
     // This is used by fixNeighbors to repair smooth nodes after all move
     // operations have been completed. If this is empty, no fixing is needed.
@@ -367,7 +375,23 @@ public:
      */
     bool degenerate() const;
 
-    void setClosed(bool c) { _closed = c; }
+    void setClosed(bool c) { _closed = c; _invalidate(); }
+
+    /**
+     * Whether the structure of this subpath changed since the path manipulator last
+     * rebuilt it, so that it has to be rebuilt whole. Set by all list operations.
+     */
+    bool dirty() const { return _dirty; }
+    /**
+     * The nodes that moved, or whose handles moved, since the last rebuild, if the
+     * structure didn't change. May hold a node more than once.
+     */
+    std::vector<Node *> const &movedNodes() const { return _moved; }
+    /** Record that the segments next to @a node have to be rebuilt. */
+    void nodeMoved(Node *node);
+    /** Called once the subpath is rebuilt; numbers the nodes if it was rebuilt whole. */
+    void markClean();
+
     iterator before(double t, double *fracpart = nullptr);
     iterator before(Geom::PathTime const &pvp);
     const_iterator before(double t, double *fracpart = nullptr) const {
@@ -419,8 +443,12 @@ public:
     static NodeList &get(iterator const &i);
 
 private:
+    void _invalidate();
+
     SubpathList &_list;
     bool _closed = false;
+    bool _dirty = true;
+    std::vector<Node *> _moved;
 
     friend class Node;
     friend class Handle; // required to access handle and handle line groups
@@ -11,6 +11,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <2geom/path-sink.h>
 
 #include "display/control/canvas-item-bpath.h"
@@ -90,6 +91,7 @@ private:
 };
 
 void build_segment(Geom::PathBuilder &, Node *, Node *);
+static bool splice_moved_segments(NodeList &, Geom::Path &, Geom::Affine const &);
 PathManipulator::PathManipulator(MultiPathManipulator &mpm, SPObject *path,
         Geom::Affine const &et, guint32 outline_color, Glib::ustring lpe_key)
     : PointManipulator(mpm._path_data.node_data.desktop, *mpm._path_data.node_data.selection)
@@ -1241,6 +1243,7 @@ Geom::Affine PathManipulator::_getTransform() const
 void PathManipulator::_createControlPointsFromGeometry()
 {
     clear();
+    _subpath_cache.clear();
 
     // sanitize pathvector and store it in SPCurve,
     // so that _updateDragPoint doesn't crash on paths with naked movetos
@@ -1422,52 +1425,77 @@ Geom::Point PathManipulator::_bsplineHandleReposition(Handle *h, double pos)
  */
 void PathManipulator::_createGeometryFromControlPoints(bool alert_LPE)
 {
-    Geom::PathBuilder builder;
     //Refresh if is bspline some times -think on path change selection, this value get lost
     _recalculateIsBSpline();
+
+    Geom::Affine const to_item = _getTransform().inverse();
+    bool const transform_changed = to_item != _subpath_cache_transform;
+    bool changed = transform_changed;
+
+    std::vector<std::pair<NodeList const *, Geom::Path>> cache;
+    cache.reserve(_subpaths.size());
+    std::size_t index = 0;
     for (std::list<SubpathPtr>::iterator spi = _subpaths.begin(); spi != _subpaths.end(); ) {
         SubpathPtr subpath = *spi;
         if (subpath->empty()) {
             _subpaths.erase(spi++);
+            changed = true;
             continue;
         }
-        NodeList::iterator prev = subpath->begin();
-        builder.moveTo(prev->position());
-        for (NodeList::iterator i = ++subpath->begin(); i != subpath->end(); ++i) {
-            build_segment(builder, prev.ptr(), i.ptr());
-            prev = i;
-        }
-        if (subpath->closed()) {
-            // Here we link the last and first node if the path is closed.
-            // If the last segment is Bezier, we add it.
-            if (!prev->front()->isDegenerate() || !subpath->begin()->back()->isDegenerate()) {
-                build_segment(builder, prev.ptr(), subpath->begin().ptr());
+        // reuse the previous geometry of subpaths whose structure didn't change since the last
+        // rebuild, and rebuild only the segments next to the nodes that moved
+        if (!transform_changed && !subpath->dirty() && index < _subpath_cache.size() &&
+            _subpath_cache[index].first == subpath.get() &&
+            splice_moved_segments(*subpath, _subpath_cache[index].second, to_item))
+        {
+            changed = changed || !subpath->movedNodes().empty();
+            cache.push_back(std::move(_subpath_cache[index]));
+        } else {
+            Geom::PathBuilder builder;
+            NodeList::iterator prev = subpath->begin();
+            builder.moveTo(prev->position());
+            for (NodeList::iterator i = ++subpath->begin(); i != subpath->end(); ++i) {
+                build_segment(builder, prev.ptr(), i.ptr());
+                prev = i;
             }
-            // if that segment is linear, we just call closePath().
-            builder.closePath();
+            if (subpath->closed()) {
+                // Here we link the last and first node if the path is closed.
+                // If the last segment is Bezier, we add it.
+                if (!prev->front()->isDegenerate() || !subpath->begin()->back()->isDegenerate()) {
+                    build_segment(builder, prev.ptr(), subpath->begin().ptr());
+                }
+                // if that segment is linear, we just call closePath().
+                builder.closePath();
+            }
+            builder.flush();
+            cache.emplace_back(subpath.get(), builder.peek().front() * to_item);
+            changed = true;
         }
+        subpath->markClean();
+        ++index;
         ++spi;
     }
-    builder.flush();
-    Geom::PathVector pathv = builder.peek() * _getTransform().inverse();
-    for (Geom::PathVector::iterator i = pathv.begin(); i != pathv.end(); ) {
-        // NOTE: this utilizes the fact that Geom::PathVector is an std::vector.
-        // When we erase an element, the next one slides into position,
-        // so we do not increment the iterator even though it is theoretically invalidated.
-        if (i->empty()) {
-            i = pathv.erase(i);
-        } else {
-            ++i;
+    changed = changed || index != _subpath_cache.size();
+    _subpath_cache = std::move(cache);
+    _subpath_cache_transform = to_item;
+
+    // nothing moved since the last rebuild, so the geometry is already up to date
+    if (!changed) {
+        return;
+    }
+
+    Geom::PathVector pathv;
+    for (auto const &[list, path] : _subpath_cache) {
+        // drop subpaths without segments, e.g. a single node left over after deletion
+        if (!path.empty()) {
+            pathv.push_back(path);
         }
     }
     if (pathv.empty()) {
         return;
     }
 
-    if (_spcurve == pathv) {
-        return;
-    }
-    _spcurve = pathv;
+    _spcurve = std::move(pathv);
     if (alert_LPE) {
         /// \todo note that _path can be an Inkscape::LivePathEffect::Effect* too, kind of confusing, rework member naming?
         auto path = cast<SPPath>(_path);
@@ -1484,8 +1512,102 @@ void PathManipulator::_createGeometryFromControlPoints(bool alert_LPE)
         _updateOutline();
     }
     if (_live_objects) {
-        _setGeometry();
+        _setGeometry(true);
+    }
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> moved_segment_runs(std::vector<std::size_t> const &moved,
+                                                                    std::size_t node_count)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    if (node_count < 2) {
+        return runs;
+    }
+    for (auto k : moved) {
+        // a node is the end of the segment before it and the start of the one after it
+        std::size_t const first = k == 0 ? 0 : k - 1;
+        std::size_t const last = std::min(k, node_count - 2);
+        if (!runs.empty() && first <= runs.back().second + 1) {
+            runs.back().second = std::max(runs.back().second, last);
+        } else {
+            runs.emplace_back(first, last);
+        }
+    }
+    return runs;
+}
+
+bool splice_segments(Geom::Path &path, std::size_t first, std::size_t last, Geom::Path const &run)
+{
+    if (last >= path.size_open() || run.size_open() != last - first + 1) {
+        return false;
+    }
+    // the segments around the run must stay continuous; at the ends of an open path
+    // there is nothing to join up with
+    bool const joins_front = !path.closed() && first == 0;
+    bool const joins_back = !path.closed() && last + 1 == path.size_open();
+    if ((!joins_front && run.initialPoint() != path[first].initialPoint()) ||
+        (!joins_back && run.finalPoint() != path[last].finalPoint()))
+    {
+        return false;
+    }
+    path.replace(path.begin() + first, path.begin() + last + 1, run);
+    return true;
+}
+
+/** Rebuild the segments of @a path next to the nodes of @a subpath that moved since the last
+ * rebuild. Returns false if the subpath has to be rebuilt whole instead.
+ * @relates PathManipulator */
+static bool splice_moved_segments(NodeList &subpath, Geom::Path &path, Geom::Affine const &to_item)
+{
+    auto const &moved_nodes = subpath.movedNodes();
+    if (moved_nodes.empty()) {
+        return true;
+    }
+    std::size_t const node_count = subpath.size();
+    std::vector<Node *> moved(moved_nodes.begin(), moved_nodes.end());
+    std::sort(moved.begin(), moved.end(), [](Node *a, Node *b) { return a->index() < b->index(); });
+    moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+    // past that, rebuilding everything is as cheap as splicing
+    if (moved.size() * 2 > node_count) {
+        return false;
+    }
+    // the closing segment and the parts around it are left to a full rebuild
+    if (subpath.closed() && (moved.front()->index() == 0 || moved.back()->index() + 1 == node_count)) {
+        return false;
+    }
+    // a closed subpath may end with an explicit segment back to its first node
+    if (path.size_open() + 1 != node_count && !(subpath.closed() && path.size_open() == node_count)) {
+        return false;
+    }
+
+    std::vector<std::size_t> indices;
+    indices.reserve(moved.size());
+    for (auto node : moved) {
+        indices.push_back(node->index());
+    }
+    auto m = moved.begin();
+    for (auto [first, last] : moved_segment_runs(indices, node_count)) {
+        // the run starts at its first moved node, or at the node before it
+        NodeList::iterator prev = NodeList::get_iterator(*m);
+        if ((*m)->index() != first) {
+            prev = prev.prev();
+        }
+        Geom::PathBuilder builder;
+        builder.moveTo(prev->position());
+        for (std::size_t i = first; i <= last; ++i) {
+            NodeList::iterator cur = prev.next();
+            build_segment(builder, prev.ptr(), cur.ptr());
+            prev = cur;
+        }
+        builder.flush();
+        if (!splice_segments(path, first, last, builder.peek().front() * to_item)) {
+            return false;
+        }
+        while (m != moved.end() && (*m)->index() <= last + 1) {
+            ++m;
+        }
     }
+    return true;
 }
 
 /** Build one segment of the geometric representation.
@@ -1573,10 +1695,14 @@ void PathManipulator::_getGeometry()
             _spcurve = {};
         }
     }
+    _subpath_cache.clear();
 }
 
 /** Set the geometry of the edited object in the object tree, but do not commit to XML */
-void PathManipulator::_setGeometry()
+/** Write the geometry to the path, or to the LPE parameter being edited.
+ * @param changed Whether the geometry is known to differ from what was last written, which
+ *                saves comparing it with the parameter's. */
+void PathManipulator::_setGeometry(bool changed)
 {
     using namespace Inkscape::LivePathEffect;
     auto lpeobj = cast<LivePathEffectObject>(_path);
@@ -1588,7 +1714,7 @@ void PathManipulator::_setGeometry()
         Effect *lpe = lpeobj->get_lpe();
         if (lpe) {
             PathParam *pathparam = dynamic_cast<PathParam *>(lpe->getParameter(_lpe_key.data()));
-            if (pathparam->get_pathvector() == _spcurve) {
+            if (!changed && pathparam->get_pathvector() == _spcurve) {
                 return; //False we dont update LPE
             }
             pathparam->set_new_value(_spcurve, false);
@@ -13,6 +13,8 @@
 #define INKSCAPE_UI_TOOL_PATH_MANIPULATOR_H
 
 #include <memory>
+#include <utility>
+#include <vector>
 #include <2geom/path-sink.h>
 #include "manipulator.h"
 #include "node.h"
@@ -140,7 +142,7 @@ private:
     void _updateOutline();
     //void _setOutline(Geom::PathVector const &);
     void _getGeometry();
-    void _setGeometry();
+    void _setGeometry(bool changed = false);
     Glib::ustring _nodetypesKey();
     Inkscape::XML::Node *_getXMLNode();
     Geom::Affine _getTransform() const;
@@ -165,6 +167,10 @@ private:
     MultiPathManipulator &_multi_path_manipulator;
     SPObject *_path; ///< can be an SPPath or an Inkscape::LivePathEffect::Effect  !!!
     Geom::PathVector _spcurve; // in item coordinates
+    /// Item-coordinate geometry of each subpath from the last rebuild, so that a drag only
+    /// rebuilds the subpaths whose nodes or handles actually moved.
+    std::vector<std::pair<NodeList const *, Geom::Path>> _subpath_cache;
+    Geom::Affine _subpath_cache_transform;
     CanvasItemPtr<Inkscape::CanvasItemBpath> _outline;
     CurveDragPoint *_dragpoint; // an invisible control point hovering over curve
     PathManipulatorObserver *_observer;
@@ -185,6 +191,20 @@ private:
     friend class Handle;
 };
 
+/**
+ * The runs of segments of a subpath with @a node_count nodes that have to be rebuilt when the
+ * nodes at the sorted positions @a moved were moved. Segment i goes from node i to node i + 1;
+ * the closing segment isn't covered. Returns inclusive [first, last] ranges in order.
+ */
+std::vector<std::pair<std::size_t, std::size_t>> moved_segment_runs(std::vector<std::size_t> const &moved,
+                                                                    std::size_t node_count);
+
+/**
+ * Replace the segments [first, last] of @a path with those of @a run, if @a run joins up
+ * exactly with the segments around them. Returns false and leaves @a path alone otherwise.
+ */
+bool splice_segments(Geom::Path &path, std::size_t first, std::size_t last, Geom::Path const &run);
+
 } // namespace UI
 } // namespace Inkscape
 
@@ -21,7 +21,17 @@ SelectableControlPoint::SelectableControlPoint(SPDesktop *d, Geom::Point const &
     : ControlPoint(d, initial_pos, anchor, type, group)
     , _selection(sel)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:SelectableControlPoint");
+    _canvas_item_ctrl.set_name("CanvasItemCtrl:SelectableControlPoint");
+    _selection.allPoints().insert(this);
+}
+
+SelectableControlPoint::SelectableControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
+                                               Inkscape::CanvasItemCtrlType type,
+                                               ControlPointSelection &sel,
+                                               Inkscape::CanvasItemCtrlBatch *batch)
+    : ControlPoint(d, initial_pos, anchor, type, batch)
+    , _selection(sel)
+{
     _selection.allPoints().insert(this);
 }
 
@@ -96,15 +106,15 @@ void SelectableControlPoint::_setState(State state)
     if (!selected()) {
         ControlPoint::_setState(state);
     } else {
-        _canvas_item_ctrl->set_normal(true);
+        _canvas_item_ctrl.set_normal(true);
         switch (state) {
             case STATE_NORMAL:
                 break;
             case STATE_MOUSEOVER:
-                _canvas_item_ctrl->set_hover();
+                _canvas_item_ctrl.set_hover();
                 break;
             case STATE_CLICKED:
-                _canvas_item_ctrl->set_click();
+                _canvas_item_ctrl.set_click();
                 break;
         }
         _state = state;
@@ -37,6 +37,10 @@ protected:
                            Inkscape::CanvasItemCtrlType type,
                            ControlPointSelection &sel,
                            Inkscape::CanvasItemGroup *group = nullptr);
+    SelectableControlPoint(SPDesktop *d, Geom::Point const &initial_pos, SPAnchorType anchor,
+                           Inkscape::CanvasItemCtrlType type,
+                           ControlPointSelection &sel,
+                           Inkscape::CanvasItemCtrlBatch *batch);
 
     void _setState(State state) override;
 
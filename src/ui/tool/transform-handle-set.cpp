@@ -70,7 +70,7 @@ TransformHandle::TransformHandle(TransformHandleSet &th, SPAnchorType anchor, In
     : ControlPoint(th._desktop, Geom::Point(), anchor, type, th._transform_handle_group)
     , _th(th)
 {
-    _canvas_item_ctrl->set_name("CanvasItemCtrl:TransformHandle");
+    _canvas_item_ctrl.set_name("CanvasItemCtrl:TransformHandle");
     setVisible(false);
 }
 
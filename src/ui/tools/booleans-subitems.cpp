@@ -100,8 +100,8 @@ static void extract_pathvectors_recursive(SPItem *root, SPItem *item, Pathvector
         if (clip && is<SPImage>(use->get_original())) {
             // A clipped clone of an image is consumed as a single object
             result.emplace_back(*clip * transform, root, item);
-        } else if (use->child) {
-            extract_pathvectors_recursive(root, use->child, result, use->child->transform * Geom::Translate(use->x.computed, use->y.computed) * transform);
+        } else if (auto const child = use->sharedChild()) {
+            extract_pathvectors_recursive(root, child, result, child->transform * Geom::Translate(use->x.computed, use->y.computed) * transform);
         }
     }
 }
@@ -17,6 +17,7 @@
 #include <glib/gi18n.h>
 
 #include "display/control/canvas-item-bpath.h"
+#include "display/control/canvas-item-ctrl-batch.h"
 #include "display/control/canvas-item-group.h"
 #include "display/curve.h"
 #include "live_effects/effect.h"
@@ -125,6 +126,10 @@ NodeTool::NodeTool(SPDesktop *desktop)
 
     data.node_data.handle_line_group->set_name("CanvasItemGroup:NodeTool:handle_line_group");
 
+    // Paths may have tens of thousands of nodes, so they are drawn and picked in bulk.
+    data.node_data.node_batch   = new Inkscape::CanvasItemCtrlBatch(data.node_data.node_group);
+    data.node_data.handle_batch = new Inkscape::CanvasItemCtrlBatch(data.node_data.handle_group);
+
     Inkscape::Selection *selection = desktop->getSelection();
 
     this->_selection_changed_connection.disconnect();
@@ -29,6 +29,8 @@
 #include "style.h"
 
 #include "display/control/canvas-item-bpath.h"
+#include "display/dispatch-pool.h"
+#include "display/threading.h"
 
 #include "object/box3d.h"
 #include "object/filters/gaussian-blur.h"
@@ -283,8 +285,25 @@ get_move_force (TweakTool *tc)
     return force * tc->force;
 }
 
+/**
+ * A path (or shape about to become one) under the brush, waiting for its new geometry.
+ */
+struct TweakPathJob
+{
+    SPItem *item = nullptr;
+    Inkscape::XML::Node *newrepr = nullptr; ///< Replacement repr for shapes that aren't paths yet.
+    gint pos = 0;
+    Inkscape::XML::Node *parent = nullptr;
+    std::string id;
+    std::unique_ptr<Path> orig;
+    Geom::Affine i2doc;
+    FillRule fill_rule = fill_nonZero;
+    bool changed = false;      ///< Set by sp_tweak_path_geometry() when the brush changed the path.
+    std::unique_ptr<Path> res; ///< The new geometry, null when too few nodes are left.
+};
+
 static bool
-sp_tweak_dilate_recursive (Inkscape::Selection *selection, SPItem *item, Geom::Point p, Geom::Point vector, gint mode, double radius, double force, double fidelity, bool reverse)
+sp_tweak_dilate_recursive (Inkscape::Selection *selection, SPItem *item, Geom::Point p, Geom::Point vector, gint mode, double radius, double force, double fidelity, bool reverse, std::vector<TweakPathJob> &jobs)
 {
     bool did = false;
 
@@ -323,7 +342,7 @@ sp_tweak_dilate_recursive (Inkscape::Selection *selection, SPItem *item, Geom::P
         for (auto i = children.rbegin(); i!= children.rend(); ++i) {
             SPItem *child = *i; 
             g_assert(child != nullptr);
-            if (sp_tweak_dilate_recursive (selection, child, p, vector, mode, radius, force, fidelity, reverse)) {
+            if (sp_tweak_dilate_recursive (selection, child, p, vector, mode, radius, force, fidelity, reverse, jobs)) {
                 did = true;
             }
         }
@@ -430,153 +449,184 @@ sp_tweak_dilate_recursive (Inkscape::Selection *selection, SPItem *item, Geom::P
 
         } else if (is<SPPath>(item) || is<SPShape>(item)) {
 
-            Inkscape::XML::Node *newrepr = nullptr;
-            gint pos = 0;
-            Inkscape::XML::Node *parent = nullptr;
-            char const *id = nullptr;
+            // skip those paths whose bboxes are entirely out of reach with our radius
+            Geom::OptRect bbox = item->documentVisualBounds();
+            if (bbox) {
+                bbox->expandBy(radius);
+                if (!bbox->contains(p)) {
+                    return false;
+                }
+            }
+
+            TweakPathJob job;
+            job.item = item;
             if (!is<SPPath>(item)) {
-                newrepr = sp_selected_item_to_curved_repr(item, 0);
-                if (!newrepr) {
+                job.newrepr = sp_selected_item_to_curved_repr(item, 0);
+                if (!job.newrepr) {
                     return false;
                 }
 
                 // remember the position of the item
-                pos = item->getRepr()->position();
+                job.pos = item->getRepr()->position();
                 // remember parent
-                parent = item->getRepr()->parent();
+                job.parent = item->getRepr()->parent();
                 // remember id
-                id = item->getRepr()->attribute("id");
-            }
-
-            // skip those paths whose bboxes are entirely out of reach with our radius
-            Geom::OptRect bbox = item->documentVisualBounds();
-            if (bbox) {
-                bbox->expandBy(radius);
-                if (!bbox->contains(p)) {
-                    return false;
+                if (auto id = item->getRepr()->attribute("id")) {
+                    job.id = id;
                 }
             }
 
-            auto orig = Path_for_item(item, false);
-            if (!orig) {
+            job.orig = Path_for_item(item, false);
+            if (!job.orig) {
+                if (job.newrepr) {
+                    Inkscape::GC::release(job.newrepr);
+                }
                 return false;
             }
+            job.i2doc = item->i2doc_affine();
 
-            Path *res = new Path;
-            res->SetBackData(false);
+            SPCSSAttr *css = sp_repr_css_attr(item->getRepr(), "style");
+            gchar const *val = sp_repr_css_property(css, "fill-rule", nullptr);
+            job.fill_rule = (val && strcmp(val, "evenodd") == 0) ? fill_oddEven : fill_nonZero;
 
-            Shape *theShape = new Shape;
-            Shape *theRes = new Shape;
-            Geom::Affine i2doc(item->i2doc_affine());
+            // The geometry is computed for all items at once by sp_tweak_paths().
+            jobs.push_back(std::move(job));
+        }
 
-            orig->ConvertWithBackData((0.08 - (0.07 * fidelity)) / i2doc.descrim()); // default 0.059
-            orig->Fill(theShape, 0);
+    }
 
-            SPCSSAttr *css = sp_repr_css_attr(item->getRepr(), "style");
-            gchar const *val = sp_repr_css_property(css, "fill-rule", nullptr);
-            if (val && strcmp(val, "nonzero") == 0) {
-                theRes->ConvertToShape(theShape, fill_nonZero);
-            } else if (val && strcmp(val, "evenodd") == 0) {
-                theRes->ConvertToShape(theShape, fill_oddEven);
-            } else {
-                theRes->ConvertToShape(theShape, fill_nonZero);
-            }
+    return did;
+}
 
-            if (Geom::L2(vector) != 0) {
-                vector = 1/Geom::L2(vector) * vector;
-            }
+/**
+ * Run the livarot part of a path tweak. This only touches the job itself, so it is safe to
+ * call for several jobs at once from worker threads. Serializing the result reads preferences,
+ * so that is left to the main thread.
+ */
+static void sp_tweak_path_geometry(TweakPathJob &job, Geom::Point p, Geom::Point vector, gint mode, double radius,
+                                   double force, double fidelity, bool reverse, double zoom)
+{
+    auto const &i2doc = job.i2doc;
+    auto res = std::make_unique<Path>();
+    res->SetBackData(false);
 
-            bool did_this = false;
-            if (mode == TWEAK_MODE_SHRINK_GROW) {
-                if (theShape->MakeTweak(tweak_mode_grow, theRes,
-                        reverse? force : -force,
-                        join_straight, 4.0,
-                        true, p, Geom::Point(0,0), radius, &i2doc) == 0) // 0 means the shape was actually changed
-                    did_this = true;
-            } else if (mode == TWEAK_MODE_ATTRACT_REPEL) {
-                if (theShape->MakeTweak(tweak_mode_repel, theRes,
-                        reverse? force : -force,
-                        join_straight, 4.0,
-                        true, p, Geom::Point(0,0), radius, &i2doc) == 0)
-                    did_this = true;
-            } else if (mode == TWEAK_MODE_PUSH) {
-                if (theShape->MakeTweak(tweak_mode_push, theRes,
-                        1.0,
-                        join_straight, 4.0,
-                        true, p, force*2*vector, radius, &i2doc) == 0)
-                    did_this = true;
-            } else if (mode == TWEAK_MODE_ROUGHEN) {
-                if (theShape->MakeTweak(tweak_mode_roughen, theRes,
-                        force,
-                        join_straight, 4.0,
-                        true, p, Geom::Point(0,0), radius, &i2doc) == 0)
-                    did_this = true;
-            }
+    Shape theShape;
+    Shape theRes;
 
-            // the rest only makes sense if we actually changed the path
-            if (did_this) {
-                theRes->ConvertToShape(theShape, fill_positive);
+    job.orig->ConvertWithBackData((0.08 - (0.07 * fidelity)) / i2doc.descrim()); // default 0.059
+    job.orig->Fill(&theShape, 0);
+    theRes.ConvertToShape(&theShape, job.fill_rule);
 
-                res->Reset();
-                theRes->ConvertToForme(res);
+    if (Geom::L2(vector) != 0) {
+        vector = 1/Geom::L2(vector) * vector;
+    }
 
-                double th_max = (0.6 - 0.59*sqrt(fidelity)) / i2doc.descrim();
-                double threshold = MAX(th_max, th_max*force);
-                res->ConvertEvenLines(threshold);
-                res->Simplify(threshold / (selection->desktop()->current_zoom()));
+    bool did_this = false;
+    if (mode == TWEAK_MODE_SHRINK_GROW) {
+        if (theShape.MakeTweak(tweak_mode_grow, &theRes,
+                reverse? force : -force,
+                join_straight, 4.0,
+                true, p, Geom::Point(0,0), radius, &i2doc) == 0) // 0 means the shape was actually changed
+            did_this = true;
+    } else if (mode == TWEAK_MODE_ATTRACT_REPEL) {
+        if (theShape.MakeTweak(tweak_mode_repel, &theRes,
+                reverse? force : -force,
+                join_straight, 4.0,
+                true, p, Geom::Point(0,0), radius, &i2doc) == 0)
+            did_this = true;
+    } else if (mode == TWEAK_MODE_PUSH) {
+        if (theShape.MakeTweak(tweak_mode_push, &theRes,
+                1.0,
+                join_straight, 4.0,
+                true, p, force*2*vector, radius, &i2doc) == 0)
+            did_this = true;
+    } else if (mode == TWEAK_MODE_ROUGHEN) {
+        if (theShape.MakeTweak(tweak_mode_roughen, &theRes,
+                force,
+                join_straight, 4.0,
+                true, p, Geom::Point(0,0), radius, &i2doc) == 0)
+            did_this = true;
+    }
 
-                if (newrepr) { // converting to path, need to replace the repr
-                    bool is_selected = selection->includes(item);
-                    if (is_selected) {
-                        selection->remove(item);
-                    }
+    // the rest only makes sense if we actually changed the path
+    if (did_this) {
+        theRes.ConvertToShape(&theShape, fill_positive);
 
-                    // It's going to resurrect, so we delete without notifying listeners.
-                    item->deleteObject(false);
+        res->Reset();
+        theRes.ConvertToForme(res.get());
 
-                    // restore id
-                    newrepr->setAttribute("id", id);
-                    // add the new repr to the parent
-                    // move to the saved position
-                    parent->addChildAtPos(newrepr, pos);
+        double th_max = (0.6 - 0.59*sqrt(fidelity)) / i2doc.descrim();
+        double threshold = MAX(th_max, th_max*force);
+        res->ConvertEvenLines(threshold);
+        res->Simplify(threshold / zoom);
 
-                    if (is_selected)
-                        selection->add(newrepr);
-                }
+        job.changed = true;
+        if (res->descr_cmd.size() > 1) {
+            job.res = std::move(res);
+        }
+    }
+}
 
-                if (res->descr_cmd.size() > 1) {
-                    auto str = res->svg_dump_path();
-                    if (newrepr) {
-                        newrepr->setAttribute("d", str.c_str());
-                    } else {
-                        auto lpeitem = cast<SPLPEItem>(item);
-                        if (lpeitem && lpeitem->hasPathEffectRecursive()) {
-                            item->setAttribute("inkscape:original-d", str.c_str());
-                        } else {
-                            item->setAttribute("d", str.c_str());
-                        }
-                    }
-                } else {
-                    // TODO: if there's 0 or 1 node left, delete this path altogether
-                }
+/**
+ * Tweak the paths collected by sp_tweak_dilate_recursive(). The geometry of each path is
+ * independent, so it is computed on the dispatch pool; the results are then written to the
+ * document here on the main thread.
+ */
+static bool sp_tweak_paths(Inkscape::Selection *selection, std::vector<TweakPathJob> &jobs, Geom::Point p,
+                           Geom::Point vector, gint mode, double radius, double force, double fidelity, bool reverse)
+{
+    double const zoom = selection->desktop()->current_zoom();
+    get_global_dispatch_pool()->dispatch_threshold(jobs.size(), jobs.size() > 1, [&] (int i, int) {
+        sp_tweak_path_geometry(jobs[i], p, vector, mode, radius, force, fidelity, reverse, zoom);
+    });
 
-                if (newrepr) {
-                    Inkscape::GC::release(newrepr);
-                    newrepr = nullptr;
+    bool did = false;
+    for (auto &job : jobs) {
+        auto item = job.item;
+        auto newrepr = job.newrepr;
+
+        if (job.changed) {
+            if (newrepr) { // converting to path, need to replace the repr
+                bool is_selected = selection->includes(item);
+                if (is_selected) {
+                    selection->remove(item);
                 }
-            }
 
-            delete theShape;
-            delete theRes;
-            delete res;
+                // It's going to resurrect, so we delete without notifying listeners.
+                item->deleteObject(false);
 
-            if (did_this) {
-                did = true;
+                // restore id
+                newrepr->setAttribute("id", job.id.empty() ? nullptr : job.id.c_str());
+                // add the new repr to the parent
+                // move to the saved position
+                job.parent->addChildAtPos(newrepr, job.pos);
+
+                if (is_selected)
+                    selection->add(newrepr);
+            }
+
+            if (job.res) {
+                auto const d = job.res->svg_dump_path();
+                if (newrepr) {
+                    newrepr->setAttribute("d", d.c_str());
+                } else {
+                    auto lpeitem = cast<SPLPEItem>(item);
+                    if (lpeitem && lpeitem->hasPathEffectRecursive()) {
+                        item->setAttribute("inkscape:original-d", d.c_str());
+                    } else {
+                        item->setAttribute("d", d.c_str());
+                    }
+                }
+            } else {
+                // TODO: if there's 0 or 1 node left, delete this path altogether
             }
+            did = true;
         }
 
+        if (newrepr) {
+            Inkscape::GC::release(newrepr);
+        }
     }
-
     return did;
 }
 
@@ -945,6 +995,7 @@ sp_tweak_dilate (TweakTool *tc, Geom::Point event_p, Geom::Point p, Geom::Point
     double move_force = get_move_force(tc);
     double color_force = MIN(sqrt(path_force)/20.0, 1);
 
+    std::vector<TweakPathJob> jobs;
     for (auto item : selection->items_vector()) {
         if (is_color_mode (tc->mode)) {
             if (fill_goal || stroke_goal || do_opacity) {
@@ -957,16 +1008,20 @@ sp_tweak_dilate (TweakTool *tc, Geom::Point event_p, Geom::Point p, Geom::Point
                 }
             }
         } else if (is_transform_mode(tc->mode)) {
-            if (sp_tweak_dilate_recursive (selection, item, p, vector, tc->mode, radius, move_force, tc->fidelity, reverse)) {
+            if (sp_tweak_dilate_recursive (selection, item, p, vector, tc->mode, radius, move_force, tc->fidelity, reverse, jobs)) {
                 did = true;
             }
         } else {
-            if (sp_tweak_dilate_recursive (selection, item, p, vector, tc->mode, radius, path_force, tc->fidelity, reverse)) {
+            if (sp_tweak_dilate_recursive (selection, item, p, vector, tc->mode, radius, path_force, tc->fidelity, reverse, jobs)) {
                 did = true;
             }
         }
     }
 
+    if (!jobs.empty() && sp_tweak_paths(selection, jobs, p, vector, tc->mode, radius, path_force, tc->fidelity, reverse)) {
+        did = true;
+    }
+
     return did;
 }
 
@@ -12,12 +12,15 @@
  *
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  *
- * TODO:
- *   Lazy load.
+ * Rows are created lazily: only the children of expanded rows are materialized (and observed),
+ * collapsed rows with children get a single placeholder row so that they can be expanded.
+ * Nodes with many children get their rows in batches, one per idle callback.
+ * Structural changes and row text updates are coalesced and applied once per main loop tick.
  */
 
 #include "xml-treeview.h"
 
+#include <glibmm/main.h>
 #include <glibmm/property.h>
 #include <gtkmm/dragsource.h>
 #include <gtkmm/droptarget.h>
@@ -64,6 +67,9 @@ public:
 
 /************ NodeWatcher ************/
 
+// Rows added at once when expanding a node, the others follow in idle callbacks.
+constexpr std::size_t POPULATE_BATCH = 200;
+
 class NodeWatcher : public Inkscape::XML::NodeObserver
 {
 public:
@@ -74,25 +80,32 @@ public:
     std::unordered_map<Inkscape::XML::Node const *,
                        std::unique_ptr<NodeWatcher>> child_watchers;
 
+    Inkscape::XML::Node *get_node() const { return node; }
+    Gtk::TreeModel::Path get_path() const { return row_ref.get_path(); }
+
+    // Materialize child rows, called when the row is expanded.
+    void populate(Inkscape::XML::Node const *until = nullptr);
+    void depopulate(); // Drop child rows again, called when the row is collapsed.
+    void sync();       // Apply changes queued since the last main loop tick.
+
 private:
     void update_row();
 
     // Treeview routines
     Gtk::TreeNodeChildren get_children() const;
     void add_child (Inkscape::XML::Node *child); // Add a NodeWatcher for a child.
-    void add_children();  // Add children to this node. (Maybe not needed.)
-
-    // XML routines
-    void move_child(Inkscape::XML::Node &child, Inkscape::XML::Node *sibling);
-
-    Gtk::TreeModel::iterator get_child_iterator(Inkscape::XML::Node *node) const;
+    bool add_children(Inkscape::XML::Node const *until = nullptr);
+    void sync_children();
+    void sync_placeholder();
+    void schedule();
 
     // Notifiers
     void notifyContentChanged(Inkscape::XML::Node & /* node */,
                               Inkscape::Util::ptr_shared /* old_content */,
                               Inkscape::Util::ptr_shared new_content) override
     {
-        update_row();
+        row_dirty = true;
+        schedule();
     }
 
     void notifyChildAdded(Inkscape::XML::Node &node,
@@ -101,22 +114,25 @@ private:
     {
         assert (this->node == &node);
 
-        add_child(&child);
-        move_child(child, prev);
+        children_dirty = true;
+        schedule();
     }
 
     void notifyChildRemoved(Inkscape::XML::Node &node,
                             Inkscape::XML::Node &child,
-                            Inkscape::XML::Node *) override
+                            Inkscape::XML::Node *prev) override
     {
         assert (this->node == &node);
 
-        if (child_watchers.erase(&child) > 0) {
-            return;
+        // Removed nodes may be collected before the next tick, so drop the watcher right away.
+        child_watchers.erase(&child);
+        if (&child == next_child) {
+            next_child = prev ? prev->next() : node->firstChild();
+        }
+        if (!populated) {
+            children_dirty = true;
+            schedule();
         }
-
-        std::cerr << "NodeWatcher::notifyChildRemoved: failed to remove child!"
-                  << std::endl;
     }
 
     void notifyChildOrderChanged(Inkscape::XML::Node &parent,
@@ -126,7 +142,8 @@ private:
     {
         assert (this->node == &parent);
 
-        move_child(child, new_prev);
+        children_dirty = true;
+        schedule();
     }
         
     void notifyAttributeChanged(Inkscape::XML::Node &node,
@@ -138,7 +155,8 @@ private:
         auto const attribute = g_quark_to_string(key);
         if (std::strcmp(attribute, "id") == 0 ||
             std::strcmp(attribute, "inkscape:label") == 0) {
-            update_row();
+            row_dirty = true;
+            schedule();
         }
     }
 
@@ -146,13 +164,19 @@ private:
                                   GQuark,
                                   GQuark) override
     {
-        update_row();
+        row_dirty = true;
+        schedule();
     }
 
     // Variables
     Inkscape::XML::Node* node;
     XmlTreeView *xml_tree_view;
     Gtk::TreeModel::RowReference row_ref;
+    bool populated = false;      // Child rows are materialized.
+    Inkscape::XML::Node *next_child = nullptr; // The child to add a row for next while populating.
+    sigc::scoped_connection populate_idle;
+    bool children_dirty = false; // Child rows need to be synced with the XML children.
+    bool row_dirty = false;      // Row text needs to be updated.
 };
 
 NodeWatcher::NodeWatcher(XmlTreeView *xml_tree_view, Inkscape::XML::Node *node, Gtk::TreeRow *row)
@@ -173,13 +197,16 @@ NodeWatcher::NodeWatcher(XmlTreeView *xml_tree_view, Inkscape::XML::Node *node,
     }
 
     node->addObserver(*this);
+    ++xml_tree_view->watched_nodes;
 
-    add_children(); // Recursively add all descendents.
+    sync_placeholder(); // Children are only added once the row is expanded.
 }
 
 NodeWatcher::~NodeWatcher()
 {
     node->removeObserver(*this);
+    --xml_tree_view->watched_nodes;
+    xml_tree_view->pending.erase(this);
     Gtk::TreeModel::Path path;
     if (bool(row_ref) && (path = row_ref.get_path())) {
         if (auto iter = xml_tree_view->store->get_iter(path)) {
@@ -299,54 +326,157 @@ NodeWatcher::add_child(Inkscape::XML::Node *child)
     watcher.reset(new NodeWatcher(xml_tree_view, child, &row));
 }
 
-void
-NodeWatcher::add_children()
+/**
+ * Add rows for the next batch of children, and up to the row of @a until if given.
+ * Returns whether children are left to add.
+ */
+bool
+NodeWatcher::add_children(Inkscape::XML::Node const *until)
 {
-    for (auto *child = node->firstChild(); child != nullptr; child = child->next()) {
-        add_child(child);
+    std::size_t added = 0;
+    while (next_child && (added < POPULATE_BATCH || (until && !child_watchers.contains(until)))) {
+        auto child = next_child;
+        next_child = child->next();
+        // Children moved around while populating may have their row already.
+        if (!child_watchers.contains(child)) {
+            add_child(child);
+            added++;
+        }
+    }
+
+    if (next_child) {
+        return true;
+    }
+
+    // Changes made while populating are put in order once all rows are there.
+    if (children_dirty) {
+        children_dirty = false;
+        sync_children();
     }
+    return false;
 }
 
 /**
- * Changes TreeStore in response to XML changes.
+ * Materialize the child rows, the first batch and those up to @a until right away,
+ * the others on idle.
  */
 void
-NodeWatcher::move_child(Inkscape::XML::Node &child, Inkscape::XML::Node *sibling)
+NodeWatcher::populate(Inkscape::XML::Node const *until)
 {
-    auto child_iter = get_child_iterator(&child);
-    if (!child_iter) {
-        std::cerr << "NodeWatcher::move_child: no child iterator!" << std::endl;
+    if (!populated) {
+        // Remove placeholder.
+        auto children = get_children();
+        for (auto iter = children.begin(); iter != children.end(); ) {
+            iter = xml_tree_view->store->erase(iter);
+        }
+
+        populated = true;
+        children_dirty = false;
+        next_child = node->firstChild();
+    } else if (!next_child || (until && child_watchers.contains(until))) {
         return;
     }
 
-    auto sibling_iter = get_child_iterator(sibling); // Can be null.
-    // move() puts the child before the sibling, but we need it before...
-    if (sibling_iter) {
-        sibling_iter++;
-    } else {
-        sibling_iter = get_children().begin(); // Messy!
+    if (!add_children(until)) {
+        populate_idle.disconnect();
+    } else if (!populate_idle.connected()) {
+        populate_idle = Glib::signal_idle().connect([this] { return add_children(); });
     }
-    xml_tree_view->store->move(     child_iter, sibling_iter);
 }
 
-Gtk::TreeModel::iterator
-NodeWatcher::get_child_iterator(Inkscape::XML::Node *node) const
+void
+NodeWatcher::depopulate()
 {
-    auto child_rows = get_children();
+    if (!populated) {
+        return;
+    }
 
-    if (!node) {
-        return child_rows.end();
+    populate_idle.disconnect();
+    next_child = nullptr;
+    child_watchers.clear(); // Also erases the rows.
+    populated = false;
+    sync_placeholder();
+}
+
+void
+NodeWatcher::schedule()
+{
+    xml_tree_view->pending.insert(this);
+    if (!xml_tree_view->pending_idle.connected()) {
+        xml_tree_view->pending_idle = Glib::signal_idle().connect([view = xml_tree_view] {
+            view->flush_pending();
+            return false;
+        });
     }
+}
+
+void
+NodeWatcher::sync()
+{
+    if (row_dirty && row_ref) {
+        update_row();
+    }
+    row_dirty = false;
+
+    if (children_dirty && !next_child) { // Otherwise left for when populating is done.
+        children_dirty = false;
+        if (populated) {
+            sync_children();
+        } else {
+            sync_placeholder();
+        }
+    }
+}
+
+/**
+ * Changes TreeStore in response to XML changes: rows of removed children are already gone,
+ * so insert rows for new children and move existing rows into document order.
+ */
+void
+NodeWatcher::sync_children()
+{
+    auto store = xml_tree_view->store;
+    auto children = get_children();
+    auto iter = children.begin();
+
+    for (auto *child = node->firstChild(); child != nullptr; child = child->next()) {
+        if (iter != children.end() && xml_tree_view->get_repr(*iter) == child) {
+            ++iter;
+            continue;
+        }
 
-    for (auto &row : child_rows) {
-        if (xml_tree_view->get_repr(row) == node) {
-            return row.get_iter();
+        if (auto found = child_watchers.find(child); found != child_watchers.end()) {
+            // Row exists further down, move it before the current position.
+            if (auto child_iter = store->get_iter(found->second->get_path())) {
+                store->move(child_iter, iter);
+            }
+        } else {
+            Gtk::TreeModel::Row row = *(store->insert(iter));
+            child_watchers[child].reset(new NodeWatcher(xml_tree_view, child, &row));
         }
     }
+}
 
-    std::cerr << "NodeWatcher::get_child_iterator: failed to find interator!" << std::endl;
+/**
+ * Keep a single empty row below unexpanded nodes that have children, so they get an expander.
+ */
+void
+NodeWatcher::sync_placeholder()
+{
+    if (!row_ref) {
+        return;
+    }
 
-    return child_rows.begin();
+    auto children = get_children();
+    bool const has_placeholder = !children.empty();
+    bool const needs_placeholder = node->firstChild() != nullptr;
+
+    if (needs_placeholder && !has_placeholder) {
+        Gtk::TreeModel::Row row = *(xml_tree_view->store->append(children));
+        row[xml_tree_view->model_columns->node] = nullptr;
+    } else if (!needs_placeholder && has_placeholder) {
+        xml_tree_view->store->erase(children.begin());
+    }
 }
 
 /************ NodeRenderer ***********/
@@ -409,6 +539,20 @@ XmlTreeView::XmlTreeView()
     drop->signal_motion().connect(sigc::mem_fun(*this, &XmlTreeView::on_drag_motion), false); // before
     drop->signal_drop().connect(sigc::mem_fun(*this, &XmlTreeView::on_drag_drop), false); // before
     add_controller(drop);
+
+    // Lazy loading
+    signal_test_expand_row().connect([this](Gtk::TreeModel::iterator const &iter, Gtk::TreeModel::Path const &) {
+        if (auto watcher = find_watcher(get_repr(*iter))) {
+            flush_pending();
+            watcher->populate();
+        }
+        return false; // allow expansion
+    }, false);
+    signal_row_collapsed().connect([this](Gtk::TreeModel::iterator const &iter, Gtk::TreeModel::Path const &) {
+        if (auto watcher = find_watcher(get_repr(*iter))) {
+            watcher->depopulate();
+        }
+    });
 }
 
 XmlTreeView::~XmlTreeView() = default;
@@ -433,6 +577,51 @@ XmlTreeView::build_tree(SPDocument* document_in)
 
     Gtk::TreeModel::Row row = *(store->prepend());
     root_watcher = std::make_unique<NodeWatcher>(this, root, &row);
+    root_watcher->populate();
+    expand_row(root_watcher->get_path(), false);
+}
+
+/**
+ * Find the watcher of a node whose row is materialized, nullptr otherwise.
+ */
+NodeWatcher *
+XmlTreeView::find_watcher(Inkscape::XML::Node const *node) const
+{
+    if (!node || !root_watcher) {
+        return nullptr;
+    }
+
+    std::vector<Inkscape::XML::Node const *> ancestors;
+    for (; node && node != root_watcher->get_node(); node = node->parent()) {
+        ancestors.push_back(node);
+    }
+    if (!node) {
+        return nullptr; // Not in this document.
+    }
+
+    NodeWatcher *watcher = root_watcher.get();
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+        auto found = watcher->child_watchers.find(*it);
+        if (found == watcher->child_watchers.end()) {
+            return nullptr;
+        }
+        watcher = found->second.get();
+    }
+    return watcher;
+}
+
+/**
+ * Apply all XML changes queued since the last main loop tick.
+ */
+void
+XmlTreeView::flush_pending()
+{
+    pending_idle.disconnect();
+    while (!pending.empty()) {
+        auto watcher = *pending.begin();
+        pending.erase(pending.begin());
+        watcher->sync();
+    }
 }
 
 Inkscape::XML::Node*
@@ -449,27 +638,36 @@ XmlTreeView::select_node(Inkscape::XML::Node *node, bool edit)
 {
     auto selection = get_selection();
 
-    if (node) {
-        store->foreach_iter([this, node, edit, selection](const Gtk::TreeModel::iterator &it) {
-            if ((*it)[model_columns->node] == node) {
+    if (node && root_watcher) {
+        flush_pending();
 
-                // Ensure node is shown
-                auto path = store->get_path(it);
-                expand_to_path(path);
-                auto column = get_column(0);
-                scroll_to_cell(path, *column, 0.66, 0.0);
+        std::vector<Inkscape::XML::Node *> ancestors;
+        for (auto ancestor = node; ancestor && ancestor != root_watcher->get_node(); ancestor = ancestor->parent()) {
+            ancestors.push_back(ancestor);
+        }
 
-                selection->unselect_all();
-                selection->select(it);
-                set_cursor(path, *column, edit);
+        // Materialize the rows leading to the node.
+        NodeWatcher *watcher = root_watcher.get();
+        for (auto it = ancestors.rbegin(); watcher && it != ancestors.rend(); ++it) {
+            watcher->populate(*it);
+            auto found = watcher->child_watchers.find(*it);
+            watcher = found != watcher->child_watchers.end() ? found->second.get() : nullptr;
+        }
 
-                return true; // stop
-            }
-            return false; // continue
-        });
-    } else {
-        selection->unselect_all();
+        if (watcher && watcher->get_node() == node) {
+            // Ensure node is shown
+            auto path = watcher->get_path();
+            expand_to_path(path);
+            auto column = get_column(0);
+            scroll_to_cell(path, *column, 0.66, 0.0);
+
+            selection->unselect_all();
+            selection->select(path);
+            set_cursor(path, *column, edit);
+            return;
+        }
     }
+    selection->unselect_all();
 }
 
 /*
@@ -506,7 +704,8 @@ XmlTreeView::on_prepare(Gtk::DragSource &controller, double x, double y)
             node = (*row_iter)[model_columns->node];
 
             // Don't drag, document holds pointers to these elements which must stay valid.
-            if (node->code() == CODE_sodipodi_namedview ||
+            if (!node ||
+                node->code() == CODE_sodipodi_namedview ||
                 node->code() == CODE_svg_defs) {
                 return nullptr;
             }
@@ -538,8 +737,8 @@ Gdk::DragAction XmlTreeView::on_drag_motion(double const x, double const y)
                 pos != Gtk::TreeView::DropPosition::BEFORE &&
                 pos != Gtk::TreeView::DropPosition::AFTER;
 
-            // Only xml element nodes can have children.
-            if (drop_into && node->type() != Inkscape::XML::NodeType::ELEMENT_NODE) {
+            // Placeholder rows can't be dropped onto, only xml element nodes can have children.
+            if (!node || (drop_into && node->type() != Inkscape::XML::NodeType::ELEMENT_NODE)) {
                 unset_drag_dest_row();
                 return Gdk::DragAction{};
             }
@@ -591,8 +790,8 @@ bool XmlTreeView::on_drag_drop(Glib::ValueBase const &value, double x, double y)
 
     Inkscape::XML::Node *drop_node = (*row_iter)[model_columns->node];
 
-    if (node == drop_node) {
-        // Don't drop onto self!
+    if (!drop_node || node == drop_node) {
+        // Don't drop onto self or a placeholder!
         return false;
     }
 
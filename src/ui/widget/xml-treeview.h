@@ -16,7 +16,9 @@
 #ifndef SEEN_XML_TREEVIEW_H
 #define SEEN_XML_TREEVIEW_H
 
+#include <unordered_set>
 #include <gtkmm/treeview.h>
+#include <sigc++/scoped_connection.h>
 
 #include "ui/syntax.h"  // XMLFormatter
 
@@ -52,14 +54,21 @@ public:
     void select_node(Inkscape::XML::Node *node, bool edit = false);
     void set_style(Inkscape::UI::Syntax::XMLStyles const &new_style);
     Gtk::CellRendererText *get_renderer() { return text_renderer; }
+    std::size_t get_watched_node_count() const { return watched_nodes; } // Number of observed XML nodes.
 
 private:
 
     friend class NodeWatcher;
 
+    NodeWatcher *find_watcher(Inkscape::XML::Node const *node) const;
+    void flush_pending();
+
     SPDocument* document = nullptr;
     Glib::RefPtr<Gtk::TreeStore> store;
     std::unique_ptr<ModelColumns> model_columns;
+    std::unordered_set<NodeWatcher *> pending; // Watchers with changes to apply on the next tick.
+    sigc::scoped_connection pending_idle;
+    std::size_t watched_nodes = 0;
     std::unique_ptr<NodeWatcher> root_watcher;
     std::unique_ptr<Inkscape::UI::Syntax::XMLFormatter> formatter;
     Gtk::CellRendererText *text_renderer = nullptr;
@@ -30,6 +30,31 @@ ptr_shared share_string(char const *string, std::size_t length) {
     return share_unsafe(new_string);
 }
 
+namespace {
+constexpr std::size_t POOL_BLOCK_SIZE = 4096;
+// Longer strings get a collector object of their own, so that they are reclaimed on their own.
+constexpr std::size_t POOL_MAX_LENGTH = 255;
+} // namespace
+
+ptr_shared SharedStringPool::share(char const *string)
+{
+    g_return_val_if_fail(string != nullptr, share_unsafe(nullptr));
+    auto const length = std::strlen(string);
+    if (length > POOL_MAX_LENGTH) {
+        return share_string(string, length);
+    }
+
+    if (!_block || _used + length + 1 > POOL_BLOCK_SIZE) {
+        // The strings in the previous block keep it alive for as long as they are used.
+        _block = new (GC::ATOMIC) char[POOL_BLOCK_SIZE];
+        _used = 0;
+    }
+    auto const new_string = _block + _used;
+    std::memcpy(new_string, string, length + 1);
+    _used += length + 1;
+    return share_unsafe(new_string);
+}
+
 }
 }
 
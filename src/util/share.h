@@ -96,6 +96,24 @@ inline ptr_shared share_static_string(char const *string) {
     return share_unsafe(string);
 }
 
+/**
+ * Allocates the short strings of one owner, such as the attribute values of an XML document,
+ * out of larger garbage-collected blocks. They take up less memory and fewer collector objects
+ * that way, and stay close together.
+ *
+ * A block is reclaimed by the collector once the pool has moved on to the next block, or has
+ * itself been released with its owner, and none of the block's strings is referenced anymore.
+ * Like the rest of its owner, a pool must only be used by one thread at a time.
+ */
+class SharedStringPool {
+public:
+    ptr_shared share(char const *string);
+
+private:
+    char *_block = nullptr;
+    std::size_t _used = 0;
+};
+
 }
 }
 
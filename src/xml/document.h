@@ -96,6 +96,13 @@ public:
     virtual Node *createPI(char const *target, char const *content)=0;
     /*@}*/
 
+    /**
+     * @brief Copy a string to be used as an attribute value or content of this document's nodes
+     *
+     * Implementations may allocate the copies from storage of their own.
+     */
+    virtual Util::ptr_shared shareString(char const *string)=0;
+
     Document *duplicate(Document *doc) const override = 0;
 
     /**
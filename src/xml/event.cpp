@@ -15,7 +15,11 @@
  */
 
 #include <glib.h> // g_assert()
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
 
 #include "event.h"
 #include "event-fns.h"
@@ -163,15 +167,48 @@ void Inkscape::XML::EventDel::_undoOne(
     observer.notifyChildAdded(*this->repr, *this->child, this->ref);
 }
 
+namespace {
+
+/**
+ * Rebuild the value a compacted change sets from the value the node currently has.
+ * Fails if the node was modified outside of undo and redo since.
+ */
+std::optional<Inkscape::Util::ptr_shared> rebuild_value(Inkscape::XML::ValueDelta const &delta, char const *current,
+                                                        bool to_old)
+{
+    auto const value = delta.rebuild(current, to_old);
+    if (!value) {
+        g_warning("Cannot %s change: the value was modified outside of the undo history", to_old ? "undo" : "redo");
+        return {};
+    }
+    return Inkscape::Util::share_string(value->data(), value->size());
+}
+
+} // namespace
+
 void Inkscape::XML::EventChgAttr::_undoOne(
     Inkscape::XML::NodeObserver &observer
 ) const {
+    if (this->delta) {
+        auto const current = this->repr->attribute(g_quark_to_string(this->key));
+        if (auto const value = rebuild_value(*this->delta, current, true)) {
+            observer.notifyAttributeChanged(*this->repr, this->key, Inkscape::Util::share_unsafe(current), *value);
+        }
+        return;
+    }
     observer.notifyAttributeChanged(*this->repr, this->key, this->newval, this->oldval);
 }
 
 void Inkscape::XML::EventChgContent::_undoOne(
     Inkscape::XML::NodeObserver &observer
 ) const {
+    if (this->delta) {
+        auto const current = this->repr->content();
+        if (auto const value = rebuild_value(*this->delta, current, true)) {
+            observer.notifyContentChanged(*this->repr, Inkscape::Util::share_unsafe(current), *value);
+        }
+        return;
+    }
     observer.notifyContentChanged(*this->repr, this->newval, this->oldval);
 }
 
@@ -234,12 +271,26 @@ void Inkscape::XML::EventDel::_replayOne(
 void Inkscape::XML::EventChgAttr::_replayOne(
     Inkscape::XML::NodeObserver &observer
 ) const {
+    if (this->delta) {
+        auto const current = this->repr->attribute(g_quark_to_string(this->key));
+        if (auto const value = rebuild_value(*this->delta, current, false)) {
+            observer.notifyAttributeChanged(*this->repr, this->key, Inkscape::Util::share_unsafe(current), *value);
+        }
+        return;
+    }
     observer.notifyAttributeChanged(*this->repr, this->key, this->oldval, this->newval);
 }
 
 void Inkscape::XML::EventChgContent::_replayOne(
     Inkscape::XML::NodeObserver &observer
 ) const {
+    if (this->delta) {
+        auto const current = this->repr->content();
+        if (auto const value = rebuild_value(*this->delta, current, false)) {
+            observer.notifyContentChanged(*this->repr, Inkscape::Util::share_unsafe(current), *value);
+        }
+        return;
+    }
     observer.notifyContentChanged(*this->repr, this->oldval, this->newval);
 }
 
@@ -292,6 +343,200 @@ sp_repr_free_log (Inkscape::XML::Event *log)
     }
 }
 
+/**
+ * Estimate the memory held by an event log: the event records themselves plus the attribute
+ * values and content strings they keep alive.
+ *
+ * Each value is counted with the change that replaces it. The new value of a change is held by
+ * the next change of the same attribute, or by the document, so counting it here as well would
+ * count the values shared by neighbouring undo steps twice.
+ */
+std::size_t sp_repr_log_memory_usage(Inkscape::XML::Event const *log)
+{
+    std::size_t bytes = 0;
+
+    auto const string_size = [](Inkscape::Util::ptr_shared const &str) -> std::size_t {
+        return str ? std::strlen(str) + 1 : 0;
+    };
+    auto const delta_size = [](std::unique_ptr<Inkscape::XML::ValueDelta> const &delta) -> std::size_t {
+        return delta ? sizeof(*delta) + delta->old_middle.size() + delta->new_middle.size() : 0;
+    };
+
+    for (; log; log = log->next) {
+        if (auto const chg_attr = dynamic_cast<Inkscape::XML::EventChgAttr const *>(log)) {
+            bytes += sizeof(*chg_attr) + string_size(chg_attr->oldval) + delta_size(chg_attr->delta);
+        } else if (auto const chg_content = dynamic_cast<Inkscape::XML::EventChgContent const *>(log)) {
+            bytes += sizeof(*chg_content) + string_size(chg_content->oldval) + delta_size(chg_content->delta);
+        } else if (dynamic_cast<Inkscape::XML::EventChgOrder const *>(log)) {
+            bytes += sizeof(Inkscape::XML::EventChgOrder);
+        } else if (dynamic_cast<Inkscape::XML::EventChgElementName const *>(log)) {
+            bytes += sizeof(Inkscape::XML::EventChgElementName);
+        } else {
+            bytes += sizeof(Inkscape::XML::EventAdd);
+        }
+    }
+
+    return bytes;
+}
+
+std::unique_ptr<Inkscape::XML::ValueDelta> Inkscape::XML::ValueDelta::create(char const *oldval, char const *newval,
+                                                                            bool always)
+{
+    // Shorter values are not worth the bookkeeping.
+    constexpr std::size_t MIN_LENGTH = 256;
+
+    if (!oldval || !newval) {
+        return {};
+    }
+    auto const old_value = std::string_view(oldval);
+    auto const new_value = std::string_view(newval);
+    if (std::max(old_value.size(), new_value.size()) < MIN_LENGTH) {
+        return {};
+    }
+
+    auto const shorter = std::min(old_value.size(), new_value.size());
+    std::size_t const prefix =
+        std::mismatch(old_value.begin(), old_value.begin() + shorter, new_value.begin()).first - old_value.begin();
+    std::size_t const suffix =
+        std::mismatch(old_value.rbegin(), old_value.rbegin() + (shorter - prefix), new_value.rbegin()).first -
+        old_value.rbegin();
+
+    // Unchanged values are shared with the neighbouring steps, so a delta only pays off if it is
+    // well below the size of the values.
+    auto const old_middle = old_value.substr(prefix, old_value.size() - prefix - suffix);
+    auto const new_middle = new_value.substr(prefix, new_value.size() - prefix - suffix);
+    if (!always && old_middle.size() + new_middle.size() > (old_value.size() + new_value.size()) / 2) {
+        return {};
+    }
+
+    auto delta = std::make_unique<ValueDelta>();
+    delta->prefix = prefix;
+    delta->suffix = suffix;
+    delta->old_length = old_value.size();
+    delta->new_length = new_value.size();
+    delta->old_hash = std::hash<std::string_view>{}(old_value);
+    delta->new_hash = std::hash<std::string_view>{}(new_value);
+    delta->old_middle = old_middle;
+    delta->new_middle = new_middle;
+    return delta;
+}
+
+std::optional<std::string> Inkscape::XML::ValueDelta::rebuild(char const *from, bool to_old) const
+{
+    if (spilled || !from) {
+        return {};
+    }
+
+    auto const length = to_old ? new_length : old_length;
+    auto const hash = to_old ? new_hash : old_hash;
+    auto const value = std::string_view(from);
+    if (value.size() != length || std::hash<std::string_view>{}(value) != hash) {
+        return {};
+    }
+
+    auto result = std::string(value.substr(0, prefix));
+    result += to_old ? old_middle : new_middle;
+    result += value.substr(value.size() - suffix);
+    return result;
+}
+
+namespace {
+
+template <typename E>
+void compact_event(E *event, bool always)
+{
+    if (event->delta) {
+        return;
+    }
+    event->delta = Inkscape::XML::ValueDelta::create(event->oldval, event->newval, always);
+    if (event->delta) {
+        // Unreferenced values are released by the garbage collector.
+        event->oldval = event->newval = Inkscape::Util::ptr_shared();
+    }
+}
+
+/// Store the values of a change as a delta, if it has two values and they are long.
+Inkscape::XML::ValueDelta *compact_event(Inkscape::XML::Event *event, bool always)
+{
+    if (auto const chg_attr = dynamic_cast<Inkscape::XML::EventChgAttr *>(event)) {
+        compact_event(chg_attr, always);
+        return chg_attr->delta.get();
+    } else if (auto const chg_content = dynamic_cast<Inkscape::XML::EventChgContent *>(event)) {
+        compact_event(chg_content, always);
+        return chg_content->delta.get();
+    }
+    return nullptr;
+}
+
+Inkscape::XML::ValueDelta *get_delta(Inkscape::XML::Event *event)
+{
+    if (auto const chg_attr = dynamic_cast<Inkscape::XML::EventChgAttr *>(event)) {
+        return chg_attr->delta.get();
+    } else if (auto const chg_content = dynamic_cast<Inkscape::XML::EventChgContent *>(event)) {
+        return chg_content->delta.get();
+    }
+    return nullptr;
+}
+
+} // namespace
+
+/**
+ * Store long attribute values and contents changed by the log as deltas, where they differ little.
+ * The log must only be undone or replayed in order with the rest of the history from then on.
+ */
+void sp_repr_compact_log(Inkscape::XML::Event *log)
+{
+    for (; log; log = log->next) {
+        compact_event(log, false);
+    }
+}
+
+/**
+ * Move the long values changed by the log out of memory, as deltas even where they differ a lot.
+ * Like sp_repr_compact_log(), the log must only be used in order with the rest of the history.
+ * @return The moved data, to be handed back to sp_repr_unspill_log() before the log is used.
+ */
+std::string sp_repr_spill_log(Inkscape::XML::Event *log)
+{
+    std::string data;
+    for (; log; log = log->next) {
+        auto const delta = compact_event(log, true);
+        if (!delta || delta->spilled) {
+            continue;
+        }
+        data += delta->old_middle;
+        data += delta->new_middle;
+        std::string().swap(delta->old_middle);
+        std::string().swap(delta->new_middle);
+        delta->spilled = true;
+    }
+    return data;
+}
+
+/**
+ * Restore the data moved out by sp_repr_spill_log().
+ * @return False if the data does not fit the log.
+ */
+bool sp_repr_unspill_log(Inkscape::XML::Event *log, std::string_view data)
+{
+    for (; log; log = log->next) {
+        auto const delta = get_delta(log);
+        if (!delta || !delta->spilled) {
+            continue;
+        }
+        auto const old_size = delta->old_length - delta->prefix - delta->suffix;
+        auto const new_size = delta->new_length - delta->prefix - delta->suffix;
+        if (data.size() < old_size + new_size) {
+            return false;
+        }
+        delta->old_middle = data.substr(0, old_size);
+        delta->new_middle = data.substr(old_size, new_size);
+        delta->spilled = false;
+        data.remove_prefix(old_size + new_size);
+    }
+    return data.empty();
+}
+
 namespace {
 
 template <typename T> struct ActionRelations;
@@ -346,7 +591,8 @@ Inkscape::XML::Event *Inkscape::XML::EventChgAttr::_optimizeOne() {
     /* consecutive chgattrs on the same key can be combined */
     if ( chg_attr) {
         if ( chg_attr->repr == this->repr &&
-             chg_attr->key == this->key )
+             chg_attr->key == this->key &&
+             !chg_attr->delta && !this->delta )
         {
             /* replace our oldval with the prior action's */
             this->oldval = chg_attr->oldval;
@@ -365,7 +611,7 @@ Inkscape::XML::Event *Inkscape::XML::EventChgContent::_optimizeOne() {
 
     /* consecutive content changes can be combined */
     if (chg_content) {
-        if (chg_content->repr == this->repr ) {
+        if (chg_content->repr == this->repr && !chg_content->delta && !this->delta) {
             /* replace our oldval with the prior action's */
             this->oldval = chg_content->oldval;
 
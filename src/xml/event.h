@@ -16,7 +16,11 @@
 typedef unsigned int GQuark;
 #include <glibmm/ustring.h>
 
+#include <cstddef>
 #include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
 #include "util/share.h"
 #include "util/forward-pointer-iterator.h"
 #include "inkgc/gc-managed.h"
@@ -156,6 +160,44 @@ private:
     void _replayOne(NodeObserver &observer) const override;
 };
 
+/**
+ * @brief Old and new value of a change, stored as the part in which they differ
+ *
+ * When a change is undone the node holds its new value, and when it is replayed the node holds
+ * its old value, so either value can be rebuilt from the other one. Long values edited in
+ * small steps, like path data, then only keep the edited part of each step in the undo history.
+ */
+struct ValueDelta
+{
+    /// Length of the start both values share
+    std::size_t prefix = 0;
+    /// Length of the end both values share, not overlapping the prefix
+    std::size_t suffix = 0;
+    std::size_t old_length = 0;
+    std::size_t new_length = 0;
+    /// Hashes of the values, to check the value a rebuild starts from
+    std::size_t old_hash = 0;
+    std::size_t new_hash = 0;
+    /// The differing part of each value, empty while spilled
+    std::string old_middle;
+    std::string new_middle;
+    /// Whether the differing parts were moved out by sp_repr_spill_log()
+    bool spilled = false;
+
+    /**
+     * @brief Store two values as a delta, if that saves memory or @a always
+     * @return The delta, or nullptr if a value is unset or short, or if the values mostly differ
+     *         and not @a always
+     */
+    static std::unique_ptr<ValueDelta> create(char const *oldval, char const *newval, bool always = false);
+
+    /**
+     * @brief Rebuild the old value from the new one, or the new value from the old one
+     * @return The rebuilt value, or nothing if @a from is not the value the delta was made from
+     */
+    std::optional<std::string> rebuild(char const *from, bool to_old) const;
+};
+
 /**
  * @brief Object representing attribute change
  */
@@ -174,6 +216,8 @@ public:
     Inkscape::Util::ptr_shared oldval;
     /// Value of the attribute after the change
     Inkscape::Util::ptr_shared newval;
+    /// Both values as a delta after sp_repr_compact_log(), which unsets oldval and newval
+    std::unique_ptr<ValueDelta> delta;
 
 private:
     Event *_optimizeOne() override;
@@ -196,6 +240,8 @@ public:
     Inkscape::Util::ptr_shared oldval;
     /// Content of the node after the change
     Inkscape::Util::ptr_shared newval;
+    /// Both values as a delta after sp_repr_compact_log(), which unsets oldval and newval
+    std::unique_ptr<ValueDelta> delta;
 
 private:
     Event *_optimizeOne() override;
@@ -13,10 +13,17 @@
 #include <map>
 #include <cstring>
 #include <string>
+#include <vector>
 #include <glib.h> // g_assert()
 
 #include "xml/node-iterators.h"
 #include "node-fns.h"
+#include "xml/comment-node.h"
+#include "xml/element-node.h"
+#include "xml/pi-node.h"
+#include "xml/simple-document.h"
+#include "xml/simple-node.h"
+#include "xml/text-node.h"
 
 namespace Inkscape {
 namespace XML {
@@ -70,6 +77,60 @@ Node *previous_node(Node *node) {
     return node->prev();
 }
 
+/// Size of the concrete node object behind @a node.
+static std::size_t node_size(Node const &node)
+{
+    switch (node.type()) {
+        case NodeType::DOCUMENT_NODE:
+            return sizeof(SimpleDocument);
+        case NodeType::ELEMENT_NODE:
+            return sizeof(ElementNode);
+        case NodeType::TEXT_NODE:
+            return sizeof(TextNode);
+        case NodeType::COMMENT_NODE:
+            return sizeof(CommentNode);
+        case NodeType::PI_NODE:
+            return sizeof(PINode);
+    }
+    return sizeof(SimpleNode);
+}
+
+MemoryUsage memory_usage(Node const &node)
+{
+    MemoryUsage usage;
+
+    std::vector<Node const *> stack{&node};
+    while (!stack.empty()) {
+        auto const current = stack.back();
+        stack.pop_back();
+
+        usage.nodes++;
+        usage.bytes += node_size(*current);
+
+        auto const &attributes = current->attributeList();
+        usage.attributes += attributes.size();
+        usage.bytes += attributes.capacity() * sizeof(AttributeRecord);
+        if (auto const simple = dynamic_cast<SimpleNode const *>(current)) {
+            usage.bytes += simple->attributeIndexBytes();
+        }
+        for (auto const &attr : attributes) {
+            if (attr.value) {
+                usage.bytes += std::strlen(attr.value) + 1;
+            }
+        }
+
+        if (auto const content = current->content()) {
+            usage.bytes += std::strlen(content) + 1;
+        }
+
+        for (auto child = current->firstChild(); child; child = child->next()) {
+            stack.push_back(child);
+        }
+    }
+
+    return usage;
+}
+
 }
 }
 
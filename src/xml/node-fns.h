@@ -14,6 +14,8 @@
 #ifndef SEEN_XML_NODE_FNS_H
 #define SEEN_XML_NODE_FNS_H
 
+#include <cstddef>
+
 #include "xml/node.h"
 
 namespace Inkscape {
@@ -21,6 +23,26 @@ namespace XML {
 
 bool id_permitted(Node const *node);
 
+/**
+ * @brief Memory held by an XML subtree
+ *
+ * Attribute values and content are shared strings which may also be referenced by other
+ * nodes or by undo events, so the byte count is an upper bound for what freeing the subtree
+ * would return to the heap.
+ */
+struct MemoryUsage
+{
+    std::size_t nodes = 0;      ///< Number of nodes, including the subtree root
+    std::size_t attributes = 0; ///< Number of attribute records
+    std::size_t bytes = 0;      ///< Node objects (by concrete type), attribute and string storage in bytes
+};
+
+/**
+ * @brief Measure the memory held by a node and all of its descendants
+ * @relates Inkscape::XML::Node
+ */
+MemoryUsage memory_usage(Node const &node);
+
 //@{
 /**
  * @brief Get the next node in sibling order
@@ -66,7 +66,8 @@ static void sp_repr_css_add_components(SPCSSAttr *css, Node const *repr, gchar c
  */
 SPCSSAttr *sp_repr_css_attr_new()
 {
-    static auto const attr_doc = new Inkscape::XML::SimpleDocument();
+    // One per thread, as the document's string pool isn't thread-safe. Anchored, so never freed.
+    static thread_local auto const attr_doc = new Inkscape::XML::SimpleDocument();
     return new SPCSSAttrImpl(attr_doc);
 }
 
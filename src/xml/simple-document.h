@@ -46,6 +46,8 @@ public:
     Node *createComment(char const *content) override;
     Node *createPI(char const *target, char const *content) override;
 
+    Util::ptr_shared shareString(char const *string) override { return _strings.share(string); }
+
     Document *duplicate(Document * /* doc */) const override;
 
     void notifyChildAdded(Node &parent, Node &child, Node *prev) override;
@@ -75,6 +77,7 @@ protected:
 private:
     bool _in_transaction = false;
     LogBuilder _log_builder;
+    Util::SharedStringPool _strings; ///< Released with the document
 };
 
 }
@@ -213,6 +213,7 @@ SimpleNode::SimpleNode(SimpleNode const &node, Document *document)
     }
 
     _attributes = node._attributes;
+    _rebuildAttributeIndex();
 
     _observers.add(_subtree_observers);
 }
@@ -228,18 +229,80 @@ gchar const *SimpleNode::content() const {
 gchar const *SimpleNode::attribute(gchar const *name) const {
     g_return_val_if_fail(name != nullptr, NULL);
 
-    GQuark const key = g_quark_from_string(name);
+    // An attribute name which was never interned cannot be set on any node.
+    GQuark const key = g_quark_try_string(name);
+    if (!key) {
+        return nullptr;
+    }
 
-    for (const auto & iter : _attributes)
-    {
-        if ( iter.key == key ) {
-            return iter.value;
+    auto const record = _findAttribute(key);
+    return record ? record->value : nullptr;
+}
+
+namespace {
+
+// Nodes with more attributes than this get a hash index for lookups.
+constexpr std::size_t ATTRIBUTE_INDEX_THRESHOLD = 16;
+
+inline std::size_t attribute_bucket(GQuark key, std::size_t mask)
+{
+    // Fibonacci hashing; quarks are small sequential integers.
+    return (static_cast<std::size_t>(key) * 2654435761u) & mask;
+}
+
+} // namespace
+
+AttributeRecord *SimpleNode::_findAttribute(GQuark key)
+{
+    if (_attribute_index.empty()) {
+        for (auto &record : _attributes) {
+            if (record.key == key) {
+                return &record;
+            }
         }
+        return nullptr;
     }
 
+    auto const mask = _attribute_index.size() - 1;
+    for (auto bucket = attribute_bucket(key, mask); _attribute_index[bucket]; bucket = (bucket + 1) & mask) {
+        auto &record = _attributes[_attribute_index[bucket] - 1];
+        if (record.key == key) {
+            return &record;
+        }
+    }
     return nullptr;
 }
 
+void SimpleNode::_rebuildAttributeIndex()
+{
+    _attribute_index.clear();
+    if (_attributes.size() <= ATTRIBUTE_INDEX_THRESHOLD) {
+        _attribute_index.shrink_to_fit();
+        return;
+    }
+
+    // Keep the load factor at or below one half.
+    std::size_t size = 2 * ATTRIBUTE_INDEX_THRESHOLD;
+    while (size < 2 * _attributes.size()) {
+        size *= 2;
+    }
+    _attribute_index.resize(size);
+
+    for (unsigned i = 0; i < _attributes.size(); i++) {
+        _indexAttribute(i);
+    }
+}
+
+void SimpleNode::_indexAttribute(unsigned position)
+{
+    auto const mask = _attribute_index.size() - 1;
+    auto bucket = attribute_bucket(_attributes[position].key, mask);
+    while (_attribute_index[bucket]) {
+        bucket = (bucket + 1) & mask;
+    }
+    _attribute_index[bucket] = position + 1;
+}
+
 unsigned SimpleNode::position() const {
     g_return_val_if_fail(_parent != nullptr, 0);
     return _parent->_childPosition(*this);
@@ -293,7 +356,7 @@ void SimpleNode::_setParent(SimpleNode *parent) {
 
 void SimpleNode::setContent(gchar const *content) {
     ptr_shared old_content=_content;
-    ptr_shared new_content = ( content ? share_string(content) : ptr_shared() );
+    ptr_shared new_content = ( content ? _document->shareString(content) : ptr_shared() );
 
     Debug::EventTracker<> tracker;
     if (new_content) {
@@ -361,23 +424,22 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
 
     GQuark const key = g_quark_from_string(name);
 
-    AttributeRecord *ref = nullptr;
-    for ( auto & existing : _attributes ) {
-        if ( existing.key == key ) {
-            ref = &existing;
-            break;
-        }
-    }
+    AttributeRecord *ref = _findAttribute(key);
     Debug::EventTracker<> tracker;
 
     ptr_shared old_value=( ref ? ref->value : ptr_shared() );
 
     ptr_shared new_value=ptr_shared();
     if (cleaned_value) { // set value of attribute
-        new_value = share_string(cleaned_value);
+        new_value = _document->shareString(cleaned_value);
         tracker.set<DebugSetAttribute>(*this, key, new_value);
         if (!ref) {
 	    _attributes.emplace_back(key, new_value);
+            if (!_attribute_index.empty() && 2 * _attributes.size() <= _attribute_index.size()) {
+                _indexAttribute(_attributes.size() - 1);
+            } else if (_attributes.size() > ATTRIBUTE_INDEX_THRESHOLD) {
+                _rebuildAttributeIndex();
+            }
         } else {
             ref->value = new_value;
         }
@@ -385,6 +447,10 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
         tracker.set<DebugClearAttribute>(*this, key);
         if (ref) {
 	    _attributes.erase(std::find(_attributes.begin(),_attributes.end(),(*ref)));
+            if (!_attribute_index.empty()) {
+                // Removal shifts the positions of all later attributes.
+                _rebuildAttributeIndex();
+            }
         }
     }
 
@@ -19,6 +19,7 @@
 #include <iostream>
 #include <vector>
 
+#include "inkgc/gc-alloc.h"
 #include "xml/node.h"
 #include "xml/attribute-record.h"
 #include "xml/composite-node-observer.h"
@@ -93,6 +94,11 @@ public:
         return _attributes;
     }
 
+    /// Memory held by the index that speeds up attribute lookups on nodes with many attributes.
+    std::size_t attributeIndexBytes() const {
+        return _attribute_index.capacity() * sizeof(AttributeIndex::value_type);
+    }
+
     void synthesizeEvents(NodeObserver &observer) override;
 
     void addObserver(NodeObserver &observer) override {
@@ -123,6 +129,13 @@ private:
     void _setParent(SimpleNode *parent);
     unsigned _childPosition(SimpleNode const &child) const;
 
+    AttributeRecord *_findAttribute(GQuark key);
+    AttributeRecord const *_findAttribute(GQuark key) const {
+        return const_cast<SimpleNode *>(this)->_findAttribute(key);
+    }
+    void _rebuildAttributeIndex();
+    void _indexAttribute(unsigned position);
+
     SimpleNode *_parent;
     SimpleNode *_next;
     SimpleNode *_prev;
@@ -133,6 +146,14 @@ private:
 
     AttributeVector _attributes;
 
+    /**
+     * Open-addressing table from attribute key to position in _attributes + 1 (0 marks an empty
+     * bucket). It is only built for nodes with many attributes; _attributes remains the owner
+     * of the records and keeps their insertion order for serialization.
+     */
+    using AttributeIndex = std::vector<unsigned, Inkscape::GC::Alloc<unsigned, Inkscape::GC::ATOMIC>>;
+    AttributeIndex _attribute_index;
+
     Inkscape::Util::ptr_shared _content;
 
     unsigned _child_count{0};
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the Cairo renderer used by PDF and PS export
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "display/drawing.h"
+#include "document.h"
+#include "extension/internal/cairo-render-context.h"
+#include "extension/internal/cairo-renderer.h"
+#include "inkscape.h"
+#include "object/sp-item.h"
+#include "object/sp-root.h"
+
+using namespace Inkscape::Extension::Internal;
+using namespace std::literals;
+
+class CairoRendererTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase() { Inkscape::Application::create(false); }
+
+    /// Render the document like PDF export does, but into a bitmap so that the result can be inspected.
+    static cairo_surface_t *render_vector(SPDocument *doc, bool reuse_clones)
+    {
+        doc->ensureUpToDate();
+        auto root = doc->getRoot();
+
+        // Vector targets are set up in pt, i.e. at 3/4 of the px size.
+        auto const size = doc->getDimensions() * 0.75;
+        auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, std::ceil(size.x()), std::ceil(size.y()));
+
+        CairoRenderer renderer;
+        renderer.setReuseClones(reuse_clones);
+        {
+            CairoRenderContext ctx = renderer.createContext();
+            EXPECT_TRUE(ctx.setSurfaceTarget(surface, true));
+            EXPECT_TRUE(renderer.setupDocument(&ctx, doc, root));
+            EXPECT_TRUE(renderer.renderPages(&ctx, doc, false));
+            ctx.finish(false);
+        }
+
+        cairo_surface_flush(surface);
+        return surface;
+    }
+
+    /// Render the document with filtered items rasterized, with one device pixel per px.
+    static cairo_surface_t *render_rasterized(SPDocument *doc, std::size_t bitmap_budget)
+    {
+        doc->ensureUpToDate();
+        auto root = doc->getRoot();
+
+        auto const size = doc->getDimensions();
+        auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, std::ceil(size.x()), std::ceil(size.y()));
+        // Undo the scaling from px to pt that is applied to vector targets.
+        cairo_matrix_t ctm;
+        cairo_matrix_init_scale(&ctm, 4.0 / 3.0, 4.0 / 3.0);
+
+        CairoRenderer renderer;
+        {
+            CairoRenderContext ctx = renderer.createContext();
+            ctx.setFilterToBitmap(true);
+            ctx.setBitmapResolution(96);
+            ctx.setBitmapBudget(bitmap_budget);
+            EXPECT_TRUE(ctx.setSurfaceTarget(surface, true, &ctm));
+            EXPECT_TRUE(renderer.setupDocument(&ctx, doc, root));
+            EXPECT_TRUE(renderer.renderPages(&ctx, doc, false));
+            ctx.finish(false);
+        }
+
+        cairo_surface_flush(surface);
+        return surface;
+    }
+
+    static std::uint32_t pixel(cairo_surface_t *surface, int x, int y)
+    {
+        auto const data = cairo_image_surface_get_data(surface) + y * cairo_image_surface_get_stride(surface);
+        return reinterpret_cast<std::uint32_t const *>(data)[x];
+    }
+};
+
+TEST_F(CairoRendererTest, SharedClonesDoNotPaintClipContent)
+{
+    auto doc = SPDocument::createNewDocFromMem(R"(
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink" width="100" height="100">
+  <defs>
+    <rect id="shape" width="50" height="50" style="fill:#00ff00"/>
+    <clipPath id="clip"><use xlink:href="#shape"/></clipPath>
+  </defs>
+  <rect width="100" height="100" style="fill:#0000ff" clip-path="url(#clip)"/>
+  <use xlink:href="#shape" x="50" y="50"/>
+</svg>)"sv);
+    ASSERT_TRUE(doc);
+
+    for (bool reuse_clones : {false, true}) {
+        auto surface = render_vector(doc.get(), reuse_clones);
+        // Inside the clip, the clipped rectangle shows; the clone in the clip path itself is not painted.
+        EXPECT_EQ(pixel(surface, 18, 18), 0xff0000ff) << reuse_clones;
+        // Outside the clip, nothing is painted...
+        EXPECT_EQ(pixel(surface, 56, 18), 0x00000000) << reuse_clones;
+        // ...except the visible clone.
+        EXPECT_EQ(pixel(surface, 56, 56), 0xff00ff00) << reuse_clones;
+        cairo_surface_destroy(surface);
+    }
+}
+
+TEST_F(CairoRendererTest, TiledBitmapsMatchUntiled)
+{
+    auto doc = SPDocument::createNewDocFromMem(R"(
+<svg xmlns="http://www.w3.org/2000/svg" width="400" height="400">
+  <filter id="blur"><feGaussianBlur stdDeviation="4"/></filter>
+  <rect x="20" y="20" width="360" height="360" filter="url(#blur)"
+        style="fill:#3366cc;stroke:#cc3300;stroke-width:10;image-rendering:pixelated"/>
+</svg>)"sv);
+    ASSERT_TRUE(doc);
+
+    // The default budget fits the whole 400x400 bitmap, none splits it into 256x256 tiles.
+    auto untiled = render_rasterized(doc.get(), 64 << 20);
+    auto tiled = render_rasterized(doc.get(), 0);
+
+    // Something was drawn, both in and across tile boundaries.
+    EXPECT_NE(pixel(untiled, 200, 200), 0u);
+    EXPECT_NE(pixel(untiled, 256, 256), 0u);
+
+    int mismatches = 0;
+    for (int y = 0; y < 400; y++) {
+        for (int x = 0; x < 400; x++) {
+            if (pixel(tiled, x, y) != pixel(untiled, x, y)) {
+                mismatches++;
+            }
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+
+    cairo_surface_destroy(untiled);
+    cairo_surface_destroy(tiled);
+}
+
+TEST_F(CairoRendererTest, PreparedBitmapsLandInPlace)
+{
+    // More filtered items than worker threads, so that rasterizations start as others are taken.
+    auto doc = SPDocument::createNewDocFromMem(R"(
+<svg xmlns="http://www.w3.org/2000/svg" width="300" height="200">
+  <filter id="blur"><feGaussianBlur stdDeviation="1"/></filter>
+  <rect x="10" y="10" width="80" height="80" filter="url(#blur)" style="fill:#ff0000"/>
+  <rect x="110" y="10" width="80" height="80" filter="url(#blur)" style="fill:#00ff00"/>
+  <rect x="210" y="10" width="80" height="80" filter="url(#blur)" style="fill:#0000ff"/>
+  <g>
+    <rect x="10" y="110" width="80" height="80" filter="url(#blur)" style="fill:#ffff00"/>
+    <rect x="110" y="110" width="80" height="80" filter="url(#blur)" style="display:none"/>
+    <rect x="110" y="110" width="80" height="80" filter="url(#blur)" style="fill:#00ffff"/>
+  </g>
+  <rect x="210" y="110" width="80" height="80" filter="url(#blur)" style="fill:#ff00ff"/>
+</svg>)"sv);
+    ASSERT_TRUE(doc);
+
+    auto surface = render_rasterized(doc.get(), 64 << 20);
+    EXPECT_EQ(pixel(surface, 50, 50), 0xffff0000);
+    EXPECT_EQ(pixel(surface, 150, 50), 0xff00ff00);
+    EXPECT_EQ(pixel(surface, 250, 50), 0xff0000ff);
+    EXPECT_EQ(pixel(surface, 50, 150), 0xffffff00);
+    EXPECT_EQ(pixel(surface, 150, 150), 0xff00ffff);
+    EXPECT_EQ(pixel(surface, 250, 150), 0xffff00ff);
+    cairo_surface_destroy(surface);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test picking canvas items from large groups and batches of handles
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "display/control/canvas-item-ctrl-batch.h"
+#include "display/control/canvas-item-group.h"
+#include "display/control/canvas-item-rect.h"
+#include "inkscape.h"
+#include "ui/widget/canvas.h"
+#include "ui/widget/events/canvas-event.h"
+
+using namespace Inkscape;
+
+class CanvasItemGroupTest : public ::testing::Test
+{
+protected:
+    std::unique_ptr<UI::Widget::Canvas> canvas;
+    CanvasItemGroup *group = nullptr;
+    std::vector<CanvasItemRect *> stack; // The rects of the group, bottom up.
+    std::mt19937 rng{42};
+
+    void SetUp() override
+    {
+        char const *gui_env = std::getenv("INKSCAPE_TEST_GUI");
+        if (!gui_env || std::string(gui_env) != "1") {
+            GTEST_SKIP() << "Skipping GUI tests: GUI testing not enabled";
+        } else {
+            gtk_init();
+        }
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+
+        canvas = std::make_unique<UI::Widget::Canvas>();
+        group = new CanvasItemGroup(canvas->get_canvas_item_root());
+        for (int i = 0; i < 300; i++) {
+            auto rect = new CanvasItemRect(group, random_rect());
+            rect->set_pickable(true);
+            stack.push_back(rect);
+        }
+        update();
+    }
+
+    void TearDown() override
+    {
+        if (group) {
+            group->unlink();
+        }
+        canvas.reset();
+    }
+
+    Geom::Point random_point(double extent = 1000)
+    {
+        std::uniform_real_distribution<double> coord(0, extent);
+        return {coord(rng), coord(rng)};
+    }
+
+    Geom::Rect random_rect(Geom::Point const &offset = {})
+    {
+        std::uniform_real_distribution<double> size(5, 60);
+        auto const p = random_point() + offset;
+        return Geom::Rect::from_xywh(p, {size(rng), size(rng)});
+    }
+
+    void update() { canvas->get_canvas_item_root()->update(false); }
+
+    /// What picking should find: the topmost visible rect containing the point.
+    CanvasItem *linear_pick(Geom::Point const &p)
+    {
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+            if ((*it)->is_visible() && (*it)->contains(p)) {
+                return *it;
+            }
+        }
+        return nullptr;
+    }
+
+    void expect_same_picks()
+    {
+        int hits = 0;
+        for (int i = 0; i < 2000; i++) {
+            // Some points outside the rects as well.
+            auto const p = random_point(1100) - Geom::Point(50, 50);
+            auto const expected = linear_pick(p);
+            ASSERT_EQ(group->pick_item(p), expected) << "at " << p;
+            hits += expected != nullptr;
+        }
+        EXPECT_GT(hits, 0);
+    }
+};
+
+TEST_F(CanvasItemGroupTest, PicksTopmostItem)
+{
+    expect_same_picks();
+}
+
+TEST_F(CanvasItemGroupTest, PicksMovedItems)
+{
+    expect_same_picks();
+
+    // Move some children within the grid, and a few far out of it.
+    for (int i = 0; i < 300; i += 7) {
+        stack[i]->set_rect(random_rect());
+    }
+    stack[1]->set_rect(Geom::Rect::from_xywh(-500, -500, 40, 40));
+    stack[2]->set_rect(Geom::Rect::from_xywh(2000, 2000, 40, 40));
+    update();
+    expect_same_picks();
+    EXPECT_EQ(group->pick_item({-480, -480}), stack[1]);
+    EXPECT_EQ(group->pick_item({2020, 2020}), stack[2]);
+
+    // Move every child, more than fit outside the grid.
+    for (auto rect : stack) {
+        rect->set_rect(random_rect({1500, 0}));
+    }
+    update();
+    expect_same_picks();
+}
+
+TEST_F(CanvasItemGroupTest, PicksInStackingOrderAfterRestacking)
+{
+    expect_same_picks();
+
+    for (int i = 0; i < 300; i += 11) {
+        stack[i]->raise_to_top();
+    }
+    for (int i = 5; i < 300; i += 13) {
+        stack[i]->lower_to_bottom();
+    }
+    // Rebuild the expected order the same way.
+    std::vector<CanvasItemRect *> raised, lowered, rest;
+    for (int i = 0; i < 300; i++) {
+        if (i >= 5 && (i - 5) % 13 == 0) {
+            lowered.insert(lowered.begin(), stack[i]);
+        } else if (i % 11 == 0) {
+            raised.push_back(stack[i]);
+        } else {
+            rest.push_back(stack[i]);
+        }
+    }
+    stack = lowered;
+    stack.insert(stack.end(), rest.begin(), rest.end());
+    stack.insert(stack.end(), raised.begin(), raised.end());
+    update();
+    expect_same_picks();
+}
+
+TEST_F(CanvasItemGroupTest, SkipsHiddenItems)
+{
+    expect_same_picks();
+
+    for (int i = 0; i < 300; i += 3) {
+        stack[i]->set_visible(false);
+    }
+    update();
+    expect_same_picks();
+
+    for (int i = 0; i < 300; i += 6) {
+        stack[i]->set_visible(true);
+    }
+    update();
+    expect_same_picks();
+}
+
+TEST_F(CanvasItemGroupTest, BatchSendsEventsToTopmostHandle)
+{
+    auto batch = new CanvasItemCtrlBatch(group);
+    std::vector<std::string> events;
+    auto const add = [&] (char const *name, Geom::Point const &p) {
+        auto entry = batch->add(CANVAS_ITEM_CTRL_TYPE_NODE_CUSP);
+        batch->set_position(entry, p);
+        batch->set_handler(entry, [&events, name] (CanvasEvent const &event) {
+            events.push_back(std::string(name) + ":" + std::to_string(static_cast<int>(event.type())));
+            return true;
+        });
+        return entry;
+    };
+    auto a = add("a", {2000, 2000});
+    auto b = add("b", {2000, 2000});
+    auto c = add("c", {2100, 2000});
+    update();
+
+    auto const enter = [] (Geom::Point const &p) {
+        auto event = EnterEvent();
+        event.pos = p;
+        return event;
+    };
+    auto const motion = [] (Geom::Point const &p) {
+        auto event = MotionEvent();
+        event.pos = p;
+        return event;
+    };
+    auto const name = [] (char const *handle, EventType type) {
+        return std::string(handle) + ":" + std::to_string(static_cast<int>(type));
+    };
+
+    EXPECT_TRUE(batch->contains({2000, 2000}));
+    EXPECT_FALSE(batch->contains({2050, 2000}));
+    EXPECT_EQ(group->pick_item({2000, 2000}), batch);
+
+    // The handle added last is on top.
+    batch->handle_event(enter({2000, 2000}));
+    EXPECT_EQ(events, (std::vector{name("b", EventType::ENTER)}));
+
+    // Moving to another handle leaves the first one.
+    events.clear();
+    batch->handle_event(motion({2100, 2000}));
+    EXPECT_EQ(events, (std::vector{name("b", EventType::LEAVE), name("c", EventType::ENTER),
+                                   name("c", EventType::MOTION)}));
+
+    // Lowering the top handle uncovers the one below, and hidden handles aren't hit.
+    batch->lower_to_bottom(b);
+    batch->set_visible(c, false);
+    update();
+    EXPECT_FALSE(batch->contains({2100, 2000}));
+    events.clear();
+    batch->handle_event(motion({2000, 2000}));
+    EXPECT_EQ(events, (std::vector{name("c", EventType::LEAVE), name("a", EventType::ENTER),
+                                   name("a", EventType::MOTION)}));
+
+    // Removed handles get nothing more.
+    batch->remove(a);
+    update();
+    events.clear();
+    batch->handle_event(motion({2000, 2000}));
+    EXPECT_EQ(events, (std::vector{name("b", EventType::ENTER), name("b", EventType::MOTION)}));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
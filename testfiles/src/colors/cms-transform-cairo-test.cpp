@@ -8,17 +8,113 @@
  */
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
 
 #include "colors/cms/profile.h"
 #include "colors/cms/transform.h"
 #include "colors/cms/transform-cairo.h"
 
+static std::string grb_profile = INKSCAPE_TESTS_DIR "/data/colors/SwappedRedAndGreen.icc";
+static std::string display_profile = INKSCAPE_TESTS_DIR "/data/colors/display.icc";
+static std::string cmyk_profile = INKSCAPE_TESTS_DIR "/data/colors/default_cmyk.icc";
+
 using namespace Inkscape::Colors;
 
 namespace {
 
-TEST(ColorsCmsTransformCairo, writeTestsHere)
+/**
+ * Transform random premultiplied pixels through the lookup table and return the largest
+ * difference to transforming each pixel with lcms directly.
+ */
+int max_lut_error(CMS::TransformCairo const &tr)
+{
+    int const width = 256;
+    int const height = 64;
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    auto const stride = cairo_image_surface_get_stride(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::uint32_t> dist(0, 255);
+    std::vector<std::uint32_t> input;
+    for (int y = 0; y < height; y++) {
+        auto row = reinterpret_cast<std::uint32_t *>(data + y * stride);
+        for (int x = 0; x < width; x++) {
+            // Mostly opaque, with some translucent pixels to check premultiplication.
+            std::uint32_t const a = x % 4 ? 255 : dist(gen);
+            std::uint32_t const r = dist(gen) * a / 255, g = dist(gen) * a / 255, b = dist(gen) * a / 255;
+            row[x] = a << 24 | r << 16 | g << 8 | b;
+            input.push_back(row[x]);
+        }
+    }
+    cairo_surface_mark_dirty(surface);
+
+    tr.do_transform(surface, surface);
+
+    int error = 0;
+    for (int y = 0; y < height; y++) {
+        auto row = reinterpret_cast<std::uint32_t const *>(data + y * stride);
+        for (int x = 0; x < width; x++) {
+            auto const px = input[y * width + x];
+            auto const a = px >> 24;
+            EXPECT_EQ(row[x] >> 24, a);
+            if (a == 0) {
+                EXPECT_EQ(row[x], 0);
+                continue;
+            }
+            float rgba[4] = {((px >> 16) & 0xff) / (float)a, ((px >> 8) & 0xff) / (float)a, (px & 0xff) / (float)a, 1.0f};
+            float result[4];
+            cmsDoTransform(tr.getHandle(), rgba, result, 1);
+            for (int c = 0; c < 3; c++) {
+                int const expected = std::lround(std::clamp(result[c], 0.0f, 1.0f) * a);
+                int const actual = (row[x] >> (16 - c * 8)) & 0xff;
+                error = std::max(error, std::abs(expected - actual));
+            }
+        }
+    }
+    cairo_surface_destroy(surface);
+    return error;
+}
+
+TEST(ColorsCmsTransformCairo, lutMatchesLcms)
+{
+    auto srgb = CMS::Profile::create_srgb();
+    auto display = CMS::Profile::create_from_uri(display_profile);
+    ASSERT_TRUE(display);
+
+    auto tr = CMS::TransformCairo(srgb, display);
+    ASSERT_TRUE(tr.has_lut());
+    // Within about one percent of the exact transform.
+    EXPECT_LE(max_lut_error(tr), 3);
+}
+
+TEST(ColorsCmsTransformCairo, lutSwapsChannels)
 {
+    auto srgb = CMS::Profile::create_srgb();
+    auto grb = CMS::Profile::create_from_uri(grb_profile);
+    ASSERT_TRUE(grb);
+
+    auto tr = CMS::TransformCairo(srgb, grb);
+    ASSERT_TRUE(tr.has_lut());
+    EXPECT_LE(max_lut_error(tr), 1);
+}
+
+TEST(ColorsCmsTransformCairo, noLutWithGamutWarning)
+{
+    auto srgb = CMS::Profile::create_srgb();
+    auto display = CMS::Profile::create_from_uri(display_profile);
+    auto cmyk = CMS::Profile::create_from_uri(cmyk_profile);
+    ASSERT_TRUE(display);
+    ASSERT_TRUE(cmyk);
+
+    // Soft proofing alone is still sampled.
+    auto proof = CMS::TransformCairo(srgb, display, cmyk, RenderingIntent::PERCEPTUAL, false);
+    EXPECT_TRUE(proof.has_lut());
+
+    auto gamut_warn = CMS::TransformCairo(srgb, display, cmyk, RenderingIntent::PERCEPTUAL, true);
+    EXPECT_FALSE(gamut_warn.has_lut());
 }
 
 } // namespace
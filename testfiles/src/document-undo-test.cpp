@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the undo history of documents
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "document-undo.h"
+#include "document.h"
+#include "inkscape.h"
+#include "preferences.h"
+#include "object/sp-object.h"
+#include "xml/node.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+class DocumentUndoTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase() { Application::create(false); }
+
+    void SetUp() override
+    {
+        doc = SPDocument::createNewDocFromMem(R"(
+<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+  <rect id="rect" width="10" height="10"/>
+</svg>)"sv);
+        ASSERT_TRUE(doc);
+        repr = doc->getObjectById("rect")->getRepr();
+    }
+
+    void TearDown() override
+    {
+        auto prefs = Preferences::get();
+        prefs->setBool("/options/undo/limit", true);
+        prefs->setInt("/options/undo/budget", 0);
+        prefs->setBool("/options/undo/spill", true);
+    }
+
+    void change(std::string const &value)
+    {
+        repr->setAttribute("data-blob", value);
+        DocumentUndo::done(doc.get(), RC_("Undo", "Change blob"), "");
+    }
+
+    std::unique_ptr<SPDocument> doc;
+    XML::Node *repr = nullptr;
+};
+
+// Unrelated values of a quarter MiB each.
+static std::string unrelated_value(int i)
+{
+    return std::string(256 * 1024, 'a' + i);
+}
+
+// Half MiB values that only differ from each other in a few characters.
+static std::string similar_value(int i)
+{
+    auto value = std::string(512 * 1024, 'x');
+    value.replace(value.size() / 2, 4, std::to_string(1000 + i));
+    return value;
+}
+
+TEST_F(DocumentUndoTest, SimilarValuesAreStoredAsDeltas)
+{
+    constexpr int changes = 20;
+    for (int i = 0; i < changes; i++) {
+        change(similar_value(i));
+    }
+
+    // Only the top step holds a full value, the ones below it only hold what changed.
+    EXPECT_LT(DocumentUndo::getUndoMemoryUsage(doc.get()), 1024 * 1024);
+
+    for (int i = changes - 1; i > 0; i--) {
+        ASSERT_TRUE(DocumentUndo::undo(doc.get()));
+        EXPECT_EQ(repr->attribute("data-blob"), similar_value(i - 1));
+    }
+    while (DocumentUndo::redo(doc.get())) {
+    }
+    EXPECT_EQ(repr->attribute("data-blob"), similar_value(changes - 1));
+}
+
+TEST_F(DocumentUndoTest, BudgetSpillsOldSteps)
+{
+    auto prefs = Preferences::get();
+    prefs->setBool("/options/undo/limit", false);
+    prefs->setInt("/options/undo/budget", 1);
+
+    constexpr int changes = 10;
+    for (int i = 0; i < changes; i++) {
+        change(unrelated_value(i));
+    }
+
+    EXPECT_LE(DocumentUndo::getUndoMemoryUsage(doc.get()), 1024 * 1024);
+
+    // No step was dropped, the old ones are read back from the temporary file.
+    for (int i = changes - 1; i > 0; i--) {
+        ASSERT_TRUE(DocumentUndo::undo(doc.get()));
+        EXPECT_EQ(repr->attribute("data-blob"), unrelated_value(i - 1));
+    }
+    ASSERT_TRUE(DocumentUndo::undo(doc.get()));
+    EXPECT_FALSE(repr->attribute("data-blob"));
+    EXPECT_FALSE(DocumentUndo::undo(doc.get()));
+}
+
+TEST_F(DocumentUndoTest, BudgetDropsOldestStepsWithoutSpill)
+{
+    auto prefs = Preferences::get();
+    // The budget applies on its own, without a limit on the number of steps.
+    prefs->setBool("/options/undo/limit", false);
+    prefs->setInt("/options/undo/budget", 1);
+    prefs->setBool("/options/undo/spill", false);
+
+    constexpr int changes = 10;
+    for (int i = 0; i < changes; i++) {
+        change(unrelated_value(i));
+    }
+
+    EXPECT_LE(DocumentUndo::getUndoMemoryUsage(doc.get()), 1024 * 1024);
+
+    // Each step holds the quarter MiB value it replaces. The value it sets is held by the next
+    // step or the document and is not counted again, so three steps fit into the budget.
+    int steps = 0;
+    while (DocumentUndo::undo(doc.get())) {
+        steps++;
+    }
+    EXPECT_EQ(steps, 3);
+
+    // The steps that were kept are the newest ones.
+    EXPECT_EQ(repr->attribute("data-blob"), unrelated_value(changes - steps - 1));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
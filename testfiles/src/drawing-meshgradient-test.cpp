@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Test the tiled rasterization of mesh gradients
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cairo.h>
+#include <cairomm/surface.h>
+
+#include "colors/color.h"
+#include "display/drawing-paintserver.h"
+
+namespace Inkscape {
+
+namespace {
+
+/// A single patch over the square (0, 0) - (size, size), with a different colour at each corner.
+DrawingMeshGradient make_mesh(double size)
+{
+    Geom::Point const corners[4] = {{0, 0}, {size, 0}, {size, size}, {0, size}};
+    uint32_t const colors[4] = {0xff0000ff, 0x00ff00ff, 0x0000ffff, 0xffffffff};
+
+    DrawingMeshGradient::PatchData data{};
+    for (int k = 0; k < 4; k++) {
+        auto const a = corners[k], b = corners[(k + 1) % 4];
+        for (int i = 0; i < 4; i++) {
+            data.points[k][i] = Geom::lerp(i / 3.0, a, b);
+        }
+        data.pathtype[k] = 'l';
+        data.tensorIsSet[k] = false;
+        data.color[k] = Colors::Color(colors[k]);
+    }
+    return DrawingMeshGradient(SP_GRADIENT_SPREAD_PAD, SP_GRADIENT_UNITS_USERSPACEONUSE, Geom::identity(), 1, 1,
+                               {{data}});
+}
+
+/// Paint @a mesh at @a scale into the part @a clip of @a surface.
+void paint(DrawingMeshGradient const &mesh, Cairo::RefPtr<Cairo::ImageSurface> const &surface, double scale,
+           Geom::IntRect const &clip)
+{
+    auto ct = cairo_create(surface->cobj());
+    cairo_rectangle(ct, clip.left(), clip.top(), clip.width(), clip.height());
+    cairo_clip(ct);
+    cairo_scale(ct, scale, scale);
+    auto pat = mesh.create_pattern(ct, {}, 1.0);
+    cairo_set_source(ct, pat);
+    cairo_paint(ct);
+    cairo_pattern_destroy(pat);
+    cairo_destroy(ct);
+    surface->flush();
+}
+
+/// The largest difference between the channels of two images of the same size.
+int max_difference(Cairo::RefPtr<Cairo::ImageSurface> const &a, Cairo::RefPtr<Cairo::ImageSurface> const &b)
+{
+    int result = 0;
+    for (int y = 0; y < a->get_height(); y++) {
+        auto const row_a = a->get_data() + y * a->get_stride();
+        auto const row_b = b->get_data() + y * b->get_stride();
+        for (int x = 0; x < a->get_width() * 4; x++) {
+            result = std::max(result, std::abs(row_a[x] - row_b[x]));
+        }
+    }
+    return result;
+}
+
+auto create_image(int size)
+{
+    return Cairo::ImageSurface::create(Cairo::ImageSurface::Format::ARGB32, size, size);
+}
+
+} // namespace
+
+TEST(DrawingMeshGradientTest, TilesMatchExactMesh)
+{
+    constexpr int size = 600;
+    constexpr double scale = 2.5;
+    auto const mesh = make_mesh(200);
+    auto const whole = Geom::IntRect(0, 0, size, size);
+
+    // painting into a vector surface keeps the exact mesh
+    auto reference = create_image(size);
+    {
+        auto recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+        auto rct = cairo_create(recording);
+        cairo_scale(rct, scale, scale);
+        auto pat = mesh.create_pattern(rct, {}, 1.0);
+        ASSERT_EQ(cairo_pattern_get_type(pat), CAIRO_PATTERN_TYPE_MESH);
+        cairo_destroy(rct);
+        cairo_surface_destroy(recording);
+
+        auto ct = cairo_create(reference->cobj());
+        cairo_scale(ct, scale, scale);
+        cairo_set_source(ct, pat);
+        cairo_paint(ct);
+        cairo_destroy(ct);
+        cairo_pattern_destroy(pat);
+        reference->flush();
+    }
+
+    auto tiled = create_image(size);
+    paint(mesh, tiled, scale, whole);
+    EXPECT_LE(max_difference(tiled, reference), 2);
+
+    // 500 x 500 pixels of mesh take 2 x 2 tiles
+    auto const cached = mesh.cached_tiles();
+    EXPECT_EQ(cached, 4);
+
+    // painting again, a quarter at a time, reuses the same tiles
+    auto quarters = create_image(size);
+    for (int i = 0; i < 4; i++) {
+        auto const x = i % 2 * size / 2, y = i / 2 * size / 2;
+        paint(mesh, quarters, scale, Geom::IntRect::from_xywh(x, y, size / 2, size / 2));
+    }
+    EXPECT_EQ(mesh.cached_tiles(), cached);
+    EXPECT_LE(max_difference(quarters, tiled), 1);
+}
+
+TEST(DrawingMeshGradientTest, CacheIsBounded)
+{
+    auto const mesh = make_mesh(100);
+    auto image = create_image(400);
+    for (int i = 0; i < 100; i++) {
+        paint(mesh, image, 1.0 + i * 0.03, Geom::IntRect(0, 0, 400, 400));
+        EXPECT_LE(mesh.cached_tiles(), DrawingMeshGradient::MAX_TILES);
+    }
+    EXPECT_GT(mesh.cached_tiles(), 0);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for DrawingSampler
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <gtest/gtest.h>
+#include <src/display/cairo-utils.h>
+#include <src/display/drawing-sampler.h>
+
+TEST(DrawingSamplerTest, averageColorMatchesRender)
+{
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 8, 6);
+    auto cr = cairo_create(surface);
+    cairo_set_source_rgba(cr, 1, 0, 0, 1);
+    cairo_rectangle(cr, 0, 0, 3, 6);
+    cairo_fill(cr);
+    cairo_set_source_rgba(cr, 0, 0.5, 1, 0.5);
+    cairo_rectangle(cr, 3, 2, 5, 4);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    auto const origin = Geom::IntPoint(10, 20);
+    auto const sampler = Inkscape::DrawingSampler(surface, origin);
+    EXPECT_EQ(sampler.area(), Geom::IntRect::from_xywh(origin, {8, 6}));
+
+    for (auto const &box : {Geom::IntRect(0, 0, 8, 6), Geom::IntRect(0, 0, 3, 6), Geom::IntRect(2, 1, 7, 5),
+                            Geom::IntRect(3, 2, 8, 6), Geom::IntRect(-2, -2, 4, 4)}) {
+        // Reference: copy the box into its own surface and average it the usual way.
+        auto part = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, box.width(), box.height());
+        auto pcr = cairo_create(part);
+        cairo_set_source_surface(pcr, surface, -box.left(), -box.top());
+        cairo_paint(pcr);
+        cairo_destroy(pcr);
+        auto const expected = ink_cairo_surface_average_color(part).toRGBA();
+        cairo_surface_destroy(part);
+
+        auto const result = sampler.averageColor(box + origin).toRGBA();
+        for (int shift = 0; shift < 32; shift += 8) {
+            EXPECT_NEAR((result >> shift) & 0xff, (expected >> shift) & 0xff, 1) << "box " << box;
+        }
+    }
+
+    // Entirely outside the sampled area.
+    EXPECT_EQ(sampler.averageColor(Geom::IntRect(0, 0, 4, 4)).toRGBA(), 0u);
+
+    cairo_surface_destroy(surface);
+}
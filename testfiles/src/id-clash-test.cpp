@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Tests for resolving ID clashes when importing or pasting.
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <gtest/gtest.h>
+
+#include <src/document.h>
+#include <src/id-clash.h>
+#include <src/inkscape.h>
+#include <src/object/sp-defs.h>
+#include <src/object/sp-linear-gradient.h>
+#include <src/object/sp-root.h>
+
+using namespace Inkscape;
+using namespace std::literals;
+
+class IdClashTest : public ::testing::Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        Inkscape::Application::create(false);
+    }
+
+    static std::unique_ptr<SPDocument> create_doc(int count)
+    {
+        std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink">)"
+                          R"(<defs><linearGradient id="grad"><stop offset="0" style="stop-color:#ff0000"/>)"
+                          R"(<stop offset="1" style="stop-color:#0000ff"/></linearGradient></defs>)";
+        for (int i = 0; i < count; i++) {
+            auto const id = std::to_string(i);
+            svg += "<rect id=\"rect" + id + "\" width=\"1\" height=\"1\" style=\"fill:url(#grad)\"/>";
+            svg += "<use id=\"use" + id + "\" xlink:href=\"#rect" + id + "\"/>";
+        }
+        svg += "</svg>";
+        return SPDocument::createNewDocFromMem(svg);
+    }
+};
+
+TEST_F(IdClashTest, PasteTenThousandObjects)
+{
+    constexpr int count = 10000;
+    auto current = create_doc(count);
+    auto imported = create_doc(count);
+    ASSERT_TRUE(current);
+    ASSERT_TRUE(imported);
+
+    prevent_id_clashes(imported.get(), current.get(), true);
+
+    for (int i = 0; i < count; i += 997) {
+        auto const id = std::to_string(i);
+        // Clashing ids get a deterministic suffix...
+        EXPECT_FALSE(imported->getObjectById("rect" + id));
+        auto rect = imported->getObjectById("rect" + id + "-1");
+        ASSERT_TRUE(rect);
+        auto use = imported->getObjectById("use" + id + "-1");
+        ASSERT_TRUE(use);
+        // ...and references follow the change.
+        EXPECT_STREQ(use->getAttribute("xlink:href"), ("#rect" + id + "-1").c_str());
+    }
+
+    // An equivalent gradient keeps its id, so it can be merged with the existing one.
+    EXPECT_TRUE(imported->getObjectById("grad"));
+    EXPECT_FALSE(imported->getObjectById("grad-1"));
+}
+
+TEST_F(IdClashTest, SuffixSkipsTakenIds)
+{
+    auto current = SPDocument::createNewDocFromMem(
+        R"(<svg xmlns="http://www.w3.org/2000/svg"><rect id="a"/><rect id="a-1"/></svg>)"s);
+    auto imported = SPDocument::createNewDocFromMem(
+        R"(<svg xmlns="http://www.w3.org/2000/svg"><rect id="a"/><rect id="a-2"/></svg>)"s);
+    ASSERT_TRUE(current);
+    ASSERT_TRUE(imported);
+
+    prevent_id_clashes(imported.get(), current.get(), true);
+
+    EXPECT_FALSE(imported->getObjectById("a"));
+    EXPECT_TRUE(imported->getObjectById("a-2"));
+    EXPECT_TRUE(imported->getObjectById("a-3"));
+}
+
+TEST_F(IdClashTest, SuffixStartsPastExistingOnes)
+{
+    // e.g. after importing the same document many times
+    auto current = SPDocument::createNewDocFromMem(
+        R"(<svg xmlns="http://www.w3.org/2000/svg"><rect id="a"/><rect id="a-1"/><rect id="a-7"/>)"
+        R"(<rect id="a-07"/><rect id="a-x3"/></svg>)"s);
+    auto imported = SPDocument::createNewDocFromMem(
+        R"(<svg xmlns="http://www.w3.org/2000/svg"><rect id="a"/></svg>)"s);
+    ASSERT_TRUE(current);
+    ASSERT_TRUE(imported);
+
+    EXPECT_EQ(current->highestIdSuffix("a-"), 7ul);
+    EXPECT_EQ(current->highestIdSuffix("b-"), 0ul);
+
+    prevent_id_clashes(imported.get(), current.get(), true);
+
+    EXPECT_FALSE(imported->getObjectById("a"));
+    EXPECT_TRUE(imported->getObjectById("a-8"));
+}
+
+TEST_F(IdClashTest, ImportMergesOnlyEquivalentGradients)
+{
+    auto const gradient = [] (char const *id, char const *x2, char const *color) {
+        return "<linearGradient id=\""s + id + "\" x1=\"0\" y1=\"0\" x2=\"" + x2 + "\" y2=\"0\">"
+               "<stop offset=\"0\" style=\"stop-color:" + color + "\"/>"
+               "<stop offset=\"1\" style=\"stop-color:#0000ff\"/></linearGradient>";
+    };
+    auto const svg = [] (std::string const &defs) {
+        return R"(<svg xmlns="http://www.w3.org/2000/svg"><defs>)" + defs + "</defs></svg>";
+    };
+    auto current = SPDocument::createNewDocFromMem(svg(gradient("grad", "1", "#ff0000")));
+    auto imported = SPDocument::createNewDocFromMem(svg(gradient("same", "1", "#ff0000") +
+                                                        gradient("moved", "2", "#ff0000") +
+                                                        gradient("recolored", "1", "#fe0000")));
+    ASSERT_TRUE(current);
+    ASSERT_TRUE(imported);
+
+    current->importDefs(imported.get());
+
+    std::vector<std::string> ids;
+    for (auto &child : current->getDefs()->children) {
+        if (is<SPLinearGradient>(&child)) {
+            ids.emplace_back(child.getId());
+        }
+    }
+    EXPECT_EQ(ids, (std::vector<std::string>{"grad", "moved", "recolored"}));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Rebuilding only the segments of a path next to the nodes that moved
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+#include <gtest/gtest.h>
+
+#include <2geom/path-sink.h>
+#include <2geom/path.h>
+
+#include "ui/tool/path-manipulator.h"
+
+using namespace Inkscape::UI;
+
+namespace {
+
+using Runs = std::vector<std::pair<std::size_t, std::size_t>>;
+
+/// A path through @a points, with a cubic segment between each pair of them.
+Geom::Path curve_through(std::vector<Geom::Point> const &points, bool closed)
+{
+    Geom::PathBuilder builder;
+    builder.moveTo(points.front());
+    for (std::size_t i = 1; i < points.size(); ++i) {
+        auto const &a = points[i - 1], &b = points[i];
+        builder.curveTo(a + Geom::Point(1, 2), b - Geom::Point(2, 1), b);
+    }
+    if (closed) {
+        builder.closePath();
+    }
+    builder.flush();
+    return builder.peek().front();
+}
+
+Geom::Path sub_curve(std::vector<Geom::Point> const &points, std::size_t first, std::size_t last)
+{
+    return curve_through({points.begin() + first, points.begin() + last + 2}, false);
+}
+
+} // namespace
+
+TEST(PathManipulatorTest, MovedSegmentRuns)
+{
+    EXPECT_EQ(moved_segment_runs({}, 5), Runs{});
+    EXPECT_EQ(moved_segment_runs({0}, 1), Runs{});
+    EXPECT_EQ(moved_segment_runs({0}, 5), (Runs{{0, 0}}));
+    EXPECT_EQ(moved_segment_runs({4}, 5), (Runs{{3, 3}}));
+    EXPECT_EQ(moved_segment_runs({2}, 5), (Runs{{1, 2}}));
+    // runs that touch or overlap are merged
+    EXPECT_EQ(moved_segment_runs({1, 2}, 8), (Runs{{0, 2}}));
+    EXPECT_EQ(moved_segment_runs({1, 3}, 8), (Runs{{0, 3}}));
+    EXPECT_EQ(moved_segment_runs({1, 4}, 8), (Runs{{0, 1}, {3, 4}}));
+    EXPECT_EQ(moved_segment_runs({1, 6, 7}, 8), (Runs{{0, 1}, {5, 6}}));
+}
+
+TEST(PathManipulatorTest, SpliceMatchesFullRebuild)
+{
+    for (bool closed : {false, true}) {
+        std::vector<Geom::Point> points{{0, 0}, {10, 0}, {20, 5}, {30, 0}, {40, 10}, {50, 0}, {60, 3}};
+        auto path = curve_through(points, closed);
+
+        points[2] += Geom::Point(3, -7);
+        points[5] += Geom::Point(-1, 4);
+        for (auto [first, last] : moved_segment_runs({2, 5}, points.size())) {
+            EXPECT_TRUE(splice_segments(path, first, last, sub_curve(points, first, last)));
+        }
+        EXPECT_EQ(path, curve_through(points, closed));
+    }
+}
+
+TEST(PathManipulatorTest, SpliceMovesOpenEnds)
+{
+    std::vector<Geom::Point> points{{0, 0}, {10, 0}, {20, 5}, {30, 0}};
+    auto path = curve_through(points, false);
+
+    points.front() = {-5, -5};
+    points.back() = {35, 5};
+    for (auto [first, last] : moved_segment_runs({0, 3}, points.size())) {
+        EXPECT_TRUE(splice_segments(path, first, last, sub_curve(points, first, last)));
+    }
+    EXPECT_EQ(path, curve_through(points, false));
+}
+
+TEST(PathManipulatorTest, SpliceRejectsGaps)
+{
+    std::vector<Geom::Point> points{{0, 0}, {10, 0}, {20, 5}, {30, 0}, {40, 10}};
+    auto const path = curve_through(points, true);
+    auto spliced = path;
+
+    // the run would leave a gap to the unmoved node 3
+    auto moved = points;
+    moved[3] += Geom::Point(1, 1);
+    EXPECT_FALSE(splice_segments(spliced, 2, 2, sub_curve(moved, 2, 2)));
+    // the run doesn't have as many segments as it replaces
+    EXPECT_FALSE(splice_segments(spliced, 1, 2, sub_curve(points, 1, 1)));
+    // past the end of the path
+    EXPECT_FALSE(splice_segments(spliced, 3, 4, sub_curve(points, 2, 3)));
+    EXPECT_EQ(spliced, path);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
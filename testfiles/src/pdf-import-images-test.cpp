@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Embedding the JPEG images of imported PDFs as they are, and what it saves
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#include <glibmm/miscutils.h>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "extension/db.h"
+#include "extension/input.h"
+#include "extension/internal/pdfinput/pdf-input.h"
+#include "inkscape.h"
+#include "xml/node.h"
+#include "xml/repr.h"
+
+using namespace Inkscape;
+
+namespace {
+
+constexpr int WIDTH = 800;
+constexpr int HEIGHT = 600;
+
+/// A photo-like RGB image: smooth gradients with some noise, as written by libjpeg.
+std::string make_jpeg(unsigned seed)
+{
+    auto pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, false, 8, WIDTH, HEIGHT);
+    auto const pixels = gdk_pixbuf_get_pixels(pixbuf);
+    auto const stride = gdk_pixbuf_get_rowstride(pixbuf);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-12, 12);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            auto p = pixels + y * stride + x * 3;
+            p[0] = std::clamp(x * 255 / WIDTH + noise(rng), 0, 255);
+            p[1] = std::clamp(y * 255 / HEIGHT + noise(rng), 0, 255);
+            p[2] = std::clamp(static_cast<int>(seed * 40 % 256) + noise(rng), 0, 255);
+        }
+    }
+    gchar *buffer = nullptr;
+    gsize size = 0;
+    gdk_pixbuf_save_to_buffer(pixbuf, &buffer, &size, "jpeg", nullptr, "quality", "85", nullptr);
+    g_object_unref(pixbuf);
+    auto result = std::string(buffer, size);
+    g_free(buffer);
+    return result;
+}
+
+/// A one page PDF showing the given JPEG images one above the other.
+std::string make_pdf(std::vector<std::string> const &jpegs, std::string const &decode_params)
+{
+    auto const count = static_cast<int>(jpegs.size());
+    std::vector<std::string> objects;
+    objects.emplace_back("<< /Type /Catalog /Pages 2 0 R >>");
+    objects.emplace_back("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+
+    std::string xobjects, content;
+    for (int i = 0; i < count; i++) {
+        auto const name = "/Im" + std::to_string(i);
+        xobjects += name + " " + std::to_string(5 + i) + " 0 R ";
+        content += "q " + std::to_string(WIDTH) + " 0 0 " + std::to_string(HEIGHT) + " 0 " +
+                   std::to_string(i * HEIGHT) + " cm " + name + " Do Q\n";
+    }
+    objects.emplace_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " + std::to_string(WIDTH) + " " +
+                         std::to_string(count * HEIGHT) + "] /Resources << /XObject << " + xobjects +
+                         ">> >> /Contents 4 0 R >>");
+    objects.emplace_back("<< /Length " + std::to_string(content.size()) + " >>\nstream\n" + content + "\nendstream");
+    for (auto const &jpeg : jpegs) {
+        objects.emplace_back("<< /Type /XObject /Subtype /Image /Width " + std::to_string(WIDTH) + " /Height " +
+                             std::to_string(HEIGHT) + " /ColorSpace /DeviceRGB /BitsPerComponent 8"
+                             " /Filter /DCTDecode " + decode_params + " /Length " + std::to_string(jpeg.size()) +
+                             " >>\nstream\n" + jpeg + "\nendstream");
+    }
+
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < objects.size(); i++) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+    auto const xref = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (auto offset : offsets) {
+        auto entry = std::to_string(offset);
+        pdf += std::string(10 - entry.size(), '0') + entry + " 00000 n \n";
+    }
+    pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+           std::to_string(xref) + "\n%%EOF\n";
+    return pdf;
+}
+
+struct ImportResult
+{
+    std::chrono::steady_clock::duration time;
+    std::size_t jpeg_images = 0;
+    std::size_t png_images = 0;
+    std::size_t image_bytes = 0; ///< Size of the data URIs of the images.
+};
+
+ImportResult import_pdf(std::string const &pdf, char const *name)
+{
+    auto const path = Glib::build_filename(Glib::get_tmp_dir(), name);
+    g_file_set_contents(path.c_str(), pdf.data(), pdf.size(), nullptr);
+    auto input = dynamic_cast<Extension::Input *>(Extension::db.get("org.inkscape.input.pdf"));
+
+    ImportResult result;
+    auto const start = std::chrono::steady_clock::now();
+    auto doc = input->open(path.c_str());
+    result.time = std::chrono::steady_clock::now() - start;
+    g_remove(path.c_str());
+
+    EXPECT_TRUE(doc);
+    if (doc) {
+        for (auto image : sp_repr_lookup_name_many(doc->getReprRoot(), "svg:image")) {
+            std::string const href = image->attribute("xlink:href") ? image->attribute("xlink:href") : "";
+            result.jpeg_images += href.starts_with("data:image/jpeg;base64,");
+            result.png_images += href.starts_with("data:image/png;base64,");
+            result.image_bytes += href.size();
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+class PdfImportImagesTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        Application::create(false);
+        if (!Extension::db.get("org.inkscape.input.pdf")) {
+            Extension::Internal::PdfInput::init();
+        }
+    }
+};
+
+TEST_F(PdfImportImagesTest, JpegPassThroughSavesTimeAndSize)
+{
+    constexpr int count = 6;
+    std::vector<std::string> jpegs;
+    for (int i = 0; i < count; i++) {
+        jpegs.push_back(make_jpeg(i));
+    }
+
+    // libjpeg writes a JFIF marker, so other readers take the data for YCbCr as the PDF does
+    // by default; saying otherwise in the PDF means the images have to be converted.
+    auto const passed = import_pdf(make_pdf(jpegs, ""), "pdf-import-images-jpeg.pdf");
+    auto const converted =
+        import_pdf(make_pdf(jpegs, "/DecodeParms << /ColorTransform 0 >>"), "pdf-import-images-png.pdf");
+
+    EXPECT_EQ(passed.jpeg_images, count);
+    EXPECT_EQ(passed.png_images, 0);
+    EXPECT_EQ(converted.jpeg_images, 0);
+    EXPECT_EQ(converted.png_images, count);
+
+    using ms = std::chrono::duration<double, std::milli>;
+    RecordProperty("jpeg_import_ms", std::to_string(ms(passed.time).count()));
+    RecordProperty("png_import_ms", std::to_string(ms(converted.time).count()));
+    RecordProperty("jpeg_image_bytes", std::to_string(passed.image_bytes));
+    RecordProperty("png_image_bytes", std::to_string(converted.image_bytes));
+
+    // Noisy photos compress several times better as JPEG than as PNG.
+    EXPECT_LT(passed.image_bytes * 2, converted.image_bytes);
+    EXPECT_LT(passed.time, converted.time);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <unordered_set>
 #include <gtest/gtest.h>
+#include <2geom/transforms.h>
 #include <src/document.h>
 #include <src/object/sp-item.h>
 #include <src/object/sp-object.h>
@@ -8,8 +11,10 @@
 #include "geom-predicates.h"
 #include "inkscape.h"
 #include "object/object-set.h"
+#include "object/sp-path.h"
 #include "object/sp-root.h"
 #include "style.h"
+#include "svg/svg.h"
 #include "util/units.h"
 
 using namespace Inkscape;
@@ -260,3 +265,97 @@ TEST_F(SPDocumentTestSVGPair, ImportParentGroupWhenNeeded)
         EXPECT_EQ(style->fill.getColor(), Colors::Color(0xff000000, false));
     }
 }
+
+TEST(SPDocumentTest, PreparsedAttributesMatchSerialParsing)
+{
+    Application::create(false);
+    // Enough paths for them to be parsed on the dispatch pool.
+    std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg">)";
+    for (int i = 0; i < 200; i++) {
+        auto const n = std::to_string(i);
+        svg += "<path id=\"path" + n + "\" d=\"M " + n + ",0 L 10,10 C 1,2 3,4 5," + n + " Z\"";
+        if (i % 3 == 0) {
+            svg += " transform=\"translate(" + n + ",2) rotate(30)\"";
+        } else if (i % 3 == 1) {
+            svg += " transform=\"bogus(" + n + ")\"";
+        }
+        svg += "/>";
+    }
+    svg += "</svg>";
+    auto doc = SPDocument::createNewDocFromMem(svg);
+    ASSERT_TRUE(doc);
+
+    for (int i = 0; i < 200; i++) {
+        auto const n = std::to_string(i);
+        auto path = cast<SPPath>(doc->getObjectById("path" + n));
+        ASSERT_TRUE(path);
+        ASSERT_TRUE(path->curve());
+        EXPECT_EQ(*path->curve(), sp_svg_read_pathv(path->getAttribute("d")));
+
+        Geom::Affine expected;
+        if (i % 3 == 0) {
+            expected = Geom::Rotate::from_degrees(30) * Geom::Translate(i, 2);
+        }
+        EXPECT_TRUE(Geom::are_near(path->transform, expected, 1e-9)) << i;
+    }
+}
+
+TEST(SPDocumentTest, GenerateUniqueIdContinuesAfterHighestSuffix)
+{
+    Application::create(false);
+    auto doc = SPDocument::createNewDocFromMem(
+        std::string(R"(<svg xmlns="http://www.w3.org/2000/svg"><rect id="rect2"/><rect id="rect7"/>)"
+                    R"(<rect id="rect07"/><rect id="rect1a"/><path id="path3"/></svg>)"));
+    ASSERT_TRUE(doc);
+
+    EXPECT_EQ(doc->generate_unique_id("rect"), "rect8");
+    EXPECT_EQ(doc->generate_unique_id("path"), "path4");
+    // Prefixes ending in a digit still get ids nobody uses.
+    EXPECT_EQ(doc->generate_unique_id("rect0"), "rect08");
+
+    // Released suffixes are handed out again before the counter grows.
+    doc->getObjectById("rect7")->deleteObject();
+    EXPECT_EQ(doc->generate_unique_id("rect"), "rect7");
+    EXPECT_EQ(doc->generate_unique_id("rect"), "rect9");
+}
+
+TEST(SPDocumentTest, GenerateUniqueIdHundredThousand)
+{
+    Application::create(false);
+    std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg">)";
+    for (int i = 1; i <= 1000; i++) {
+        svg += "<rect id=\"rect" + std::to_string(i) + "\"/>";
+    }
+    svg += "</svg>";
+    auto doc = SPDocument::createNewDocFromMem(svg);
+    ASSERT_TRUE(doc);
+
+    constexpr int count = 100000;
+
+    // Baseline: building an id and looking it up once, which is all that generating an id
+    // should cost, rather than probing every id in use.
+    std::unordered_set<std::string> baseline_ids;
+    auto const baseline_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        auto id = "rect" + std::to_string(1001 + i);
+        if (!doc->getObjectById(id)) {
+            baseline_ids.insert(std::move(id));
+        }
+    }
+    auto const baseline = std::chrono::steady_clock::now() - baseline_start;
+
+    std::unordered_set<std::string> ids;
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        ids.insert(doc->generate_unique_id("rect"));
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(ids.size(), count);
+    EXPECT_FALSE(ids.contains("rect1000"));
+    EXPECT_TRUE(ids.contains("rect1001"));
+    EXPECT_TRUE(ids == baseline_ids);
+    // Probing from the first suffix takes about a thousand lookups per id here; the margin is
+    // generous so that a busy machine does not fail the test.
+    EXPECT_LT(elapsed, baseline * 20 + std::chrono::milliseconds(100));
+}
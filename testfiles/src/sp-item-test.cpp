@@ -13,9 +13,12 @@
 
 #include <2geom/pathvector.h>
 
+#include "display/drawing.h"
+#include "display/drawing-item.h"
 #include "document.h"
 #include "inkscape.h"
 #include "object/sp-item.h"
+#include "object/sp-root.h"
 #include "svg/svg.h"
 
 using namespace Inkscape;
@@ -80,3 +83,39 @@ TEST_F(SPItemTest, getClipPathVector)
     auto pathv4 = r_item->getClipPathVector(r_parent);
     ASSERT_EQ(sp_svg_write_path(*pathv4), "M 13.166016,13.166016 V 40.837891 H 40.837891 V 13.166016 Z");
 }
+
+TEST_F(SPItemTest, HiddenInViewSurvivesUpdates)
+{
+    constexpr auto svg = R"""(<?xml version="1.0"?>
+<svg width="100" height="100">
+  <rect id="rect1" width="50" height="50" style="fill:blue" />
+</svg>)"""sv;
+
+    auto doc = SPDocument::createNewDocFromMem(svg);
+    doc->ensureUpToDate();
+    auto rect = cast<SPItem>(doc->getObjectById("rect1"));
+    ASSERT_TRUE(rect);
+
+    Drawing drawing;
+    auto const dkey = SPItem::display_key_new(1);
+    drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+    auto const other_key = SPItem::display_key_new(1);
+    Drawing other;
+    other.setRoot(doc->getRoot()->invoke_show(other, other_key, SP_ITEM_SHOW_DISPLAY));
+
+    rect->setHiddenInView(dkey, true);
+    EXPECT_FALSE(rect->get_arenaitem(dkey)->visible());
+    EXPECT_TRUE(rect->get_arenaitem(other_key)->visible());
+
+    // a style change updates the visibility of every view
+    rect->setAttribute("style", "fill:red;opacity:0.5");
+    doc->ensureUpToDate();
+    EXPECT_FALSE(rect->get_arenaitem(dkey)->visible());
+    EXPECT_TRUE(rect->get_arenaitem(other_key)->visible());
+
+    rect->setHiddenInView(dkey, false);
+    EXPECT_TRUE(rect->get_arenaitem(dkey)->visible());
+
+    doc->getRoot()->invoke_hide(dkey);
+    doc->getRoot()->invoke_hide(other_key);
+}
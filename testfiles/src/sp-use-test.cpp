@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for clones, and for clone instancing mode in particular
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <memory>
+#include <gtest/gtest.h>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "preferences.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+#include "object/sp-path.h"
+#include "object/sp-root.h"
+#include "object/sp-use.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+namespace {
+
+constexpr auto symbols = R"(
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink" width="100" height="20">
+  <defs>
+    <symbol id="sym"><rect width="10" height="10"/></symbol>
+  </defs>
+  <use id="a" xlink:href="#sym" width="10" height="10" y="5" style="fill:#ff0000"/>
+  <use id="b" xlink:href="#sym" width="10" height="10" x="20.3" y="5" style="fill:#ff0000"/>
+  <use id="c" xlink:href="#sym" width="10" height="10" y="5" transform="translate(40.6,0.4)" style="fill:#ff0000"/>
+  <use id="d" xlink:href="#sym" width="10" height="10" x="60" y="5" style="fill:#0000ff"/>
+</svg>)"sv;
+
+/// Shows a document in a drawing of its own.
+class Display
+{
+public:
+    explicit Display(SPDocument &doc)
+        : _root(doc.getRoot())
+        , _key(SPItem::display_key_new(1))
+    {
+        _drawing.setRoot(_root->invoke_show(_drawing, _key, SP_ITEM_SHOW_DISPLAY));
+    }
+
+    ~Display() { _root->invoke_hide(_key); }
+
+    Cairo::RefPtr<Cairo::ImageSurface> draw(Geom::IntRect const &rect)
+    {
+        _drawing.update();
+        auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width(), rect.height());
+        auto ds = DrawingSurface(surface->cobj(), rect.min());
+        auto dc = DrawingContext(ds);
+        _drawing.render(dc, rect);
+        surface->flush();
+        return surface;
+    }
+
+private:
+    Drawing _drawing;
+    SPRoot *_root;
+    unsigned _key;
+};
+
+std::uint32_t pixel(Cairo::RefPtr<Cairo::ImageSurface> const &surface, int x, int y)
+{
+    return *reinterpret_cast<std::uint32_t const *>(surface->get_data() + y * surface->get_stride() + x * 4);
+}
+
+} // namespace
+
+class SPUseTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase() { Application::create(false); }
+
+    void TearDown() override { Preferences::get()->setBool("/options/cloneinstancing/value", false); }
+
+    std::unique_ptr<SPDocument> load(bool instancing)
+    {
+        Preferences::get()->setBool("/options/cloneinstancing/value", instancing);
+        auto doc = SPDocument::createNewDocFromMem(symbols);
+        doc->ensureUpToDate();
+        return doc;
+    }
+
+    static SPUse *use(SPDocument &doc, char const *id) { return cast<SPUse>(doc.getObjectById(id)); }
+};
+
+TEST_F(SPUseTest, InstancesShareTheChildOfTheFirstUse)
+{
+    auto doc = load(true);
+    auto a = use(*doc, "a"), b = use(*doc, "b"), c = use(*doc, "c"), d = use(*doc, "d");
+
+    ASSERT_TRUE(a->child);
+    EXPECT_FALSE(a->master());
+    for (auto instance : {b, c}) {
+        EXPECT_EQ(instance->master(), a);
+        EXPECT_FALSE(instance->child);
+        EXPECT_EQ(instance->sharedChild(), a->child);
+    }
+    // A different fill is inherited by the content, so the content is different.
+    EXPECT_FALSE(d->master());
+    EXPECT_TRUE(d->child);
+
+    auto const bbox = b->documentVisualBounds();
+    ASSERT_TRUE(bbox);
+    EXPECT_TRUE(Geom::are_near(*bbox, Geom::Rect::from_xywh(20.3, 5, 10, 10), 1e-6)) << *bbox;
+}
+
+TEST_F(SPUseTest, InstancesRenderLikeClones)
+{
+    auto const area = Geom::IntRect(0, 0, 100, 20);
+    auto const reference = Display(*load(false)).draw(area);
+
+    auto doc = load(true);
+    auto display = Display(*doc);
+    // The second time round, the instances paint the rasters of the first.
+    for (int i = 0; i < 2; i++) {
+        auto const surface = display.draw(area);
+        EXPECT_EQ(pixel(surface, 5, 10), 0xffff0000);
+        EXPECT_EQ(pixel(surface, 25, 10), 0xffff0000);
+        EXPECT_EQ(pixel(surface, 45, 10), 0xffff0000);
+        EXPECT_EQ(pixel(surface, 65, 10), 0xff0000ff);
+        EXPECT_EQ(pixel(surface, 15, 10), 0u);
+
+        // Instances are placed to the nearest quarter pixel, which only shows at their edges.
+        int maxdiff = 0;
+        for (int y = 0; y < area.height(); y++) {
+            for (int x = 0; x < area.width(); x++) {
+                auto const p = pixel(reference, x, y), q = pixel(surface, x, y);
+                for (int shift = 0; shift < 32; shift += 8) {
+                    maxdiff = std::max(maxdiff, std::abs(int((p >> shift) & 0xff) - int((q >> shift) & 0xff)));
+                }
+            }
+        }
+        EXPECT_LE(maxdiff, 40);
+    }
+}
+
+TEST_F(SPUseTest, InstancesFindAnotherMaster)
+{
+    auto doc = load(true);
+    auto display = Display(*doc);
+    display.draw(Geom::IntRect(0, 0, 100, 20));
+
+    auto b = use(*doc, "b"), c = use(*doc, "c"), d = use(*doc, "d");
+
+    // Looking like another clone makes it share that one's content.
+    b->setAttribute("style", "fill:#0000ff");
+    doc->ensureUpToDate();
+    EXPECT_EQ(b->master(), d);
+    EXPECT_EQ(c->master(), use(*doc, "a"));
+
+    // When the master goes away, the first of its instances takes over.
+    use(*doc, "a")->deleteObject();
+    doc->ensureUpToDate();
+    EXPECT_FALSE(c->master());
+    EXPECT_TRUE(c->child);
+
+    auto const surface = display.draw(Geom::IntRect(0, 0, 100, 20));
+    EXPECT_EQ(pixel(surface, 5, 10), 0u);
+    EXPECT_EQ(pixel(surface, 25, 10), 0xff0000ff);
+    EXPECT_EQ(pixel(surface, 45, 10), 0xffff0000);
+}
+
+TEST_F(SPUseTest, ClonedPathFollowsItsOriginal)
+{
+    auto doc = SPDocument::createNewDocFromMem(R"(
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink" width="100" height="100">
+  <path id="p" d="M 0,0 H 10 V 10 Z"/>
+  <use id="u1" xlink:href="#p"/>
+  <use id="u2" xlink:href="#p"/>
+</svg>)"sv);
+    doc->ensureUpToDate();
+
+    auto const path_of = [&] (char const *id) { return cast<SPPath>(use(*doc, id)->child); };
+    ASSERT_TRUE(path_of("u1") && path_of("u2"));
+    EXPECT_EQ(path_of("u1")->curve()->boundsFast(), Geom::OptRect(Geom::Rect(0, 0, 10, 10)));
+
+    doc->getObjectById("p")->setAttribute("d", "M 0,0 H 20 V 20 Z");
+    doc->ensureUpToDate();
+    for (auto id : {"u1", "u2"}) {
+        EXPECT_EQ(path_of(id)->curve()->boundsFast(), Geom::OptRect(Geom::Rect(0, 0, 20, 20))) << id;
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -12,10 +12,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cstring>
 #include <list>
 #include <memory>
 #include <string>
 #include <gtest/gtest.h>
+#include "xml/node-fns.h"
 #include "xml/repr.h"
 
 TEST(XmlTest, nodeiter)
@@ -98,6 +100,107 @@ NODE
 )""");
 }
 
+TEST(XmlTest, manyAttributes)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg><g/></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+    auto group = testdoc->root()->firstChild();
+    ASSERT_TRUE(group);
+
+    // Enough attributes for the node to switch to indexed lookups.
+    for (int i = 0; i < 100; i++) {
+        group->setAttribute("data-attr" + std::to_string(i), std::to_string(i));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(group->attribute(("data-attr" + std::to_string(i)).c_str()), std::to_string(i));
+    }
+    EXPECT_EQ(group->attribute("data-missing"), nullptr);
+
+    // Remove every other attribute; the rest must still be found and keep their order.
+    for (int i = 0; i < 100; i += 2) {
+        group->removeAttribute("data-attr" + std::to_string(i));
+    }
+    group->setAttribute("data-attr5", "five");
+
+    int expected = 1;
+    for (auto const &attr : group->attributeList()) {
+        EXPECT_EQ(g_quark_to_string(attr.key), "data-attr" + std::to_string(expected));
+        expected += 2;
+    }
+    EXPECT_EQ(expected, 101);
+    EXPECT_STREQ(group->attribute("data-attr5"), "five");
+    EXPECT_STREQ(group->attribute("data-attr99"), "99");
+    EXPECT_EQ(group->attribute("data-attr98"), nullptr);
+
+    // Copies carry their own index.
+    auto copy = group->duplicate(testdoc.get());
+    EXPECT_STREQ(copy->attribute("data-attr77"), "77");
+    Inkscape::GC::release(copy);
+}
+
+TEST(XmlTest, memoryUsage)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(
+        sp_repr_read_buf("<svg><g id='a'/><g id='bb' class='x'><circle/></g></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+
+    auto group = testdoc->root()->nthChild(1);
+    ASSERT_TRUE(group);
+
+    auto usage = Inkscape::XML::memory_usage(*group);
+    EXPECT_EQ(usage.nodes, 2u);
+    EXPECT_EQ(usage.attributes, 2u);
+
+    // Growing an attribute value is accounted for byte by byte.
+    auto const before = usage.bytes;
+    group->setAttribute("class", "x123456789");
+    usage = Inkscape::XML::memory_usage(*group);
+    EXPECT_EQ(usage.bytes, before + 9);
+
+    EXPECT_GT(Inkscape::XML::memory_usage(*testdoc->root()).nodes, usage.nodes);
+
+    // Nodes with many attributes also hold a lookup index.
+    auto const strings_and_records = [](Inkscape::XML::Node const &node) {
+        std::size_t bytes = node.attributeList().capacity() * sizeof(Inkscape::XML::AttributeRecord);
+        for (auto const &attr : node.attributeList()) {
+            bytes += std::strlen(attr.value) + 1;
+        }
+        return bytes;
+    };
+    auto circle = group->firstChild();
+    auto const circle_bytes = Inkscape::XML::memory_usage(*circle).bytes - strings_and_records(*circle);
+    for (int i = 0; i < 100; i++) {
+        circle->setAttribute("data-attr" + std::to_string(i), "1");
+    }
+    EXPECT_GE(Inkscape::XML::memory_usage(*circle).bytes - strings_and_records(*circle),
+              circle_bytes + 100 * sizeof(unsigned));
+}
+
+TEST(XmlTest, sharedStringPool)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg><g/></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+    auto group = testdoc->root()->firstChild();
+
+    // Short values of a document are packed into shared blocks, long ones are allocated alone.
+    group->setAttribute("a", "first");
+    group->setAttribute("b", "second");
+    EXPECT_EQ(group->attribute("b"), group->attribute("a") + std::strlen("first") + 1);
+
+    auto const long_value = std::string(1000, 'x');
+    group->setAttribute("c", long_value);
+    group->setAttribute("d", "third");
+    EXPECT_EQ(group->attribute("c"), long_value);
+    EXPECT_EQ(group->attribute("d"), group->attribute("b") + std::strlen("second") + 1);
+
+    // Values are copied, and stay valid after the source is gone.
+    {
+        auto value = std::string("temporary");
+        group->setAttribute("e", value);
+    }
+    EXPECT_STREQ(group->attribute("e"), "temporary");
+}
+
 /*
   Local Variables:
   mode:c++
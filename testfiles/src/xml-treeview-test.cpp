@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test lazy row creation and change coalescing of the XML editor tree
+ *
+ * Copyright (C) 2025 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <gtest/gtest.h>
+#include <gtkmm/treestore.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "ui/widget/xml-treeview.h"
+#include "xml/node.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+class XmlTreeViewTest : public ::testing::Test
+{
+protected:
+    std::unique_ptr<SPDocument> doc;
+    std::unique_ptr<UI::Widget::XmlTreeView> view;
+
+    void SetUp() override
+    {
+        char const *gui_env = std::getenv("INKSCAPE_TEST_GUI");
+        if (!gui_env || std::string(gui_env) != "1") {
+            GTEST_SKIP() << "Skipping GUI tests: GUI testing not enabled";
+        } else {
+            gtk_init();
+        }
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+
+        std::string svg = R"(<svg xmlns="http://www.w3.org/2000/svg" id="root"><g id="big">)";
+        for (int i = 0; i < 500; i++) {
+            svg += "<rect id=\"r" + std::to_string(i) + "\"/>";
+        }
+        svg += R"(</g><g id="small"><rect id="leaf"/></g></svg>)";
+        doc = SPDocument::createNewDocFromMem(svg);
+        ASSERT_TRUE(doc);
+
+        view = std::make_unique<UI::Widget::XmlTreeView>();
+        view->build_tree(doc.get());
+    }
+
+    void TearDown() override
+    {
+        view.reset();
+    }
+
+    static std::size_t count_rows(Gtk::TreeNodeChildren const &children)
+    {
+        std::size_t count = 0;
+        for (auto const &row : children) {
+            count += 1 + count_rows(row.children());
+        }
+        return count;
+    }
+
+    std::size_t row_count() const
+    {
+        auto store = std::dynamic_pointer_cast<Gtk::TreeStore>(view->get_model());
+        return count_rows(store->children());
+    }
+
+    static std::size_t child_count(XML::Node const *node)
+    {
+        std::size_t count = 0;
+        for (auto child = node->firstChild(); child; child = child->next()) {
+            count++;
+        }
+        return count;
+    }
+
+    static void run_main_loop()
+    {
+        while (g_main_context_iteration(nullptr, false)) {}
+    }
+};
+
+TEST_F(XmlTreeViewTest, OnlyTopLevelIsMaterialized)
+{
+    auto root = doc->getReprRoot();
+    auto const top_level = child_count(root);
+
+    // The root and its children are observed, the 500 rects are not.
+    EXPECT_EQ(view->get_watched_node_count(), 1 + top_level);
+
+    // Children with children of their own only get a placeholder row.
+    std::size_t placeholders = 0;
+    for (auto child = root->firstChild(); child; child = child->next()) {
+        placeholders += child->firstChild() ? 1 : 0;
+    }
+    EXPECT_EQ(row_count(), 1 + top_level + placeholders);
+}
+
+TEST_F(XmlTreeViewTest, SelectingMaterializesAncestors)
+{
+    auto const before = view->get_watched_node_count();
+    view->select_node(doc->getObjectById("leaf")->getRepr());
+
+    // "small" is expanded with its single child, "leaf" itself has no children.
+    EXPECT_EQ(view->get_watched_node_count(), before + 1);
+
+    view->select_node(doc->getObjectById("r10")->getRepr());
+    // Expanding "big" adds its first batch of rects right away, the others on idle.
+    auto const batch = view->get_watched_node_count() - before - 1;
+    EXPECT_GT(batch, 10);
+    EXPECT_LT(batch, 500);
+    run_main_loop();
+    EXPECT_EQ(view->get_watched_node_count(), before + 1 + 500);
+}
+
+TEST_F(XmlTreeViewTest, SelectingBeyondTheBatchMaterializesUpToTheNode)
+{
+    auto const before = view->get_watched_node_count();
+    auto const last = doc->getObjectById("r499")->getRepr();
+    view->select_node(last);
+    EXPECT_EQ(view->get_watched_node_count(), before + 500);
+
+    auto selected = view->get_selection()->get_selected();
+    ASSERT_TRUE(selected);
+    EXPECT_EQ(view->get_repr(*selected), last);
+}
+
+TEST_F(XmlTreeViewTest, ChangesWhilePopulatingEndInDocumentOrder)
+{
+    auto big = doc->getObjectById("big")->getRepr();
+    view->select_node(doc->getObjectById("r0")->getRepr());
+
+    // Change children on both sides of the rows added so far.
+    auto r1 = doc->getObjectById("r1")->getRepr();
+    auto r300 = doc->getObjectById("r300")->getRepr();
+    big->changeOrder(r300, nullptr);
+    big->changeOrder(r1, big->lastChild());
+    big->removeChild(doc->getObjectById("r400")->getRepr());
+    big->removeChild(doc->getObjectById("r200")->getRepr()); // The next one to get a row.
+    for (int i = 0; i < 3; i++) {
+        auto rect = doc->getReprDoc()->createElement("svg:rect");
+        big->addChild(rect, i == 0 ? nullptr : doc->getObjectById("r250")->getRepr());
+        GC::release(rect);
+    }
+    run_main_loop();
+
+    auto store = std::dynamic_pointer_cast<Gtk::TreeStore>(view->get_model());
+    auto path = store->get_path(view->get_selection()->get_selected());
+    path.up();
+    auto rows = store->get_iter(path)->children();
+    ASSERT_EQ(rows.size(), child_count(big));
+    auto child = big->firstChild();
+    for (auto const &row : rows) {
+        EXPECT_EQ(view->get_repr(row), child);
+        child = child->next();
+    }
+}
+
+TEST_F(XmlTreeViewTest, ChangesAreCoalesced)
+{
+    auto root = doc->getReprRoot();
+    auto const rows = row_count();
+    auto const watched = view->get_watched_node_count();
+
+    // Adding to an unexpanded group doesn't create rows or observers.
+    auto big = doc->getObjectById("big")->getRepr();
+    for (int i = 0; i < 100; i++) {
+        auto rect = doc->getReprDoc()->createElement("svg:rect");
+        big->appendChild(rect);
+        GC::release(rect);
+    }
+    run_main_loop();
+    EXPECT_EQ(row_count(), rows);
+    EXPECT_EQ(view->get_watched_node_count(), watched);
+
+    // Rows for new children of expanded nodes appear on the next tick, in document order.
+    auto rect = doc->getReprDoc()->createElement("svg:rect");
+    root->addChild(rect, nullptr);
+    GC::release(rect);
+    EXPECT_EQ(row_count(), rows);
+    run_main_loop();
+    EXPECT_EQ(row_count(), rows + 1);
+    EXPECT_EQ(view->get_watched_node_count(), watched + 1);
+
+    auto store = std::dynamic_pointer_cast<Gtk::TreeStore>(view->get_model());
+    auto first = store->children().begin()->children().begin();
+    EXPECT_EQ(view->get_repr(*first), rect);
+
+    // Removal is immediate.
+    root->removeChild(rect);
+    EXPECT_EQ(row_count(), rows);
+    EXPECT_EQ(view->get_watched_node_count(), watched);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :